@@ -0,0 +1,107 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CHECKHEADER_SLIB_BENCH
+#define CHECKHEADER_SLIB_BENCH
+
+#include "slib/core/definition.h"
+
+#include <chrono>
+#include <stdio.h>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+namespace slib
+{
+	namespace bench
+	{
+
+		class Stopwatch
+		{
+		public:
+			Stopwatch()
+			{
+				reset();
+			}
+
+		public:
+			void reset()
+			{
+				m_start = std::chrono::steady_clock::now();
+			}
+
+			double getElapsedMilliseconds() const
+			{
+				return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_start).count();
+			}
+
+		private:
+			std::chrono::steady_clock::time_point m_start;
+
+		};
+
+		// runs `f` `nRepeat` times and returns the fastest run in milliseconds
+		template <class FN>
+		inline double measure(sl_uint32 nRepeat, const FN& f)
+		{
+			double best = 0;
+			for (sl_uint32 i = 0; i < nRepeat; i++) {
+				Stopwatch sw;
+				f();
+				double t = sw.getElapsedMilliseconds();
+				if (!i || t < best) {
+					best = t;
+				}
+			}
+			return best;
+		}
+
+		inline void printHeader(const char* title)
+		{
+			printf("\n== %s\n", title);
+		}
+
+		// `nOps` operations or `nBytes` bytes processed in `ms`. zero is not printed
+		inline void printResult(const char* name, double ms, double nOps, double nBytes = 0)
+		{
+			printf("%-48s %10.2f ms", name, ms);
+			if (nOps > 0 && ms > 0) {
+				printf(" %14.0f ops/s", nOps * 1000 / ms);
+			}
+			if (nBytes > 0 && ms > 0) {
+				printf(" %10.1f MB/s", nBytes / ms / 1000);
+			}
+			printf("\n");
+		}
+
+		// returns the freed memory of the previous case to the system, so that its consolidation is not charged to the next case
+		inline void trimHeap()
+		{
+#if defined(__GLIBC__)
+			malloc_trim(0);
+#endif
+		}
+
+		// prevents the compiler from removing the computation of `value`
+		template <class T>
+		SLIB_INLINE void keep(const T& value)
+		{
+#if defined(__GNUC__) || defined(__clang__)
+			__asm__ __volatile__("" : : "r"(&value) : "memory");
+#else
+			(void)(*((const volatile sl_uint8*)&value));
+#endif
+		}
+
+	}
+}
+
+#endif
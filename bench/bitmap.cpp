@@ -0,0 +1,98 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/*
+	`BitmapData::copyPixelsFrom` on 1080p frames, for the format pairs converted by the row kernels
+	Each pair is compared with a neighbouring pair of the same kind of work which has no kernel (ARGB or ABGR in place of RGBA or BGRA),
+	and so is still converted pixel by pixel through the sample procs, as all the pairs were before the kernels.
+*/
+
+#include "bench.h"
+
+#include "slib/graphics/bitmap_data.h"
+#include "slib/core/memory.h"
+
+using namespace slib;
+using namespace slib::bench;
+
+namespace
+{
+
+	const sl_uint32 g_width = 1920;
+	const sl_uint32 g_height = 1080;
+
+	class Frame
+	{
+	public:
+		Frame(BitmapFormat format)
+		{
+			mem = Memory::create(g_width * g_height * 4 + 4096);
+			sl_uint8* p = (sl_uint8*)(mem.getData());
+			sl_uint64 seed = (sl_uint64)(format) + 1;
+			for (sl_size i = 0; i < mem.getSize(); i++) {
+				seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+				p[i] = (sl_uint8)(seed >> 56);
+			}
+			bitmap.width = g_width;
+			bitmap.height = g_height;
+			bitmap.format = format;
+			bitmap.data = p;
+			bitmap.fillDefaultValues();
+		}
+
+	public:
+		Memory mem;
+		BitmapData bitmap;
+
+	};
+
+	struct Pair
+	{
+		const char* name;
+		BitmapFormat src;
+		BitmapFormat dst;
+	};
+
+	double run(const Pair& pair)
+	{
+		Frame src(pair.src);
+		Frame dst(pair.dst);
+		return measure(5, [&]() {
+			dst.bitmap.copyPixelsFrom(src.bitmap);
+		});
+	}
+
+}
+
+int main(int argc, const char* argv[])
+{
+	// kernel pair followed by the pair converted by the sample procs
+	Pair pairs[][2] = {
+		{{"RGBA -> BGRA", BitmapFormat::RGBA, BitmapFormat::BGRA}, {"RGBA -> ABGR", BitmapFormat::RGBA, BitmapFormat::ABGR}},
+		{{"RGB -> RGBA", BitmapFormat::RGB, BitmapFormat::RGBA}, {"RGB -> ARGB", BitmapFormat::RGB, BitmapFormat::ARGB}},
+		{{"RGBA -> RGB", BitmapFormat::RGBA, BitmapFormat::RGB}, {"ARGB -> RGB", BitmapFormat::ARGB, BitmapFormat::RGB}},
+		{{"RGBA -> RGBA_PA (premultiply)", BitmapFormat::RGBA, BitmapFormat::RGBA_PA}, {"RGBA -> ABGR_PA", BitmapFormat::RGBA, BitmapFormat::ABGR_PA}},
+		{{"RGBA_PA -> RGBA (unpremultiply)", BitmapFormat::RGBA_PA, BitmapFormat::RGBA}, {"ABGR_PA -> RGBA", BitmapFormat::ABGR_PA, BitmapFormat::RGBA}},
+		{{"YUV_I420 -> RGBA", BitmapFormat::YUV_I420, BitmapFormat::RGBA}, {"YUV_I420 -> ARGB", BitmapFormat::YUV_I420, BitmapFormat::ARGB}},
+		{{"YUV_NV12 -> RGBA", BitmapFormat::YUV_NV12, BitmapFormat::RGBA}, {"YUV_NV12 -> ARGB", BitmapFormat::YUV_NV12, BitmapFormat::ARGB}},
+		{{"YUV_NV21 -> BGRA", BitmapFormat::YUV_NV21, BitmapFormat::BGRA}, {"YUV_NV21 -> ABGR", BitmapFormat::YUV_NV21, BitmapFormat::ABGR}},
+		{{"RGBA -> YUV_I420", BitmapFormat::RGBA, BitmapFormat::YUV_I420}, {"ARGB -> YUV_I420", BitmapFormat::ARGB, BitmapFormat::YUV_I420}},
+		{{"BGRA -> YUV_NV12", BitmapFormat::BGRA, BitmapFormat::YUV_NV12}, {"ABGR -> YUV_NV12", BitmapFormat::ABGR, BitmapFormat::YUV_NV12}}
+	};
+	printHeader("1920x1080 frame, row kernel against sample procs");
+	for (sl_uint32 i = 0; i < sizeof(pairs) / sizeof(pairs[0]); i++) {
+		double msKernel = run(pairs[i][0]);
+		double msProcs = run(pairs[i][1]);
+		printResult(pairs[i][0].name, msKernel, (double)g_width * g_height);
+		printResult(pairs[i][1].name, msProcs, (double)g_width * g_height);
+		printf("%-48s %10.1fx\n", "", msProcs / msKernel);
+	}
+	return 0;
+}
@@ -0,0 +1,158 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/*
+	Throughput of `HashBytes` (wyhash) against the previous byte hashes, over several key-length distributions
+	- previous `HashBytes`: Adler-32 style, two modulo operations per byte
+	- previous string hash: `h * 31 + c` per character
+	- `WyHash` streaming input, fed in 4KB pieces
+*/
+
+#include "bench.h"
+
+#include "slib/core/hash.h"
+
+using namespace slib;
+using namespace slib::bench;
+
+namespace
+{
+
+	sl_uint32 hashAdlerPrevious(const void* _buf, sl_size n)
+	{
+		sl_uint8* buf = (sl_uint8*)_buf;
+		sl_uint32 a = 1, b = 0;
+		for (sl_size i = 0; i < n; i++) {
+			a = (a + buf[i]) % 65521;
+			b = (b + a) % 65521;
+		}
+		return Rehash((b << 16) | a);
+	}
+
+	sl_uint32 hashStringPrevious(const void* _buf, sl_size n)
+	{
+		sl_uint8* buf = (sl_uint8*)_buf;
+		sl_uint32 hash = 0;
+		for (sl_size i = 0; i < n; i++) {
+			hash = hash * 31 + buf[i];
+		}
+		return Rehash(hash);
+	}
+
+	sl_uint32 hashBytes(const void* buf, sl_size n)
+	{
+		return HashBytes(buf, n);
+	}
+
+	sl_uint32 hashBytes64(const void* buf, sl_size n)
+	{
+		return (sl_uint32)(HashBytes64(buf, n));
+	}
+
+	sl_uint32 hashStreaming(const void* buf, sl_size n)
+	{
+		WyHash hash;
+		hash.start(1);
+		const sl_uint8* p = (const sl_uint8*)buf;
+		while (n) {
+			sl_size m = n < 4096 ? n : 4096;
+			hash.update(p, m);
+			p += m;
+			n -= m;
+		}
+		return (sl_uint32)(hash.finish());
+	}
+
+	struct Key
+	{
+		sl_uint32 offset;
+		sl_uint32 length;
+	};
+
+	struct Distribution
+	{
+		const char* name;
+		sl_uint32 lengthMin;
+		sl_uint32 lengthMax;
+		sl_uint32 nKeys;
+	};
+
+	typedef sl_uint32(*HashFunction)(const void* buf, sl_size n);
+
+	void run(const Distribution& dist, const sl_uint8* data, sl_size sizeData)
+	{
+		Key* keys = new Key[dist.nKeys];
+		sl_uint64 seed = 1;
+		double nBytes = 0;
+		for (sl_uint32 i = 0; i < dist.nKeys; i++) {
+			seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+			sl_uint32 r = (sl_uint32)(seed >> 33);
+			sl_uint32 len = dist.lengthMin + r % (dist.lengthMax - dist.lengthMin + 1);
+			keys[i].length = len;
+			keys[i].offset = (sl_uint32)((r * 2654435761u) % (sizeData - len + 1));
+			nBytes += len;
+		}
+		char title[128];
+		sprintf(title, "%s: %u keys of %u~%u bytes", dist.name, dist.nKeys, dist.lengthMin, dist.lengthMax);
+		printHeader(title);
+
+		struct Candidate
+		{
+			const char* name;
+			HashFunction fn;
+		} candidates[] = {
+			{"previous HashBytes (adler, % per byte)", hashAdlerPrevious},
+			{"previous string hash (h * 31 + c)", hashStringPrevious},
+			{"HashBytes (wyhash, 32-bit)", hashBytes},
+			{"HashBytes64 (wyhash)", hashBytes64},
+			{"WyHash streaming (4KB pieces)", hashStreaming}
+		};
+		sl_uint32 nRepeat = (sl_uint32)(200000000 / nBytes) + 1;
+		for (sl_uint32 k = 0; k < sizeof(candidates) / sizeof(candidates[0]); k++) {
+			HashFunction fn = candidates[k].fn;
+			double ms = measure(3, [&]() {
+				sl_uint32 sum = 0;
+				for (sl_uint32 r = 0; r < nRepeat; r++) {
+					for (sl_uint32 i = 0; i < dist.nKeys; i++) {
+						sum += fn(data + keys[i].offset, keys[i].length);
+					}
+				}
+				keep(sum);
+			});
+			printResult(candidates[k].name, ms, (double)dist.nKeys * nRepeat, nBytes * nRepeat);
+		}
+		delete[] keys;
+	}
+
+}
+
+int main(int argc, const char* argv[])
+{
+	const sl_size sizeData = 4 << 20;
+	sl_uint8* data = new sl_uint8[sizeData];
+	sl_uint64 seed = 7;
+	for (sl_size i = 0; i < sizeData; i++) {
+		seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+		// printable text, like the keys of the maps
+		data[i] = (sl_uint8)(32 + (seed >> 33) % 95);
+	}
+	Distribution dists[] = {
+		{"integers and short codes", 4, 8, 100000},
+		{"identifiers", 8, 32, 100000},
+		{"header names and URLs", 16, 128, 100000},
+		{"JSON documents", 256, 4096, 10000},
+		{"bulk", 1 << 20, 1 << 20, 4}
+	};
+	for (sl_uint32 i = 0; i < sizeof(dists) / sizeof(dists[0]); i++) {
+		run(dists[i], data, sizeData);
+	}
+	delete[] data;
+	return 0;
+}
@@ -0,0 +1,200 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/*
+	Chained `HashTable` against open-addressing `FlatHashTable`
+	- insertion, successful and failed lookups, and removal of the integer and string keys, from cache-resident to memory-bound sizes
+	- the lookups visit the keys in a shuffled order, so that the chained entries allocated in the insertion order don't get the help of the prefetcher
+	- the same operations through `HashMap` and `Map::createFlatHash()`
+*/
+
+#include "bench.h"
+
+#include "slib/core/hashtable.h"
+#include "slib/core/flat_hashtable.h"
+#include "slib/core/map.h"
+#include "slib/core/string.h"
+
+using namespace slib;
+using namespace slib::bench;
+
+namespace
+{
+
+	sl_uint64 random64(sl_uint64& state)
+	{
+		// splitmix64
+		sl_uint64 z = (state += 0x9E3779B97F4A7C15ULL);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+		return z ^ (z >> 31);
+	}
+
+	template <class KT>
+	void makeKeys(sl_uint32 n, sl_uint64 seed, KT* keys);
+
+	template <>
+	void makeKeys<sl_uint64>(sl_uint32 n, sl_uint64 seed, sl_uint64* keys)
+	{
+		for (sl_uint32 i = 0; i < n; i++) {
+			keys[i] = random64(seed);
+		}
+	}
+
+	template <>
+	void makeKeys<String>(sl_uint32 n, sl_uint64 seed, String* keys)
+	{
+		// identifier-like keys of 8~40 characters
+		for (sl_uint32 i = 0; i < n; i++) {
+			sl_uint64 r = random64(seed);
+			String s = "key_" + String::fromUint64(r, 36) + "_";
+			sl_uint32 len = 8 + (sl_uint32)(r % 33);
+			while (s.getLength() < len) {
+				s += "x";
+			}
+			keys[i] = s.substring(0, len);
+		}
+	}
+
+	void shuffle(sl_uint32* order, sl_uint32 n, sl_uint64 seed)
+	{
+		for (sl_uint32 i = 0; i < n; i++) {
+			order[i] = i;
+		}
+		for (sl_uint32 i = n - 1; i > 0; i--) {
+			sl_uint32 j = (sl_uint32)(random64(seed) % (i + 1));
+			sl_uint32 t = order[i];
+			order[i] = order[j];
+			order[j] = t;
+		}
+	}
+
+	template <class TABLE, class KT>
+	void runTable(const char* name, sl_uint32 n, const KT* keys, const KT* missing, const sl_uint32* order)
+	{
+		TABLE table;
+		double ms = measure(1, [&]() {
+			for (sl_uint32 i = 0; i < n; i++) {
+				table.put(keys[i], i);
+			}
+		});
+		char label[128];
+		sprintf(label, "%s insert", name);
+		printResult(label, ms, n);
+
+		sl_uint32 nRepeat = n < 100000 ? 1000000 / n : 1;
+		ms = measure(3, [&]() {
+			sl_uint64 sum = 0;
+			for (sl_uint32 k = 0; k < nRepeat; k++) {
+				for (sl_uint32 i = 0; i < n; i++) {
+					sl_uint32 v;
+					if (table.get(keys[order[i]], &v)) {
+						sum += v;
+					}
+				}
+			}
+			keep(sum);
+		});
+		sprintf(label, "%s lookup (hit)", name);
+		printResult(label, ms, (double)n * nRepeat);
+
+		ms = measure(3, [&]() {
+			sl_uint64 sum = 0;
+			for (sl_uint32 k = 0; k < nRepeat; k++) {
+				for (sl_uint32 i = 0; i < n; i++) {
+					sl_uint32 v;
+					if (table.get(missing[i], &v)) {
+						sum += v;
+					}
+				}
+			}
+			keep(sum);
+		});
+		sprintf(label, "%s lookup (miss)", name);
+		printResult(label, ms, (double)n * nRepeat);
+
+		ms = measure(1, [&]() {
+			for (sl_uint32 i = 0; i < n; i++) {
+				table.remove(keys[order[i]]);
+			}
+		});
+		sprintf(label, "%s remove", name);
+		printResult(label, ms, n);
+	}
+
+	template <class KT>
+	void runSize(const char* nameKey, sl_uint32 n)
+	{
+		trimHeap();
+		KT* keys = new KT[n];
+		KT* missing = new KT[n];
+		sl_uint32* order = new sl_uint32[n];
+		makeKeys<KT>(n, 1, keys);
+		makeKeys<KT>(n, 2, missing);
+		shuffle(order, n, 3);
+		char title[128];
+		sprintf(title, "%u %s keys", n, nameKey);
+		printHeader(title);
+		runTable< HashTable<KT, sl_uint32> >("HashTable", n, keys, missing, order);
+		runTable< FlatHashTable<KT, sl_uint32> >("FlatHashTable", n, keys, missing, order);
+		delete[] keys;
+		delete[] missing;
+		delete[] order;
+	}
+
+	template <class KT>
+	void runMap(const char* name, Map<KT, sl_uint32> map, sl_uint32 n, const KT* keys)
+	{
+		double ms = measure(1, [&]() {
+			for (sl_uint32 i = 0; i < n; i++) {
+				map.put_NoLock(keys[i], i);
+			}
+		});
+		char label[128];
+		sprintf(label, "%s insert", name);
+		printResult(label, ms, n);
+		ms = measure(3, [&]() {
+			sl_uint64 sum = 0;
+			for (sl_uint32 i = 0; i < n; i++) {
+				sl_uint32 v;
+				if (map.get_NoLock(keys[(i * 7919) % n], &v)) {
+					sum += v;
+				}
+			}
+			keep(sum);
+		});
+		sprintf(label, "%s lookup (hit)", name);
+		printResult(label, ms, n);
+	}
+
+}
+
+int main(int argc, const char* argv[])
+{
+	sl_uint32 sizes[] = {1000, 100000, 1000000};
+	for (sl_uint32 i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+		runSize<sl_uint64>("integer", sizes[i]);
+	}
+	for (sl_uint32 i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+		runSize<String>("string", sizes[i]);
+	}
+
+	{
+		trimHeap();
+		const sl_uint32 n = 200000;
+		String* keys = new String[n];
+		makeKeys<String>(n, 3, keys);
+		printHeader("200000 string keys through Map");
+		runMap<String>("Map::createHash", Map<String, sl_uint32>::createHash(), n, keys);
+		runMap<String>("Map::createFlatHash", Map<String, sl_uint32>::createFlatHash(), n, keys);
+		delete[] keys;
+	}
+	return 0;
+}
@@ -0,0 +1,429 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/*
+	Small HTTP responses over the loopback, with the gathered output (`AsyncStream::writeV`) and without it
+	- the streams without writeV are wrapped by a forwarding stream which doesn't support it, so `AsyncOutput` copies the chunks into its buffer as before
+	- latency of the sequential keep-alive requests to `HttpService`
+	  (the copied output sends the header and the body by separate writes, and the service doesn't disable Nagle's algorithm,
+	  so a small body may wait for the delayed ACK of the client: the counts are kept small for the copied output to finish in time)
+	- `AsyncOutput` sending a queue of responses at once, as the responses written before the previous ones are sent
+	  (`HttpService` doesn't process the pipelined requests, so the queue is filled directly)
+	- the send syscalls of the server side are counted by interposing `send()` and `sendmsg()`
+*/
+
+#include "bench.h"
+
+#include "slib/network/http_service.h"
+#include "slib/network/async.h"
+
+#include <dlfcn.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <string.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+	volatile sl_int32 g_nSendCalls = 0;
+}
+
+// the client side of this benchmark uses `write()`, so only the calls from the service are counted
+extern "C" ssize_t send(int fd, const void* buf, size_t n, int flags)
+{
+	typedef ssize_t(*FN)(int, const void*, size_t, int);
+	static FN fn = (FN)(dlsym(RTLD_NEXT, "send"));
+	slib::Base::interlockedIncrement32((sl_int32*)&g_nSendCalls);
+	return fn(fd, buf, n, flags);
+}
+
+extern "C" ssize_t sendmsg(int fd, const struct msghdr* msg, int flags)
+{
+	typedef ssize_t(*FN)(int, const struct msghdr*, int);
+	static FN fn = (FN)(dlsym(RTLD_NEXT, "sendmsg"));
+	slib::Base::interlockedIncrement32((sl_int32*)&g_nSendCalls);
+	return fn(fd, msg, flags);
+}
+
+using namespace slib;
+using namespace slib::bench;
+
+namespace
+{
+
+	// one port for each service, as a port just released may not be bound again at once
+	const sl_uint16 g_portWriteV = 18590;
+	const sl_uint16 g_portCopy = 18591;
+	const sl_uint16 g_portQueue = 18592;
+
+	// forwards to the socket stream, without the gathered output
+	class ForwardingStream : public AsyncStream
+	{
+	public:
+		ForwardingStream(const Ref<AsyncStream>& stream): m_stream(stream)
+		{
+		}
+
+	public:
+		// override
+		void close()
+		{
+			m_stream->close();
+		}
+
+		// override
+		sl_bool isOpened()
+		{
+			return m_stream->isOpened();
+		}
+
+		// override
+		sl_bool read(void* data, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback, Referable* userObject)
+		{
+			return m_stream->read(data, size, callback, userObject);
+		}
+
+		// override
+		sl_bool write(void* data, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback, Referable* userObject)
+		{
+			return m_stream->write(data, size, callback, userObject);
+		}
+
+		// override
+		sl_bool addTask(const Function<void()>& callback)
+		{
+			return m_stream->addTask(callback);
+		}
+
+	private:
+		Ref<AsyncStream> m_stream;
+
+	};
+
+	class BenchService : public HttpService
+	{
+	public:
+		static Ref<BenchService> create(const HttpServiceParam& param, sl_bool flagWriteV)
+		{
+			Ref<BenchService> ret = new BenchService;
+			if (ret.isNotNull()) {
+				ret->m_flagWriteV = flagWriteV;
+				if (ret->_init(param)) {
+					return ret;
+				}
+			}
+			return sl_null;
+		}
+
+	public:
+		// override
+		Ref<HttpServiceConnection> addConnection(const Ref<AsyncStream>& stream, const SocketAddress& remoteAddress, const SocketAddress& localAddress)
+		{
+			if (m_flagWriteV) {
+				return HttpService::addConnection(stream, remoteAddress, localAddress);
+			} else {
+				return HttpService::addConnection(new ForwardingStream(stream), remoteAddress, localAddress);
+			}
+		}
+
+	private:
+		sl_bool m_flagWriteV;
+
+	};
+
+	Memory g_body64;
+	Memory g_body1K;
+	Memory g_body16K;
+	Memory g_bodyPart;
+
+	sl_bool onRequest(HttpService*, HttpServiceContext* context)
+	{
+		String path = context->getPath();
+		if (path == "/64") {
+			context->write(g_body64);
+		} else if (path == "/1k") {
+			context->write(g_body1K);
+		} else if (path == "/16k") {
+			context->write(g_body16K);
+		} else if (path == "/parts") {
+			// a page built from 32 pieces of 64 bytes
+			for (sl_uint32 i = 0; i < 32; i++) {
+				context->write(g_bodyPart);
+			}
+		}
+		return sl_true;
+	}
+
+	class Client
+	{
+	public:
+		Client(sl_uint16 port)
+		{
+			m_fd = socket(AF_INET, SOCK_STREAM, 0);
+			int one = 1;
+			setsockopt(m_fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+			sockaddr_in addr;
+			Base::zeroMemory(&addr, sizeof(addr));
+			addr.sin_family = AF_INET;
+			addr.sin_port = htons(port);
+			addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+			if (connect(m_fd, (sockaddr*)&addr, sizeof(addr))) {
+				::close(m_fd);
+				m_fd = -1;
+			}
+			m_nBuf = 0;
+		}
+
+		~Client()
+		{
+			if (m_fd >= 0) {
+				::close(m_fd);
+			}
+		}
+
+	public:
+		sl_bool isConnected()
+		{
+			return m_fd >= 0;
+		}
+
+		sl_bool sendRequests(const char* path, sl_uint32 count)
+		{
+			char req[256];
+			int n = sprintf(req, "GET %s HTTP/1.1\r\nHost: 127.0.0.1\r\nConnection: keep-alive\r\n\r\n", path);
+			std::vector<char> buf;
+			for (sl_uint32 i = 0; i < count; i++) {
+				buf.insert(buf.end(), req, req + n);
+			}
+			return ::write(m_fd, buf.data(), buf.size()) == (ssize_t)(buf.size());
+		}
+
+		// reads one response, returns false on error
+		sl_bool readResponse()
+		{
+			for (;;) {
+				char* end = findHeaderEnd();
+				if (end) {
+					const char* cl = strstr(m_buf, "Content-Length: ");
+					if (!cl || cl > end) {
+						return sl_false;
+					}
+					sl_size sizeTotal = (end - m_buf) + (sl_size)(atol(cl + 16));
+					while (m_nBuf < sizeTotal) {
+						if (!(_recv())) {
+							return sl_false;
+						}
+					}
+					memmove(m_buf, m_buf + sizeTotal, m_nBuf - sizeTotal);
+					m_nBuf -= sizeTotal;
+					return sl_true;
+				}
+				if (!(_recv())) {
+					return sl_false;
+				}
+			}
+		}
+
+	private:
+		char* findHeaderEnd()
+		{
+			m_buf[m_nBuf] = 0;
+			char* p = strstr(m_buf, "\r\n\r\n");
+			return p ? p + 4 : sl_null;
+		}
+
+		sl_bool _recv()
+		{
+			if (m_nBuf + 4096 >= sizeof(m_buf)) {
+				return sl_false;
+			}
+			ssize_t n = ::read(m_fd, m_buf + m_nBuf, sizeof(m_buf) - m_nBuf - 1);
+			if (n <= 0) {
+				return sl_false;
+			}
+			m_nBuf += n;
+			return sl_true;
+		}
+
+	private:
+		int m_fd;
+		char m_buf[1 << 20];
+		sl_size m_nBuf;
+
+	};
+
+	void runLatency(sl_uint16 port, const char* path, sl_bool flagWriteV, sl_uint32 nRequests)
+	{
+		Client* client = new Client(port);
+		if (!(client->isConnected())) {
+			printf("cannot connect\n");
+			delete client;
+			return;
+		}
+		std::vector<double> latencies;
+		latencies.reserve(nRequests);
+		// warm up
+		for (sl_uint32 i = 0; i < 20; i++) {
+			client->sendRequests(path, 1);
+			client->readResponse();
+		}
+		sl_int32 nCallsStart = g_nSendCalls;
+		Stopwatch total;
+		for (sl_uint32 i = 0; i < nRequests; i++) {
+			Stopwatch sw;
+			if (!(client->sendRequests(path, 1) && client->readResponse())) {
+				printf("request failed\n");
+				break;
+			}
+			latencies.push_back(sw.getElapsedMilliseconds() * 1000);
+		}
+		double ms = total.getElapsedMilliseconds();
+		sl_int32 nCalls = g_nSendCalls - nCallsStart;
+		delete client;
+		if (latencies.empty()) {
+			return;
+		}
+		std::sort(latencies.begin(), latencies.end());
+		char name[128];
+		sprintf(name, "%s %s", path, flagWriteV ? "writeV" : "copy");
+		printf("%-20s %10.0f req/s   p50 %6.1f us   p99 %6.1f us   %5.2f sends/response\n", name, latencies.size() * 1000 / ms, latencies[latencies.size() / 2], latencies[latencies.size() * 99 / 100], (double)nCalls / latencies.size());
+	}
+
+	// the responses of `HttpService`: the header and the body in separate elements of the output queue
+	void queueResponse(AsyncOutput* output, const Memory& body)
+	{
+		char header[256];
+		int n = sprintf(header, "HTTP/1.1 200 OK\r\nContent-Type: text/html; charset=UTF-8\r\nContent-Length: %u\r\n\r\n", (sl_uint32)(body.getSize()));
+		output->write(header, n);
+		AsyncOutputBuffer buffer;
+		buffer.write(body);
+		output->mergeBuffer(&buffer);
+	}
+
+	void runQueued(const char* name, const Memory& body, sl_bool flagWriteV, sl_uint32 depth, sl_uint32 nBatches)
+	{
+		Ref<Socket> listener = Socket::openTcp();
+		if (listener.isNull()) {
+			return;
+		}
+		listener->setOption_ReuseAddress(sl_true);
+		if (!(listener->bind(SocketAddress(IPv4Address(127, 0, 0, 1), g_portQueue)) && listener->listen())) {
+			printf("cannot listen\n");
+			return;
+		}
+		Client* client = new Client(g_portQueue);
+		Ref<Socket> socket;
+		SocketAddress address;
+		if (!(client->isConnected() && listener->accept(socket, address))) {
+			printf("cannot connect\n");
+			delete client;
+			return;
+		}
+		AsyncTcpSocketParam paramSocket;
+		paramSocket.socket = socket;
+		Ref<AsyncStream> stream = AsyncTcpSocket::create(paramSocket);
+		if (stream.isNull()) {
+			delete client;
+			return;
+		}
+		if (!flagWriteV) {
+			stream = new ForwardingStream(stream);
+		}
+		AsyncOutputParam paramOutput;
+		paramOutput.stream = stream;
+		Ref<AsyncOutput> output = AsyncOutput::create(paramOutput);
+		if (output.isNull()) {
+			delete client;
+			return;
+		}
+		sl_int32 nCallsStart = g_nSendCalls;
+		Stopwatch sw;
+		sl_uint32 nResponses = 0;
+		for (sl_uint32 i = 0; i < nBatches; i++) {
+			for (sl_uint32 k = 0; k < depth; k++) {
+				queueResponse(output.get(), body);
+			}
+			output->startWriting();
+			sl_uint32 k = 0;
+			for (; k < depth; k++) {
+				if (!(client->readResponse())) {
+					break;
+				}
+			}
+			nResponses += k;
+			if (k < depth) {
+				printf("response failed\n");
+				break;
+			}
+		}
+		double ms = sw.getElapsedMilliseconds();
+		sl_int32 nCalls = g_nSendCalls - nCallsStart;
+		output->close();
+		stream->close();
+		delete client;
+		char title[128];
+		sprintf(title, "%s %s", name, flagWriteV ? "writeV" : "copy");
+		printf("%-20s %10.0f responses/s   %5.2f sends/response\n", title, nResponses * 1000 / ms, nResponses ? (double)nCalls / nResponses : 0.0);
+	}
+
+	Memory createBody(sl_size size)
+	{
+		Memory mem = Memory::create(size);
+		Base::resetMemory(mem.getData(), 'a', size);
+		return mem;
+	}
+
+}
+
+int main(int argc, const char* argv[])
+{
+	g_body64 = createBody(64);
+	g_body1K = createBody(1024);
+	g_body16K = createBody(16384);
+	g_bodyPart = createBody(64);
+
+	const char* paths[] = {"/64", "/1k", "/16k", "/parts"};
+	const sl_uint32 nPaths = sizeof(paths) / sizeof(paths[0]);
+
+	for (sl_uint32 m = 0; m < 2; m++) {
+		sl_bool flagWriteV = m == 0;
+		HttpServiceParam param;
+		param.port = flagWriteV ? g_portWriteV : g_portCopy;
+		param.addressBind = IPv4Address(127, 0, 0, 1);
+		param.flagProcessByThreads = sl_false;
+		param.onRequest = &onRequest;
+		Ref<BenchService> service = BenchService::create(param, flagWriteV);
+		if (service.isNull()) {
+			printf("cannot start the service\n");
+			return 1;
+		}
+		printHeader(flagWriteV ? "gathered output (writeV): sequential requests" : "copied output: sequential requests");
+		for (sl_uint32 i = 0; i < nPaths; i++) {
+			runLatency(param.port, paths[i], flagWriteV, 500);
+		}
+		service->release();
+	}
+
+	const char* names[] = {"64 bytes", "1 KB", "16 KB"};
+	Memory bodies[] = {g_body64, g_body1K, g_body16K};
+	for (sl_uint32 m = 0; m < 2; m++) {
+		sl_bool flagWriteV = m == 0;
+		printHeader(flagWriteV ? "gathered output (writeV): 16 queued responses" : "copied output: 16 queued responses");
+		for (sl_uint32 i = 0; i < 3; i++) {
+			runQueued(names[i], bodies[i], flagWriteV, 16, 200);
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,202 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/*
+	NatTable packet rate, translating UDP packets from several threads at once
+	- established flows: every outgoing packet is followed by its reply, both translated by the existing mappings
+	- churning flows: more flows than ports, so that the outgoing packets keep allocating the ports by evicting the least recently used mappings
+	- a single shard (one lock for all the flows) against the default 16 shards
+*/
+
+#include "bench.h"
+
+#include "slib/network/nat.h"
+#include "slib/core/thread.h"
+#include "slib/core/event.h"
+#include "slib/core/system.h"
+
+using namespace slib;
+using namespace slib::bench;
+
+namespace
+{
+
+	enum
+	{
+		PayloadSize = 32,
+		PacketSize = 20 + UdpDatagram::HeaderSize + PayloadSize
+	};
+
+	const IPv4Address g_addressTarget(192, 168, 0, 1);
+	const IPv4Address g_addressServer(8, 8, 8, 8);
+
+	struct Flow
+	{
+		sl_uint8 outgoing[PacketSize];
+		sl_uint8 incoming[PacketSize];
+	};
+
+	void buildPacket(sl_uint8* buf, const IPv4Address& source, sl_uint16 sourcePort, const IPv4Address& destination, sl_uint16 destinationPort)
+	{
+		Base::zeroMemory(buf, PacketSize);
+		IPv4Packet* ip = (IPv4Packet*)buf;
+		ip->setVersion();
+		ip->setHeaderLength();
+		ip->setTotalSize(PacketSize);
+		ip->setTTL(64);
+		ip->setProtocol(NetworkInternetProtocol::UDP);
+		ip->setSourceAddress(source);
+		ip->setDestinationAddress(destination);
+		ip->updateChecksum();
+		UdpDatagram* udp = (UdpDatagram*)(ip->getContent());
+		udp->setSourcePort(sourcePort);
+		udp->setDestinationPort(destinationPort);
+		udp->setTotalSize(UdpDatagram::HeaderSize + PayloadSize);
+		udp->updateChecksum(ip);
+	}
+
+	sl_bool translate(NatTable* nat, sl_uint8* buf, const sl_uint8* packet, sl_bool flagOutgoing)
+	{
+		Base::copyMemory(buf, packet, PacketSize);
+		IPv4Packet* ip = (IPv4Packet*)buf;
+		if (flagOutgoing) {
+			return nat->translateOutgoingPacket(ip, ip->getContent(), PacketSize - 20);
+		} else {
+			return nat->translateIncomingPacket(ip, ip->getContent(), PacketSize - 20);
+		}
+	}
+
+	// internal addresses are unique over the threads
+	Flow* createFlows(NatTable* nat, sl_uint32 iThread, sl_uint32 nFlows, sl_bool flagMap)
+	{
+		Flow* flows = new Flow[nFlows];
+		sl_uint8 buf[PacketSize];
+		for (sl_uint32 i = 0; i < nFlows; i++) {
+			Flow& flow = flows[i];
+			buildPacket(flow.outgoing, IPv4Address(10, (sl_uint8)iThread, (sl_uint8)(i >> 8), (sl_uint8)i), (sl_uint16)(10000 + i), g_addressServer, 53);
+			sl_uint16 port = 0;
+			if (flagMap && translate(nat, buf, flow.outgoing, sl_true)) {
+				port = ((UdpDatagram*)(((IPv4Packet*)buf)->getContent()))->getSourcePort();
+			}
+			buildPacket(flow.incoming, g_addressServer, 53, g_addressTarget, port);
+		}
+		return flows;
+	}
+
+	// returns the translated packets per second
+	double run(sl_uint32 nShards, sl_uint32 nThreads, sl_uint32 nPortsPerThread, sl_uint32 nFlowsPerThread, sl_uint32 nPacketsPerThread, sl_bool flagChurn, sl_uint32* outFailures)
+	{
+		Ref<NatTable> nat = new NatTable;
+		NatTableParam param;
+		param.targetAddress = g_addressTarget;
+		param.udpPortBegin = 20000;
+		param.udpPortEnd = (sl_uint16)(20000 + nPortsPerThread * nThreads - 1);
+		param.shardsCount = nShards;
+		nat->setup(param);
+
+		Flow** flows = new Flow*[nThreads];
+		for (sl_uint32 i = 0; i < nThreads; i++) {
+			flows[i] = createFlows(nat.get(), i, nFlowsPerThread, !flagChurn);
+		}
+
+		Ref<Event> eventStart = Event::create(sl_false);
+		sl_int32 nFailures = 0;
+		sl_int32* pFailures = &nFailures;
+		List< Ref<Thread> > threads;
+		for (sl_uint32 i = 0; i < nThreads; i++) {
+			Flow* flowsThread = flows[i];
+			threads.add_NoLock(Thread::start([nat, eventStart, flowsThread, nFlowsPerThread, nPacketsPerThread, flagChurn, pFailures]() {
+				eventStart->wait();
+				sl_uint8 buf[PacketSize];
+				sl_int32 nFailed = 0;
+				sl_uint32 iFlow = 0;
+				for (sl_uint32 k = 0; k < nPacketsPerThread; k += 2) {
+					Flow& flow = flowsThread[iFlow];
+					if (flagChurn) {
+						if (!(translate(nat.get(), buf, flow.outgoing, sl_true))) {
+							nFailed++;
+						}
+						// the next flow of the cycle starts at its first packet
+						if (!(translate(nat.get(), buf, flowsThread[(iFlow + 1) % nFlowsPerThread].outgoing, sl_true))) {
+							nFailed++;
+						}
+						iFlow = (iFlow + 2) % nFlowsPerThread;
+					} else {
+						if (!(translate(nat.get(), buf, flow.outgoing, sl_true))) {
+							nFailed++;
+						}
+						if (!(translate(nat.get(), buf, flow.incoming, sl_false))) {
+							nFailed++;
+						}
+						iFlow++;
+						if (iFlow == nFlowsPerThread) {
+							iFlow = 0;
+						}
+					}
+				}
+				Base::interlockedAdd32(pFailures, nFailed);
+			}));
+		}
+
+		Stopwatch sw;
+		eventStart->set();
+		for (sl_size i = 0; i < threads.getCount(); i++) {
+			threads[i]->finishAndWait();
+		}
+		double ms = sw.getElapsedMilliseconds();
+
+		for (sl_uint32 i = 0; i < nThreads; i++) {
+			delete[] flows[i];
+		}
+		delete[] flows;
+		if (outFailures) {
+			*outFailures = (sl_uint32)nFailures;
+		}
+		return (double)nPacketsPerThread * nThreads * 1000 / ms;
+	}
+
+	void runCase(const char* title, sl_uint32 nPortsPerThread, sl_uint32 nFlowsPerThread, sl_bool flagChurn)
+	{
+		printHeader(title);
+		sl_uint32 nProcessors = System::getProcessorsCount();
+		sl_uint32 listThreads[] = {1, 2, 4, 8};
+		sl_uint32 listShards[] = {1, 16};
+		const sl_uint32 nPackets = 4000000;
+		for (sl_uint32 i = 0; i < sizeof(listThreads) / sizeof(listThreads[0]); i++) {
+			sl_uint32 nThreads = listThreads[i];
+			for (sl_uint32 j = 0; j < sizeof(listShards) / sizeof(listShards[0]); j++) {
+				sl_uint32 nShards = listShards[j];
+				sl_uint32 nFailures = 0;
+				double rate = 0;
+				for (sl_uint32 r = 0; r < 3; r++) {
+					sl_uint32 n = 0;
+					double t = run(nShards, nThreads, nPortsPerThread, nFlowsPerThread, nPackets / nThreads, flagChurn, &n);
+					if (t > rate) {
+						rate = t;
+						nFailures = n;
+					}
+				}
+				printf("%u threads (%u processors), %2u shards %20.0f packets/s", nThreads, nProcessors, nShards, rate);
+				if (nFailures) {
+					printf(", %u failed", nFailures);
+				}
+				printf("\n");
+			}
+		}
+	}
+
+}
+
+int main(int argc, const char* argv[])
+{
+	runCase("established flows: 2000 flows per thread, 4000 ports per thread", 4000, 2000, sl_false);
+	runCase("churning flows: 2000 flows per thread, 500 ports per thread", 500, 2000, sl_true);
+	return 0;
+}
@@ -0,0 +1,445 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/*
+	Substring search, `replaceAll` and `split` over long log lines (1 MB) and a JSON HTTP body (256 KB)
+	- `String::indexOf` against the previous search (the first character by `memchr`, then comparing the rest), for rare patterns
+	  and for patterns starting with a frequent character
+	- `String16::indexOf`, against the same search with the previous 16-bit character loop
+	- `replaceAll` and `split` against the previous implementations on the previous search
+	- `indexOfAny` against the nearest match of separate searches, searched again on every step or only when passed
+	- `Base::resetMemory2` and `Base::findMemory2` against the previous loops
+	The results of each pair are compared, and a mismatch is reported.
+*/
+
+#include "bench.h"
+
+#include "slib/core/string.h"
+#include "slib/core/string_buffer.h"
+#include "slib/core/list.h"
+#include "slib/core/queue.h"
+
+#include <string.h>
+
+using namespace slib;
+using namespace slib::bench;
+
+namespace
+{
+
+	String createLog(sl_size size)
+	{
+		const char* levels[] = {"INFO", "INFO", "INFO", "DEBUG", "INFO", "WARN"};
+		const char* paths[] = {"/api/v2/items", "/api/v2/orders", "/static/js/app.min.js", "/account/settings", "/search"};
+		const int statuses[] = {200, 200, 200, 304, 200, 404, 200, 302};
+		StringBuffer sb;
+		sl_size len = 0;
+		char line[512];
+		for (sl_uint32 i = 0; len < size; i++) {
+			// one error for every 500 lines
+			const char* level = (i % 500 == 499) ? "ERROR" : levels[i % 6];
+			int status = (i % 500 == 499) ? 500 : statuses[i % 8];
+			int n = sprintf(line, "2017-10-23T12:%02u:%02u.%03uZ %s [worker-%u] 192.168.%u.%u \"GET %s/%u?page=%u HTTP/1.1\" %d %u %u.%ums \"Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/61.0.3163.100 Safari/537.36\"\n",
+				(i / 60000) % 60, (i / 1000) % 60, i % 1000, level, i % 8, (i >> 8) & 255, i & 255, paths[i % 5], (i * 7919) % 100000, i % 10, status, (i * 131) % 50000, i % 90, i % 10);
+			sb.add(String(line, n));
+			len += n;
+		}
+		return sb.merge();
+	}
+
+	String createJsonBody(sl_size size)
+	{
+		StringBuffer sb;
+		sb.addStatic("[", 1);
+		sl_size len = 1;
+		char item[512];
+		for (sl_uint32 i = 0; len < size; i++) {
+			int n = sprintf(item, "%s{\"id\":%u,\"name\":\"item-%u\",\"price\":%u.%02u,\"tags\":[\"sale\",\"new\"],\"description\":\"A sample item number %u with a description long enough to look real.\",\"available\":%s}",
+				i ? "," : "", i, i, (i * 37) % 1000, i % 100, i, (i % 3) ? "true" : "false");
+			sb.add(String(item, n));
+			len += n;
+		}
+		sb.addStatic("]", 1);
+		return sb.merge();
+	}
+
+	// the search before the first-and-last filter
+	template <class CT>
+	const CT* findCharPrevious(const CT* buf, CT ch, sl_size count);
+
+	template <>
+	const sl_char8* findCharPrevious(const sl_char8* buf, sl_char8 ch, sl_size count)
+	{
+		return (const sl_char8*)(memchr(buf, ch, count));
+	}
+
+	// the previous `Base::findMemory2`
+	template <>
+	__attribute__((noinline)) const sl_char16* findCharPrevious(const sl_char16* buf, sl_char16 ch, sl_size count)
+	{
+		for (sl_size i = 0; i < count; i++) {
+			if (buf[i] == ch) {
+				return buf + i;
+			}
+		}
+		return sl_null;
+	}
+
+	template <class CT>
+	sl_reg indexOfPrevious(const CT* buf, sl_size count, const CT* pattern, sl_size countPattern, sl_size start)
+	{
+		if (countPattern > count) {
+			return -1;
+		}
+		while (start <= count - countPattern) {
+			const CT* pt = findCharPrevious(buf + start, pattern[0], count - start - countPattern + 1);
+			if (!pt) {
+				return -1;
+			}
+			if (!(memcmp(pt + 1, pattern + 1, (countPattern - 1) * sizeof(CT)))) {
+				return (sl_reg)(pt - buf);
+			}
+			start = (sl_size)(pt - buf + 1);
+		}
+		return -1;
+	}
+
+	struct Subset
+	{
+		sl_size start;
+		sl_size len;
+	};
+
+	// the previous `replaceAll`: the pattern length is taken on every search, and the pieces are queued
+	String replaceAllPrevious(const String& str, const sl_char8* pattern, const sl_char8* replacement)
+	{
+		sl_size countReplace = Base::getStringLength(replacement);
+		sl_size countPattern = Base::getStringLength(pattern);
+		const sl_char8* buf = str.getData();
+		sl_size count = str.getLength();
+		LinkedQueue<Subset> queue;
+		Subset subset;
+		sl_size size = 0;
+		sl_size start = 0;
+		while (start <= count + countPattern - 1) {
+			sl_reg index = indexOfPrevious(buf, count, pattern, Base::getStringLength(pattern), start);
+			if (index < 0) {
+				index = count;
+			} else {
+				size += countReplace;
+			}
+			subset.start = start;
+			subset.len = index - start;
+			queue.push_NoLock(subset);
+			size += subset.len;
+			start = index + countPattern;
+		}
+		String ret = String::allocate(size);
+		if (ret.isNotNull()) {
+			sl_char8* out = ret.getData();
+			while (queue.pop_NoLock(&subset)) {
+				Base::copyMemory(out, buf + subset.start, subset.len);
+				out += subset.len;
+				if (queue.isNotEmpty()) {
+					Base::copyMemory(out, replacement, countReplace);
+					out += countReplace;
+				}
+			}
+		}
+		return ret;
+	}
+
+	List<String> splitPrevious(const String& str, const sl_char8* pattern)
+	{
+		sl_size countPattern = Base::getStringLength(pattern);
+		List<String> ret;
+		sl_size start = 0;
+		while (1) {
+			sl_reg index = indexOfPrevious(str.getData(), str.getLength(), pattern, countPattern, start);
+			if (index < 0) {
+				ret.add_NoLock(str.substring(start));
+				break;
+			}
+			ret.add_NoLock(str.substring(start, index));
+			start = index + countPattern;
+		}
+		return ret;
+	}
+
+	template <class ST, class CT>
+	sl_size countPrevious(const ST& str, const ST& pattern)
+	{
+		sl_size n = 0;
+		sl_size start = 0;
+		for (;;) {
+			sl_reg index = indexOfPrevious<CT>(str.getData(), str.getLength(), pattern.getData(), pattern.getLength(), start);
+			if (index < 0) {
+				return n;
+			}
+			n++;
+			start = index + pattern.getLength();
+		}
+	}
+
+	template <class ST>
+	sl_size countCurrent(const ST& str, const ST& pattern)
+	{
+		sl_size n = 0;
+		sl_reg start = 0;
+		for (;;) {
+			sl_reg index = str.indexOf(pattern, start);
+			if (index < 0) {
+				return n;
+			}
+			n++;
+			start = index + pattern.getLength();
+		}
+	}
+
+	// the nearest match of the separate searches on every step
+	sl_size countAnyNaive(const String& str, const String* patterns, sl_size nPatterns)
+	{
+		sl_size n = 0;
+		sl_reg start = 0;
+		for (;;) {
+			sl_reg index = -1;
+			sl_size kFound = 0;
+			for (sl_size k = 0; k < nPatterns; k++) {
+				sl_reg i = str.indexOf(patterns[k], start);
+				if (i >= 0 && (index < 0 || i < index)) {
+					index = i;
+					kFound = k;
+				}
+			}
+			if (index < 0) {
+				return n;
+			}
+			n++;
+			start = index + patterns[kFound].getLength();
+		}
+	}
+
+	// the nearest match of the separate searches, each searched again only when its match is passed
+	sl_size countAnySeparate(const String& str, const String* patterns, sl_size nPatterns)
+	{
+		sl_reg next[8];
+		for (sl_size k = 0; k < nPatterns; k++) {
+			next[k] = str.indexOf(patterns[k]);
+		}
+		sl_size n = 0;
+		sl_reg start = 0;
+		for (;;) {
+			sl_reg index = -1;
+			sl_size kFound = 0;
+			for (sl_size k = 0; k < nPatterns; k++) {
+				if (next[k] >= 0 && next[k] < start) {
+					next[k] = str.indexOf(patterns[k], start);
+				}
+				if (next[k] >= 0 && (index < 0 || next[k] < index)) {
+					index = next[k];
+					kFound = k;
+				}
+			}
+			if (index < 0) {
+				return n;
+			}
+			n++;
+			start = index + patterns[kFound].getLength();
+		}
+	}
+
+	sl_size countAny(const String& str, const String* patterns, sl_size nPatterns)
+	{
+		sl_size n = 0;
+		sl_reg start = 0;
+		for (;;) {
+			sl_size k = 0;
+			sl_reg index = str.indexOfAny(patterns, nPatterns, start, &k);
+			if (index < 0) {
+				return n;
+			}
+			n++;
+			start = index + patterns[k].getLength();
+		}
+	}
+
+	void check(sl_bool flagEqual, const char* name)
+	{
+		if (!flagEqual) {
+			printf("MISMATCH: %s\n", name);
+		}
+	}
+
+	template <class ST, class CT>
+	void runSearch(const char* name, const ST& text, const ST& pattern)
+	{
+		sl_size nPrevious = 0;
+		sl_size nCurrent = 0;
+		double msPrevious = measure(5, [&]() {
+			nPrevious = countPrevious<ST, CT>(text, pattern);
+		});
+		double msCurrent = measure(5, [&]() {
+			nCurrent = countCurrent(text, pattern);
+		});
+		check(nPrevious == nCurrent, name);
+		char title[128];
+		sprintf(title, "%s, %u found", name, (sl_uint32)nCurrent);
+		printf("%s\n", title);
+		sl_size nBytes = text.getLength() * sizeof(CT);
+		printResult("  previous search", msPrevious, 1, (double)nBytes);
+		printResult("  indexOf", msCurrent, 1, (double)nBytes);
+		printf("%-48s %10.1fx\n", "", msPrevious / msCurrent);
+	}
+
+	void runReplace(const char* name, const String& text, const sl_char8* pattern, const sl_char8* replacement)
+	{
+		String outPrevious;
+		String outCurrent;
+		double msPrevious = measure(5, [&]() {
+			outPrevious = replaceAllPrevious(text, pattern, replacement);
+		});
+		double msCurrent = measure(5, [&]() {
+			outCurrent = text.replaceAll(pattern, replacement);
+		});
+		check(outPrevious == outCurrent, name);
+		printf("%s\n", name);
+		printResult("  previous replaceAll", msPrevious, 1, (double)(text.getLength()));
+		printResult("  replaceAll", msCurrent, 1, (double)(text.getLength()));
+		printf("%-48s %10.1fx\n", "", msPrevious / msCurrent);
+	}
+
+	void runSplit(const char* name, const String& text, const sl_char8* pattern)
+	{
+		sl_size nPrevious = 0;
+		sl_size nCurrent = 0;
+		double msPrevious = measure(5, [&]() {
+			nPrevious = splitPrevious(text, pattern).getCount();
+		});
+		double msCurrent = measure(5, [&]() {
+			nCurrent = text.split(pattern).getCount();
+		});
+		check(nPrevious == nCurrent, name);
+		printf("%s, %u pieces\n", name, (sl_uint32)nCurrent);
+		printResult("  previous split", msPrevious, 1, (double)(text.getLength()));
+		printResult("  split", msCurrent, 1, (double)(text.getLength()));
+		printf("%-48s %10.1fx\n", "", msPrevious / msCurrent);
+	}
+
+	void runAny(const char* name, const String& text, const String* patterns, sl_size nPatterns)
+	{
+		sl_size nNaive = 0;
+		sl_size nSeparate = 0;
+		sl_size nAny = 0;
+		double msNaive = measure(5, [&]() {
+			nNaive = countAnyNaive(text, patterns, nPatterns);
+		});
+		double msSeparate = measure(5, [&]() {
+			nSeparate = countAnySeparate(text, patterns, nPatterns);
+		});
+		double msAny = measure(5, [&]() {
+			nAny = countAny(text, patterns, nPatterns);
+		});
+		check(nNaive == nAny && nSeparate == nAny, name);
+		printf("%s, %u found\n", name, (sl_uint32)nAny);
+		printResult("  nearest of separate indexOf", msNaive, 1, (double)(text.getLength()));
+		printResult("  same, keeping the matches not passed", msSeparate, 1, (double)(text.getLength()));
+		printResult("  indexOfAny", msAny, 1, (double)(text.getLength()));
+		printf("%-48s %10.1fx %6.1fx\n", "", msNaive / msAny, msSeparate / msAny);
+	}
+
+	// the previous `Base::resetMemory2`
+	__attribute__((noinline)) void resetMemory2Previous(sl_uint16* dst, sl_uint16 value, sl_size count)
+	{
+		for (sl_size i = 0; i < count; i++) {
+			dst[i] = value;
+		}
+	}
+
+	void runMemory2()
+	{
+		const sl_size count = 1 << 20;
+		sl_uint16* buf = new sl_uint16[count];
+		printf("1M characters of 16 bits\n");
+		double ms = measure(5, [&]() {
+			for (sl_uint32 i = 0; i < 16; i++) {
+				resetMemory2Previous(buf, (sl_uint16)(' ' + i), count);
+			}
+			keep(buf[count - 1]);
+		});
+		printResult("  previous resetMemory2", ms, 16, 32.0 * count);
+		double msCurrent = measure(5, [&]() {
+			for (sl_uint32 i = 0; i < 16; i++) {
+				Base::resetMemory2(buf, (sl_uint16)(' ' + i), count);
+			}
+			keep(buf[count - 1]);
+		});
+		printResult("  Base::resetMemory2", msCurrent, 16, 32.0 * count);
+		printf("%-48s %10.1fx\n", "", ms / msCurrent);
+		buf[count - 1] = 'x';
+		// the length differs in each call, so that the calls are not merged by the compiler
+		sl_size sum = 0;
+		ms = measure(5, [&]() {
+			for (sl_uint32 i = 0; i < 16; i++) {
+				sum += (sl_size)(findCharPrevious((const sl_char16*)buf, (sl_char16)'x', count - i) != sl_null);
+			}
+		});
+		const sl_char16* p = findCharPrevious((const sl_char16*)buf, (sl_char16)'x', count);
+		check(p == (const sl_char16*)(buf + count - 1), "previous findMemory2");
+		printResult("  previous findMemory2 (value at the end)", ms, 16, 32.0 * count);
+		msCurrent = measure(5, [&]() {
+			for (sl_uint32 i = 0; i < 16; i++) {
+				sum += (sl_size)(Base::findMemory2(buf, (sl_uint16)'x', count - i) != sl_null);
+			}
+		});
+		keep(sum);
+		const sl_uint16* q = Base::findMemory2(buf, (sl_uint16)'x', count);
+		check(q == buf + count - 1, "findMemory2");
+		printResult("  Base::findMemory2 (value at the end)", msCurrent, 16, 32.0 * count);
+		printf("%-48s %10.1fx\n", "", ms / msCurrent);
+		delete[] buf;
+	}
+
+}
+
+int main(int argc, const char* argv[])
+{
+	String log = createLog(1 << 20);
+	String body = createJsonBody(1 << 18);
+	String16 log16 = log;
+
+	printHeader("indexOf over all the matches");
+	runSearch<String, sl_char8>("log, rare: \"ERROR\"", log, "ERROR");
+	runSearch<String, sl_char8>("log, frequent first char: \" 500 \"", log, " 500 ");
+	runSearch<String, sl_char8>("log, frequent: \"HTTP/1.1\"", log, "HTTP/1.1");
+	runSearch<String, sl_char8>("body, frequent first char: \"\\\"price\\\":\"", body, "\"price\":");
+	runSearch<String, sl_char8>("body, absent: \"\\\"discount\\\":\"", body, "\"discount\":");
+	runSearch<String16, sl_char16>("log16, rare: \"ERROR\"", log16, "ERROR");
+	runSearch<String16, sl_char16>("log16, frequent first char: \" 500 \"", log16, " 500 ");
+
+	printHeader("replaceAll");
+	runReplace("log, lines: \"\\n\" -> \"\\r\\n\"", log, "\n", "\r\n");
+	runReplace("log, rare: \"ERROR\" -> \"FAILURE\"", log, "ERROR", "FAILURE");
+	runReplace("body: \"\\\"price\\\":\" -> \"\\\"cost\\\":\"", body, "\"price\":", "\"cost\":");
+	runReplace("body, absent: \"\\\"discount\\\":\" -> \"\\\"off\\\":\"", body, "\"discount\":", "\"off\":");
+
+	printHeader("split");
+	runSplit("log by lines", log, "\n");
+	runSplit("body by items", body, "},{");
+
+	printHeader("indexOfAny over all the matches");
+	String levels[] = {"ERROR", "WARN", "FATAL"};
+	runAny("log: ERROR, WARN, FATAL", log, levels, 3);
+	String keys[] = {"\"price\":", "\"available\":false", "\"discount\":"};
+	runAny("body: 3 keys", body, keys, 3);
+
+	printHeader("16-bit memory");
+	runMemory2();
+	return 0;
+}
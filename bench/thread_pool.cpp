@@ -0,0 +1,204 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/*
+	ThreadPool contention: the shared-queue pool (`ThreadPool::create`) against the work-stealing pool (`ThreadPool::createWorkStealing`)
+	- tiny tasks submitted from several outside threads at once
+	- tasks forking child tasks from the workers (local LIFO push and stealing)
+	- lateness of the delayed dispatches on the timer wheel
+*/
+
+#include "bench.h"
+
+#include "slib/core/thread_pool.h"
+#include "slib/core/system.h"
+#include "slib/core/event.h"
+#include "slib/core/math.h"
+
+using namespace slib;
+using namespace slib::bench;
+
+namespace
+{
+
+	class Counter
+	{
+	public:
+		Counter(sl_int32 n): m_count(n), m_event(Event::create(sl_false))
+		{
+		}
+
+	public:
+		void done()
+		{
+			if (!(Base::interlockedDecrement32(&m_count))) {
+				m_event->set();
+			}
+		}
+
+		void wait()
+		{
+			m_event->wait();
+		}
+
+	private:
+		sl_int32 m_count;
+		Ref<Event> m_event;
+
+	};
+
+	Ref<ThreadPool> createPool(sl_bool flagStealing, sl_uint32 nWorkers)
+	{
+		if (flagStealing) {
+			return ThreadPool::createWorkStealing(nWorkers);
+		} else {
+			return ThreadPool::create(nWorkers, nWorkers);
+		}
+	}
+
+	double runSubmit(sl_bool flagStealing, sl_uint32 nWorkers, sl_uint32 nSubmitters, sl_uint32 nTasks)
+	{
+		Ref<ThreadPool> pool = createPool(flagStealing, nWorkers);
+		Counter counter((sl_int32)nTasks);
+		Counter* pCounter = &counter;
+		Stopwatch sw;
+		List< Ref<Thread> > threads;
+		for (sl_uint32 i = 0; i < nSubmitters; i++) {
+			sl_uint32 n = nTasks / nSubmitters + (i < nTasks % nSubmitters ? 1 : 0);
+			threads.add_NoLock(Thread::start([pool, pCounter, n]() {
+				for (sl_uint32 k = 0; k < n; k++) {
+					pool->addTask([pCounter]() {
+						pCounter->done();
+					});
+				}
+			}));
+		}
+		counter.wait();
+		double ms = sw.getElapsedMilliseconds();
+		ListElements< Ref<Thread> > elements(threads);
+		for (sl_size i = 0; i < elements.count; i++) {
+			elements[i]->finishAndWait();
+		}
+		pool->release();
+		return ms;
+	}
+
+	void fork(ThreadPool* pool, Counter* counter, sl_uint32 depth)
+	{
+		if (depth) {
+			Ref<ThreadPool> ref = pool;
+			pool->addTask([ref, counter, depth]() {
+				fork(ref.get(), counter, depth - 1);
+			});
+			pool->addTask([ref, counter, depth]() {
+				fork(ref.get(), counter, depth - 1);
+			});
+		}
+		counter->done();
+	}
+
+	double runFork(sl_bool flagStealing, sl_uint32 nWorkers, sl_uint32 depth)
+	{
+		Ref<ThreadPool> pool = createPool(flagStealing, nWorkers);
+		// the complete binary tree of `depth` levels below the root
+		Counter counter((sl_int32)((2 << depth) - 1));
+		Counter* pCounter = &counter;
+		Stopwatch sw;
+		pool->addTask([pool, pCounter, depth]() {
+			fork(pool.get(), pCounter, depth);
+		});
+		counter.wait();
+		double ms = sw.getElapsedMilliseconds();
+		pool->release();
+		return ms;
+	}
+
+	void runDelayed(sl_bool flagStealing, sl_uint32 nWorkers, sl_uint32 nTasks)
+	{
+		Ref<ThreadPool> pool = createPool(flagStealing, nWorkers);
+		Counter counter((sl_int32)nTasks);
+		Counter* pCounter = &counter;
+		sl_int64 sumLate = 0;
+		sl_int64* pSumLate = &sumLate;
+		sl_int32 maxLate = 0;
+		sl_int32* pMaxLate = &maxLate;
+		sl_int32 nEarly = 0;
+		sl_int32* pEarly = &nEarly;
+		Stopwatch* sw = new Stopwatch;
+		sl_uint32 seed = 1;
+		for (sl_uint32 i = 0; i < nTasks; i++) {
+			seed = seed * 1103515245 + 12345;
+			sl_uint32 delay = 1 + (seed >> 16) % 500;
+			double due = sw->getElapsedMilliseconds() + delay;
+			pool->dispatch([sw, due, pCounter, pSumLate, pMaxLate, pEarly]() {
+				double late = sw->getElapsedMilliseconds() - due;
+				if (late < 0) {
+					Base::interlockedIncrement32(pEarly);
+					late = 0;
+				}
+				sl_int32 us = (sl_int32)(late * 1000);
+				Base::interlockedAdd64(pSumLate, us);
+				for (;;) {
+					sl_int32 old = *pMaxLate;
+					if (us <= old || Base::interlockedCompareExchange32(pMaxLate, us, old)) {
+						break;
+					}
+				}
+				pCounter->done();
+			}, delay);
+		}
+		counter.wait();
+		pool->release();
+		delete sw;
+		printf("%-48s avg %.3f ms, max %.3f ms, early %d\n", flagStealing ? "work-stealing" : "shared queue", (double)sumLate / nTasks / 1000, (double)maxLate / 1000, nEarly);
+	}
+
+}
+
+int main(int argc, const char* argv[])
+{
+	sl_uint32 nWorkers = System::getProcessorsCount();
+	const sl_uint32 nTasks = 1000000;
+	printf("workers: %u\n", nWorkers);
+
+	sl_uint32 submitters[] = {1, 4, nWorkers};
+	for (sl_uint32 i = 0; i < sizeof(submitters) / sizeof(submitters[0]); i++) {
+		if (i && submitters[i] <= submitters[i - 1]) {
+			continue;
+		}
+		char title[128];
+		sprintf(title, "%u tiny tasks from %u outside threads", nTasks, submitters[i]);
+		printHeader(title);
+		for (int mode = 0; mode < 2; mode++) {
+			double ms = measure(3, [&]() {
+				runSubmit(mode != 0, nWorkers, submitters[i], nTasks);
+			});
+			printResult(mode ? "work-stealing" : "shared queue", ms, nTasks);
+		}
+	}
+
+	{
+		const sl_uint32 depth = 19;
+		printHeader("binary fork tree of 2^20-1 tasks submitted from the workers");
+		for (int mode = 0; mode < 2; mode++) {
+			double ms = measure(3, [&]() {
+				runFork(mode != 0, nWorkers, depth);
+			});
+			printResult(mode ? "work-stealing" : "shared queue", ms, (double)((2 << depth) - 1));
+		}
+	}
+
+	printHeader("lateness of 100000 delayed dispatches (1~500 ms)");
+	for (int mode = 0; mode < 2; mode++) {
+		runDelayed(mode != 0, nWorkers, 100000);
+	}
+
+	return 0;
+}
@@ -73,6 +73,18 @@ namespace slib
 
 		// override
 		sl_bool dispatch(const Function<void()>& callback, sl_uint64 delay_ms);
+		
+#if defined(SLIB_PLATFORM_IS_LINUX)
+		// io_uring is selected at runtime when the kernel supports it, and epoll is used otherwise
+		static void setIoUringEnabled(sl_bool flagEnabled);
+		
+		sl_bool isIoUring();
+		
+		// io_uring only, must be called in the loop thread. The completion is delivered to `AsyncIoInstance::onEvent()` with `flagCompletion`
+		sl_bool submitRead(AsyncIoInstance* instance, void* data, sl_uint32 size, sl_uint64 offset);
+		
+		sl_bool submitWrite(AsyncIoInstance* instance, const void* data, sl_uint32 size, sl_uint64 offset);
+#endif
 
 	protected:
 		sl_bool m_flagInit;
@@ -98,10 +110,50 @@ namespace slib
 	protected:
 		void _stepBegin();
 		void _stepEnd();
+		
+#if defined(SLIB_PLATFORM_IS_LINUX)
+		void _native_runLoop_IoUring(void* uring);
+#endif
 	
 	};
 	
 	
+	class SLIB_EXPORT AsyncIoLoopGroup : public Object
+	{
+		SLIB_DECLARE_OBJECT
+		
+	private:
+		AsyncIoLoopGroup();
+		
+		~AsyncIoLoopGroup();
+		
+	public:
+		// `nLoops = 0` creates one loop per processor
+		static Ref<AsyncIoLoopGroup> create(sl_uint32 nLoops = 0, sl_bool flagAutoStart = sl_true, sl_bool flagPinToProcessors = sl_true);
+		
+	public:
+		void release();
+		
+		void start();
+		
+		sl_bool isRunning();
+		
+		sl_uint32 getLoopsCount();
+		
+		Ref<AsyncIoLoop> getLoop(sl_uint32 index);
+		
+		// round-robin
+		Ref<AsyncIoLoop> getNextLoop();
+		
+	protected:
+		Array< Ref<AsyncIoLoop> > m_loops;
+		sl_int32 m_indexNext;
+		sl_bool m_flagPinToProcessors;
+		sl_bool m_flagRunning;
+		
+	};
+	
+	
 	class AsyncIoObject;
 	
 	class SLIB_EXPORT AsyncIoInstance : public Object
@@ -156,6 +208,10 @@ namespace slib
 			sl_bool flagIn;
 			sl_bool flagOut;
 			sl_bool flagError;
+#endif
+#if defined(SLIB_PLATFORM_IS_LINUX)
+			sl_bool flagCompletion; // io_uring: an operation submitted by the instance is completed
+			sl_int32 result; // io_uring: transferred size, or negative error code
 #endif
 		};
 		virtual void onEvent(EventDesc* pev) = 0;
@@ -259,6 +315,14 @@ namespace slib
 
 		virtual sl_bool write(void* data, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback, Referable* userObject);
 
+		// returns false if the instance can't send the file region by itself
+		virtual sl_bool writeFromFile(const Ref<File>& file, sl_uint64 offset, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback);
+
+		// returns false if the instance can't gather the chunks by itself
+		virtual sl_bool writeV(const MemoryData* chunks, sl_uint32 nChunks, const Function<void(AsyncStreamResult*)>& callback);
+
+		virtual sl_bool isWriteVSupported();
+
 		virtual sl_bool isSeekable();
 
 		virtual sl_bool seek(sl_uint64 pos);
@@ -310,6 +374,19 @@ namespace slib
 
 		virtual sl_bool write(void* data, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback, Referable* userObject = sl_null) = 0;
 
+		// zero-copy output of a file region (sendfile). Returns false if the stream doesn't support it, and the caller should copy the file by itself
+		virtual sl_bool writeFromFile(const Ref<File>& file, sl_uint64 offset, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback);
+
+		/*
+			Gathered output of the chunks in a request (writev). The request keeps the chunks alive until the callback, and the result size is the total size.
+			Up to `SLIB_ASYNC_STREAM_WRITEV_MAX_CHUNKS` chunks and `SLIB_ASYNC_STREAM_WRITEV_MAX_SIZE` bytes are written at once.
+			Returns false on error, or if the stream doesn't support it (see `isWriteVSupported()`)
+		*/
+		virtual sl_bool writeV(const MemoryData* chunks, sl_uint32 nChunks, const Function<void(AsyncStreamResult*)>& callback);
+
+		// if false, the caller should write the chunks by itself
+		virtual sl_bool isWriteVSupported();
+
 		virtual sl_bool isSeekable();
 
 		virtual sl_bool seek(sl_uint64 pos);
@@ -344,6 +421,15 @@ namespace slib
 		// override
 		sl_bool write(void* data, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback, Referable* userObject = sl_null);
 
+		// override
+		sl_bool writeFromFile(const Ref<File>& file, sl_uint64 offset, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback);
+
+		// override
+		sl_bool writeV(const MemoryData* chunks, sl_uint32 nChunks, const Function<void(AsyncStreamResult*)>& callback);
+
+		// override
+		sl_bool isWriteVSupported();
+
 		// override
 		sl_bool isSeekable();
 
@@ -517,6 +603,11 @@ namespace slib
 
 		static Ref<AsyncStream> openIOCP(const String& path, FileMode mode);
 #endif
+		
+#if defined(SLIB_PLATFORM_IS_LINUX)
+		// returns null if `loop` is not driven by io_uring
+		static Ref<AsyncStream> openIoUring(const String& path, FileMode mode, const Ref<AsyncIoLoop>& loop);
+#endif
 	
 	public:
 		// override
@@ -664,6 +755,13 @@ namespace slib
 	
 	};
 	
+	// maximum size of a file region handed to `AsyncStream::writeFromFile()` at once
+#define SLIB_ASYNC_OUTPUT_FILE_SEGMENT 0x40000000
+
+	// limits of a request of `AsyncStream::writeV()`
+#define SLIB_ASYNC_STREAM_WRITEV_MAX_CHUNKS 64
+#define SLIB_ASYNC_STREAM_WRITEV_MAX_SIZE 0x40000000
+
 	class SLIB_EXPORT AsyncOutputBufferElement : public Referable
 	{
 	public:
@@ -673,6 +771,8 @@ namespace slib
 
 		AsyncOutputBufferElement(AsyncStream* stream, sl_uint64 size);
 
+		AsyncOutputBufferElement(const Ref<File>& file, sl_uint64 offset, sl_uint64 size, const Ref<Dispatcher>& dispatcher);
+
 		~AsyncOutputBufferElement();
 	
 	public:
@@ -684,17 +784,29 @@ namespace slib
 		sl_bool addHeader(const Memory& header);
 
 		void setBody(AsyncStream* stream, sl_uint64 size);
+
+		// file region which can be sent without user-space copies; `dispatcher` is used when it should be copied
+		void setBodyFile(const Ref<File>& file, sl_uint64 offset, sl_uint64 size, const Ref<Dispatcher>& dispatcher);
 	
 		MemoryQueue& getHeader();
 	
 		Ref<AsyncStream> getBody();
 	
 		sl_uint64 getBodySize();
+
+		Ref<File> getBodyFile();
+
+		sl_uint64 getBodyFileOffset();
+
+		Ref<Dispatcher> getBodyFileDispatcher();
 	
 	protected:
 		MemoryQueue m_header;
 		sl_uint64 m_sizeBody;
 		AtomicRef<AsyncStream> m_body;
+		AtomicRef<File> m_bodyFile;
+		sl_uint64 m_offsetBodyFile;
+		AtomicRef<Dispatcher> m_dispatcherBodyFile;
 
 	};
 	
@@ -718,7 +830,12 @@ namespace slib
 
 		sl_bool copyFromFile(const String& path, const Ref<Dispatcher>& dispatcher);
 
+		sl_bool copyFromFile(const String& path, sl_uint64 offset, sl_uint64 size, const Ref<Dispatcher>& dispatcher);
+
 		sl_uint64 getOutputLength() const;
+
+	protected:
+		sl_bool _addBodyFile(const Ref<File>& file, sl_uint64 offset, sl_uint64 size, const Ref<Dispatcher>& dispatcher);
 	
 	protected:
 		sl_uint64 m_lengthOutput;
@@ -796,6 +913,10 @@ namespace slib
 
 		void _write(sl_bool flagCompleted);
 
+		void _writeHeader();
+
+		Ref<AsyncStream> _openBodyFile(const Ref<File>& file, const Ref<Dispatcher>& dispatcher);
+
 	protected:
 		Ref<AsyncStream> m_streamOutput;
 		sl_uint32 m_bufferSize;
@@ -807,6 +928,7 @@ namespace slib
 		Ref<AsyncOutputBufferElement> m_elementWriting;
 		Ref<AsyncCopy> m_copy;
 		Memory m_bufWrite;
+		sl_bool m_flagWriteV;
 		sl_bool m_flagWriting;
 		sl_bool m_flagClosed;
 
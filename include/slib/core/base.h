@@ -132,6 +132,11 @@ namespace slib
 
 		static const sl_int64* findMemory8(const sl_int64* mem, sl_int64 pattern, sl_size count);
 
+		// first occurrence of `pattern` in `mem`, or `mem` if the pattern is empty
+		static const sl_uint8* findMemory(const void* mem, sl_size size, const void* pattern, sl_size sizePattern);
+
+		static const sl_uint16* findMemory2(const sl_uint16* mem, sl_size count, const sl_uint16* pattern, sl_size countPattern);
+
 
 		static const sl_uint8* findMemoryReverse(const void* mem, sl_uint8 pattern, sl_size count);
 
@@ -39,6 +39,9 @@ namespace slib
 
 		static sl_size utf32ToUtf16(const sl_char32* utf32, sl_reg lenUtf32, sl_char16* utf16, sl_reg lenUtf16Buffer);
 
+		// returns sl_true if `utf8` is well-formed: no overlong forms, no encoded surrogates, and no code points beyond U+10FFFF
+		static sl_bool checkUtf8(const sl_char8* utf8, sl_size len);
+
 	};
 
 }
@@ -16,6 +16,8 @@
 #include "dispatch.h"
 #include "thread.h"
 #include "time.h"
+#include "timer_wheel.h"
+#include "flat_hashtable.h"
 
 namespace slib
 {
@@ -61,30 +63,22 @@ namespace slib
 
 		LinkedQueue< Function<void()> > m_queueTasks;
 
+		// delayed tasks and timers, ticking every millisecond
 		struct TimeTask
 		{
-			sl_uint64 time;
 			Function<void()> task;
-		};
-		BTree<sl_uint64, TimeTask> m_timeTasks;
-		Mutex m_lockTimeTasks;
-
-		class TimerTask
-		{
-		public:
 			WeakRef<Timer> timer;
-
-		public:
-			sl_bool operator==(const TimerTask& other) const;
+			// key of `m_mapTimers`, never dereferenced
+			Timer* timerKey;
 		};
-		LinkedQueue<TimerTask> m_queueTimers;
-		Mutex m_lockTimer;
+		TimerWheel<TimeTask> m_timeTasks;
+		FlatHashTable<Timer*, TimerWheelEntry<TimeTask>*> m_mapTimers;
+		Mutex m_lockTimeTasks;
 
 	protected:
 		void _wake();
 		sl_int32 _getTimeout();
 		sl_int32 _getTimeout_TimeTasks();
-		sl_int32 _getTimeout_Timer();
 		void _runLoop();
 
 	};
@@ -28,12 +28,13 @@ namespace slib
 		Map<KT, VT> m_mapBackup;
 
 		sl_uint32 m_duration;
+		sl_bool m_flagFlatHash;
 
 		Ref<Timer> m_timer;
 		WeakRef<DispatchLoop> m_dispatchLoop;
 	
 	public:
-		ExpiringMap();
+		ExpiringMap(sl_bool flagFlatHash = sl_false);
 
 		~ExpiringMap();
 
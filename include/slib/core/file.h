@@ -94,6 +94,37 @@ namespace slib
 	
 	};
 	
+	enum class FileMapMode
+	{
+		// the pages are read-only, and writing to them raises a fault
+		Read = 0,
+		// the written pages are private to the mapping, and never stored to the file
+		CopyOnWrite = 1,
+		// the written pages are shared with the other mappings, and stored to the file
+		Write = 2
+	};
+	
+	// hints for the paging of the mapped region (ignored when the platform does not support)
+	class FileMapHints
+	{
+	public:
+		int value;
+		SLIB_MEMBERS_OF_FLAGS(FileMapHints, value)
+	
+		enum {
+			Normal = 0,
+			Sequential = 1,
+			Random = 2,
+			// starts reading the pages ahead
+			WillNeed = 4,
+			// backs the region by transparent huge pages, when possible
+			HugePage = 8
+		};
+	
+	};
+	
+	class MappedFile;
+	
 	class SLIB_EXPORT File : public IO
 	{
 		SLIB_DECLARE_OBJECT
@@ -235,6 +266,16 @@ namespace slib
 
 		static String16 readAllText16(const String& path, Charset* outCharset = sl_null, sl_size maxSize = SLIB_SIZE_MAX);
 	
+		/*
+			Maps the region of the file into the memory, without reading it.
+			The returned memory keeps the region mapped until it is released, even after the file is closed.
+			`size` is clipped by the file size. The file must be opened with `Write` mode for `FileMapMode::Write`.
+		*/
+		Memory mapRegion(sl_uint64 offset, sl_size size, FileMapMode mode = FileMapMode::Read, const FileMapHints& hints = FileMapHints::Normal);
+	
+		// maps the whole file as read-only memory. returns null for the empty or not existing file
+		static Memory mapAllBytes(const String& path, const FileMapHints& hints = FileMapHints::Sequential);
+	
 		static sl_size writeAllBytes(const String& path, const void* buf, sl_size size);
 
 		static sl_size writeAllBytes(const String& path, const Memory& mem);
@@ -292,6 +333,56 @@ namespace slib
 
 	};
 	
+	/*
+		Memory-mapped region of a file.
+	
+		The pages are loaded on demand and shared with the page cache of the system.
+		Note that accessing the region after the file is truncated by others raises SIGBUS on Unix.
+	*/
+	class SLIB_EXPORT MappedFile : public Referable
+	{
+		SLIB_DECLARE_OBJECT
+	
+	private:
+		MappedFile();
+	
+		~MappedFile();
+	
+	public:
+		static Ref<MappedFile> create(const Ref<File>& file, sl_uint64 offset, sl_size size, FileMapMode mode = FileMapMode::Read, const FileMapHints& hints = FileMapHints::Normal);
+	
+		static Ref<MappedFile> create(const String& filePath, FileMapMode mode = FileMapMode::Read, const FileMapHints& hints = FileMapHints::Normal);
+	
+	public:
+		void* getData() const;
+	
+		sl_size getSize() const;
+	
+		FileMapMode getMode() const;
+	
+		// the returned memory keeps this mapping alive
+		Memory getMemory();
+	
+		sl_bool advise(const FileMapHints& hints);
+	
+		// writes the modified pages of `FileMapMode::Write` mapping to the file
+		sl_bool flush(sl_bool flagWait = sl_true);
+	
+	private:
+		sl_bool _map(sl_file file, sl_uint64 offset, sl_size size, FileMapMode mode);
+	
+		void _unmap();
+	
+	private:
+		// the mapped pages begin at the aligned offset
+		void* m_base;
+		sl_size m_sizeMapped;
+		void* m_data;
+		sl_size m_size;
+		FileMapMode m_mode;
+	
+	};
+	
 	// FilePathSegments is not thread-safe
 	class SLIB_EXPORT FilePathSegments
 	{
@@ -0,0 +1,229 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CHECKHEADER_SLIB_CORE_FLAT_HASHTABLE
+#define CHECKHEADER_SLIB_CORE_FLAT_HASHTABLE
+
+#include "definition.h"
+
+#include "constants.h"
+#include "hash.h"
+#include "compare.h"
+#include "list.h"
+#include "math.h"
+
+#if defined(__SSE2__) || defined(SLIB_ARCH_IS_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#	define SLIB_FLAT_HASHTABLE_USE_SSE2
+#	include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(SLIB_ARCH_IS_ARM64)
+#	define SLIB_FLAT_HASHTABLE_USE_NEON
+#	include <arm_neon.h>
+#endif
+
+#if defined(SLIB_COMPILER_IS_VC)
+#	include <intrin.h>
+#endif
+
+#define _SLIB_FLAT_HASHTABLE_GROUP_SIZE 16
+#define _SLIB_FLAT_HASHTABLE_MIN_CAPACITY 16
+#define _SLIB_FLAT_HASHTABLE_MAX_CAPACITY 0x10000000
+
+/*
+	Control byte of each slot
+		0 ~ 127: occupied, holds 7 bits of the hash (H2)
+		EMPTY: never occupied, stops the probing
+		DELETED: tombstone, continues the probing
+*/
+#define _SLIB_FLAT_HASHTABLE_CONTROL_EMPTY ((sl_int8)-128)
+#define _SLIB_FLAT_HASHTABLE_CONTROL_DELETED ((sl_int8)-2)
+
+namespace slib
+{
+
+	template <class KT, class VT>
+	struct FlatHashEntry
+	{
+		KT key;
+		VT value;
+
+		sl_uint32 hash;
+
+	public:
+		template <class KEY, class VALUE>
+		FlatHashEntry(KEY&& _key, VALUE&& _value, sl_uint32 _hash);
+
+	};
+
+	// bit mask of the slots in a group, matched by `FlatHashGroup`
+	class SLIB_EXPORT FlatHashMask
+	{
+	public:
+#if defined(SLIB_FLAT_HASHTABLE_USE_NEON)
+		// 4 bits per slot, only the highest bit of each nibble is used
+		typedef sl_uint64 MaskType;
+#else
+		// 1 bit per slot
+		typedef sl_uint32 MaskType;
+#endif
+		MaskType mask;
+
+	public:
+		FlatHashMask(MaskType mask);
+
+	public:
+		sl_bool isNotEmpty() const;
+
+		// index of the first matched slot
+		sl_uint32 getLowestIndex() const;
+
+		void removeLowest();
+
+		// number of unmatched slots before the first matched slot
+		sl_uint32 countTrailingUnmatched() const;
+
+		// number of unmatched slots after the last matched slot
+		sl_uint32 countLeadingUnmatched() const;
+
+	};
+
+	// compares the control bytes of 16 consecutive slots at once (SSE2/NEON, or portable fallback)
+	class SLIB_EXPORT FlatHashGroup
+	{
+	public:
+		FlatHashGroup(const sl_int8* control);
+
+	public:
+		FlatHashMask match(sl_int8 h2) const;
+
+		FlatHashMask matchEmpty() const;
+
+		FlatHashMask matchEmptyOrDeleted() const;
+
+	private:
+#if defined(SLIB_FLAT_HASHTABLE_USE_SSE2)
+		__m128i m_control;
+#elif defined(SLIB_FLAT_HASHTABLE_USE_NEON)
+		int8x16_t m_control;
+
+		static FlatHashMask _toMask(uint8x16_t v);
+#else
+		const sl_int8* m_control;
+#endif
+
+	};
+
+	/*
+		Open-addressing hash table.
+
+		Entries are stored inline in a single array, and looked up by probing groups of 16 control bytes.
+		Unlike `HashTable`, iteration order is not the insertion order, and the entry pointers are invalidated by the insertions and removals.
+	*/
+	template < class KT, class VT, class HASH = Hash<KT>, class KEY_EQUALS = Equals<KT> >
+	class SLIB_EXPORT FlatHashTable
+	{
+	public:
+		FlatHashTable(sl_uint32 capacity = 0, const HASH& hash = HASH(), const KEY_EQUALS& key_equals = KEY_EQUALS());
+
+		~FlatHashTable();
+
+	public:
+		sl_size getCount() const;
+
+		sl_size getCapacity() const;
+
+		FlatHashEntry<KT, VT>* getFirstEntry() const;
+
+		FlatHashEntry<KT, VT>* getNextEntry(FlatHashEntry<KT, VT>* entry) const;
+
+		FlatHashEntry<KT, VT>* search(const KT& key) const;
+
+		template < class _VT, class VALUE_EQUALS = Equals<VT, _VT> >
+		FlatHashEntry<KT, VT>* searchKeyAndValue(const KT& key, const _VT& value, const VALUE_EQUALS& value_equals = VALUE_EQUALS()) const;
+
+		sl_bool get(const KT& key, VT* outValue = sl_null) const;
+
+		VT* getItemPointer(const KT& key) const;
+
+		template < class _VT, class VALUE_EQUALS = Equals<VT, _VT> >
+		VT* getItemPointerByKeyAndValue(const KT& key, const _VT& value, const VALUE_EQUALS& value_equals = VALUE_EQUALS()) const;
+
+		List<VT> getValues(const KT& key) const;
+
+		template < class _VT, class VALUE_EQUALS = Equals<VT, _VT> >
+		List<VT> getValuesByKeyAndValue(const KT& key, const _VT& value, const VALUE_EQUALS& value_equals = VALUE_EQUALS()) const;
+
+		sl_bool put(const KT& key, const VT& value, MapPutMode mode = MapPutMode::Default, sl_bool* pFlagExist = sl_null);
+
+		template < class _VT, class VALUE_EQUALS = Equals<VT, _VT> >
+		sl_bool addIfNewKeyAndValue(const KT& key, const _VT& value, sl_bool* pFlagExist = sl_null, const VALUE_EQUALS& value_equals = VALUE_EQUALS());
+
+		sl_bool remove(const KT& key, VT* outValue = sl_null);
+
+		sl_size removeItems(const KT& key, List<VT>* outValues = sl_null);
+
+		template < class _VT, class VALUE_EQUALS = Equals<VT, _VT> >
+		sl_bool removeKeyAndValue(const KT& key, const _VT& value, VT* outValue = sl_null, const VALUE_EQUALS& value_equals = VALUE_EQUALS());
+
+		template < class _VT, class VALUE_EQUALS = Equals<VT, _VT> >
+		sl_size removeItemsByKeyAndValue(const KT& key, const _VT& value, List<VT>* outValues = sl_null, const VALUE_EQUALS& value_equals = VALUE_EQUALS());
+
+		sl_size removeAll();
+
+		sl_bool copyFrom(const FlatHashTable<KT, VT, HASH, KEY_EQUALS>* other);
+
+	private:
+		typedef FlatHashEntry<KT, VT> Entry;
+
+		void* m_table;
+		sl_int8* m_control;
+		Entry* m_slots;
+		sl_size m_nSize;
+
+		sl_uint32 m_nCapacity;
+		sl_uint32 m_nCapacityMin;
+		sl_uint32 m_nGrowthLeft;
+		sl_uint32 m_nThresholdDown;
+
+		HASH m_hash;
+		KEY_EQUALS m_equals;
+
+	private:
+		static sl_uint32 _mix(sl_uint32 hash);
+
+		void _init();
+
+		void _free();
+
+		sl_bool _createTable(sl_uint32 capacity);
+
+		void _setControl(sl_uint32 index, sl_int8 control);
+
+		sl_uint32 _findInsertSlot(sl_uint32 mixed) const;
+
+		Entry* _find(sl_uint32 hash, const KT& key) const;
+
+		template <class _VT, class VALUE_EQUALS>
+		Entry* _findKeyAndValue(sl_uint32 hash, const KT& key, const _VT& value, const VALUE_EQUALS& value_equals) const;
+
+		sl_bool _addEntry(sl_uint32 hash, const KT& key, const VT& value);
+
+		void _removeEntry(Entry* entry);
+
+		sl_bool _rehash(sl_uint32 capacity);
+
+		void _compact();
+
+	};
+
+}
+
+#include "detail/flat_hashtable.inc"
+
+#endif
@@ -29,8 +29,52 @@ namespace slib
 		return Rehash((sl_uint32)(x ^ (x >> 32)));
 	}
 
+	// uses the per-process random seed (see `GetHashBytesSeed()`), so the results differ between processes
 	sl_uint32 HashBytes(const void* buf, sl_size n);
 
+	sl_uint32 HashBytes(const void* buf, sl_size n, sl_uint64 seed);
+
+	sl_uint64 HashBytes64(const void* buf, sl_size n);
+
+	sl_uint64 HashBytes64(const void* buf, sl_size n, sl_uint64 seed);
+
+	// random seed chosen once per process, which makes it hard to flood the hash tables by crafted keys
+	sl_uint64 GetHashBytesSeed();
+
+	// wyhash (final version 4): fast 64-bit non-cryptographic hash, supporting the streaming input
+	class SLIB_EXPORT WyHash
+	{
+	public:
+		WyHash();
+
+		~WyHash();
+
+	public:
+		static sl_uint64 hash(const void* input, sl_size n, sl_uint64 seed = 0);
+
+	public:
+		void start(sl_uint64 seed = 0);
+
+		void update(const void* input, sl_size n);
+
+		sl_uint64 finish();
+
+	private:
+		void _processBlock(const sl_uint8* block);
+
+	private:
+		sl_uint64 m_seed;
+		sl_uint64 m_see1;
+		sl_uint64 m_see2;
+		sl_uint64 m_len;
+		sl_bool m_flagBlocks;
+
+		// 16 bytes of the last processed block, followed by the pending input
+		sl_uint8 m_buf[64];
+		sl_uint32 m_nBuf;
+
+	};
+
 	template <>
 	class Hash<char>
 	{
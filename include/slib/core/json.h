@@ -29,6 +29,8 @@ namespace slib
 		sl_bool flagSupportComments;
 		// in
 		sl_bool flagLogError;
+		// in, objects are stored in `FlatHashMap` instead of `HashMap`
+		sl_bool flagFlatHashMap;
 
 		// out
 		sl_bool flagError;
@@ -17,11 +17,16 @@
 #include "object.h"
 #include "list.h"
 #include "variant.h"
+#include "file.h"
+#include "thread.h"
+#include "event.h"
 
 namespace slib
 {
 
 	class LoggerSet;
+	class AsyncFileLogger;
+	class AsyncFileLoggerParam;
 	
 	class SLIB_EXPORT Console
 	{
@@ -53,6 +58,9 @@ namespace slib
 		virtual void log(const String& tag, const String& content) = 0;
 
 		virtual void logError(const String& tag, const String& content);
+
+		// writes out the buffered logs, if any
+		virtual void flush();
 	
 	public:
 		static Ref<LoggerSet> global();
@@ -61,6 +69,10 @@ namespace slib
 
 		static Ref<Logger> createFileLogger(const String& fileName);
 
+		static Ref<Logger> createAsyncFileLogger(const String& fileName);
+
+		static Ref<Logger> createAsyncFileLogger(const AsyncFileLoggerParam& param);
+
 		static void logGlobal(const String& tag, const String& content);
 
 		static void logGlobalError(const String& tag, const String& content);
@@ -85,6 +97,87 @@ namespace slib
 	
 	};
 	
+	class SLIB_EXPORT AsyncFileLoggerParam
+	{
+	public:
+		String fileName;
+
+		sl_uint64 maxFileSize; // default: 0 (no size-based rotation)
+		sl_uint32 rotationInterval; // default: 0 (no time-based rotation), in milliseconds
+		sl_uint32 maxBackupFiles; // default: 5, rotated files are named `fileName.1` (newest) ~ `fileName.N`
+
+		sl_uint32 flushInterval; // default: 200, in milliseconds
+		sl_size maxBufferSize; // default: 8MB, bytes of the lines waiting to be written
+		sl_bool flagBlockWhenFull; // default: false (drops the lines when the buffer is full)
+
+	public:
+		AsyncFileLoggerParam();
+
+		~AsyncFileLoggerParam();
+
+	};
+
+	/*
+		Lines are pushed to a lock-free list by the calling threads, and a background thread writes them in batches into the file kept open.
+	*/
+	class SLIB_EXPORT AsyncFileLogger : public Logger
+	{
+		SLIB_DECLARE_OBJECT
+
+	protected:
+		AsyncFileLogger();
+
+		~AsyncFileLogger();
+
+	public:
+		static Ref<AsyncFileLogger> create(const AsyncFileLoggerParam& param);
+
+	public:
+		void release();
+
+		sl_uint64 getDroppedLinesCount();
+
+	public:
+		// override
+		void log(const String& tag, const String& content);
+
+		// override
+		void flush();
+
+	protected:
+		struct Line;
+
+		void _push(const String& line);
+
+		Line* _popAll();
+
+		void _runWriter();
+
+		void _write();
+
+		sl_bool _openFile();
+
+		void _rotate();
+
+	protected:
+		AsyncFileLoggerParam m_param;
+
+		Line* volatile m_lines;
+		sl_reg m_sizePending;
+		sl_int64 m_nDropped;
+		sl_int64 m_nDroppedReported;
+
+		Ref<Thread> m_thread;
+		Ref<Event> m_eventSpace;
+		sl_bool m_flagRunning;
+
+		Mutex m_lockWrite;
+		Ref<File> m_file;
+		sl_uint64 m_sizeFile;
+		sl_int64 m_timeOpened;
+
+	};
+	
 	class SLIB_EXPORT LoggerSet : public Logger
 	{
 	public:
@@ -115,6 +208,9 @@ namespace slib
 		// override
 		void logError(const String& tag, const String& content);
 
+		// override
+		void flush();
+
 	protected:
 		CList< Ref<Logger> > m_listLoggers;
 		CList< Ref<Logger> > m_listErrorLoggers;
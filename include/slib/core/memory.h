@@ -15,6 +15,7 @@
 
 #include "array.h"
 #include "queue.h"
+#include "hash.h"
 
 namespace slib
 {
@@ -139,6 +140,9 @@ namespace slib
 
 		~MemoryData();
 
+	public:
+		MemoryData& operator=(const MemoryData& other);
+
 	public:
 		Memory getMemory() const;
 
@@ -209,6 +213,11 @@ namespace slib
 		sl_bool pop_NoLock(MemoryData& data);
 		
 		sl_bool pop(MemoryData& data);
+
+		// pops at most `sizeMax` bytes of the front chunk without copying. the rest of the chunk remains in the queue
+		sl_bool pop_NoLock(MemoryData& data, sl_size sizeMax);
+
+		sl_bool pop(MemoryData& data, sl_size sizeMax);
 		
 		sl_size pop_NoLock(void* buf, sl_size size);
 	
@@ -225,6 +234,13 @@ namespace slib
 		sl_size m_posCurrent;
 
 	};
+	
+	template <>
+	class Hash<Memory>
+	{
+	public:
+		sl_uint32 operator()(const Memory& mem) const;
+	};
 
 }
 
@@ -1109,6 +1109,12 @@ namespace slib
 		 */
 		sl_reg indexOf(const sl_char16* str, sl_reg start = 0) const;
 		
+		/**
+		 * @return the index of the first occurrence of any of the non-empty patterns, starting the search at start. Returns -1 if no pattern is found.
+		 * The index of the found pattern is returned in outIndexPattern. At the same position, the pattern coming first in the array is chosen.
+		 */
+		sl_reg indexOfAny(const String16* patterns, sl_size nPatterns, sl_reg start = 0, sl_size* outIndexPattern = sl_null) const;
+		
 		/**
 		 * @return the index within the calling String object of the last occurrence of the specified value, searching backwards from fromIndex. Returns -1 if the value is not found.
 		 */
@@ -2669,6 +2675,12 @@ namespace slib
 		 */
 		sl_reg indexOf(const sl_char16* str, sl_reg start = 0) const;
 		
+		/**
+		 * @return the index of the first occurrence of any of the non-empty patterns, starting the search at start. Returns -1 if no pattern is found.
+		 * The index of the found pattern is returned in outIndexPattern. At the same position, the pattern coming first in the array is chosen.
+		 */
+		sl_reg indexOfAny(const String16* patterns, sl_size nPatterns, sl_reg start = 0, sl_size* outIndexPattern = sl_null) const;
+		
 		/**
 		 * @return the index within the calling String object of the last occurrence of the specified value, searching backwards from fromIndex. Returns -1 if the value is not found.
 		 */
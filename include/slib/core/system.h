@@ -41,12 +41,17 @@ namespace slib
 
 		// Tick count
 		static sl_uint32 getTickCount();
+
+		// does not wrap around
+		static sl_uint64 getTickCount64();
 	
 
 		// Process & Thread
 		static sl_uint32 getProcessId();
 
 		static sl_uint32 getThreadId();
+	
+		static sl_uint32 getProcessorsCount();
 
 		static sl_bool createProcess(const String& pathExecutable, const String* command, sl_uint32 nCommands);
 
@@ -94,6 +94,9 @@ namespace slib
 		static sl_bool isNotStoppingCurrent();
 
 		static sl_uint64 getCurrentThreadUniqueId();
+		
+		// binds the current thread to the processor
+		static sl_bool setCurrentThreadAffinity(sl_uint32 indexProcessor);
 	
 
 		// attached objects are removed when the thread is exited
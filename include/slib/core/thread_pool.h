@@ -20,6 +20,9 @@
 namespace slib
 {
 	
+	class _ThreadPoolStealingWorker;
+	class _ThreadPoolTimer;
+	
 	class SLIB_EXPORT ThreadPool : public Dispatcher
 	{
 		SLIB_DECLARE_OBJECT
@@ -31,6 +34,13 @@ namespace slib
 
 	public:
 		static Ref<ThreadPool> create(sl_uint32 minThreads = 0, sl_uint32 maxThreads = 30);
+		
+		/*
+			Work-stealing scheduler: every worker owns a lock-free deque (LIFO for the tasks submitted by the worker itself) and an inbox for the tasks submitted by other threads.
+			Idle workers steal from random victims and are parked until new tasks arrive.
+			`nWorkers = 0` creates one worker per processor.
+		*/
+		static Ref<ThreadPool> createWorkStealing(sl_uint32 nWorkers = 0);
 	
 	public:
 		void release();
@@ -38,6 +48,8 @@ namespace slib
 		sl_bool isRunning();
 
 		sl_uint32 getThreadsCount();
+		
+		sl_bool isWorkStealing();
 	
 		sl_bool addTask(const Function<void()>& task);
 
@@ -51,12 +63,29 @@ namespace slib
 	
 	protected:
 		void onRunWorker();
+		
+		void onRunStealingWorker(_ThreadPoolStealingWorker* worker);
+		
+	protected:
+		sl_bool _addTask_Stealing(const Function<void()>& task);
+		
+		sl_bool _findTask_Stealing(_ThreadPoolStealingWorker* worker, Function<void()>* _out);
+		
+		void _wakeWorker_Stealing();
 	
 	protected:
 		CList< Ref<Thread> > m_threadWorkers;
 		LinkedQueue< Function<void()> > m_tasks;
 	
 		sl_bool m_flagRunning;
+		
+		sl_bool m_flagWorkStealing;
+		_ThreadPoolStealingWorker** m_stealingWorkers;
+		sl_uint32 m_nStealingWorkers;
+		sl_int32 m_nParkedWorkers;
+		sl_int32 m_indexNextInbox;
+		
+		_ThreadPoolTimer* m_timer;
 
 	};
 
@@ -0,0 +1,123 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CHECKHEADER_SLIB_CORE_TIMER_WHEEL
+#define CHECKHEADER_SLIB_CORE_TIMER_WHEEL
+
+#include "definition.h"
+
+#include "list.h"
+
+#if defined(SLIB_COMPILER_IS_VC)
+#	include <intrin.h>
+#endif
+
+#define SLIB_TIMER_WHEEL_ROOT_BITS 8
+#define SLIB_TIMER_WHEEL_ROOT_SIZE 256
+#define SLIB_TIMER_WHEEL_LEVEL_BITS 6
+#define SLIB_TIMER_WHEEL_LEVEL_SIZE 64
+#define SLIB_TIMER_WHEEL_LEVELS_COUNT 4
+
+// the root wheel and the upper levels cover 2^32 ticks. the farther entries are parked in the last level, and re-inserted when it cascades
+#define SLIB_TIMER_WHEEL_RANGE ((sl_uint64)1 << (SLIB_TIMER_WHEEL_ROOT_BITS + SLIB_TIMER_WHEEL_LEVEL_BITS * SLIB_TIMER_WHEEL_LEVELS_COUNT))
+
+namespace slib
+{
+
+	template <class T>
+	struct TimerWheelEntry
+	{
+		T value;
+
+		// the tick when the entry expires
+		sl_uint64 tick;
+
+		// used by `TimerWheel`
+		TimerWheelEntry<T>* next;
+		TimerWheelEntry<T>** pprev;
+		sl_uint32 slot;
+
+	public:
+		TimerWheelEntry(const T& value, sl_uint64 tick);
+
+	};
+
+	/*
+		Hashed hierarchical timer wheel (Varghese & Lauck).
+
+		The root wheel has a slot per tick, and every upper level has a slot per revolution of the lower level.
+		Adding, removing and rescheduling an entry are O(1), and the entries of an upper slot cascade down in a batch when the lower level wraps around.
+		The unit of the ticks is chosen by the owner (for example, milliseconds).
+
+		TimerWheel is not thread-safe. The returned entries are valid until they expire or are removed.
+	*/
+	template <class T>
+	class SLIB_EXPORT TimerWheel
+	{
+	public:
+		TimerWheel(sl_uint64 tickCurrent = 0);
+
+		~TimerWheel();
+
+	public:
+		sl_size getCount() const;
+
+		sl_uint64 getCurrentTick() const;
+
+		// the first tick when any entry can expire or cascade down, or `SLIB_UINT64_MAX` if the wheel is empty
+		sl_uint64 getNextTick() const;
+
+		// an entry in the earliest non-empty slot, or null if the wheel is empty. the entries sharing an upper level slot are not ordered
+		TimerWheelEntry<T>* getFirstEntry() const;
+
+		// the entries earlier than the current tick expire at the next tick
+		TimerWheelEntry<T>* add(sl_uint64 tick, const T& value);
+
+		void remove(TimerWheelEntry<T>* entry);
+
+		void reschedule(TimerWheelEntry<T>* entry, sl_uint64 tick);
+
+		// moves to `tick`, and appends the values of the expired entries to `expired` in the order of the expiring ticks
+		void advance(sl_uint64 tick, List<T>& expired);
+
+		void removeAll();
+
+	private:
+		// returns the index of the earliest non-empty slot and the tick when it expires or cascades down, or -1 if the wheel is empty
+		sl_int32 _getNextSlot(sl_uint64& tick) const;
+
+		void _link(TimerWheelEntry<T>* entry);
+
+		void _unlink(TimerWheelEntry<T>* entry);
+
+		void _cascade(sl_uint32 level, sl_uint32 index);
+
+		void _expire(sl_uint32 index, List<T>& expired);
+
+		static sl_uint32 _findNext(const sl_uint64* bitmap, sl_uint32 nWords, sl_uint32 start);
+
+	private:
+		// slots of the root wheel, followed by the slots of the upper levels
+		TimerWheelEntry<T>* m_slots[SLIB_TIMER_WHEEL_ROOT_SIZE + SLIB_TIMER_WHEEL_LEVEL_SIZE * SLIB_TIMER_WHEEL_LEVELS_COUNT];
+
+		// non-empty slots
+		sl_uint64 m_bitmapRoot[SLIB_TIMER_WHEEL_ROOT_SIZE / 64];
+		sl_uint64 m_bitmapLevels[SLIB_TIMER_WHEEL_LEVELS_COUNT];
+
+		sl_uint64 m_tickCurrent;
+		sl_size m_nEntries;
+
+	};
+
+}
+
+#include "detail/timer_wheel.inc"
+
+#endif
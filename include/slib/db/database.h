@@ -17,6 +17,8 @@
 #include "../core/list.h"
 #include "../core/map.h"
 #include "../core/variant.h"
+#include "../core/linked_list.h"
+#include "../core/hashtable.h"
 
 namespace slib
 {
@@ -101,10 +103,66 @@ namespace slib
 	
 
 		virtual sl_bool moveNext() = 0;
+
+
+		// binds the output of the column for `fetch()`. `fetchBlock(n)` regards `out` as an array having at least `n` elements
+		void bindColumn(sl_uint32 index, sl_int32* out);
+
+		void bindColumn(sl_uint32 index, sl_uint32* out);
+
+		void bindColumn(sl_uint32 index, sl_int64* out);
+
+		void bindColumn(sl_uint32 index, sl_uint64* out);
+
+		void bindColumn(sl_uint32 index, float* out);
+
+		void bindColumn(sl_uint32 index, double* out);
+
+		void bindColumn(sl_uint32 index, sl_bool* out);
+
+		void bindColumn(sl_uint32 index, String* out);
+
+		void bindColumn(sl_uint32 index, Time* out);
+
+		void bindColumn(sl_uint32 index, Memory* out);
+
+		void bindColumn(sl_uint32 index, Variant* out);
+
+		template <class T>
+		sl_bool bindColumn(const String& name, T* out)
+		{
+			sl_int32 index = getColumnIndex(name);
+			if (index >= 0) {
+				bindColumn((sl_uint32)index, out);
+				return sl_true;
+			}
+			return sl_false;
+		}
+
+		void unbindColumns();
+
+		// moves to the next row, and stores the bound columns
+		sl_bool fetch();
+
+		// fetches up to `n` rows into the bound arrays, returns the count of the fetched rows
+		sl_uint32 fetchBlock(sl_uint32 n);
+
+	protected:
+		void _bindColumn(sl_uint32 index, sl_uint32 type, void* out);
+
+		void _storeBoundColumns(sl_uint32 row);
 	
 	protected:
 		Ref<Database> m_db;
 
+		struct ColumnBinding
+		{
+			sl_uint32 index;
+			sl_uint32 type;
+			void* out;
+		};
+		List<ColumnBinding> m_listBindings;
+
 	};
 	
 	class SLIB_EXPORT DatabaseStatement : public Object
@@ -265,6 +323,48 @@ namespace slib
 	
 		virtual String getErrorMessage() = 0;
 
+
+		virtual sl_bool beginTransaction();
+
+		virtual sl_bool commit();
+
+		virtual sl_bool rollback();
+
+		sl_bool isInTransaction();
+
+		// executes the statement for each row in a single transaction (unless already in a transaction), returns the total affected rows or -1 on failure
+		virtual sl_int64 executeMany(const String& sql, const List< List<Variant> >& rows);
+
+
+		sl_uint32 getStatementCacheSize();
+
+		// maximum count of the prepared statements kept by SQL text, 0 disables the cache
+		void setStatementCacheSize(sl_uint32 size);
+
+		// frees the cached statements, keeping the cache size
+		void clearStatementCache();
+
+	protected:
+		// removes the prepared native statement from the cache, so that it is owned by one `DatabaseStatement` at a time
+		void* _takeCachedStatement(const String& sql);
+
+		// puts back the native statement to the cache, the least recently used statement is freed when the cache is full
+		void _returnCachedStatement(const String& sql, void* statement);
+
+		// must be implemented by the backends using the statement cache, and `clearStatementCache()` must be called in their destructors
+		virtual void _freeCachedStatement(void* statement);
+
+	protected:
+		sl_bool m_flagInTransaction;
+
+		struct CachedStatement
+		{
+			String sql;
+			void* statement;
+		};
+		sl_uint32 m_nStatementCacheSize;
+		CLinkedList<CachedStatement> m_listCachedStatements;
+		HashTable< String, Link<CachedStatement>* > m_mapCachedStatements;
 	
 	};
 
@@ -30,6 +30,83 @@ namespace slib
 
 	};
 
+	class SLIB_EXPORT SQLiteDatabasePoolParam
+	{
+	public:
+		String filePath;
+
+		sl_uint32 readersCount; // default: 0 (count of the processors)
+		sl_bool flagCreate; // default: true
+
+		sl_uint32 busyTimeout; // default: 5000, in milliseconds
+		sl_int32 cacheSize; // default: -16384 (16MB per connection), same as `PRAGMA cache_size`
+		sl_uint64 mmapSize; // default: 256MB, same as `PRAGMA mmap_size`
+
+	public:
+		SQLiteDatabasePoolParam();
+
+		~SQLiteDatabasePoolParam();
+
+	};
+
+	/*
+		One writer connection and multiple reader connections on the same file in WAL mode.
+
+		Read-only statements are routed to the reader connection assigned to the calling thread, so that the readers on the different threads are not serialized.
+		All the other statements, and all the statements of the thread running a transaction, are run on the writer connection.
+	*/
+	class SLIB_EXPORT SQLiteDatabasePool : public Database
+	{
+		SLIB_DECLARE_OBJECT
+
+	protected:
+		SQLiteDatabasePool();
+
+		~SQLiteDatabasePool();
+
+	public:
+		static Ref<SQLiteDatabasePool> open(const SQLiteDatabasePoolParam& param);
+
+		static Ref<SQLiteDatabasePool> open(const String& filePath);
+
+	public:
+		Ref<SQLiteDatabase> getWriter();
+
+		// returns the reader connection assigned to the current thread
+		Ref<SQLiteDatabase> getReader();
+
+		sl_uint32 getReadersCount();
+
+	public:
+		// override
+		Ref<DatabaseStatement> prepareStatement(const String& sql);
+
+		// override
+		String getErrorMessage();
+
+		// override
+		sl_bool beginTransaction();
+
+		// override
+		sl_bool commit();
+
+		// override
+		sl_bool rollback();
+
+		// override
+		sl_int64 executeMany(const String& sql, const List< List<Variant> >& rows);
+
+	protected:
+		void _updateTransactionOwner();
+
+	protected:
+		Ref<SQLiteDatabase> m_writer;
+		Array< Ref<SQLiteDatabase> > m_readers;
+		// unique id of the thread running the transaction on the writer, 0 if none
+		sl_uint64 m_idThreadTransaction;
+
+	};
+
 }
 
 #endif
@@ -97,6 +97,7 @@ namespace slib
 		Nearest = 0,
 		Linear = 1,
 		Box = 2,
+		Lanczos = 3, // Lanczos3, sharper than Box when downscaling
 		
 		Default = Box
 	};
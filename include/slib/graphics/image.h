@@ -24,6 +24,9 @@
 namespace slib
 {
 	
+	class ThreadPool;
+	class JpegDecodeParam;
+	
 	class SLIB_EXPORT ImageDesc
 	{
 	public:
@@ -115,6 +118,9 @@ namespace slib
 
 		static void draw(ImageDesc& dst, const ImageDesc& src, BlendMode blend = BlendMode::Copy, StretchMode stretch = StretchMode::Default);
 
+		// smooth stretching is divided into bands of rows running on `threadPool`, and the result does not depend on the number of threads
+		static void draw(ImageDesc& dst, const ImageDesc& src, BlendMode blend, StretchMode stretch, const Ref<ThreadPool>& threadPool);
+
 		void drawImage(sl_int32 dx, sl_int32 dy, sl_int32 dw, sl_int32 dh,
 					   const Ref<Image>& src, sl_int32 sx, sl_int32 sy, sl_int32 sw, sl_int32 sh,
 					   BlendMode blend = BlendMode::Copy, StretchMode stretch = StretchMode::Default);
@@ -135,8 +141,12 @@ namespace slib
 
 		Ref<Image> scale(sl_uint32 width, sl_uint32 height, StretchMode stretch = StretchMode::Default) const;
 
+		Ref<Image> scale(sl_uint32 width, sl_uint32 height, StretchMode stretch, const Ref<ThreadPool>& threadPool) const;
+
 		Ref<Image> scaleToSmall(sl_uint32 requiredWidth, sl_uint32 requiredHeight, StretchMode stretch = StretchMode::Default) const;
 
+		Ref<Image> scaleToSmall(sl_uint32 requiredWidth, sl_uint32 requiredHeight, StretchMode stretch, const Ref<ThreadPool>& threadPool) const;
+
 
 		static ImageFileType getFileType(const void* mem, sl_size size);
 
@@ -164,6 +174,8 @@ namespace slib
 
 		static Ref<Image> loadFromJPEG(const void* content, sl_size size);
 
+		static Ref<Image> loadFromJPEG(const void* content, sl_size size, const JpegDecodeParam& param);
+
 		static Memory saveToJPEG(const Ref<Image>& image, float quality = 0.5f);
 
 		Memory saveToJPEG(float quality = 0.5f);
@@ -0,0 +1,122 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CHECKHEADER_SLIB_GRAPHICS_JPEG
+#define CHECKHEADER_SLIB_GRAPHICS_JPEG
+
+#include "definition.h"
+
+#include "image.h"
+#include "bitmap_data.h"
+
+#include "../core/object.h"
+#include "../core/function.h"
+
+namespace slib
+{
+
+	class AsyncStream;
+	class _JpegDecoderContext;
+
+	class SLIB_EXPORT JpegDecodeParam
+	{
+	public:
+		// the image is decoded at the smallest scale of 1/8, 1/4, 1/2 and 1/1 which is not smaller than the required size. 0 means the full size
+		sl_uint32 requiredWidth; // default: 0
+		sl_uint32 requiredHeight; // default: 0
+
+		// uses the fast integer IDCT and the simple upsampling, with slightly lower quality
+		sl_bool flagFast; // default: false
+
+	public:
+		JpegDecodeParam();
+
+		~JpegDecodeParam();
+
+	};
+
+	/*
+		Incremental JPEG decoder.
+
+		The data can be put in chunks of any size, and every `put()` decodes as many rows as the data allows.
+		The rows are written to the output bitmap set by `setOutput()`, or to an image created when the header is decoded.
+	*/
+	class SLIB_EXPORT JpegDecoder : public Object
+	{
+		SLIB_DECLARE_OBJECT
+
+	protected:
+		JpegDecoder();
+
+		~JpegDecoder();
+
+	public:
+		static Ref<JpegDecoder> create(const JpegDecodeParam& param);
+
+	public:
+		// returns `sl_false` on error
+		sl_bool put(const void* data, sl_size size);
+
+		// notifies the end of the data. returns `sl_true` when the image is completely decoded
+		sl_bool finish();
+
+		sl_bool isHeaderDecoded();
+
+		sl_bool isCompleted();
+
+		sl_bool isError();
+
+		// the size of the decoded image, available after the header is decoded
+		sl_uint32 getWidth();
+
+		sl_uint32 getHeight();
+
+		sl_uint32 getOriginalWidth();
+
+		sl_uint32 getOriginalHeight();
+
+		sl_uint32 getDecodedRowsCount();
+
+		/*
+			Sets the bitmap receiving the decoded rows, before any row is decoded.
+			The rows are written to the top-left area of the bitmap and clipped by its size. YUV420 formats are not supported.
+		*/
+		sl_bool setOutput(const BitmapData& output);
+
+		// the image created when no output is set
+		Ref<Image> getImage();
+
+	public:
+		static sl_bool getSize(const void* content, sl_size size, const JpegDecodeParam& param, sl_uint32* outWidth, sl_uint32* outHeight);
+
+		static Ref<Image> decode(const void* content, sl_size size, const JpegDecodeParam& param);
+
+		static sl_bool decode(const void* content, sl_size size, const BitmapData& output, const JpegDecodeParam& param);
+
+		// reads `stream` until the end, and calls `callback` with the decoded image (null on error)
+		static sl_bool decode(const Ref<AsyncStream>& stream, const JpegDecodeParam& param, const Function<void(Image*)>& callback);
+
+	protected:
+		sl_bool _process();
+
+	protected:
+		JpegDecodeParam m_param;
+		_JpegDecoderContext* m_context;
+
+		sl_uint32 m_state;
+		BitmapData m_output;
+		sl_bool m_flagOutput;
+		Ref<Image> m_image;
+
+	};
+
+}
+
+#endif
@@ -133,6 +133,7 @@ namespace slib
 		
 		// optional
 		sl_bool flagIPv6; // default: false
+		sl_bool flagReusePort; // default: false, allows several listeners on the same port (kernel-level accept sharding on Linux)
 		sl_bool flagAutoStart; // default: true
 		sl_bool flagLogError; // default: true
 		Ref<AsyncIoLoop> ioLoop;
@@ -194,6 +195,15 @@ namespace slib
 	class AsyncUdpSocket;
 	class AsyncUdpSocketInstance;
 	
+	class SLIB_EXPORT AsyncUdpDatagram
+	{
+	public:
+		SocketAddress address;
+		void* data;
+		sl_uint32 size;
+		
+	};
+	
 	class SLIB_EXPORT IAsyncUdpSocketListener
 	{
 	public:
@@ -204,6 +214,9 @@ namespace slib
 	public:
 		virtual void onReceiveFrom(AsyncUdpSocket* socket, const SocketAddress& address, void* data, sl_uint32 sizeReceived) = 0;
 		
+		// called in batch mode. default implementation calls `onReceiveFrom` for each datagram
+		virtual void onReceiveBatch(AsyncUdpSocket* socket, AsyncUdpDatagram* datagrams, sl_uint32 count);
+		
 	};
 	
 	
@@ -218,10 +231,16 @@ namespace slib
 		sl_bool flagAutoStart; // default: true
 		sl_bool flagLogError; // default: true
 		sl_uint32 packetSize; // default: 65536
+		// batch mode (linux): up to this number of datagrams are received by one `recvmmsg` and sent by one `sendmmsg`
+		sl_uint32 batchSize; // default: 0 (disabled)
+		// uses UDP GSO/GRO in batch mode if the kernel supports them. GRO is used only when `packetSize` is not less than 65535
+		sl_bool flagUseOffload; // default: true
 		Ref<AsyncIoLoop> ioLoop;
 		
 		Ptr<IAsyncUdpSocketListener> listener;
 		Function<void(AsyncUdpSocket*, const SocketAddress&, void*, sl_uint32)> onReceiveFrom;
+		// called in batch mode instead of `onReceiveFrom`. the data of the datagrams are valid only in the callback
+		Function<void(AsyncUdpSocket*, AsyncUdpDatagram*, sl_uint32)> onReceiveBatch;
 		
 	public:
 		AsyncUdpSocketParam();
@@ -264,17 +283,24 @@ namespace slib
 		
 		sl_bool sendTo(const SocketAddress& addressTo, const Memory& mem);
 		
+		// queues the datagrams at once. in batch mode, they are sent by `sendmmsg`, and the consecutive datagrams to the same address are coalesced by UDP GSO.
+		// returns the count of the queued datagrams: the queueing stops at the first failure, so the datagrams from the returned index are not sent
+		sl_uint32 sendToBatch(const AsyncUdpDatagram* datagrams, sl_uint32 count);
+		
 	protected:
 		Ref<AsyncUdpSocketInstance> _getIoInstance();
 		
 		void _onReceive(const SocketAddress& address, void* data, sl_uint32 sizeReceived);
 		
+		void _onReceiveBatch(AsyncUdpDatagram* datagrams, sl_uint32 count);
+		
 	protected:
-		static Ref<AsyncUdpSocketInstance> _createInstance(const Ref<Socket>& socket, sl_uint32 packetSize);
+		static Ref<AsyncUdpSocketInstance> _createInstance(const Ref<Socket>& socket, const AsyncUdpSocketParam& param);
 		
 	protected:
 		Ptr<IAsyncUdpSocketListener> m_listener;
 		Function<void(AsyncUdpSocket*, const SocketAddress&, void*, sl_uint32)> m_onReceiveFrom;
+		Function<void(AsyncUdpSocket*, AsyncUdpDatagram*, sl_uint32)> m_onReceiveBatch;
 		
 		friend class AsyncUdpSocketInstance;
 		
@@ -90,10 +90,20 @@ namespace slib
 		
 		NetworkLinkDeviceType preferedLinkDeviceType; // NetworkLinkDeviceType, used in Packet Socket mode. now supported Ethernet and Raw
 		
+		// below options are used in Packet Socket mode with the memory-mapped ring (linux, TPACKET_V3)
+		sl_bool flagUseRingBuffer; // default: false
+		sl_uint32 ringBlockSize; // default: 1MB, must be a multiple of the page size
+		sl_uint32 ringBlocksCount; // default: 64
+		sl_uint32 ringFrameSize; // default: 2048
+		sl_uint32 ringBlockTimeout; // default: 10, in milliseconds, the partially filled block is delivered after this timeout
+		sl_uint32 fanoutThreadsCount; // default: 0 (no fanout), spreads the packets of the device across the capturing threads by flow hash (PACKET_FANOUT)
+		
 		sl_bool flagAutoStart; // default: true
 		
 		Ptr<INetCaptureListener> listener;
 		Function<void(NetCapture*, NetCapturePacket*)> onCapturePacket;
+		// called per block in ring buffer mode (instead of `listener` and `onCapturePacket`), the packets point to the ring and are valid only in the callback. with fanout, called concurrently from the capturing threads
+		Function<void(NetCapture*, NetCapturePacket* packets, sl_uint32 nPackets)> onCapturePackets;
 		
 	public:
 		NetCaptureParam();
@@ -147,9 +157,12 @@ namespace slib
 		
 		void _onCapturePacket(NetCapturePacket* packet);
 		
+		void _onCapturePackets(NetCapturePacket* packets, sl_uint32 nPackets);
+		
 	protected:
 		Ptr<INetCaptureListener> m_listener;
 		Function<void(NetCapture*, NetCapturePacket*)> m_onCapturePacket;
+		Function<void(NetCapture*, NetCapturePacket*, sl_uint32)> m_onCapturePackets;
 		
 	};
 	
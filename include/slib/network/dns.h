@@ -156,6 +156,7 @@ namespace slib
 		MX = 15, // mail exchange
 		TXT = 16, // text strings
 		AAAA = 28, // a host address (IPv6)
+		OPT = 41, // EDNS pseudo-record (RFC 6891): CLASS is the UDP payload size, and TTL holds the extended flags
 		Question_AXFR = 252, // A request for a transfer of an entire zone
 		Question_MAILB = 253, // A request for mailbox-related records (MB, MG or MR)
 		Question_MAILA = 254, // A request for mail agent RRs (Obsolete - see MX)
@@ -391,6 +392,13 @@ namespace slib
 		
 		sl_uint16 id;
 		
+		DnsResponseCode responseCode;
+		
+		sl_bool flagTruncated;
+		
+		// minimum TTL of the response records, SOA record is limited by its MINIMUM field (RFC 2308). 0xFFFFFFFF if there is no response record
+		sl_uint32 minimumTTL;
+		
 		struct Question
 		{
 			String name;
@@ -554,6 +562,14 @@ namespace slib
 		
 		sl_bool flagAutoStart;
 		
+		// caches the forwarded answers (including NXDOMAIN and NODATA), and coalesces the identical questions in flight
+		sl_bool flagCache; // default: true
+		sl_size cacheMemorySize; // default: 4MB
+		sl_uint32 cacheShardsCount; // default: 16
+		sl_uint32 cacheMinimumTTL; // default: 0 (seconds)
+		sl_uint32 cacheMaximumTTL; // default: 86400 (seconds)
+		sl_uint32 negativeCacheTTL; // default: 300 (seconds), used when the negative answer has no SOA record, and limits the negative TTL
+		
 		Ref<AsyncIoLoop> ioLoop;
 		
 		Ptr<IDnsServerListener> listener;
@@ -569,6 +585,34 @@ namespace slib
 	};
 	
 	
+	class SLIB_EXPORT DnsServerStatistics
+	{
+	public:
+		sl_uint64 questionsCount;
+		sl_uint64 cacheHitsCount; // including negative hits
+		sl_uint64 negativeCacheHitsCount;
+		sl_uint64 coalescedQuestionsCount;
+		sl_uint64 forwardedQuestionsCount;
+		sl_uint64 forwardedAnswersCount;
+		sl_uint32 averageForwardLatency; // milliseconds
+		sl_uint32 maximumForwardLatency; // milliseconds
+		
+		sl_size cacheEntriesCount;
+		sl_size cacheMemorySize;
+		
+	public:
+		DnsServerStatistics();
+		
+		~DnsServerStatistics();
+		
+	public:
+		// cache hits / questions
+		double getCacheHitRate() const;
+		
+	};
+	
+	class _DnsServerCache;
+	
 	class SLIB_EXPORT DnsServer : public Object, public IAsyncUdpSocketListener
 	{
 		SLIB_DECLARE_OBJECT
@@ -588,6 +632,10 @@ namespace slib
 		
 		sl_bool isRunning();
 		
+		DnsServerStatistics getStatistics();
+		
+		void clearCache();
+		
 	protected:
 		void _processReceivedDnsQuestion(const SocketAddress& clientAddress, sl_uint16 id, const String& hostName, sl_bool flagEncryptedRequest);
 		
@@ -612,6 +660,21 @@ namespace slib
 		
 		void _cacheDnsHost(const String& hostName, const IPAddress& hostAddress);
 		
+		sl_bool _answerFromCache(const String& key, const SocketAddress& clientAddress, sl_uint16 id, sl_bool flagEncrypted);
+		
+		sl_bool _coalesceQuestion(const String& key, const SocketAddress& clientAddress, sl_uint16 id, sl_bool flagEncrypted);
+		
+		void _registerForward(sl_uint16 idForward, const String& key);
+		
+		void _onForwardAnswer(sl_uint32 tickSent);
+		
+		void _cacheAnswer(sl_uint16 idForward, const String& key, const DnsPacket& packet, const Memory& answer, sl_bool flagNoData);
+		
+		void _sendCachedAnswer(const Memory& answer, const SocketAddress& clientAddress, sl_uint16 id, sl_bool flagEncrypted);
+
+		// `packet` is owned by the caller, and its id is overwritten
+		void _sendAnswerPacket(Memory& packet, const SocketAddress& clientAddress, sl_uint16 id, sl_bool flagEncrypted);
+		
 	private:
 		sl_bool m_flagInit;
 		sl_bool m_flagRunning;
@@ -628,14 +691,39 @@ namespace slib
 		
 		sl_uint16 m_lastForwardId;
 		
+		struct ForwardClient
+		{
+			SocketAddress clientAddress;
+			sl_uint16 requestedId;
+			sl_bool flagEncrypted;
+		};
 		struct ForwardElement
 		{
 			SocketAddress clientAddress;
 			sl_uint16 requestedId;
 			String requestedHostName;
 			sl_bool flagEncrypted;
+			String cacheKey;
+			sl_uint32 tickSent;
+			List<ForwardClient> coalescedClients;
 		};
 		HashMap<sl_uint16, ForwardElement> m_mapForward;
+		// cache key -> forward id
+		HashMap<String, sl_uint16> m_mapPendingQuestions;
+		
+		Ref<_DnsServerCache> m_cache;
+		sl_uint32 m_cacheMinimumTTL;
+		sl_uint32 m_cacheMaximumTTL;
+		sl_uint32 m_negativeCacheTTL;
+		
+		sl_int64 m_nQuestions;
+		sl_int64 m_nCacheHits;
+		sl_int64 m_nNegativeCacheHits;
+		sl_int64 m_nCoalescedQuestions;
+		sl_int64 m_nForwardedQuestions;
+		sl_int64 m_nForwardedAnswers;
+		sl_int64 m_sumForwardLatency;
+		sl_int32 m_maxForwardLatency;
 		
 		Ptr<IDnsServerListener> m_listener;
 		
@@ -133,6 +133,33 @@ namespace slib
 		
 	};
 	
+	// header field pointing into the raw header packet, without allocating the strings
+	class SLIB_EXPORT HttpHeaderView
+	{
+	public:
+		const sl_char8* name;
+		sl_size nameLength;
+		// leading and trailing white spaces are excluded, and percent-encoding is not decoded
+		const sl_char8* value;
+		sl_size valueLength;
+		
+	public:
+		HttpHeaderView();
+		
+		~HttpHeaderView();
+		
+	public:
+		String getName() const;
+		
+		// decoded in the same way as `HttpHeaders::parseHeaders`
+		String getValue() const;
+		
+		sl_bool equalsName(const sl_char8* name, sl_size len) const;
+		
+		sl_bool equalsName(const String& name) const;
+		
+	};
+	
 	
 	class SLIB_EXPORT HttpHeaders
 	{
@@ -161,6 +188,12 @@ namespace slib
 		 */
 		static sl_reg parseHeaders(Map<String, String>& outMap, const void* headers, sl_size size);
 		
+		// same return values as above, the views are valid while `headers` is alive
+		static sl_reg parseHeaders(List<HttpHeaderView>& outList, const void* headers, sl_size size);
+		
+		// returns the size of the header section including the terminating [CR][LF][CR][LF], or 0 if the terminator is not found
+		static sl_size findHeaderEnd(const void* data, sl_size size);
+		
 	};
 	
 	
@@ -197,6 +230,9 @@ namespace slib
 		
 		const Map<String, String>& getRequestHeaders() const;
 		
+		// headers as received by `parseRequestPacket()`, not affected by the modifications
+		const List<HttpHeaderView>& getRequestHeaderViews() const;
+		
 		String getRequestHeader(String name) const;
 		
 		List<String> getRequestHeaderValues(String name) const;
@@ -297,6 +333,16 @@ namespace slib
 		 */
 		sl_reg parseRequestPacket(const void* packet, sl_size size);
 		
+		// the header map is built on demand from the views into `packet`
+		sl_reg parseRequestPacket(const Memory& packet);
+		
+	protected:
+		sl_reg _parseRequestPacket(const void* packet, sl_size size);
+		
+		const HttpHeaderView* _findRequestHeaderView(const String& name) const;
+		
+		void _buildRequestHeaders() const;
+		
 	protected:
 		HttpMethod m_method;
 		String m_methodText;
@@ -305,7 +351,10 @@ namespace slib
 		String m_query;
 		String m_requestVersion;
 		
-		Map<String, String> m_requestHeaders;
+		mutable Map<String, String> m_requestHeaders;
+		Memory m_requestHeaderPacket;
+		List<HttpHeaderView> m_requestHeaderViews;
+		mutable sl_bool m_flagRequestHeadersNotBuilt;
 		Map<String, String> m_parameters;
 		Map<String, String> m_queryParameters;
 		Map<String, String> m_postParameters;
@@ -43,6 +43,8 @@ namespace slib
 		
 		void copyFromFile(const String& path, const Ref<Dispatcher>& dispatcher);
 		
+		void copyFromFile(const String& path, sl_uint64 offset, sl_uint64 size, const Ref<Dispatcher>& dispatcher);
+		
 		sl_uint64 getOutputLength() const;
 		
 	protected:
@@ -18,6 +18,8 @@
 #include "socket_address.h"
 
 #include "../core/thread_pool.h"
+#include "../core/timer.h"
+#include "../core/timer_wheel.h"
 
 namespace slib
 {
@@ -140,7 +142,16 @@ namespace slib
 		Memory m_bufRead;
 		sl_bool m_flagReading;
 		
+		// for the idle timeout: the time (in seconds) of the last activity, and the requests which are not responded yet
+		sl_uint64 m_tickLastActive;
+		sl_int32 m_nRequestsProcessing;
+		sl_bool m_flagWritingResponse;
+		// guarded by the idle lock of the service
+		TimerWheelEntry<HttpServiceConnection*>* m_entryIdle;
+		
 	protected:
+		void _setActive();
+		
 		void _read();
 		
 		void _processInput(const void* data, sl_uint32 size);
@@ -159,6 +170,7 @@ namespace slib
 		void onAsyncOutputError(AsyncOutput* output);
 		
 		friend class HttpServiceContext;
+		friend class HttpService;
 		
 	};
 	
@@ -204,12 +216,18 @@ namespace slib
 		sl_uint32 maxThreadsCount;
 		sl_bool flagProcessByThreads;
 		
+		sl_uint32 ioLoopsCount; // default: 1, 0 means the count of the processors
+		sl_bool flagUseReusePort; // default: true on Linux; each I/O loop gets its own SO_REUSEPORT listener, otherwise the accepted connections are distributed over the loops
+		
 		sl_bool flagUseAsset;
 		String prefixAsset;
 		
 		sl_uint64 maxRequestHeadersSize;
 		sl_uint64 maxRequestBodySize;
 		
+		// in seconds. closes the connections which have no activity for the duration while no request is being processed. 0 (default) means no timeout
+		sl_uint32 connectionIdleTimeout;
+		
 		sl_bool flagAllowCrossOrigin;
 		sl_bool flagAlwaysRespondAcceptRangesHeader;
 		
@@ -246,6 +264,8 @@ namespace slib
 		
 		Ref<AsyncIoLoop> getAsyncIoLoop();
 		
+		Ref<AsyncIoLoopGroup> getAsyncIoLoopGroup();
+		
 		Ref<ThreadPool> getThreadPool();
 		
 		const HttpServiceParam& getParam();
@@ -293,19 +313,32 @@ namespace slib
 	protected:
 		sl_bool _init(const HttpServiceParam& param);
 		
+		void _watchIdle(HttpServiceConnection* connection);
+		
+		void _unwatchIdle(HttpServiceConnection* connection);
+		
+		void _onIdleTimer(Timer* timer);
+		
 	protected:
 		AtomicRef<AsyncIoLoop> m_ioLoop;
+		AtomicRef<AsyncIoLoopGroup> m_ioLoopGroup;
 		AtomicRef<ThreadPool> m_threadPool;
 		sl_bool m_flagRunning;
 		
 		HashMap< HttpServiceConnection*, Ref<HttpServiceConnection> > m_connections;
 		
+		Mutex m_lockIdle;
+		TimerWheel<HttpServiceConnection*> m_wheelIdle;
+		Ref<Timer> m_timerIdle;
+		
 		CList< Ptr<IHttpServiceProcessor> > m_processors;
 		AtomicList< Ptr<IHttpServiceProcessor> > m_processorsCached;
 		CList< Ref<HttpServiceConnectionProvider> > m_connectionProviders;
 		
 		HttpServiceParam m_param;
 		
+		friend class HttpServiceConnection;
+		
 	};
 
 }
@@ -31,20 +31,13 @@
 namespace slib
 {
 
-	class _NatTablePort
-	{
-	public:
-		sl_bool flagActive;
-		SocketAddress addressSource;
-		Time timeLastAccess;
-		
-	public:
-		_NatTablePort();
-		
-		~_NatTablePort();
-		
-	};
+	class _NatTableMappingShard;
 	
+	/*
+		The port range is striped over the shards (port = portBegin + index * nShards + shard), and the internal address is hashed to select the shard,
+		so both directions of the translation lock only one shard.
+		Each shard allocates the ports from a bitmap and expires the idle mappings by a hierarchical timer wheel.
+	*/
 	class _NatTableMapping : public Object
 	{
 	public:
@@ -53,18 +46,21 @@ namespace slib
 		~_NatTableMapping();
 		
 	public:
-		void setup(sl_uint16 portBegin, sl_uint16 portEnd);
+		// must not be called while the packets are translated
+		void setup(sl_uint16 portBegin, sl_uint16 portEnd, sl_uint32 nShards, sl_uint32 timeout);
 		
 		sl_bool mapToExternalPort(const SocketAddress& address, sl_uint16& port);
 		
 		sl_bool mapToInternalAddress(sl_uint16 port, SocketAddress& address);
 		
+		sl_uint32 getMappingsCount();
+		
 	protected:
-		HashMap< SocketAddress, sl_uint16 > m_mapPorts;
+		void _free();
 		
-		_NatTablePort* m_ports;
-		sl_uint16 m_nPorts;
-		sl_uint16 m_pos;
+	protected:
+		_NatTableMappingShard* m_shards;
+		sl_uint32 m_nShards;
 		
 		sl_uint16 m_portBegin;
 		sl_uint16 m_portEnd;
@@ -84,6 +80,12 @@ namespace slib
 		
 		sl_uint16 icmpEchoIdentifier;
 		
+		sl_uint32 tcpIdleTimeout; // default: 7440 (seconds, RFC 5382)
+		sl_uint32 udpIdleTimeout; // default: 300 (seconds, RFC 4787)
+		
+		// the mapping tables are split into the shards to translate the packets from multiple threads concurrently
+		sl_uint32 shardsCount; // default: 16
+		
 	public:
 		NatTableParam();
 		
@@ -110,6 +112,10 @@ namespace slib
 		
 		sl_uint16 getMappedIcmpEchoSequenceNumber(const IcmpEchoAddress& address);
 		
+		sl_uint32 getTcpMappingsCount();
+		
+		sl_uint32 getUdpMappingsCount();
+		
 	protected:
 		NatTableParam m_param;
 		
@@ -96,6 +96,12 @@ namespace slib
 		static sl_uint16 calculateOneComplementSum(const void* data, sl_size size, sl_uint32 add = 0);
 
 		static sl_uint16 calculateChecksum(const void* data, sl_size size);
+		
+		// Incremental update of the checksum when a 16-bit word of the covered data is changed (RFC 1624)
+		static sl_uint16 adjustChecksum(sl_uint16 checksum, sl_uint16 wordOld, sl_uint16 wordNew);
+		
+		// Incremental update of the checksum when a 32-bit word of the covered data is changed (RFC 1624)
+		static sl_uint16 adjustChecksum32(sl_uint16 checksum, sl_uint32 wordOld, sl_uint32 wordNew);
 
 	};
 
@@ -187,6 +193,9 @@ namespace slib
 		void updateChecksum();
 		
 		sl_bool checkChecksum() const;
+		
+		// updates the header checksum in O(1) after an address is changed from `addressOld` to `addressNew`
+		void adjustChecksum(const IPv4Address& addressOld, const IPv4Address& addressNew);
 
 		IPv4Address getSourceAddress() const;
 		
@@ -324,6 +333,12 @@ namespace slib
 		void updateChecksum(const IPv4Packet* ipv4, sl_uint32 sizeContent);
 		
 		sl_bool checkChecksum(const IPv4Packet* ipv4, sl_uint32 sizeContent) const;
+		
+		// updates the checksum in O(1) after an address of the pseudo header is changed
+		void adjustChecksum(const IPv4Address& addressOld, const IPv4Address& addressNew);
+		
+		// updates the checksum in O(1) after a port is changed
+		void adjustChecksum(sl_uint16 portOld, sl_uint16 portNew);
 
 		sl_bool check(IPv4Packet* ip, sl_uint32 sizeContent) const;
 
@@ -383,6 +398,12 @@ namespace slib
 		void updateChecksum(const IPv4Packet* ipv4);
 		
 		sl_bool checkChecksum(const IPv4Packet* ipv4) const;
+		
+		// updates the checksum in O(1) after an address of the pseudo header is changed. zero checksum (not used) is kept
+		void adjustChecksum(const IPv4Address& addressOld, const IPv4Address& addressNew);
+		
+		// updates the checksum in O(1) after a port is changed. zero checksum (not used) is kept
+		void adjustChecksum(sl_uint16 portOld, sl_uint16 portNew);
 
 		sl_bool check(IPv4Packet* ip, sl_uint32 sizeContent) const;
 		
@@ -67,6 +67,9 @@ namespace slib
 		sl_bool flagSelfAlive;
 		sl_bool flagStoreResponseContent;
 		sl_bool flagSynchronous;
+
+		// below option is supported by the curl backend, which shares the connections across the requests
+		sl_bool flagHttp2; // default: false, negotiates HTTP/2 and multiplexes the requests to the same host
 		
 	public:
 		UrlRequestParam();
@@ -152,6 +155,11 @@ namespace slib
 		
 		static Ref<UrlRequest> postJsonSynchronous(const String& url, const Map<String, Variant>& params, const Json& json);
 		
+		// process-wide limit of the connections to a host (0: no limit, default), applied by the curl backend to the connection cache shared by all the requests
+		static sl_uint32 getMaxConnectionsPerHost();
+		
+		static void setMaxConnectionsPerHost(sl_uint32 n);
+		
 	public:
 		const String& getUrl();
 		
@@ -274,6 +282,7 @@ namespace slib
 		sl_bool m_flagUseBackgroundSession;
 		sl_bool m_flagSelfAlive;
 		sl_bool m_flagStoreResponseContent;
+		sl_bool m_flagHttp2;
 		
 		sl_uint64 m_sizeBodySent;
 		sl_uint64 m_sizeContentTotal;
@@ -11,6 +11,7 @@
 #include "slib/core/async.h"
 
 #include "slib/core/safe_static.h"
+#include "slib/core/system.h"
 
 namespace slib
 {
@@ -182,7 +183,7 @@ namespace slib
 			LinkedQueue< Function<void()> > tasks;
 			tasks.merge(&m_queueTasks);
 			Function<void()> task;
-			while (m_queueTasks.pop(&task)) {
+			while (tasks.pop_NoLock(&task)) {
 				task();
 			}
 		}
@@ -212,6 +213,113 @@ namespace slib
 		}
 	}
 
+/*************************************
+		AsyncIoLoopGroup
+*************************************/
+
+	SLIB_DEFINE_OBJECT(AsyncIoLoopGroup, Object)
+
+	AsyncIoLoopGroup::AsyncIoLoopGroup()
+	{
+		m_indexNext = 0;
+		m_flagPinToProcessors = sl_false;
+		m_flagRunning = sl_false;
+	}
+
+	AsyncIoLoopGroup::~AsyncIoLoopGroup()
+	{
+		release();
+	}
+
+	Ref<AsyncIoLoopGroup> AsyncIoLoopGroup::create(sl_uint32 nLoops, sl_bool flagAutoStart, sl_bool flagPinToProcessors)
+	{
+		if (nLoops == 0) {
+			nLoops = System::getProcessorsCount();
+		}
+		Array< Ref<AsyncIoLoop> > loops = Array< Ref<AsyncIoLoop> >::create(nLoops);
+		if (loops.isNull()) {
+			return sl_null;
+		}
+		for (sl_uint32 i = 0; i < nLoops; i++) {
+			Ref<AsyncIoLoop> loop = AsyncIoLoop::create(sl_false);
+			if (loop.isNull()) {
+				for (sl_uint32 k = 0; k < i; k++) {
+					loops[k]->release();
+				}
+				return sl_null;
+			}
+			loops[i] = loop;
+		}
+		Ref<AsyncIoLoopGroup> ret = new AsyncIoLoopGroup;
+		if (ret.isNotNull()) {
+			ret->m_loops = loops;
+			ret->m_flagPinToProcessors = flagPinToProcessors && nLoops > 1;
+			if (flagAutoStart) {
+				ret->start();
+			}
+			return ret;
+		}
+		return sl_null;
+	}
+
+	void AsyncIoLoopGroup::release()
+	{
+		ObjectLocker lock(this);
+		Ref<AsyncIoLoop>* loops = m_loops.getData();
+		sl_size n = m_loops.getCount();
+		for (sl_size i = 0; i < n; i++) {
+			loops[i]->release();
+		}
+		m_flagRunning = sl_false;
+	}
+
+	void AsyncIoLoopGroup::start()
+	{
+		ObjectLocker lock(this);
+		if (m_flagRunning) {
+			return;
+		}
+		m_flagRunning = sl_true;
+		sl_uint32 nProcessors = System::getProcessorsCount();
+		Ref<AsyncIoLoop>* loops = m_loops.getData();
+		sl_size n = m_loops.getCount();
+		for (sl_size i = 0; i < n; i++) {
+			Ref<AsyncIoLoop>& loop = loops[i];
+			if (m_flagPinToProcessors) {
+				sl_uint32 indexProcessor = (sl_uint32)(i % nProcessors);
+				loop->addTask([indexProcessor]() {
+					Thread::setCurrentThreadAffinity(indexProcessor);
+				});
+			}
+			loop->start();
+		}
+	}
+
+	sl_bool AsyncIoLoopGroup::isRunning()
+	{
+		return m_flagRunning;
+	}
+
+	sl_uint32 AsyncIoLoopGroup::getLoopsCount()
+	{
+		return (sl_uint32)(m_loops.getCount());
+	}
+
+	Ref<AsyncIoLoop> AsyncIoLoopGroup::getLoop(sl_uint32 index)
+	{
+		return m_loops.getValueAt(index);
+	}
+
+	Ref<AsyncIoLoop> AsyncIoLoopGroup::getNextLoop()
+	{
+		sl_size n = m_loops.getCount();
+		if (n == 0) {
+			return sl_null;
+		}
+		sl_uint32 index = (sl_uint32)(Base::interlockedIncrement32(&m_indexNext));
+		return m_loops.getValueAt(index % n);
+	}
+
 /*************************************
 		AsyncIoInstance
 **************************************/
@@ -457,6 +565,21 @@ namespace slib
 		return sl_false;
 	}
 
+	sl_bool AsyncStreamInstance::writeFromFile(const Ref<File>& file, sl_uint64 offset, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback)
+	{
+		return sl_false;
+	}
+
+	sl_bool AsyncStreamInstance::writeV(const MemoryData* chunks, sl_uint32 nChunks, const Function<void(AsyncStreamResult*)>& callback)
+	{
+		return sl_false;
+	}
+
+	sl_bool AsyncStreamInstance::isWriteVSupported()
+	{
+		return sl_false;
+	}
+
 	sl_bool AsyncStreamInstance::isSeekable()
 	{
 		return sl_false;
@@ -551,6 +674,21 @@ namespace slib
 		return sl_null;
 	}
 
+	sl_bool AsyncStream::writeFromFile(const Ref<File>& file, sl_uint64 offset, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback)
+	{
+		return sl_false;
+	}
+
+	sl_bool AsyncStream::writeV(const MemoryData* chunks, sl_uint32 nChunks, const Function<void(AsyncStreamResult*)>& callback)
+	{
+		return sl_false;
+	}
+
+	sl_bool AsyncStream::isWriteVSupported()
+	{
+		return sl_false;
+	}
+
 	sl_bool AsyncStream::isSeekable()
 	{
 		return sl_false;
@@ -664,6 +802,47 @@ namespace slib
 		return sl_false;
 	}
 
+	sl_bool AsyncStreamBase::writeFromFile(const Ref<File>& file, sl_uint64 offset, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback)
+	{
+		Ref<AsyncIoLoop> loop = getIoLoop();
+		if (loop.isNull()) {
+			return sl_false;
+		}
+		Ref<AsyncStreamInstance> instance = getIoInstance();
+		if (instance.isNotNull()) {
+			if (instance->writeFromFile(file, offset, size, callback)) {
+				loop->requestOrder(instance.get());
+				return sl_true;
+			}
+		}
+		return sl_false;
+	}
+
+	sl_bool AsyncStreamBase::writeV(const MemoryData* chunks, sl_uint32 nChunks, const Function<void(AsyncStreamResult*)>& callback)
+	{
+		Ref<AsyncIoLoop> loop = getIoLoop();
+		if (loop.isNull()) {
+			return sl_false;
+		}
+		Ref<AsyncStreamInstance> instance = getIoInstance();
+		if (instance.isNotNull()) {
+			if (instance->writeV(chunks, nChunks, callback)) {
+				loop->requestOrder(instance.get());
+				return sl_true;
+			}
+		}
+		return sl_false;
+	}
+
+	sl_bool AsyncStreamBase::isWriteVSupported()
+	{
+		Ref<AsyncStreamInstance> instance = getIoInstance();
+		if (instance.isNotNull()) {
+			return instance->isWriteVSupported();
+		}
+		return sl_false;
+	}
+
 	sl_bool AsyncStreamBase::isSeekable()
 	{
 		Ref<AsyncStreamInstance> instance = getIoInstance();
@@ -1442,18 +1621,29 @@ namespace slib
 	AsyncOutputBufferElement::AsyncOutputBufferElement()
 	{
 		m_sizeBody = 0;
+		m_offsetBodyFile = 0;
 	}
 
 	AsyncOutputBufferElement::AsyncOutputBufferElement(const Memory& header)
 	{
 		m_header.add(header);
 		m_sizeBody = 0;
+		m_offsetBodyFile = 0;
 	}
 
 	AsyncOutputBufferElement::AsyncOutputBufferElement(AsyncStream* stream, sl_uint64 size)
 	{
 		m_body = stream;
 		m_sizeBody = size;
+		m_offsetBodyFile = 0;
+	}
+
+	AsyncOutputBufferElement::AsyncOutputBufferElement(const Ref<File>& file, sl_uint64 offset, sl_uint64 size, const Ref<Dispatcher>& dispatcher)
+	{
+		m_sizeBody = size;
+		m_bodyFile = file;
+		m_offsetBodyFile = offset;
+		m_dispatcherBodyFile = dispatcher;
 	}
 
 	AsyncOutputBufferElement::~AsyncOutputBufferElement()
@@ -1462,7 +1652,7 @@ namespace slib
 
 	sl_bool AsyncOutputBufferElement::isEmpty() const
 	{
-		if (m_header.getSize() == 0 && (m_sizeBody == 0 || m_body.isNull())) {
+		if (m_header.getSize() == 0 && isEmptyBody()) {
 			return sl_true;
 		}
 		return sl_false;
@@ -1470,7 +1660,7 @@ namespace slib
 
 	sl_bool AsyncOutputBufferElement::isEmptyBody() const
 	{
-		if (m_sizeBody == 0 || m_body.isNull()) {
+		if (m_sizeBody == 0 || (m_body.isNull() && m_bodyFile.isNull())) {
 			return sl_true;
 		}
 		return sl_false;
@@ -1485,6 +1675,17 @@ namespace slib
 	{
 		m_body = stream;
 		m_sizeBody = size;
+		m_bodyFile.setNull();
+		m_dispatcherBodyFile.setNull();
+	}
+
+	void AsyncOutputBufferElement::setBodyFile(const Ref<File>& file, sl_uint64 offset, sl_uint64 size, const Ref<Dispatcher>& dispatcher)
+	{
+		m_body.setNull();
+		m_sizeBody = size;
+		m_bodyFile = file;
+		m_offsetBodyFile = offset;
+		m_dispatcherBodyFile = dispatcher;
 	}
 
 	MemoryQueue& AsyncOutputBufferElement::getHeader()
@@ -1502,6 +1703,21 @@ namespace slib
 		return m_sizeBody;
 	}
 
+	Ref<File> AsyncOutputBufferElement::getBodyFile()
+	{
+		return m_bodyFile;
+	}
+
+	sl_uint64 AsyncOutputBufferElement::getBodyFileOffset()
+	{
+		return m_offsetBodyFile;
+	}
+
+	Ref<Dispatcher> AsyncOutputBufferElement::getBodyFileDispatcher()
+	{
+		return m_dispatcherBodyFile;
+	}
+
 
 /**********************************************
 		AsyncOutputBuffer
@@ -1592,9 +1808,43 @@ namespace slib
 		}
 		sl_uint64 size = File::getSize(path);
 		if (size > 0) {
-			Ref<AsyncFile> file = AsyncFile::openForRead(path, dispatcher);
+			Ref<File> file = File::openForRead(path);
 			if (file.isNotNull()) {
-				return copyFrom(file.get(), size);
+				return _addBodyFile(file, 0, size, dispatcher);
+			} else {
+				return sl_false;
+			}
+		}
+		return sl_true;
+	}
+
+	sl_bool AsyncOutputBuffer::copyFromFile(const String& path, sl_uint64 offset, sl_uint64 size, const Ref<Dispatcher>& dispatcher)
+	{
+		if (size == 0) {
+			return sl_true;
+		}
+		Ref<File> file = File::openForRead(path);
+		if (file.isNotNull()) {
+			return _addBodyFile(file, offset, size, dispatcher);
+		}
+		return sl_false;
+	}
+
+	sl_bool AsyncOutputBuffer::_addBodyFile(const Ref<File>& file, sl_uint64 offset, sl_uint64 size, const Ref<Dispatcher>& dispatcher)
+	{
+		ObjectLocker lock(this);
+		Link< Ref<AsyncOutputBufferElement> >* link = m_queueOutput.getBack();
+		if (link && link->value->isEmptyBody()) {
+			link->value->setBodyFile(file, offset, size, dispatcher);
+			m_lengthOutput += size;
+		} else {
+			Ref<AsyncOutputBufferElement> data = new AsyncOutputBufferElement(file, offset, size, dispatcher);
+			if (data.isNotNull()) {
+				if (m_queueOutput.push(data)) {
+					m_lengthOutput += size;
+				} else {
+					return sl_false;
+				}
 			} else {
 				return sl_false;
 			}
@@ -1642,6 +1892,7 @@ namespace slib
 	{
 		m_flagClosed = sl_false;
 		m_flagWriting = sl_false;
+		m_flagWriteV = sl_false;
 
 		m_bufferCount = 1;
 		m_bufferSize = 0x10000;
@@ -1679,6 +1930,7 @@ namespace slib
 		Ref<AsyncOutput> ret = new AsyncOutput;
 		if (ret.isNotNull()) {
 			ret->m_streamOutput = param.stream;
+			ret->m_flagWriteV = param.stream->isWriteVSupported();
 			ret->m_bufferSize = param.bufferSize;
 			ret->m_bufferCount = param.bufferCount;
 			ret->m_listener = param.listener;
@@ -1727,16 +1979,28 @@ namespace slib
 		}
 		MemoryQueue& header = m_elementWriting->getHeader();
 		if (header.getSize() > 0) {
-			sl_uint32 size = (sl_uint32)(header.pop(m_bufWrite.getData(), m_bufWrite.getSize()));
-			if (size > 0) {
+			_writeHeader();
+		} else {
+			sl_uint64 sizeBody = m_elementWriting->getBodySize();
+			Ref<File> file = m_elementWriting->getBodyFile();
+			if (sizeBody != 0 && file.isNotNull()) {
+				sl_uint64 offset = m_elementWriting->getBodyFileOffset();
+				Ref<Dispatcher> dispatcher = m_elementWriting->getBodyFileDispatcher();
+				sl_uint32 size = sizeBody > SLIB_ASYNC_OUTPUT_FILE_SEGMENT ? SLIB_ASYNC_OUTPUT_FILE_SEGMENT : (sl_uint32)sizeBody;
 				m_flagWriting = sl_true;
-				if (!(m_streamOutput->write(m_bufWrite.getData(), size, SLIB_FUNCTION_WEAKREF(AsyncOutput, onWriteStream, this), m_bufWrite.ref.get()))) {
-					m_flagWriting = sl_false;
+				if (m_streamOutput->writeFromFile(file, offset, size, SLIB_FUNCTION_WEAKREF(AsyncOutput, onWriteStream, this))) {
+					m_elementWriting->setBodyFile(file, offset + size, sizeBody - size, dispatcher);
+					return;
+				}
+				m_flagWriting = sl_false;
+				// the output stream can't send the file directly: copy it through the buffers
+				Ref<AsyncStream> stream = _openBodyFile(file, dispatcher);
+				if (stream.isNull() || !(stream->seek(offset))) {
 					_onError();
+					return;
 				}
+				m_elementWriting->setBody(stream.get(), sizeBody);
 			}
-		} else {
-			sl_uint64 sizeBody = m_elementWriting->getBodySize();
 			Ref<AsyncStream> body = m_elementWriting->getBody();
 			if (sizeBody != 0 && body.isNotNull()) {
 				m_flagWriting = sl_true;
@@ -1759,6 +2023,20 @@ namespace slib
 		}
 	}
 
+	Ref<AsyncStream> AsyncOutput::_openBodyFile(const Ref<File>& file, const Ref<Dispatcher>& dispatcher)
+	{
+#if defined(SLIB_PLATFORM_IS_LINUX)
+		Ref<AsyncIoLoop> loop = m_streamOutput->getIoLoop();
+		if (loop.isNotNull() && loop->isIoUring()) {
+			Ref<AsyncStream> stream = AsyncFile::openIoUring(file->getPath(), FileMode::Read, loop);
+			if (stream.isNotNull()) {
+				return stream;
+			}
+		}
+#endif
+		return AsyncFile::create(file, dispatcher);
+	}
+
 	void AsyncOutput::onAsyncCopyExit(AsyncCopy* task)
 	{
 		m_flagWriting = sl_false;
@@ -1773,6 +2051,50 @@ namespace slib
 		}
 	}
 
+	void AsyncOutput::_writeHeader()
+	{
+		sl_uint8* buf = (sl_uint8*)(m_bufWrite.getData());
+		sl_size sizeMax = m_bufWrite.getSize();
+		if (m_flagWriteV) {
+			// gathers the header chunks without copying, continuing to the following elements while no body comes between them
+			MemoryData chunks[SLIB_ASYNC_STREAM_WRITEV_MAX_CHUNKS];
+			sl_uint32 nChunks = 0;
+			sl_size size = 0;
+			while (nChunks < SLIB_ASYNC_STREAM_WRITEV_MAX_CHUNKS && size < sizeMax) {
+				if (m_elementWriting->getHeader().pop(chunks[nChunks], sizeMax - size)) {
+					size += chunks[nChunks].size;
+					nChunks++;
+				} else {
+					if (m_elementWriting->isEmptyBody()) {
+						Ref<AsyncOutputBufferElement> next;
+						if (m_queueOutput.pop(&next)) {
+							m_elementWriting = next;
+							continue;
+						}
+					}
+					break;
+				}
+			}
+			if (nChunks == 0) {
+				return;
+			}
+			m_flagWriting = sl_true;
+			if (!(m_streamOutput->writeV(chunks, nChunks, SLIB_FUNCTION_WEAKREF(AsyncOutput, onWriteStream, this)))) {
+				m_flagWriting = sl_false;
+				_onError();
+			}
+			return;
+		}
+		sl_uint32 size = (sl_uint32)(m_elementWriting->getHeader().pop(buf, sizeMax));
+		if (size > 0) {
+			m_flagWriting = sl_true;
+			if (!(m_streamOutput->write(buf, size, SLIB_FUNCTION_WEAKREF(AsyncOutput, onWriteStream, this), m_bufWrite.ref.get()))) {
+				m_flagWriting = sl_false;
+				_onError();
+			}
+		}
+	}
+
 	void AsyncOutput::onWriteStream(AsyncStreamResult* result)
 	{
 		m_flagWriting = sl_false;
@@ -15,6 +15,8 @@
 #include "slib/core/async.h"
 #include "slib/core/pipe.h"
 
+#include "async_uring.h"
+
 #include <unistd.h>
 #include <sys/epoll.h>
 #include <sys/errno.h>
@@ -30,6 +32,9 @@ namespace slib
 	{
 		int fdEpoll;
 		Ref<PipeEvent> eventWake;
+#if defined(ASYNC_USE_IO_URING)
+		_AsyncIoUring* uring;
+#endif
 	};
 
 	void* AsyncIoLoop::_native_createHandle()
@@ -38,6 +43,19 @@ namespace slib
 		if (pipe.isNull()) {
 			return 0;
 		}
+#if defined(ASYNC_USE_IO_URING)
+		_AsyncIoUring* uring = _AsyncIoUring::create(pipe);
+		if (uring) {
+			_AsyncIoLoopHandle* handle = new _AsyncIoLoopHandle;
+			if (handle) {
+				handle->fdEpoll = -1;
+				handle->eventWake = pipe;
+				handle->uring = uring;
+				return handle;
+			}
+			delete uring;
+		}
+#endif
 		int fdEpoll;
 #if defined(EPOLL_LOW)
 		fdEpoll = ::epoll_create(1024);
@@ -49,6 +67,9 @@ namespace slib
 			if (handle) {
 				handle->fdEpoll = fdEpoll;
 				handle->eventWake = pipe;
+#if defined(ASYNC_USE_IO_URING)
+				handle->uring = sl_null;
+#endif
 				// register wake event
 				epoll_event ev;
 				ev.data.ptr = sl_null;
@@ -66,7 +87,14 @@ namespace slib
 	void AsyncIoLoop::_native_closeHandle(void* _handle)
 	{
 		_AsyncIoLoopHandle* handle = (_AsyncIoLoopHandle*)_handle;
-		::close(handle->fdEpoll);
+#if defined(ASYNC_USE_IO_URING)
+		if (handle->uring) {
+			delete handle->uring;
+		}
+#endif
+		if (handle->fdEpoll >= 0) {
+			::close(handle->fdEpoll);
+		}
 		delete handle;
 	}
 
@@ -74,6 +102,13 @@ namespace slib
 	{
 		_AsyncIoLoopHandle* handle = (_AsyncIoLoopHandle*)m_handle;
 
+#if defined(ASYNC_USE_IO_URING)
+		if (handle->uring) {
+			_native_runLoop_IoUring(handle->uring);
+			return;
+		}
+#endif
+
 		epoll_event waitEvents[ASYNC_MAX_WAIT_EVENT];
 
 		while (m_flagRunning) {
@@ -100,6 +135,10 @@ namespace slib
 						desc.flagIn = sl_false;
 						desc.flagOut = sl_false;
 						desc.flagError = sl_false;
+#if defined(SLIB_PLATFORM_IS_LINUX)
+						desc.flagCompletion = sl_false;
+						desc.result = 0;
+#endif
 						int re = ev.events;
 						if (re & (EPOLLIN | EPOLLPRI)) {
 							desc.flagIn = sl_true;
@@ -137,6 +176,18 @@ namespace slib
 	sl_bool AsyncIoLoop::_native_attachInstance(AsyncIoInstance* instance, AsyncIoMode mode)
 	{
 		_AsyncIoLoopHandle* handle = (_AsyncIoLoopHandle*)m_handle;
+#if defined(ASYNC_USE_IO_URING)
+		if (handle->uring) {
+			if (handle->uring->attach(instance, mode)) {
+				// the poll is armed by the loop thread
+				if (mode != AsyncIoMode::None) {
+					_native_wake();
+				}
+				return sl_true;
+			}
+			return sl_false;
+		}
+#endif
 		int hObject = (int)(instance->getHandle());
 		epoll_event ev;
 		ev.data.ptr = (void*)instance;
@@ -171,12 +222,67 @@ namespace slib
 	void AsyncIoLoop::_native_detachInstance(AsyncIoInstance* instance)
 	{
 		_AsyncIoLoopHandle* handle = (_AsyncIoLoopHandle*)m_handle;
+#if defined(ASYNC_USE_IO_URING)
+		if (handle->uring) {
+			handle->uring->detach(instance);
+			return;
+		}
+#endif
 		int hObject = (int)(instance->getHandle());
 		epoll_event ev;
 		int ret = ::epoll_ctl(handle->fdEpoll, EPOLL_CTL_DEL, hObject, &ev);
 		SLIB_UNUSED(ret);
 	}
 
+#if defined(SLIB_PLATFORM_IS_LINUX)
+	void AsyncIoLoop::setIoUringEnabled(sl_bool flagEnabled)
+	{
+#if defined(ASYNC_USE_IO_URING)
+		_AsyncIoUring::setEnabled(flagEnabled);
+#endif
+	}
+
+	sl_bool AsyncIoLoop::isIoUring()
+	{
+#if defined(ASYNC_USE_IO_URING)
+		_AsyncIoLoopHandle* handle = (_AsyncIoLoopHandle*)m_handle;
+		if (handle) {
+			return handle->uring != sl_null;
+		}
+#endif
+		return sl_false;
+	}
+
+	sl_bool AsyncIoLoop::submitRead(AsyncIoInstance* instance, void* data, sl_uint32 size, sl_uint64 offset)
+	{
+#if defined(ASYNC_USE_IO_URING)
+		_AsyncIoLoopHandle* handle = (_AsyncIoLoopHandle*)m_handle;
+		if (handle && handle->uring) {
+			return handle->uring->submitReadWrite(instance, sl_true, data, size, offset);
+		}
+#endif
+		return sl_false;
+	}
+
+	sl_bool AsyncIoLoop::submitWrite(AsyncIoInstance* instance, const void* data, sl_uint32 size, sl_uint64 offset)
+	{
+#if defined(ASYNC_USE_IO_URING)
+		_AsyncIoLoopHandle* handle = (_AsyncIoLoopHandle*)m_handle;
+		if (handle && handle->uring) {
+			return handle->uring->submitReadWrite(instance, sl_false, data, size, offset);
+		}
+#endif
+		return sl_false;
+	}
+
+#if !defined(ASYNC_USE_IO_URING)
+	Ref<AsyncStream> AsyncFile::openIoUring(const String& path, FileMode mode, const Ref<AsyncIoLoop>& loop)
+	{
+		return sl_null;
+	}
+#endif
+#endif
+
 }
 
 #endif
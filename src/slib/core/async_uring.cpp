@@ -0,0 +1,678 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "async_uring.h"
+
+#if defined(ASYNC_USE_IO_URING)
+
+#include "slib/core/file.h"
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/epoll.h>
+#include <sys/syscall.h>
+
+namespace slib
+{
+
+	static int _AsyncIoUring_setup(sl_uint32 entries, io_uring_params* params)
+	{
+		return (int)(::syscall(__NR_io_uring_setup, entries, params));
+	}
+
+	static int _AsyncIoUring_enter(int fd, sl_uint32 toSubmit, sl_uint32 minComplete, sl_uint32 flags)
+	{
+		return (int)(::syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, sl_null, 0));
+	}
+
+	static int _AsyncIoUring_register(int fd, sl_uint32 opcode, const void* arg, sl_uint32 nArgs)
+	{
+		return (int)(::syscall(__NR_io_uring_register, fd, opcode, arg, nArgs));
+	}
+
+	static sl_bool _g_asyncIoUringEnabled = sl_true;
+
+	_AsyncIoUring::_AsyncIoUring()
+	{
+		m_fd = -1;
+		m_ptrSq = MAP_FAILED;
+		m_ptrCq = MAP_FAILED;
+		m_sqes = (io_uring_sqe*)MAP_FAILED;
+		m_sqTailLocal = 0;
+		m_nToSubmit = 0;
+		m_flagFixedFiles = sl_false;
+		Base::zeroMemory(m_bitmapFixedFiles, sizeof(m_bitmapFixedFiles));
+	}
+
+	_AsyncIoUring::~_AsyncIoUring()
+	{
+		if (m_sqes != MAP_FAILED) {
+			::munmap(m_sqes, m_sizeSqes);
+		}
+		if (m_ptrCq != MAP_FAILED && m_ptrCq != m_ptrSq) {
+			::munmap(m_ptrCq, m_sizeCq);
+		}
+		if (m_ptrSq != MAP_FAILED) {
+			::munmap(m_ptrSq, m_sizeSq);
+		}
+		if (m_fd >= 0) {
+			::close(m_fd);
+		}
+		// the kernel has cancelled everything by closing the ring
+		HashEntry<AsyncIoInstance*, Pin>* entry = m_pins.getFirstEntry();
+		while (entry) {
+			entry->key->decreaseReference();
+			entry = entry->next;
+		}
+	}
+
+	_AsyncIoUring* _AsyncIoUring::create(const Ref<PipeEvent>& eventWake)
+	{
+		if (!_g_asyncIoUringEnabled) {
+			return sl_null;
+		}
+		io_uring_params params;
+		Base::zeroMemory(&params, sizeof(params));
+		int fd = _AsyncIoUring_setup(ASYNC_IO_URING_ENTRIES, &params);
+		if (fd < 0) {
+			return sl_null;
+		}
+		// single mmap for both rings and no dropped completions are required: linux 5.5+
+		// multi-shot poll is required too: linux 5.13+, detected by IORING_FEAT_RSRC_TAGS which is introduced in the same release
+		sl_uint32 featuresRequired = IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP;
+#if defined(IORING_POLL_ADD_MULTI) && defined(IORING_FEAT_RSRC_TAGS)
+		featuresRequired |= IORING_FEAT_RSRC_TAGS;
+#else
+		featuresRequired = 0xFFFFFFFF;
+#endif
+		if ((params.features & featuresRequired) != featuresRequired) {
+			::close(fd);
+			return sl_null;
+		}
+		_AsyncIoUring* ret = new _AsyncIoUring;
+		if (!ret) {
+			::close(fd);
+			return sl_null;
+		}
+		ret->m_fd = fd;
+		ret->m_eventWake = eventWake;
+
+		sl_size sizeSq = params.sq_off.array + params.sq_entries * sizeof(sl_uint32);
+		sl_size sizeCq = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+		if (sizeCq > sizeSq) {
+			sizeSq = sizeCq;
+		}
+		ret->m_sizeSq = sizeSq;
+		ret->m_sizeCq = sizeSq;
+		ret->m_ptrSq = ::mmap(sl_null, sizeSq, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+		if (ret->m_ptrSq == MAP_FAILED) {
+			delete ret;
+			return sl_null;
+		}
+		ret->m_ptrCq = ret->m_ptrSq;
+		ret->m_sizeSqes = params.sq_entries * sizeof(io_uring_sqe);
+		ret->m_sqes = (io_uring_sqe*)(::mmap(sl_null, ret->m_sizeSqes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES));
+		if (ret->m_sqes == MAP_FAILED) {
+			delete ret;
+			return sl_null;
+		}
+
+		sl_uint8* sq = (sl_uint8*)(ret->m_ptrSq);
+		ret->m_sqHead = (sl_uint32*)(sq + params.sq_off.head);
+		ret->m_sqTail = (sl_uint32*)(sq + params.sq_off.tail);
+		ret->m_sqMask = *((sl_uint32*)(sq + params.sq_off.ring_mask));
+		ret->m_sqArray = (sl_uint32*)(sq + params.sq_off.array);
+		ret->m_sqTailLocal = *(ret->m_sqTail);
+
+		sl_uint8* cq = (sl_uint8*)(ret->m_ptrCq);
+		ret->m_cqHead = (sl_uint32*)(cq + params.cq_off.head);
+		ret->m_cqTail = (sl_uint32*)(cq + params.cq_off.tail);
+		ret->m_cqMask = *((sl_uint32*)(cq + params.cq_off.ring_mask));
+		ret->m_cqes = (io_uring_cqe*)(cq + params.cq_off.cqes);
+
+		// sparse table for fixed files, indexed by the descriptor itself
+		{
+			int* files = new int[ASYNC_IO_URING_FIXED_FILES];
+			if (files) {
+				for (sl_uint32 i = 0; i < ASYNC_IO_URING_FIXED_FILES; i++) {
+					files[i] = -1;
+				}
+				ret->m_flagFixedFiles = _AsyncIoUring_register(fd, IORING_REGISTER_FILES, files, ASYNC_IO_URING_FIXED_FILES) == 0;
+				delete[] files;
+			}
+		}
+
+		ret->armWake();
+		return ret;
+	}
+
+	sl_bool _AsyncIoUring::isEnabled()
+	{
+		return _g_asyncIoUringEnabled;
+	}
+
+	void _AsyncIoUring::setEnabled(sl_bool flag)
+	{
+		_g_asyncIoUringEnabled = flag;
+	}
+
+	sl_bool _AsyncIoUring::attach(AsyncIoInstance* instance, AsyncIoMode mode)
+	{
+		sl_uint32 events = EPOLLET | EPOLLRDHUP;
+		switch (mode) {
+			case AsyncIoMode::In:
+				events |= EPOLLIN | EPOLLPRI;
+				break;
+			case AsyncIoMode::Out:
+				events |= EPOLLOUT;
+				break;
+			case AsyncIoMode::InOut:
+				events |= EPOLLIN | EPOLLPRI | EPOLLOUT;
+				break;
+			default:
+				// no readiness: the instance submits its own operations
+				events = 0;
+				break;
+		}
+		if (!events) {
+			_registerFixedFile((int)(instance->getHandle()));
+			return sl_true;
+		}
+		// the submission queue is owned by the loop thread
+		PendingAttach pa;
+		pa.instance = instance;
+		pa.events = events;
+		return m_queuePendingAttach.push(pa);
+	}
+
+	void _AsyncIoUring::detach(AsyncIoInstance* instance)
+	{
+		_unregisterFixedFile((int)(instance->getHandle()));
+		// cancels the poll and the operation in progress. the cancellations are never dropped, because the multi-shot poll keeps referring the instance until it is removed
+		_cancel(instance, IORING_OP_POLL_REMOVE, ASYNC_IO_URING_TAG_POLL);
+		_cancel(instance, IORING_OP_ASYNC_CANCEL, ASYNC_IO_URING_TAG_COMPLETION);
+	}
+
+	sl_bool _AsyncIoUring::submitReadWrite(AsyncIoInstance* instance, sl_bool flagRead, const void* data, sl_uint32 size, sl_uint64 offset)
+	{
+		int fd = (int)(instance->getHandle());
+		if (fd < 0) {
+			return sl_false;
+		}
+		io_uring_sqe* sqe = _getSqe();
+		if (!sqe) {
+			return sl_false;
+		}
+		sqe->opcode = flagRead ? IORING_OP_READ : IORING_OP_WRITE;
+		sqe->fd = fd;
+		if (_isFixedFile(fd)) {
+			sqe->flags = IOSQE_FIXED_FILE;
+		}
+		sqe->addr = (sl_uint64)(sl_size)data;
+		sqe->len = size;
+		sqe->off = offset;
+		sqe->user_data = ((sl_uint64)(sl_size)instance) | ASYNC_IO_URING_TAG_COMPLETION;
+		pin(instance);
+		return sl_true;
+	}
+
+	void _AsyncIoUring::prepare()
+	{
+		// the cancellations delayed by the full submission queue go first
+		Link<PendingCancel>* link;
+		while ((link = m_listPendingCancel.getFront())) {
+			if (!(_submitCancel(link->value.instance.get(), link->value.opcode, link->value.tag))) {
+				break;
+			}
+			m_listPendingCancel.popFront_NoLock();
+		}
+		PendingAttach pa;
+		while (m_queuePendingAttach.pop(&pa)) {
+			AsyncIoInstance* instance = pa.instance.get();
+			if (instance->isOpened() && !(instance->isClosing())) {
+				armPoll(instance, pa.events);
+			}
+		}
+	}
+
+	void _AsyncIoUring::submitAndWait()
+	{
+		sl_uint32 n = m_nToSubmit;
+		m_nToSubmit = 0;
+		int ret = _AsyncIoUring_enter(m_fd, n, 1, IORING_ENTER_GETEVENTS);
+		if (ret < 0 && errno == EBUSY) {
+			// completion queue is full: leave the entries queued and process the completions first
+			m_nToSubmit = n;
+		}
+	}
+
+	io_uring_cqe* _AsyncIoUring::peekCompletion()
+	{
+		sl_uint32 head = *m_cqHead;
+		if (head == __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE)) {
+			return sl_null;
+		}
+		return m_cqes + (head & m_cqMask);
+	}
+
+	void _AsyncIoUring::advanceCompletion()
+	{
+		__atomic_store_n(m_cqHead, *m_cqHead + 1, __ATOMIC_RELEASE);
+	}
+
+	void _AsyncIoUring::armPoll(AsyncIoInstance* instance, sl_uint32 events)
+	{
+		io_uring_sqe* sqe = _getSqe();
+		if (!sqe) {
+			return;
+		}
+		sqe->opcode = IORING_OP_POLL_ADD;
+		sqe->fd = (int)(instance->getHandle());
+		sqe->poll32_events = events;
+		sqe->len = IORING_POLL_ADD_MULTI;
+		sqe->user_data = ((sl_uint64)(sl_size)instance) | ASYNC_IO_URING_TAG_POLL;
+		pin(instance);
+		Pin* p = m_pins.getItemPointer(instance);
+		if (p) {
+			p->events = events;
+		}
+	}
+
+	void _AsyncIoUring::rearmPoll(AsyncIoInstance* instance)
+	{
+		Pin* p = m_pins.getItemPointer(instance);
+		if (p && p->events) {
+			armPoll(instance, p->events);
+		}
+	}
+
+	void _AsyncIoUring::resetWake()
+	{
+		m_eventWake->reset();
+	}
+
+	void _AsyncIoUring::armWake()
+	{
+		io_uring_sqe* sqe = _getSqe();
+		if (!sqe) {
+			return;
+		}
+		sqe->opcode = IORING_OP_POLL_ADD;
+		sqe->fd = (int)(m_eventWake->getReadPipeHandle());
+		sqe->poll32_events = EPOLLIN | EPOLLET;
+		sqe->len = IORING_POLL_ADD_MULTI;
+		sqe->user_data = ASYNC_IO_URING_TAG_WAKE;
+	}
+
+	void _AsyncIoUring::pin(AsyncIoInstance* instance)
+	{
+		Pin* p = m_pins.getItemPointer(instance);
+		if (p) {
+			p->count++;
+		} else {
+			Pin pin;
+			pin.count = 1;
+			pin.events = 0;
+			if (m_pins.put(instance, pin)) {
+				instance->increaseReference();
+			}
+		}
+	}
+
+	void _AsyncIoUring::unpin(AsyncIoInstance* instance)
+	{
+		Pin* p = m_pins.getItemPointer(instance);
+		if (p) {
+			p->count--;
+			if (p->count == 0) {
+				m_pins.remove(instance);
+				instance->decreaseReference();
+			}
+		}
+	}
+
+	io_uring_sqe* _AsyncIoUring::_getSqe()
+	{
+		sl_uint32 head = __atomic_load_n(m_sqHead, __ATOMIC_ACQUIRE);
+		if (m_sqTailLocal - head > m_sqMask) {
+			// ring is full: hand the batch to the kernel without waiting
+			_AsyncIoUring_enter(m_fd, m_nToSubmit, 0, 0);
+			m_nToSubmit = 0;
+			head = __atomic_load_n(m_sqHead, __ATOMIC_ACQUIRE);
+			if (m_sqTailLocal - head > m_sqMask) {
+				return sl_null;
+			}
+		}
+		sl_uint32 index = m_sqTailLocal & m_sqMask;
+		io_uring_sqe* sqe = m_sqes + index;
+		Base::zeroMemory(sqe, sizeof(io_uring_sqe));
+		m_sqArray[index] = index;
+		m_sqTailLocal++;
+		m_nToSubmit++;
+		// the entry is filled by the caller before the next `io_uring_enter()`, which is issued from this thread
+		__atomic_store_n(m_sqTail, m_sqTailLocal, __ATOMIC_RELEASE);
+		return sqe;
+	}
+
+	void _AsyncIoUring::_cancel(AsyncIoInstance* instance, sl_uint8 opcode, sl_uint32 tag)
+	{
+		if (m_listPendingCancel.getCount() || !(_submitCancel(instance, opcode, tag))) {
+			PendingCancel pc;
+			pc.instance = instance;
+			pc.opcode = opcode;
+			pc.tag = tag;
+			m_listPendingCancel.pushBack_NoLock(pc);
+		}
+	}
+
+	sl_bool _AsyncIoUring::_submitCancel(AsyncIoInstance* instance, sl_uint8 opcode, sl_uint32 tag)
+	{
+		io_uring_sqe* sqe = _getSqe();
+		if (!sqe) {
+			return sl_false;
+		}
+		sqe->opcode = opcode;
+		sqe->fd = -1;
+		sqe->addr = ((sl_uint64)(sl_size)instance) | tag;
+		sqe->user_data = ASYNC_IO_URING_TAG_IGNORE;
+		return sl_true;
+	}
+
+	sl_bool _AsyncIoUring::_isFixedFile(int fd)
+	{
+		if (fd >= 0 && fd < ASYNC_IO_URING_FIXED_FILES) {
+			return (__atomic_load_n(m_bitmapFixedFiles + (fd >> 6), __ATOMIC_ACQUIRE) >> (fd & 63)) & 1;
+		}
+		return sl_false;
+	}
+
+	void _AsyncIoUring::_registerFixedFile(int fd)
+	{
+		if (!m_flagFixedFiles || fd < 0 || fd >= ASYNC_IO_URING_FIXED_FILES) {
+			return;
+		}
+		io_uring_files_update update;
+		Base::zeroMemory(&update, sizeof(update));
+		update.offset = (sl_uint32)fd;
+		update.fds = (sl_uint64)(sl_size)(&fd);
+		// the descriptor is used as the fixed file only when the slot is updated
+		if (_AsyncIoUring_register(m_fd, IORING_REGISTER_FILES_UPDATE, &update, 1) == 1) {
+			__atomic_fetch_or(m_bitmapFixedFiles + (fd >> 6), (sl_uint64)1 << (fd & 63), __ATOMIC_RELEASE);
+		}
+	}
+
+	void _AsyncIoUring::_unregisterFixedFile(int fd)
+	{
+		if (!(_isFixedFile(fd))) {
+			return;
+		}
+		__atomic_fetch_and(m_bitmapFixedFiles + (fd >> 6), ~((sl_uint64)1 << (fd & 63)), __ATOMIC_RELEASE);
+		int value = -1;
+		io_uring_files_update update;
+		Base::zeroMemory(&update, sizeof(update));
+		update.offset = (sl_uint32)fd;
+		update.fds = (sl_uint64)(sl_size)(&value);
+		_AsyncIoUring_register(m_fd, IORING_REGISTER_FILES_UPDATE, &update, 1);
+	}
+
+
+	void AsyncIoLoop::_native_runLoop_IoUring(void* _uring)
+	{
+		_AsyncIoUring* uring = (_AsyncIoUring*)_uring;
+
+		while (m_flagRunning) {
+
+			_stepBegin();
+
+			uring->prepare();
+			uring->submitAndWait();
+
+			io_uring_cqe* cqe;
+			while (m_flagRunning && (cqe = uring->peekCompletion())) {
+				sl_uint64 data = cqe->user_data;
+				sl_int32 res = cqe->res;
+				sl_uint32 flags = cqe->flags;
+				uring->advanceCompletion();
+				sl_uint32 tag = (sl_uint32)(data & ASYNC_IO_URING_TAG_MASK);
+				AsyncIoInstance* instance = (AsyncIoInstance*)(sl_size)(data & ~((sl_uint64)ASYNC_IO_URING_TAG_MASK));
+				if (tag == ASYNC_IO_URING_TAG_WAKE) {
+					if (!(flags & IORING_CQE_F_MORE)) {
+						uring->armWake();
+					}
+					uring->resetWake();
+					continue;
+				}
+				if (tag == ASYNC_IO_URING_TAG_IGNORE || !instance) {
+					continue;
+				}
+				sl_bool flagFinal = tag == ASYNC_IO_URING_TAG_COMPLETION || !(flags & IORING_CQE_F_MORE);
+				if (!(instance->isClosing()) && instance->isOpened()) {
+					AsyncIoInstance::EventDesc desc;
+					desc.flagIn = sl_false;
+					desc.flagOut = sl_false;
+					desc.flagError = sl_false;
+					desc.flagCompletion = sl_false;
+					desc.result = res;
+					if (tag == ASYNC_IO_URING_TAG_COMPLETION) {
+						desc.flagCompletion = sl_true;
+						if (res < 0) {
+							desc.flagError = sl_true;
+						}
+						instance->onEvent(&desc);
+					} else {
+						if (res < 0) {
+							if (res != -ECANCELED) {
+								desc.flagError = sl_true;
+								instance->onEvent(&desc);
+							}
+						} else {
+							if (res & (EPOLLIN | EPOLLPRI)) {
+								desc.flagIn = sl_true;
+							}
+							if (res & EPOLLOUT) {
+								desc.flagOut = sl_true;
+							}
+							if (res & (EPOLLERR | EPOLLHUP | EPOLLRDHUP)) {
+								desc.flagError = sl_true;
+							}
+							instance->onEvent(&desc);
+						}
+						if (flagFinal && res >= 0 && !(instance->isClosing()) && instance->isOpened()) {
+							// the kernel has terminated the multi-shot poll (for example on overflow)
+							uring->rearmPoll(instance);
+						}
+					}
+				}
+				if (flagFinal) {
+					uring->unpin(instance);
+				}
+			}
+
+			if (m_flagRunning) {
+				_stepEnd();
+			}
+
+			// closed instances are kept alive by the pins while the kernel references them
+			m_queueInstancesClosed.removeAll();
+		}
+	}
+
+
+	class _IoUringAsyncFileStreamInstance : public AsyncStreamInstance
+	{
+	public:
+		Ref<AsyncStreamRequest> m_requestOperating;
+		sl_uint64 m_offset;
+
+		_IoUringAsyncFileStreamInstance()
+		{
+			m_offset = 0;
+		}
+
+		~_IoUringAsyncFileStreamInstance()
+		{
+			close();
+		}
+
+		static Ref<_IoUringAsyncFileStreamInstance> open(const String& path, FileMode mode)
+		{
+			Ref<_IoUringAsyncFileStreamInstance> ret;
+			sl_file handle = _openHandle(path, mode);
+			if (handle != SLIB_FILE_INVALID_HANDLE) {
+				ret = new _IoUringAsyncFileStreamInstance();
+				if (ret.isNotNull()) {
+					ret->setHandle(handle);
+					if (mode & FileMode::SeekToEnd) {
+						ret->seek(File::getSize(handle));
+					}
+					return ret;
+				}
+				_closeHandle(handle);
+			}
+			return ret;
+		}
+
+		void close()
+		{
+			_closeHandle(getHandle());
+			setHandle(SLIB_FILE_INVALID_HANDLE);
+		}
+
+		void onOrder()
+		{
+			sl_file handle = getHandle();
+			if (handle == SLIB_FILE_INVALID_HANDLE) {
+				return;
+			}
+			if (m_requestOperating.isNotNull()) {
+				return;
+			}
+			Ref<AsyncIoLoop> loop = getLoop();
+			if (loop.isNull()) {
+				return;
+			}
+			Ref<AsyncStreamRequest> req;
+			if (popReadRequest(req)) {
+				if (req.isNotNull()) {
+					m_requestOperating = req;
+					if (!(loop->submitRead(this, req->data, req->size, m_offset))) {
+						m_requestOperating.setNull();
+						processResult(req.get(), 0, sl_true);
+					}
+					return;
+				}
+			}
+			if (popWriteRequest(req)) {
+				if (req.isNotNull()) {
+					m_requestOperating = req;
+					if (!(loop->submitWrite(this, req->data, req->size, m_offset))) {
+						m_requestOperating.setNull();
+						processResult(req.get(), 0, sl_true);
+					}
+				}
+			}
+		}
+
+		void onEvent(EventDesc* pev)
+		{
+			if (!(pev->flagCompletion)) {
+				return;
+			}
+			Ref<AsyncStreamRequest> req = m_requestOperating;
+			m_requestOperating.setNull();
+			sl_uint32 size = 0;
+			sl_bool flagError = sl_false;
+			if (pev->result < 0) {
+				flagError = sl_true;
+			} else {
+				size = (sl_uint32)(pev->result);
+				m_offset += size;
+			}
+			if (req.isNotNull()) {
+				processResult(req.get(), size, flagError);
+			}
+			if (getReadRequestsCount() > 0 || getWriteRequestsCount() > 0) {
+				requestOrder();
+			}
+		}
+
+		void processResult(AsyncStreamRequest* req, sl_uint32 size, sl_bool flagError)
+		{
+			Ref<AsyncIoObject> object = getObject();
+			if (object.isNotNull()) {
+				req->runCallback(static_cast<AsyncStream*>(object.get()), size, flagError);
+			}
+		}
+
+		sl_bool isSeekable()
+		{
+			return sl_true;
+		}
+
+		sl_bool seek(sl_uint64 pos)
+		{
+			m_offset = pos;
+			return sl_true;
+		}
+
+		sl_uint64 getSize()
+		{
+			sl_file handle = getHandle();
+			return File::getSize(handle);
+		}
+
+		static sl_file _openHandle(const String& filePath, FileMode mode)
+		{
+			if (filePath.isEmpty()) {
+				return SLIB_FILE_INVALID_HANDLE;
+			}
+			int flags = O_CLOEXEC;
+			if (mode & FileMode::Write) {
+				if (mode & FileMode::Read) {
+					flags |= O_RDWR;
+				} else {
+					flags |= O_WRONLY;
+				}
+				if (!(mode & FileMode::NotTruncate)) {
+					flags |= O_TRUNC;
+				}
+				if (!(mode & FileMode::NotCreate)) {
+					flags |= O_CREAT;
+				}
+			} else {
+				flags |= O_RDONLY;
+			}
+			int fd = ::open(filePath.getData(), flags, 0644);
+			return (sl_file)fd;
+		}
+
+		static void _closeHandle(sl_file handle)
+		{
+			if (handle != SLIB_FILE_INVALID_HANDLE) {
+				::close((int)handle);
+			}
+		}
+	};
+
+	Ref<AsyncStream> AsyncFile::openIoUring(const String& path, FileMode mode, const Ref<AsyncIoLoop>& loop)
+	{
+		if (loop.isNull() || !(loop->isIoUring())) {
+			return sl_null;
+		}
+		Ref<_IoUringAsyncFileStreamInstance> ret = _IoUringAsyncFileStreamInstance::open(path, mode);
+		return AsyncStream::create(ret.get(), AsyncIoMode::None, loop);
+	}
+
+}
+
+#endif
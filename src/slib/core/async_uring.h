@@ -0,0 +1,151 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CHECKHEADER_SLIB_CORE_ASYNC_URING
+#define CHECKHEADER_SLIB_CORE_ASYNC_URING
+
+#include "async_config.h"
+
+#if defined(ASYNC_USE_IO_URING)
+
+#include "slib/core/async.h"
+#include "slib/core/pipe.h"
+#include "slib/core/hashtable.h"
+
+#include <linux/io_uring.h>
+
+#define ASYNC_IO_URING_ENTRIES 1024
+#define ASYNC_IO_URING_FIXED_FILES 4096
+
+// lower bits of `user_data`
+#define ASYNC_IO_URING_TAG_POLL 0
+#define ASYNC_IO_URING_TAG_COMPLETION 1
+#define ASYNC_IO_URING_TAG_WAKE 2
+#define ASYNC_IO_URING_TAG_IGNORE 3
+#define ASYNC_IO_URING_TAG_MASK 3
+
+namespace slib
+{
+
+	class _AsyncIoUring
+	{
+	public:
+		_AsyncIoUring();
+
+		~_AsyncIoUring();
+
+	public:
+		static _AsyncIoUring* create(const Ref<PipeEvent>& eventWake);
+
+		static sl_bool isEnabled();
+
+		static void setEnabled(sl_bool flag);
+
+	public:
+		// can be called in any thread
+		sl_bool attach(AsyncIoInstance* instance, AsyncIoMode mode);
+
+		// below functions must be called in the loop thread
+		void detach(AsyncIoInstance* instance);
+
+		sl_bool submitReadWrite(AsyncIoInstance* instance, sl_bool flagRead, const void* data, sl_uint32 size, sl_uint64 offset);
+
+		void prepare();
+
+		// submits all the queued entries by one system call, and waits for at least one completion
+		void submitAndWait();
+
+		io_uring_cqe* peekCompletion();
+
+		void advanceCompletion();
+
+		void armPoll(AsyncIoInstance* instance, sl_uint32 events);
+
+		void rearmPoll(AsyncIoInstance* instance);
+
+		void armWake();
+
+		void resetWake();
+
+		// keeps the instance alive while the kernel may still post completions for it
+		void pin(AsyncIoInstance* instance);
+
+		void unpin(AsyncIoInstance* instance);
+
+	private:
+		io_uring_sqe* _getSqe();
+
+		// queues the cancellation when the submission queue is full, and submits it in `prepare()`
+		void _cancel(AsyncIoInstance* instance, sl_uint8 opcode, sl_uint32 tag);
+
+		sl_bool _submitCancel(AsyncIoInstance* instance, sl_uint8 opcode, sl_uint32 tag);
+
+		sl_bool _isFixedFile(int fd);
+
+		void _registerFixedFile(int fd);
+
+		void _unregisterFixedFile(int fd);
+
+	private:
+		int m_fd;
+		Ref<PipeEvent> m_eventWake;
+
+		sl_uint32* m_sqHead;
+		sl_uint32* m_sqTail;
+		sl_uint32 m_sqMask;
+		sl_uint32* m_sqArray;
+		io_uring_sqe* m_sqes;
+		sl_uint32 m_sqTailLocal;
+		sl_uint32 m_nToSubmit;
+
+		sl_uint32* m_cqHead;
+		sl_uint32* m_cqTail;
+		sl_uint32 m_cqMask;
+		io_uring_cqe* m_cqes;
+
+		void* m_ptrSq;
+		sl_size m_sizeSq;
+		void* m_ptrCq;
+		sl_size m_sizeCq;
+		sl_size m_sizeSqes;
+
+		sl_bool m_flagFixedFiles;
+		// descriptors successfully registered as the fixed files
+		sl_uint64 m_bitmapFixedFiles[ASYNC_IO_URING_FIXED_FILES / 64];
+
+		struct PendingAttach
+		{
+			Ref<AsyncIoInstance> instance;
+			sl_uint32 events;
+		};
+		LinkedQueue<PendingAttach> m_queuePendingAttach;
+
+		struct PendingCancel
+		{
+			Ref<AsyncIoInstance> instance;
+			sl_uint8 opcode;
+			sl_uint32 tag;
+		};
+		CLinkedList<PendingCancel> m_listPendingCancel;
+
+		struct Pin
+		{
+			sl_uint32 count;
+			sl_uint32 events;
+		};
+		HashTable<AsyncIoInstance*, Pin> m_pins;
+
+	};
+
+}
+
+#endif
+
+#endif
@@ -30,6 +30,21 @@
 #	define NOT_SUPPORT_ATOMIC_64BIT
 #endif
 
+#if defined(__AVX2__)
+#	define _BASE_MEMORY_USE_AVX2
+#	include <immintrin.h>
+#elif defined(__SSE2__) || defined(SLIB_ARCH_IS_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#	define _BASE_MEMORY_USE_SSE2
+#	include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(SLIB_ARCH_IS_ARM64)
+#	define _BASE_MEMORY_USE_NEON
+#	include <arm_neon.h>
+#endif
+
+#if defined(SLIB_COMPILER_IS_VC)
+#	include <intrin.h>
+#endif
+
 namespace slib
 {
 
@@ -79,16 +94,37 @@ namespace slib
 
 	void Base::resetMemory2(sl_uint16* dst, sl_uint16 value, sl_size count)
 	{
-		for (sl_size i = 0; i < count; i++) {
+		sl_size i = 0;
+#if defined(_BASE_MEMORY_USE_AVX2)
+		{
+			__m256i v = _mm256_set1_epi16((short)value);
+			for (; i + 16 <= count; i += 16) {
+				_mm256_storeu_si256((__m256i*)(dst + i), v);
+			}
+		}
+#elif defined(_BASE_MEMORY_USE_SSE2)
+		{
+			__m128i v = _mm_set1_epi16((short)value);
+			for (; i + 8 <= count; i += 8) {
+				_mm_storeu_si128((__m128i*)(dst + i), v);
+			}
+		}
+#elif defined(_BASE_MEMORY_USE_NEON)
+		{
+			uint16x8_t v = vdupq_n_u16(value);
+			for (; i + 8 <= count; i += 8) {
+				vst1q_u16(dst + i, v);
+			}
+		}
+#endif
+		for (; i < count; i++) {
 			dst[i] = value;
 		}
 	}
 
 	void Base::resetMemory2(sl_int16* dst, sl_int16 value, sl_size count)
 	{
-		for (sl_size i = 0; i < count; i++) {
-			dst[i] = value;
-		}
+		resetMemory2((sl_uint16*)dst, (sl_uint16)value, count);
 	}
 
 	void Base::resetMemory4(sl_uint32* dst, sl_uint32 value, sl_size count)
@@ -424,9 +460,65 @@ namespace slib
 		return (const sl_int8*)(::memchr(mem, pattern, count));
 	}
 
+	SLIB_INLINE static sl_uint32 _Base_getLowestBit(sl_uint64 mask)
+	{
+#if defined(SLIB_COMPILER_IS_VC)
+#	if defined(SLIB_ARCH_IS_64BIT)
+		unsigned long index;
+		_BitScanForward64(&index, mask);
+		return (sl_uint32)index;
+#	else
+		unsigned long index;
+		if ((sl_uint32)mask) {
+			_BitScanForward(&index, (sl_uint32)mask);
+			return (sl_uint32)index;
+		}
+		_BitScanForward(&index, (sl_uint32)(mask >> 32));
+		return (sl_uint32)index + 32;
+#	endif
+#else
+		return (sl_uint32)(__builtin_ctzll(mask));
+#endif
+	}
+
 	const sl_uint16* Base::findMemory2(const sl_uint16* m, sl_uint16 pattern, sl_size count)
 	{
-		for (sl_size i = 0; i < count; i++) {
+		sl_size i = 0;
+#if defined(_BASE_MEMORY_USE_AVX2)
+		{
+			__m256i p = _mm256_set1_epi16((short)pattern);
+			for (; i + 16 <= count; i += 16) {
+				// 2 bits per element
+				sl_uint32 mask = (sl_uint32)(_mm256_movemask_epi8(_mm256_cmpeq_epi16(_mm256_loadu_si256((const __m256i*)(m + i)), p)));
+				if (mask) {
+					return m + i + (_Base_getLowestBit(mask) >> 1);
+				}
+			}
+		}
+#elif defined(_BASE_MEMORY_USE_SSE2)
+		{
+			__m128i p = _mm_set1_epi16((short)pattern);
+			for (; i + 8 <= count; i += 8) {
+				// 2 bits per element
+				sl_uint32 mask = (sl_uint32)(_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_loadu_si128((const __m128i*)(m + i)), p)));
+				if (mask) {
+					return m + i + (_Base_getLowestBit(mask) >> 1);
+				}
+			}
+		}
+#elif defined(_BASE_MEMORY_USE_NEON)
+		{
+			uint16x8_t p = vdupq_n_u16(pattern);
+			for (; i + 8 <= count; i += 8) {
+				// 8 bits per element
+				sl_uint64 mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vceqq_u16(vld1q_u16(m + i), p), 4)), 0);
+				if (mask) {
+					return m + i + (_Base_getLowestBit(mask) >> 3);
+				}
+			}
+		}
+#endif
+		for (; i < count; i++) {
 			if (m[i] == pattern) {
 				return m + i;
 			}
@@ -436,12 +528,7 @@ namespace slib
 
 	const sl_int16* Base::findMemory2(const sl_int16* m, sl_int16 pattern, sl_size count)
 	{
-		for (sl_size i = 0; i < count; i++) {
-			if (m[i] == pattern) {
-				return m + i;
-			}
-		}
-		return sl_null;
+		return (const sl_int16*)(findMemory2((const sl_uint16*)m, (sl_uint16)pattern, count));
 	}
 
 	const sl_uint32* Base::findMemory4(const sl_uint32* m, sl_uint32 pattern, sl_size count)
@@ -484,6 +571,175 @@ namespace slib
 		return sl_null;
 	}
 
+	/*
+		The candidates are filtered by comparing the first and the last element of the pattern at once, for a block of the positions.
+		Only the positions matching both are verified by `memcmp`, so that the frequent first element doesn't make the search slow.
+	*/
+	const sl_uint8* Base::findMemory(const void* _mem, sl_size size, const void* _pattern, sl_size sizePattern)
+	{
+		const sl_uint8* mem = (const sl_uint8*)_mem;
+		const sl_uint8* pattern = (const sl_uint8*)_pattern;
+		if (!sizePattern) {
+			return mem;
+		}
+		if (size < sizePattern) {
+			return sl_null;
+		}
+		if (sizePattern == 1) {
+			return findMemory(mem, pattern[0], size);
+		}
+		sl_size last = sizePattern - 1;
+		// number of the positions where the pattern can start
+		sl_size n = size - last;
+		sl_size i = 0;
+#if defined(_BASE_MEMORY_USE_AVX2)
+		{
+			__m256i first = _mm256_set1_epi8((char)(pattern[0]));
+			__m256i end = _mm256_set1_epi8((char)(pattern[last]));
+			for (; i + 32 <= n; i += 32) {
+				__m256i m0 = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(mem + i)), first);
+				__m256i m1 = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(mem + i + last)), end);
+				sl_uint32 mask = (sl_uint32)(_mm256_movemask_epi8(_mm256_and_si256(m0, m1)));
+				while (mask) {
+					const sl_uint8* p = mem + i + _Base_getLowestBit(mask);
+					if (!(::memcmp(p + 1, pattern + 1, sizePattern - 2))) {
+						return p;
+					}
+					mask &= mask - 1;
+				}
+			}
+		}
+#elif defined(_BASE_MEMORY_USE_SSE2)
+		{
+			__m128i first = _mm_set1_epi8((char)(pattern[0]));
+			__m128i end = _mm_set1_epi8((char)(pattern[last]));
+			for (; i + 16 <= n; i += 16) {
+				__m128i m0 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(mem + i)), first);
+				__m128i m1 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(mem + i + last)), end);
+				sl_uint32 mask = (sl_uint32)(_mm_movemask_epi8(_mm_and_si128(m0, m1)));
+				while (mask) {
+					const sl_uint8* p = mem + i + _Base_getLowestBit(mask);
+					if (!(::memcmp(p + 1, pattern + 1, sizePattern - 2))) {
+						return p;
+					}
+					mask &= mask - 1;
+				}
+			}
+		}
+#elif defined(_BASE_MEMORY_USE_NEON)
+		{
+			uint8x16_t first = vdupq_n_u8(pattern[0]);
+			uint8x16_t end = vdupq_n_u8(pattern[last]);
+			for (; i + 16 <= n; i += 16) {
+				uint8x16_t m = vandq_u8(vceqq_u8(vld1q_u8(mem + i), first), vceqq_u8(vld1q_u8(mem + i + last), end));
+				// 4 bits per byte, and only the highest bit of each nibble is kept
+				sl_uint64 mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(m), 4)), 0) & SLIB_UINT64(0x8888888888888888);
+				while (mask) {
+					const sl_uint8* p = mem + i + (_Base_getLowestBit(mask) >> 2);
+					if (!(::memcmp(p + 1, pattern + 1, sizePattern - 2))) {
+						return p;
+					}
+					mask &= mask - 1;
+				}
+			}
+		}
+#endif
+		while (i < n) {
+			const sl_uint8* p = (const sl_uint8*)(::memchr(mem + i, pattern[0], n - i));
+			if (!p) {
+				break;
+			}
+			if (p[last] == pattern[last] && !(::memcmp(p + 1, pattern + 1, sizePattern - 2))) {
+				return p;
+			}
+			i = (sl_size)(p - mem) + 1;
+		}
+		return sl_null;
+	}
+
+	const sl_uint16* Base::findMemory2(const sl_uint16* mem, sl_size count, const sl_uint16* pattern, sl_size countPattern)
+	{
+		if (!countPattern) {
+			return mem;
+		}
+		if (count < countPattern) {
+			return sl_null;
+		}
+		if (countPattern == 1) {
+			return findMemory2(mem, pattern[0], count);
+		}
+		sl_size last = countPattern - 1;
+		sl_size sizeMiddle = (countPattern - 2) << 1;
+		// number of the positions where the pattern can start
+		sl_size n = count - last;
+		sl_size i = 0;
+#if defined(_BASE_MEMORY_USE_AVX2)
+		{
+			__m256i first = _mm256_set1_epi16((short)(pattern[0]));
+			__m256i end = _mm256_set1_epi16((short)(pattern[last]));
+			for (; i + 16 <= n; i += 16) {
+				__m256i m0 = _mm256_cmpeq_epi16(_mm256_loadu_si256((const __m256i*)(mem + i)), first);
+				__m256i m1 = _mm256_cmpeq_epi16(_mm256_loadu_si256((const __m256i*)(mem + i + last)), end);
+				// only the lower bit of each element is kept
+				sl_uint32 mask = (sl_uint32)(_mm256_movemask_epi8(_mm256_and_si256(m0, m1))) & 0x55555555;
+				while (mask) {
+					const sl_uint16* p = mem + i + (_Base_getLowestBit(mask) >> 1);
+					if (!(::memcmp(p + 1, pattern + 1, sizeMiddle))) {
+						return p;
+					}
+					mask &= mask - 1;
+				}
+			}
+		}
+#elif defined(_BASE_MEMORY_USE_SSE2)
+		{
+			__m128i first = _mm_set1_epi16((short)(pattern[0]));
+			__m128i end = _mm_set1_epi16((short)(pattern[last]));
+			for (; i + 8 <= n; i += 8) {
+				__m128i m0 = _mm_cmpeq_epi16(_mm_loadu_si128((const __m128i*)(mem + i)), first);
+				__m128i m1 = _mm_cmpeq_epi16(_mm_loadu_si128((const __m128i*)(mem + i + last)), end);
+				// only the lower bit of each element is kept
+				sl_uint32 mask = (sl_uint32)(_mm_movemask_epi8(_mm_and_si128(m0, m1))) & 0x5555;
+				while (mask) {
+					const sl_uint16* p = mem + i + (_Base_getLowestBit(mask) >> 1);
+					if (!(::memcmp(p + 1, pattern + 1, sizeMiddle))) {
+						return p;
+					}
+					mask &= mask - 1;
+				}
+			}
+		}
+#elif defined(_BASE_MEMORY_USE_NEON)
+		{
+			uint16x8_t first = vdupq_n_u16(pattern[0]);
+			uint16x8_t end = vdupq_n_u16(pattern[last]);
+			for (; i + 8 <= n; i += 8) {
+				uint16x8_t m = vandq_u16(vceqq_u16(vld1q_u16(mem + i), first), vceqq_u16(vld1q_u16(mem + i + last), end));
+				// 8 bits per element, and only the lowest bit of each byte is kept
+				sl_uint64 mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(m, 4)), 0) & SLIB_UINT64(0x0101010101010101);
+				while (mask) {
+					const sl_uint16* p = mem + i + (_Base_getLowestBit(mask) >> 3);
+					if (!(::memcmp(p + 1, pattern + 1, sizeMiddle))) {
+						return p;
+					}
+					mask &= mask - 1;
+				}
+			}
+		}
+#endif
+		while (i < n) {
+			const sl_uint16* p = findMemory2(mem + i, pattern[0], n - i);
+			if (!p) {
+				break;
+			}
+			if (p[last] == pattern[last] && !(::memcmp(p + 1, pattern + 1, sizeMiddle))) {
+				return p;
+			}
+			i = (sl_size)(p - mem) + 1;
+		}
+		return sl_null;
+	}
+
 	const sl_uint8* Base::findMemoryReverse(const void* mem, sl_uint8 pattern, sl_size count)
 	{
 		sl_uint8* m = (sl_uint8*)mem;
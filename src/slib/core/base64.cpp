@@ -10,11 +10,121 @@
 
 #include "slib/core/base64.h"
 
+#if defined(SLIB_ARCH_IS_X64) || defined(SLIB_ARCH_IS_X86)
+#	if defined(SLIB_ARCH_IS_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#		if defined(SLIB_COMPILER_IS_VC)
+#			define _BASE64_USE_SSSE3
+#			include <intrin.h>
+#			include <tmmintrin.h>
+#			define _BASE64_TARGET_SSSE3
+#		elif defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 5)
+// the instructions of SSSE3 are enabled per function, and selected at runtime
+#			define _BASE64_USE_SSSE3
+#			include <tmmintrin.h>
+#			define _BASE64_TARGET_SSSE3 __attribute__((target("ssse3")))
+#		endif
+#	endif
+#endif
+
 #define BASE64_CHARS "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/"
 
 namespace slib
 {
 
+	// index of the base64 characters, 255 for the others
+	static const sl_uint8 _g_base64_index[256] = {
+		255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+		255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+		255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 62, 255, 255, 255, 63,
+		52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 255, 255, 255, 255, 255, 255,
+		255, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14,
+		15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 255, 255, 255, 255, 255,
+		255, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+		41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 255, 255, 255, 255, 255,
+		255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+		255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+		255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+		255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+		255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+		255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+		255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+		255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255
+	};
+
+#if defined(_BASE64_USE_SSSE3)
+	static sl_bool _Base64_detectSSSE3()
+	{
+#if defined(SLIB_COMPILER_IS_VC)
+		int info[4];
+		__cpuid(info, 1);
+		return (info[2] & (1 << 9)) ? sl_true : sl_false;
+#else
+		return __builtin_cpu_supports("ssse3") ? sl_true : sl_false;
+#endif
+	}
+
+	static sl_bool _Base64_isSSSE3Supported()
+	{
+		static sl_bool flag = _Base64_detectSSSE3();
+		return flag;
+	}
+
+	/*
+		Encodes 12 bytes to 16 characters at once (W. Mula).
+		The 6-bit indices are extracted by the multiplications of the shuffled 16-bit words, and mapped to the characters by adding the offset of their ranges.
+		Returns the number of the encoded bytes. 4 bytes after the encoded ones are read.
+	*/
+	_BASE64_TARGET_SSSE3 static sl_size _Base64_encode_SSSE3(const sl_uint8* input, sl_size size, sl_char8* output)
+	{
+		const __m128i shuffleInput = _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+		const __m128i offsets = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+		sl_size n = 0;
+		while (n + 16 <= size) {
+			__m128i in = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(input + n)), shuffleInput);
+			__m128i t0 = _mm_mulhi_epu16(_mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00)), _mm_set1_epi32(0x04000040));
+			__m128i t1 = _mm_mullo_epi16(_mm_and_si128(in, _mm_set1_epi32(0x003f03f0)), _mm_set1_epi32(0x01000010));
+			__m128i indices = _mm_or_si128(t0, t1);
+			// range of each index: 0 (A-Z), 1 (a-z), 2 ~ 11 (0-9), 12 (+), 13 (/)
+			__m128i range = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+			range = _mm_or_si128(range, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), indices), _mm_set1_epi8(13)));
+			_mm_storeu_si128((__m128i*)(output + n / 3 * 4), _mm_add_epi8(indices, _mm_shuffle_epi8(offsets, range)));
+			n += 12;
+		}
+		return n;
+	}
+
+	/*
+		Decodes 16 characters to 12 bytes at once (W. Mula, D. Lemire).
+		The characters are validated by the lookups of their nibbles, and the 6-bit values are packed by the multiply-adds.
+		Returns the number of the decoded characters, stopping at the first block having other characters. 16 bytes are written for each block.
+	*/
+	_BASE64_TARGET_SSSE3 static sl_size _Base64_decode_SSSE3(const sl_char8* input, sl_size len, sl_uint8* output, sl_size size)
+	{
+		const __m128i lutLow = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+		const __m128i lutHigh = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+		const __m128i lutRoll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+		const __m128i shuffleOutput = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+		const __m128i maskNibble = _mm_set1_epi8(0x0f);
+		sl_size n = 0;
+		while (n + 16 <= len && n / 4 * 3 + 16 <= size) {
+			__m128i in = _mm_loadu_si128((const __m128i*)(input + n));
+			__m128i high = _mm_and_si128(_mm_srli_epi32(in, 4), maskNibble);
+			__m128i low = _mm_and_si128(in, maskNibble);
+			__m128i check = _mm_and_si128(_mm_shuffle_epi8(lutLow, low), _mm_shuffle_epi8(lutHigh, high));
+			if (_mm_movemask_epi8(_mm_cmpgt_epi8(check, _mm_setzero_si128()))) {
+				break;
+			}
+			__m128i roll = _mm_shuffle_epi8(lutRoll, _mm_add_epi8(_mm_cmpeq_epi8(in, _mm_set1_epi8('/')), high));
+			__m128i values = _mm_add_epi8(in, roll);
+			__m128i merged = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+			merged = _mm_madd_epi16(merged, _mm_set1_epi32(0x00011000));
+			_mm_storeu_si128((__m128i*)(output + n / 4 * 3), _mm_shuffle_epi8(merged, shuffleOutput));
+			n += 16;
+		}
+		return n;
+	}
+#endif
+
 	String Base64::encode(const void* buf, sl_size size)
 	{
 		if (size == 0) {
@@ -28,24 +138,28 @@ namespace slib
 			return ret;
 		}
 		sl_char8* output = ret.getData();
-		sl_uint32 n = 0;
-		for (sl_size iBlock = 0; iBlock < countBlock; iBlock++) {
-			sl_uint8 n0 = input[0];
-			sl_uint8 n1 = (n + 1 < size) ? input[1] : 0;
-			sl_uint8 n2 = (n + 2 < size) ? input[2] : 0;
-			output[0] = BASE64_CHARS[(n0 & 0xFC) >> 2];
-			output[1] = BASE64_CHARS[((n0 & 0x03) << 4) + ((n1 & 0xF0) >> 4)];
-			output[2] = BASE64_CHARS[((n1 & 0x0F) << 2) + ((n2 & 0xC0) >> 6)];
-			output[3] = BASE64_CHARS[n2 & 0x3F];
-			input += 3;
-			n += 3;
-			output += 4;
+		sl_size n = 0;
+#if defined(_BASE64_USE_SSSE3)
+		if (_Base64_isSSSE3Supported()) {
+			n = _Base64_encode_SSSE3(input, size, output);
+			output += n / 3 * 4;
 		}
-		if (last == 1) {
-			*(output - 2) = '=';
+#endif
+		for (; n + 3 <= size; n += 3) {
+			sl_uint32 v = ((sl_uint32)(input[n]) << 16) | ((sl_uint32)(input[n + 1]) << 8) | input[n + 2];
+			output[0] = BASE64_CHARS[v >> 18];
+			output[1] = BASE64_CHARS[(v >> 12) & 0x3F];
+			output[2] = BASE64_CHARS[(v >> 6) & 0x3F];
+			output[3] = BASE64_CHARS[v & 0x3F];
+			output += 4;
 		}
-		if (last >= 1) {
-			*(output - 1) = '=';
+		if (last) {
+			sl_uint8 n0 = input[n];
+			sl_uint8 n1 = last == 2 ? input[n + 1] : 0;
+			output[0] = BASE64_CHARS[(n0 & 0xFC) >> 2];
+			output[1] = BASE64_CHARS[((n0 & 0x03) << 4) + ((n1 & 0xF0) >> 4)];
+			output[2] = last == 2 ? BASE64_CHARS[(n1 & 0x0F) << 2] : '=';
+			output[3] = '=';
 		}
 		return ret;
 	}
@@ -55,26 +169,6 @@ namespace slib
 		return encode(mem.getData(), mem.getSize());
 	}
 
-	SLIB_INLINE sl_uint32 _Base64_index(sl_char8 c)
-	{
-		if (c >= 'A' && c <= 'Z') {
-			return c - 'A';
-		}
-		if (c >= 'a' && c <= 'z') {
-			return 26 + (c - 'a');
-		}
-		if (c >= '0' && c <= '9') {
-			return 52 + (c - '0');
-		}
-		if (c == '+') {
-			return 62;
-		}
-		if (c == '/') {
-			return 63;
-		}
-		return 64;
-	}
-
 	sl_size Base64::decode(const String& str, void* buf, sl_size size)
 	{
 		sl_uint8* output = (sl_uint8*)buf;
@@ -104,12 +198,42 @@ namespace slib
 			}
 		}
 		while (indexInput < len) {
+			if (!posInBlock) {
+				// fast path: the blocks without the line breaks and the padding
+#if defined(_BASE64_USE_SSSE3)
+				if (_Base64_isSSSE3Supported() && size > indexBlock * 3) {
+					sl_size n = _Base64_decode_SSSE3(input + indexInput, len - indexInput, output + indexBlock * 3, size - indexBlock * 3);
+					indexInput += n;
+					indexBlock += n / 4;
+				}
+#endif
+				while (indexInput + 4 <= len && (indexBlock + 1) * 3 <= size) {
+					const sl_uint8* p = (const sl_uint8*)(input + indexInput);
+					sl_uint32 d0 = _g_base64_index[p[0]];
+					sl_uint32 d1 = _g_base64_index[p[1]];
+					sl_uint32 d2 = _g_base64_index[p[2]];
+					sl_uint32 d3 = _g_base64_index[p[3]];
+					if ((d0 | d1 | d2 | d3) >= 64) {
+						break;
+					}
+					sl_uint32 v = (d0 << 18) | (d1 << 12) | (d2 << 6) | d3;
+					sl_uint8* o = output + indexBlock * 3;
+					o[0] = (sl_uint8)(v >> 16);
+					o[1] = (sl_uint8)(v >> 8);
+					o[2] = (sl_uint8)v;
+					indexInput += 4;
+					indexBlock++;
+				}
+				if (indexInput >= len) {
+					break;
+				}
+			}
 			sl_char8 ch = input[indexInput];
 			if (ch == '\r' || ch == '\n' || ch == ' ') {
 				indexInput++;
 				continue;
 			}
-			sl_uint32 sig = _Base64_index(ch);
+			sl_uint32 sig = _g_base64_index[(sl_uint8)ch];
 			if (ch == '=' && indexInput >= len - countPadding) {
 				sig = 0;
 			}
@@ -120,15 +244,22 @@ namespace slib
 			if (posInBlock >= 4) {
 				posInBlock = 0;
 				sl_size p = indexBlock * 3;
-				output[p] = (sl_uint8)((data[0] << 2) + ((data[1] & 0x30) >> 4));
-				output[p + 1] = (sl_uint8)(((data[1] & 0xf) << 4) + ((data[2] & 0x3c) >> 2));
-				output[p + 2] = (sl_uint8)(((data[2] & 0x3) << 6) + data[3]);
+				sl_uint8 o[3];
+				o[0] = (sl_uint8)((data[0] << 2) + ((data[1] & 0x30) >> 4));
+				o[1] = (sl_uint8)(((data[1] & 0xf) << 4) + ((data[2] & 0x3c) >> 2));
+				o[2] = (sl_uint8)(((data[2] & 0x3) << 6) + data[3]);
+				for (sl_uint32 k = 0; k < 3 && p + k < size; k++) {
+					output[p + k] = o[k];
+				}
 				indexBlock++;
 			}
 			indexInput++;
 		}
 		if (indexInput == len && indexBlock > 0 && posInBlock == 0) {
-			return indexBlock * 3 - countPadding;
+			sl_size ret = indexBlock * 3 - countPadding;
+			if (ret <= size) {
+				return ret;
+			}
 		}
 		return 0;
 	}
@@ -11,8 +11,99 @@
 #include "slib/core/charset.h"
 #include "slib/core/base.h"
 
+#if defined(__SSE2__) || defined(SLIB_ARCH_IS_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#	define _CHARSET_USE_SSE2
+#	include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(SLIB_ARCH_IS_ARM64)
+#	define _CHARSET_USE_NEON
+#	include <arm_neon.h>
+#endif
+
 namespace slib
 {
+
+	// number of the leading ASCII characters in `src` (up to `n`), which are copied to `dst` if it is not null
+	static sl_size _Charsets_copyAscii8To16(const sl_char8* src, sl_char16* dst, sl_size n)
+	{
+		sl_size i = 0;
+#if defined(_CHARSET_USE_SSE2)
+		__m128i zero = _mm_setzero_si128();
+		for (; i + 16 <= n; i += 16) {
+			__m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+			if (_mm_movemask_epi8(v)) {
+				break;
+			}
+			if (dst) {
+				_mm_storeu_si128((__m128i*)(dst + i), _mm_unpacklo_epi8(v, zero));
+				_mm_storeu_si128((__m128i*)(dst + i + 8), _mm_unpackhi_epi8(v, zero));
+			}
+		}
+#elif defined(_CHARSET_USE_NEON)
+		uint8x16_t high = vdupq_n_u8(0x80);
+		for (; i + 16 <= n; i += 16) {
+			uint8x16_t v = vld1q_u8((const uint8_t*)(src + i));
+			if (vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(vcgeq_u8(v, high)), 4)), 0)) {
+				break;
+			}
+			if (dst) {
+				vst1q_u16((uint16_t*)(dst + i), vmovl_u8(vget_low_u8(v)));
+				vst1q_u16((uint16_t*)(dst + i + 8), vmovl_u8(vget_high_u8(v)));
+			}
+		}
+#endif
+		for (; i < n; i++) {
+			sl_uint8 ch = (sl_uint8)(src[i]);
+			if (ch >= 0x80) {
+				break;
+			}
+			if (dst) {
+				dst[i] = (sl_char16)ch;
+			}
+		}
+		return i;
+	}
+
+	// number of the leading ASCII characters in `src` (up to `n`), which are copied to `dst` if it is not null
+	static sl_size _Charsets_copyAscii16To8(const sl_char16* src, sl_char8* dst, sl_size n)
+	{
+		sl_size i = 0;
+#if defined(_CHARSET_USE_SSE2)
+		__m128i zero = _mm_setzero_si128();
+		__m128i maskHigh = _mm_set1_epi16((short)0xFF80);
+		for (; i + 16 <= n; i += 16) {
+			__m128i a = _mm_loadu_si128((const __m128i*)(src + i));
+			__m128i b = _mm_loadu_si128((const __m128i*)(src + i + 8));
+			if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(_mm_or_si128(a, b), maskHigh), zero)) != 0xFFFF) {
+				break;
+			}
+			if (dst) {
+				_mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(a, b));
+			}
+		}
+#elif defined(_CHARSET_USE_NEON)
+		uint16x8_t maskHigh = vdupq_n_u16(0xFF80);
+		for (; i + 16 <= n; i += 16) {
+			uint16x8_t a = vld1q_u16((const uint16_t*)(src + i));
+			uint16x8_t b = vld1q_u16((const uint16_t*)(src + i + 8));
+			if (vget_lane_u64(vreinterpret_u64_u8(vqmovn_u16(vandq_u16(vorrq_u16(a, b), maskHigh))), 0)) {
+				break;
+			}
+			if (dst) {
+				vst1q_u8((uint8_t*)(dst + i), vcombine_u8(vmovn_u16(a), vmovn_u16(b)));
+			}
+		}
+#endif
+		for (; i < n; i++) {
+			sl_uint16 ch = (sl_uint16)(src[i]);
+			if (ch >= 0x80) {
+				break;
+			}
+			if (dst) {
+				dst[i] = (sl_char8)ch;
+			}
+		}
+		return i;
+	}
 	
 	sl_size Charsets::utf8ToUtf16(const sl_char8* utf8, sl_reg lenUtf8, sl_char16* utf16, sl_reg lenUtf16Buffer)
 	{
@@ -20,36 +111,61 @@ namespace slib
 			lenUtf8 = Base::getStringLength(utf8, -1) + 1;
 		}
 		sl_reg n = 0;
-		for (sl_reg i = 0; i < lenUtf8 && (lenUtf16Buffer < 0 || n < lenUtf16Buffer); i++) {
+		sl_reg i = 0;
+		while (i < lenUtf8 && (lenUtf16Buffer < 0 || n < lenUtf16Buffer)) {
 			sl_uint32 ch = (sl_uint32)((sl_uint8)utf8[i]);
 			if (ch < 0x80) {
-				if (utf16) {
-					utf16[n++] = (sl_char16)ch;
-				} else {
-					n++;
+				sl_size m = (sl_size)(lenUtf8 - i);
+				if (lenUtf16Buffer >= 0 && (sl_size)(lenUtf16Buffer - n) < m) {
+					m = (sl_size)(lenUtf16Buffer - n);
 				}
-			} else if (ch < 0xC0) {
+				m = _Charsets_copyAscii8To16(utf8 + i, utf16 ? utf16 + n : sl_null, m);
+				i += m;
+				n += m;
+				continue;
+			}
+			i++;
+			if (ch < 0xC0) {
 				// Corrupted data element
 			} else if (ch < 0xE0) {
-				if (i + 1 < lenUtf8) {
-					sl_uint32 ch1 = (sl_uint32)((sl_uint8)utf8[++i]);
+				if (i < lenUtf8) {
+					sl_uint32 ch1 = (sl_uint32)((sl_uint8)utf8[i++]);
 					if ((ch1 & 0xC0) == 0x80) {
 						if (utf16) {
-							utf16[n++] = (sl_char16)(((ch & 0x1F) << 6) | (ch1 & 0x3F));
-						} else {
-							n++;
+							utf16[n] = (sl_char16)(((ch & 0x1F) << 6) | (ch1 & 0x3F));
 						}
+						n++;
 					}
 				}
 			} else if (ch < 0xF0) {
-				if (i + 2 < lenUtf8) {
-					sl_uint32 ch1 = (sl_uint32)((sl_uint8)utf8[++i]);
-					sl_uint32 ch2 = (sl_uint32)((sl_uint8)utf8[++i]);
+				if (i + 1 < lenUtf8) {
+					sl_uint32 ch1 = (sl_uint32)((sl_uint8)utf8[i++]);
+					sl_uint32 ch2 = (sl_uint32)((sl_uint8)utf8[i++]);
 					if (((ch1 & 0xC0) == 0x80) && ((ch2 & 0xC0) == 0x80)) {
 						if (utf16) {
-							utf16[n++] = (sl_char16)(((ch & 0x0F) << 12) | ((ch1 & 0x3F) << 6) | (ch2 & 0x3F));
-						} else {
-							n++;
+							utf16[n] = (sl_char16)(((ch & 0x0F) << 12) | ((ch1 & 0x3F) << 6) | (ch2 & 0x3F));
+						}
+						n++;
+					}
+				}
+			} else if (ch < 0xF8) {
+				// supplementary planes: surrogate pair
+				if (i + 2 < lenUtf8) {
+					if (lenUtf16Buffer >= 0 && n + 1 >= lenUtf16Buffer) {
+						break;
+					}
+					sl_uint32 ch1 = (sl_uint32)((sl_uint8)utf8[i++]);
+					sl_uint32 ch2 = (sl_uint32)((sl_uint8)utf8[i++]);
+					sl_uint32 ch3 = (sl_uint32)((sl_uint8)utf8[i++]);
+					if (((ch1 & 0xC0) == 0x80) && ((ch2 & 0xC0) == 0x80) && ((ch3 & 0xC0) == 0x80)) {
+						sl_uint32 code = ((ch & 0x07) << 18) | ((ch1 & 0x3F) << 12) | ((ch2 & 0x3F) << 6) | (ch3 & 0x3F);
+						if (code >= 0x10000 && code < 0x110000) {
+							if (utf16) {
+								code -= 0x10000;
+								utf16[n] = (sl_char16)(0xD800 + (code >> 10));
+								utf16[n + 1] = (sl_char16)(0xDC00 + (code & 0x3FF));
+							}
+							n += 2;
 						}
 					}
 				}
@@ -150,33 +266,54 @@ namespace slib
 			lenUtf16 = Base::getStringLength2(utf16, -1) + 1;
 		}
 		sl_reg n = 0;
-		for (sl_reg i = 0; i < lenUtf16 && (lenUtf8Buffer < 0 || n < lenUtf8Buffer); i++) {
-			sl_uint32 ch = (sl_uint32)(utf16[i]);
+		sl_reg i = 0;
+		while (i < lenUtf16 && (lenUtf8Buffer < 0 || n < lenUtf8Buffer)) {
+			sl_uint32 ch = (sl_uint32)((sl_uint16)utf16[i]);
 			if (ch < 0x80) {
+				sl_size m = (sl_size)(lenUtf16 - i);
+				if (lenUtf8Buffer >= 0 && (sl_size)(lenUtf8Buffer - n) < m) {
+					m = (sl_size)(lenUtf8Buffer - n);
+				}
+				m = _Charsets_copyAscii16To8(utf16 + i, utf8 ? utf8 + n : sl_null, m);
+				i += m;
+				n += m;
+				continue;
+			}
+			if (ch < 0x800) {
+				if (lenUtf8Buffer >= 0 && n + 1 >= lenUtf8Buffer) {
+					break;
+				}
 				if (utf8) {
-					utf8[n++] = (sl_char8)(ch);
-				} else {
-					n++;
+					utf8[n] = (sl_char8)((ch >> 6) | 0xC0);
+					utf8[n + 1] = (sl_char8)((ch & 0x3F) | 0x80);
 				}
-			} else if (ch < 0x800) {
-				if (lenUtf8Buffer < 0 || n + 1 < lenUtf8Buffer) {
-					if (utf8) {
-						utf8[n++] = (sl_char8)((ch >> 6) | 0xC0);
-						utf8[n++] = (sl_char8)((ch & 0x3F) | 0x80);
-					} else {
-						n += 2;
-					}
+				n += 2;
+				i++;
+			} else if (ch >= 0xD800 && ch < 0xDC00 && i + 1 < lenUtf16 && (sl_uint16)(utf16[i + 1]) >= 0xDC00 && (sl_uint16)(utf16[i + 1]) < 0xE000) {
+				// surrogate pair
+				if (lenUtf8Buffer >= 0 && n + 3 >= lenUtf8Buffer) {
+					break;
+				}
+				sl_uint32 code = 0x10000 + ((ch - 0xD800) << 10) + ((sl_uint32)((sl_uint16)utf16[i + 1]) - 0xDC00);
+				if (utf8) {
+					utf8[n] = (sl_char8)((code >> 18) | 0xF0);
+					utf8[n + 1] = (sl_char8)(((code >> 12) & 0x3F) | 0x80);
+					utf8[n + 2] = (sl_char8)(((code >> 6) & 0x3F) | 0x80);
+					utf8[n + 3] = (sl_char8)((code & 0x3F) | 0x80);
 				}
+				n += 4;
+				i += 2;
 			} else {
-				if (lenUtf8Buffer < 0 || n + 2 < lenUtf8Buffer) {
-					if (utf8) {
-						utf8[n++] = (sl_char8)((ch >> 12) | 0xE0);
-						utf8[n++] = (sl_char8)(((ch >> 6) & 0x3F) | 0x80);
-						utf8[n++] = (sl_char8)((ch & 0x3F) | 0x80);
-					} else {
-						n += 3;
-					}
+				if (lenUtf8Buffer >= 0 && n + 2 >= lenUtf8Buffer) {
+					break;
 				}
+				if (utf8) {
+					utf8[n] = (sl_char8)((ch >> 12) | 0xE0);
+					utf8[n + 1] = (sl_char8)(((ch >> 6) & 0x3F) | 0x80);
+					utf8[n + 2] = (sl_char8)((ch & 0x3F) | 0x80);
+				}
+				n += 3;
+				i++;
 			}
 		}
 		return n;
@@ -272,10 +409,10 @@ namespace slib
 				}
 			} else {
 				if (i + 1 < lenUtf16) {
-					sl_uint32 ch1 = (sl_uint32)((sl_uint8)utf16[++i]);
+					sl_uint32 ch1 = (sl_uint32)((sl_uint16)utf16[++i]);
 					if (ch < 0xDC00 && ch1 >= 0xDC00 && ch1 < 0xE000) {
 						if (utf32) {
-							utf32[n++] = (sl_char32)(((ch - 0xD800) << 10) | (ch1 - 0xDC00));
+							utf32[n++] = (sl_char32)(0x10000 + ((ch - 0xD800) << 10) + (ch1 - 0xDC00));
 						} else {
 							n++;
 						}
@@ -319,4 +456,58 @@ namespace slib
 		return n;
 	}
 
+	sl_bool Charsets::checkUtf8(const sl_char8* utf8, sl_size len)
+	{
+		sl_size i = 0;
+		while (i < len) {
+			sl_uint32 ch = (sl_uint32)((sl_uint8)utf8[i]);
+			if (ch < 0x80) {
+				i += _Charsets_copyAscii8To16(utf8 + i, sl_null, len - i);
+				continue;
+			}
+			if (ch < 0xC2) {
+				// continuation byte, or overlong form of 2 bytes
+				return sl_false;
+			}
+			if (ch < 0xE0) {
+				if (i + 1 >= len || ((sl_uint8)(utf8[i + 1]) & 0xC0) != 0x80) {
+					return sl_false;
+				}
+				i += 2;
+			} else if (ch < 0xF0) {
+				if (i + 2 >= len) {
+					return sl_false;
+				}
+				sl_uint32 ch1 = (sl_uint32)((sl_uint8)utf8[i + 1]);
+				sl_uint32 ch2 = (sl_uint32)((sl_uint8)utf8[i + 2]);
+				if ((ch1 & 0xC0) != 0x80 || (ch2 & 0xC0) != 0x80) {
+					return sl_false;
+				}
+				sl_uint32 code = ((ch & 0x0F) << 12) | ((ch1 & 0x3F) << 6) | (ch2 & 0x3F);
+				if (code < 0x800 || (code >= 0xD800 && code < 0xE000)) {
+					return sl_false;
+				}
+				i += 3;
+			} else if (ch < 0xF5) {
+				if (i + 3 >= len) {
+					return sl_false;
+				}
+				sl_uint32 ch1 = (sl_uint32)((sl_uint8)utf8[i + 1]);
+				sl_uint32 ch2 = (sl_uint32)((sl_uint8)utf8[i + 2]);
+				sl_uint32 ch3 = (sl_uint32)((sl_uint8)utf8[i + 3]);
+				if ((ch1 & 0xC0) != 0x80 || (ch2 & 0xC0) != 0x80 || (ch3 & 0xC0) != 0x80) {
+					return sl_false;
+				}
+				sl_uint32 code = ((ch & 0x07) << 18) | ((ch1 & 0x3F) << 12) | ((ch2 & 0x3F) << 6) | (ch3 & 0x3F);
+				if (code < 0x10000 || code >= 0x110000) {
+					return sl_false;
+				}
+				i += 4;
+			} else {
+				return sl_false;
+			}
+		}
+		return sl_true;
+	}
+
 }
@@ -142,6 +142,7 @@ namespace slib
 		
 		MutexLocker lockTime(&m_lockTimeTasks);
 		m_timeTasks.removeAll();
+		m_mapTimers.removeAll();
 	}
 
 	void DispatchLoop::start()
@@ -179,17 +180,7 @@ namespace slib
 		if (m_queueTasks.isNotEmpty()) {
 			return 0;
 		}
-		sl_int32 t1 = _getTimeout_TimeTasks();
-		sl_int32 t2 = _getTimeout_Timer();
-		if (t1 < 0) {
-			return t2;
-		} else {
-			if (t2 < 0) {
-				return t1;
-			} else {
-				return SLIB_MIN(t1, t2);
-			}
-		}
+		return _getTimeout_TimeTasks();
 	}
 
 	sl_bool DispatchLoop::dispatch(const Function<void()>& task, sl_uint64 delay_ms)
@@ -205,10 +196,15 @@ namespace slib
 		} else {
 			MutexLocker lock(&m_lockTimeTasks);
 			TimeTask tt;
-			tt.time = getElapsedMilliseconds() + delay_ms;
 			tt.task = task;
-			if (m_timeTasks.put(tt.time, tt, MapPutMode::AddAlways)) {
-				_wake();
+			tt.timerKey = sl_null;
+			sl_uint64 time = getElapsedMilliseconds() + delay_ms;
+			sl_uint64 timeNext = m_timeTasks.getNextTick();
+			if (m_timeTasks.add(time, tt)) {
+				// the loop is already waiting for the earlier ticks
+				if (time < timeNext) {
+					_wake();
+				}
 				return sl_true;
 			}
 		}
@@ -218,105 +214,102 @@ namespace slib
 	sl_int32 DispatchLoop::_getTimeout_TimeTasks()
 	{
 		MutexLocker lock(&m_lockTimeTasks);
-		sl_uint64 rel = getElapsedMilliseconds();
-		if (m_timeTasks.getCount() == 0) {
+		if (!(m_timeTasks.getCount())) {
 			return -1;
 		}
-		sl_int32 timeout = -1;
-		TreePosition pos;
-		TimeTask timeTask;
-		LinkedQueue< Function<void()> > tasks;
-		sl_uint64 t;
-		while (m_timeTasks.getFirstPosition(pos, &t, &timeTask)) {
-			if (rel >= t) {
-				tasks.push(timeTask.task);
-				m_timeTasks.removeAt(pos);
-			} else {
-				t = t - rel;
-				timeout = (sl_int32)t;
-				break;
-			}
-		}
-		lock.unlock();
-
-		Function<void()> task;
-		while (tasks.pop(&task)) {
-			task();
-		}
-		return timeout;
-	}
-
-	sl_int32 DispatchLoop::_getTimeout_Timer()
-	{
-		MutexLocker lock(&m_lockTimer);
-
-		sl_int32 timeout = -1;
-		LinkedQueue< Ref<Timer> > tasks;
-
 		sl_uint64 rel = getElapsedMilliseconds();
-		Link<TimerTask>* link = m_queueTimers.getFront();
-		while (link) {
-			Ref<Timer> timer(link->value.timer);
-			if (timer.isNotNull()) {
-				if (timer->isStarted()) {
-					sl_uint64 t = rel - timer->getLastRunTime();
-					if (t >= timer->getInterval()) {
-						tasks.push(timer);
-						timer->setLastRunTime(rel);
-						t = timer->getInterval();
+		List<TimeTask> expired;
+		m_timeTasks.advance(rel, expired);
+
+		LinkedQueue< Function<void()> > tasks;
+		LinkedQueue< Ref<Timer> > timers;
+		ListElements<TimeTask> items(expired);
+		for (sl_size i = 0; i < items.count; i++) {
+			TimeTask& item = items[i];
+			if (item.timerKey) {
+				Ref<Timer> timer(item.timer);
+				if (timer.isNotNull() && timer->isStarted()) {
+					timer->setLastRunTime(rel);
+					TimerWheelEntry<TimeTask>* entry = m_timeTasks.add(rel + timer->getInterval(), item);
+					if (entry) {
+						m_mapTimers.put(item.timerKey, entry);
 					} else {
-						t = timer->getInterval() - t;
-					}
-					if (timeout < 0 || t < (sl_uint64)timeout) {
-						timeout = (sl_uint32)t;
+						m_mapTimers.remove(item.timerKey);
 					}
+					timers.push_NoLock(timer);
+				} else {
+					m_mapTimers.remove(item.timerKey);
 				}
-				link = link->next;
 			} else {
-				Link<TimerTask>* linkRemove = link;
-				link = link->next;
-				m_queueTimers.removeItem(linkRemove);
+				tasks.push_NoLock(item.task);
 			}
 		}
 
+		sl_int32 timeout = -1;
+		sl_uint64 timeNext = m_timeTasks.getNextTick();
+		if (timeNext != SLIB_UINT64_MAX) {
+			sl_uint64 t = timeNext - rel;
+			if (t > 0x7fffffff) {
+				t = 0x7fffffff;
+			}
+			timeout = (sl_int32)t;
+		}
 		lock.unlock();
 
-		Ref<Timer> task;
-		while (tasks.pop(&task)) {
-			if (task.isNotNull()) {
-				task->run();
-			}
+		Function<void()> task;
+		while (tasks.pop_NoLock(&task)) {
+			task();
+		}
+		Ref<Timer> timer;
+		while (timers.pop_NoLock(&timer)) {
+			timer->run();
 		}
 		return timeout;
 	}
 
-	sl_bool DispatchLoop::TimerTask::operator==(const DispatchLoop::TimerTask& other) const
-	{
-		return timer == other.timer;
-	}
-
 	sl_bool DispatchLoop::addTimer(const Ref<Timer>& timer)
 	{
 		if (timer.isNull()) {
 			return sl_false;
 		}
-		TimerTask t;
-		t.timer = timer;
-		MutexLocker lock(&m_lockTimer);
-		if (m_queueTimers.push(t)) {
-			_wake();
-			return sl_true;
-		} else {
-			return sl_false;
+		Timer* key = timer.get();
+		MutexLocker lock(&m_lockTimeTasks);
+		TimerWheelEntry<TimeTask>* entry;
+		if (m_mapTimers.get(key, &entry)) {
+			Ref<Timer> timerOld(entry->value.timer);
+			if (timerOld == timer) {
+				return sl_true;
+			}
+			// stale entry of the freed timer at the same address
+			m_timeTasks.remove(entry);
+			m_mapTimers.remove(key);
+		}
+		TimeTask tt;
+		tt.timer = timer;
+		tt.timerKey = key;
+		// same as before, the first run is counted from the last run time
+		sl_uint64 time = timer->getLastRunTime() + timer->getInterval();
+		sl_uint64 timeNext = m_timeTasks.getNextTick();
+		entry = m_timeTasks.add(time, tt);
+		if (entry) {
+			if (m_mapTimers.put(key, entry)) {
+				if (time < timeNext) {
+					_wake();
+				}
+				return sl_true;
+			}
+			m_timeTasks.remove(entry);
 		}
+		return sl_false;
 	}
 
 	void DispatchLoop::removeTimer(const Ref<Timer>& timer)
 	{
-		MutexLocker lock(&m_lockTimer);
-		TimerTask t;
-		t.timer = timer;
-		m_queueTimers.removeValue(t);
+		MutexLocker lock(&m_lockTimeTasks);
+		TimerWheelEntry<TimeTask>* entry;
+		if (m_mapTimers.remove(timer.get(), &entry)) {
+			m_timeTasks.remove(entry);
+		}
 	}
 
 	sl_uint64 DispatchLoop::getElapsedMilliseconds()
@@ -299,6 +299,24 @@ namespace slib
 		return sl_null;
 	}
 
+	Memory File::mapRegion(sl_uint64 offset, sl_size size, FileMapMode mode, const FileMapHints& hints)
+	{
+		Ref<MappedFile> mapped = MappedFile::create(this, offset, size, mode, hints);
+		if (mapped.isNotNull()) {
+			return mapped->getMemory();
+		}
+		return sl_null;
+	}
+
+	Memory File::mapAllBytes(const String& path, const FileMapHints& hints)
+	{
+		Ref<MappedFile> mapped = MappedFile::create(path, FileMapMode::Read, hints);
+		if (mapped.isNotNull()) {
+			return mapped->getMemory();
+		}
+		return sl_null;
+	}
+
 	sl_size File::writeAllBytes(const String& path, const void* buf, sl_size size)
 	{
 		Ref<File> file = File::openForWrite(path);
@@ -570,6 +588,86 @@ namespace slib
 	}
 
 
+	SLIB_DEFINE_ROOT_OBJECT(MappedFile)
+
+	MappedFile::MappedFile()
+	{
+		m_base = sl_null;
+		m_sizeMapped = 0;
+		m_data = sl_null;
+		m_size = 0;
+		m_mode = FileMapMode::Read;
+	}
+
+	MappedFile::~MappedFile()
+	{
+		if (m_base) {
+			_unmap();
+		}
+	}
+
+	Ref<MappedFile> MappedFile::create(const Ref<File>& file, sl_uint64 offset, sl_size size, FileMapMode mode, const FileMapHints& hints)
+	{
+		if (file.isNull() || !(file->isOpened())) {
+			return sl_null;
+		}
+		sl_uint64 sizeFile = file->getSize();
+		if (offset >= sizeFile) {
+			return sl_null;
+		}
+		if (size > sizeFile - offset) {
+			size = (sl_size)(sizeFile - offset);
+		}
+		if (!size) {
+			return sl_null;
+		}
+		Ref<MappedFile> ret = new MappedFile;
+		if (ret.isNotNull()) {
+			if (ret->_map(file->getHandle(), offset, size, mode)) {
+				if (hints != FileMapHints::Normal) {
+					ret->advise(hints);
+				}
+				return ret;
+			}
+		}
+		return sl_null;
+	}
+
+	Ref<MappedFile> MappedFile::create(const String& filePath, FileMapMode mode, const FileMapHints& hints)
+	{
+		Ref<File> file;
+		if (mode == FileMapMode::Write) {
+			file = File::open(filePath, FileMode::ReadWrite | FileMode::NotCreate | FileMode::NotTruncate);
+		} else {
+			file = File::openForRead(filePath);
+		}
+		if (file.isNotNull()) {
+			return create(file, 0, SLIB_SIZE_MAX, mode, hints);
+		}
+		return sl_null;
+	}
+
+	void* MappedFile::getData() const
+	{
+		return m_data;
+	}
+
+	sl_size MappedFile::getSize() const
+	{
+		return m_size;
+	}
+
+	FileMapMode MappedFile::getMode() const
+	{
+		return m_mode;
+	}
+
+	Memory MappedFile::getMemory()
+	{
+		return Memory::createStatic(m_data, m_size, this);
+	}
+
+
 	FilePathSegments::FilePathSegments()
 	{
 		parentLevel = 0;
@@ -18,6 +18,7 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
 #include <sys/time.h>
 #include <dirent.h>
 #include <stdio.h>
@@ -514,6 +515,89 @@ namespace slib
 		}
 	}
 
+
+	sl_bool MappedFile::_map(sl_file file, sl_uint64 offset, sl_size size, FileMapMode mode)
+	{
+		int fd = (int)file;
+		if (fd == -1) {
+			return sl_false;
+		}
+		long pageSize = ::sysconf(_SC_PAGESIZE);
+		if (pageSize <= 0) {
+			pageSize = 4096;
+		}
+		sl_size offsetInPage = (sl_size)(offset % (sl_uint64)pageSize);
+		sl_uint64 offsetAligned = offset - offsetInPage;
+		sl_size sizeMapped = offsetInPage + size;
+		int prot = PROT_READ;
+		int flags = MAP_SHARED;
+		if (mode == FileMapMode::CopyOnWrite) {
+			prot |= PROT_WRITE;
+			flags = MAP_PRIVATE;
+		} else if (mode == FileMapMode::Write) {
+			prot |= PROT_WRITE;
+		}
+#if defined(SLIB_PLATFORM_IS_LINUX)
+		void* base = ::mmap64(sl_null, sizeMapped, prot, flags, fd, (off64_t)offsetAligned);
+#else
+		void* base = ::mmap(sl_null, sizeMapped, prot, flags, fd, (off_t)offsetAligned);
+#endif
+		if (base == MAP_FAILED) {
+			return sl_false;
+		}
+		m_base = base;
+		m_sizeMapped = sizeMapped;
+		m_data = (sl_uint8*)base + offsetInPage;
+		m_size = size;
+		m_mode = mode;
+		return sl_true;
+	}
+
+	void MappedFile::_unmap()
+	{
+		::munmap(m_base, m_sizeMapped);
+		m_base = sl_null;
+	}
+
+	sl_bool MappedFile::advise(const FileMapHints& hints)
+	{
+		if (!m_base) {
+			return sl_false;
+		}
+		sl_bool flagSuccess = sl_true;
+		if (hints & FileMapHints::Sequential) {
+			if (::madvise(m_base, m_sizeMapped, MADV_SEQUENTIAL)) {
+				flagSuccess = sl_false;
+			}
+		}
+		if (hints & FileMapHints::Random) {
+			if (::madvise(m_base, m_sizeMapped, MADV_RANDOM)) {
+				flagSuccess = sl_false;
+			}
+		}
+		if (hints & FileMapHints::WillNeed) {
+			if (::madvise(m_base, m_sizeMapped, MADV_WILLNEED)) {
+				flagSuccess = sl_false;
+			}
+		}
+#if defined(MADV_HUGEPAGE)
+		if (hints & FileMapHints::HugePage) {
+			// fails unless the kernel supports huge pages for the page cache, which is harmless
+			::madvise(m_base, m_sizeMapped, MADV_HUGEPAGE);
+		}
+#endif
+		return flagSuccess;
+	}
+
+	sl_bool MappedFile::flush(sl_bool flagWait)
+	{
+		if (!m_base) {
+			return sl_false;
+		}
+		return 0 == ::msync(m_base, m_sizeMapped, flagWait ? MS_SYNC : MS_ASYNC);
+	}
+
+
 }
 
 #endif
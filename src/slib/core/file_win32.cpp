@@ -532,6 +532,71 @@ namespace slib
 		return ret != 0;
 	}
 
+
+	sl_bool MappedFile::_map(sl_file file, sl_uint64 offset, sl_size size, FileMapMode mode)
+	{
+		HANDLE hFile = (HANDLE)file;
+		if (hFile == INVALID_HANDLE_VALUE) {
+			return sl_false;
+		}
+		SYSTEM_INFO si;
+		::GetSystemInfo(&si);
+		sl_uint64 granularity = si.dwAllocationGranularity;
+		if (!granularity) {
+			granularity = 65536;
+		}
+		sl_size offsetInPage = (sl_size)(offset % granularity);
+		sl_uint64 offsetAligned = offset - offsetInPage;
+		sl_size sizeMapped = offsetInPage + size;
+		DWORD dwProtect = PAGE_READONLY;
+		DWORD dwAccess = FILE_MAP_READ;
+		if (mode == FileMapMode::CopyOnWrite) {
+			dwProtect = PAGE_WRITECOPY;
+			dwAccess = FILE_MAP_COPY;
+		} else if (mode == FileMapMode::Write) {
+			dwProtect = PAGE_READWRITE;
+			dwAccess = FILE_MAP_WRITE;
+		}
+		HANDLE hMapping = ::CreateFileMappingW(hFile, NULL, dwProtect, 0, 0, NULL);
+		if (!hMapping) {
+			return sl_false;
+		}
+		void* base = ::MapViewOfFile(hMapping, dwAccess, (DWORD)(offsetAligned >> 32), (DWORD)offsetAligned, sizeMapped);
+		// the view keeps the mapping object
+		::CloseHandle(hMapping);
+		if (!base) {
+			return sl_false;
+		}
+		m_base = base;
+		m_sizeMapped = sizeMapped;
+		m_data = (sl_uint8*)base + offsetInPage;
+		m_size = size;
+		m_mode = mode;
+		return sl_true;
+	}
+
+	void MappedFile::_unmap()
+	{
+		::UnmapViewOfFile(m_base);
+		m_base = sl_null;
+	}
+
+	sl_bool MappedFile::advise(const FileMapHints& hints)
+	{
+		// the paging hints are not supported
+		return m_base != sl_null;
+	}
+
+	sl_bool MappedFile::flush(sl_bool flagWait)
+	{
+		if (!m_base) {
+			return sl_false;
+		}
+		// `flagWait` is not supported, because the file handle is not kept by the mapping
+		return ::FlushViewOfFile(m_base, m_sizeMapped) != 0;
+	}
+
+
 }
 
 #endif
@@ -10,19 +10,242 @@
 
 #include "slib/core/hash.h"
 
+#include "slib/core/base.h"
+#include "slib/core/mio.h"
+#include "slib/core/time.h"
+#include "slib/core/system.h"
+#include "slib/core/safe_static.h"
+
+#if defined(SLIB_COMPILER_IS_VC) && defined(SLIB_ARCH_IS_X64)
+#include <intrin.h>
+#endif
+
+#define WYHASH_BLOCK 48
+
 namespace slib
 {
-	// based on adler32
-	sl_uint32 HashBytes(const void* _buf, sl_size n)
+
+	static const sl_uint64 _g_wyhash_secret[4] = { 0x2d358dccaa6c78a5ULL, 0x8bb84b93962eacc9ULL, 0x4b33a62ed433d4a3ULL, 0x4d5a2da51de1aa47ULL };
+
+	SLIB_INLINE static void _WyHash_mum(sl_uint64* A, sl_uint64* B)
+	{
+#if defined(__SIZEOF_INT128__)
+		__uint128_t r = *A;
+		r *= *B;
+		*A = (sl_uint64)r;
+		*B = (sl_uint64)(r >> 64);
+#elif defined(SLIB_COMPILER_IS_VC) && defined(SLIB_ARCH_IS_X64)
+		*A = _umul128(*A, *B, B);
+#else
+		sl_uint64 ha = *A >> 32, hb = *B >> 32, la = (sl_uint32)*A, lb = (sl_uint32)*B;
+		sl_uint64 rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+		sl_uint64 t = rl + (rm0 << 32);
+		sl_uint64 c = t < rl;
+		sl_uint64 lo = t + (rm1 << 32);
+		c += lo < t;
+		sl_uint64 hi = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+		*A = lo;
+		*B = hi;
+#endif
+	}
+
+	SLIB_INLINE static sl_uint64 _WyHash_mix(sl_uint64 A, sl_uint64 B)
+	{
+		_WyHash_mum(&A, &B);
+		return A ^ B;
+	}
+
+	SLIB_INLINE static sl_uint64 _WyHash_read8(const sl_uint8* p)
+	{
+		return MIO::readUint64LE(p);
+	}
+
+	SLIB_INLINE static sl_uint64 _WyHash_read4(const sl_uint8* p)
+	{
+		return MIO::readUint32LE(p);
+	}
+
+	SLIB_INLINE static sl_uint64 _WyHash_read3(const sl_uint8* p, sl_size k)
+	{
+		return (((sl_uint64)(p[0])) << 16) | (((sl_uint64)(p[k >> 1])) << 8) | p[k - 1];
+	}
+
+	SLIB_INLINE static sl_uint64 _WyHash_initSeed(sl_uint64 seed)
+	{
+		return seed ^ _WyHash_mix(seed ^ _g_wyhash_secret[0], _g_wyhash_secret[1]);
+	}
+
+	// `p` points the last `i` bytes of the input (17 <= `len`, 1 <= `i` <= 48), and the preceding 16 bytes must be readable
+	SLIB_INLINE static sl_uint64 _WyHash_finishLong(const sl_uint8* p, sl_size i, sl_uint64 seed, sl_uint64 len)
+	{
+		while (i > 16) {
+			seed = _WyHash_mix(_WyHash_read8(p) ^ _g_wyhash_secret[1], _WyHash_read8(p + 8) ^ seed);
+			i -= 16;
+			p += 16;
+		}
+		sl_uint64 a = _WyHash_read8(p + i - 16) ^ _g_wyhash_secret[1];
+		sl_uint64 b = _WyHash_read8(p + i - 8) ^ seed;
+		_WyHash_mum(&a, &b);
+		return _WyHash_mix(a ^ _g_wyhash_secret[0] ^ len, b ^ _g_wyhash_secret[1]);
+	}
+
+	SLIB_INLINE static sl_uint64 _WyHash_finishShort(const sl_uint8* p, sl_size len, sl_uint64 seed)
+	{
+		sl_uint64 a, b;
+		if (len >= 4) {
+			sl_size k = (len >> 3) << 2;
+			a = (_WyHash_read4(p) << 32) | _WyHash_read4(p + k);
+			b = (_WyHash_read4(p + len - 4) << 32) | _WyHash_read4(p + len - 4 - k);
+		} else if (len > 0) {
+			a = _WyHash_read3(p, len);
+			b = 0;
+		} else {
+			a = 0;
+			b = 0;
+		}
+		a ^= _g_wyhash_secret[1];
+		b ^= seed;
+		_WyHash_mum(&a, &b);
+		return _WyHash_mix(a ^ _g_wyhash_secret[0] ^ len, b ^ _g_wyhash_secret[1]);
+	}
+
+	WyHash::WyHash()
+	{
+		start();
+	}
+
+	WyHash::~WyHash()
+	{
+	}
+
+	sl_uint64 WyHash::hash(const void* input, sl_size len, sl_uint64 seed)
+	{
+		const sl_uint8* p = (const sl_uint8*)input;
+		seed = _WyHash_initSeed(seed);
+		if (len <= 16) {
+			return _WyHash_finishShort(p, len, seed);
+		}
+		sl_size i = len;
+		if (i > WYHASH_BLOCK) {
+			sl_uint64 see1 = seed, see2 = seed;
+			do {
+				seed = _WyHash_mix(_WyHash_read8(p) ^ _g_wyhash_secret[1], _WyHash_read8(p + 8) ^ seed);
+				see1 = _WyHash_mix(_WyHash_read8(p + 16) ^ _g_wyhash_secret[2], _WyHash_read8(p + 24) ^ see1);
+				see2 = _WyHash_mix(_WyHash_read8(p + 32) ^ _g_wyhash_secret[3], _WyHash_read8(p + 40) ^ see2);
+				p += WYHASH_BLOCK;
+				i -= WYHASH_BLOCK;
+			} while (i > WYHASH_BLOCK);
+			seed ^= see1 ^ see2;
+		}
+		return _WyHash_finishLong(p, i, seed, len);
+	}
+
+	void WyHash::start(sl_uint64 seed)
+	{
+		m_seed = _WyHash_initSeed(seed);
+		m_see1 = m_seed;
+		m_see2 = m_seed;
+		m_len = 0;
+		m_flagBlocks = sl_false;
+		m_nBuf = 0;
+	}
+
+	void WyHash::_processBlock(const sl_uint8* p)
+	{
+		m_seed = _WyHash_mix(_WyHash_read8(p) ^ _g_wyhash_secret[1], _WyHash_read8(p + 8) ^ m_seed);
+		m_see1 = _WyHash_mix(_WyHash_read8(p + 16) ^ _g_wyhash_secret[2], _WyHash_read8(p + 24) ^ m_see1);
+		m_see2 = _WyHash_mix(_WyHash_read8(p + 32) ^ _g_wyhash_secret[3], _WyHash_read8(p + 40) ^ m_see2);
+		m_flagBlocks = sl_true;
+	}
+
+	void WyHash::update(const void* input, sl_size n)
+	{
+		if (!n) {
+			return;
+		}
+		const sl_uint8* p = (const sl_uint8*)input;
+		m_len += n;
+		sl_uint8* pending = m_buf + 16;
+		// a block is processed only when more input follows it, because the last block is finished differently
+		if (m_nBuf + n <= WYHASH_BLOCK) {
+			Base::copyMemory(pending + m_nBuf, p, n);
+			m_nBuf += (sl_uint32)n;
+			return;
+		}
+		const sl_uint8* last = sl_null;
+		if (m_nBuf) {
+			sl_size k = WYHASH_BLOCK - m_nBuf;
+			Base::copyMemory(pending + m_nBuf, p, k);
+			p += k;
+			n -= k;
+			_processBlock(pending);
+			last = pending;
+		}
+		while (n > WYHASH_BLOCK) {
+			_processBlock(p);
+			last = p;
+			p += WYHASH_BLOCK;
+			n -= WYHASH_BLOCK;
+		}
+		// the finishing step may read back into the last block
+		Base::copyMemory(m_buf, last + WYHASH_BLOCK - 16, 16);
+		Base::copyMemory(pending, p, n);
+		m_nBuf = (sl_uint32)n;
+	}
+
+	sl_uint64 WyHash::finish()
+	{
+		const sl_uint8* pending = m_buf + 16;
+		if (m_len <= 16) {
+			return _WyHash_finishShort(pending, (sl_size)m_len, m_seed);
+		}
+		sl_uint64 seed = m_seed;
+		if (m_flagBlocks) {
+			seed ^= m_see1 ^ m_see2;
+		}
+		return _WyHash_finishLong(pending, m_nBuf, seed, m_len);
+	}
+
+
+	SLIB_INLINE static sl_uint64 _HashBytes_generateSeed()
 	{
-#define MOD_ADLER 65521
-		sl_uint8* buf = (sl_uint8*)_buf;
-		sl_uint32 a = 1, b = 0;
-		for (sl_size i = 0; i < n; i++) {
-			a = (a + buf[i]) % MOD_ADLER;
-			b = (b + a) % MOD_ADLER;
+		sl_uint64 seed = Time::now().toInt();
+		seed = _WyHash_mix(seed ^ _g_wyhash_secret[0], ((sl_uint64)(System::getProcessId()) << 32) ^ System::getTickCount() ^ _g_wyhash_secret[1]);
+		sl_uint64 addr = (sl_uint64)(sl_size)(&seed);
+		void* heap = Base::createMemory(1);
+		addr ^= ((sl_uint64)(sl_size)heap) << 13;
+		if (heap) {
+			Base::freeMemory(heap);
 		}
-		return Rehash((b << 16) | a);
+		return _WyHash_mix(seed ^ _g_wyhash_secret[2], addr ^ _g_wyhash_secret[3]);
+	}
+
+	sl_uint64 GetHashBytesSeed()
+	{
+		SLIB_SAFE_STATIC(sl_uint64, seed, _HashBytes_generateSeed())
+		return seed;
+	}
+
+	sl_uint32 HashBytes(const void* buf, sl_size n)
+	{
+		sl_uint64 h = WyHash::hash(buf, n, GetHashBytesSeed());
+		return (sl_uint32)(h ^ (h >> 32));
+	}
+
+	sl_uint32 HashBytes(const void* buf, sl_size n, sl_uint64 seed)
+	{
+		sl_uint64 h = WyHash::hash(buf, n, seed);
+		return (sl_uint32)(h ^ (h >> 32));
+	}
+
+	sl_uint64 HashBytes64(const void* buf, sl_size n)
+	{
+		return WyHash::hash(buf, n, GetHashBytesSeed());
+	}
+
+	sl_uint64 HashBytes64(const void* buf, sl_size n, sl_uint64 seed)
+	{
+		return WyHash::hash(buf, n, seed);
 	}
 
 }
@@ -25,6 +25,7 @@ namespace slib
 	{
 		flagLogError = sl_true;
 		flagSupportComments = sl_true;
+		flagFlatHashMap = sl_false;
 		
 		flagError = sl_false;
 		errorLine = 0;
@@ -276,6 +277,7 @@ namespace slib
 		const CT* buf = sl_null;
 		sl_size len = 0;
 		sl_bool flagSupportComments = sl_false;
+		sl_bool flagFlatHashMap = sl_false;
 		
 		sl_size pos = 0;
 		
@@ -448,7 +450,12 @@ namespace slib
 				errorMessage = "Object: Missing character } ";
 				return sl_null;
 			}
-			VariantMap map = VariantMap::createHash();
+			VariantMap map;
+			if (flagFlatHashMap) {
+				map = VariantMap::createFlatHash();
+			} else {
+				map = VariantMap::createHash();
+			}
 			sl_bool flagFirst = sl_true;
 			while (pos < len) {
 				escapeSpaceAndComments();
@@ -595,6 +602,7 @@ namespace slib
 		parser.buf = buf;
 		parser.len = len;
 		parser.flagSupportComments = param.flagSupportComments;
+		parser.flagFlatHashMap = param.flagFlatHashMap;
 		
 		parser.pos = 0;
 		parser.flagError = sl_false;
@@ -673,6 +681,20 @@ namespace slib
 
 	Json Json::parseJsonFromTextFile(const String& filePath, JsonParseParam& param)
 	{
+		// UTF-8 text is parsed in the mapped file, without reading and converting to UTF-16
+		Memory mem = File::mapAllBytes(filePath);
+		if (mem.isNotNull()) {
+			const sl_char8* sz = (const sl_char8*)(mem.getData());
+			sl_size len = mem.getSize();
+			sl_bool flagUTF16 = len % 2 == 0 && ((sz[0] == (sl_char8)0xFF && sz[1] == (sl_char8)0xFE) || (sz[0] == (sl_char8)0xFE && sz[1] == (sl_char8)0xFF));
+			if (!flagUTF16) {
+				if (len >= 3 && sz[0] == (sl_char8)0xEF && sz[1] == (sl_char8)0xBB && sz[2] == (sl_char8)0xBF) {
+					sz += 3;
+					len -= 3;
+				}
+				return parseJson(sz, len, param);
+			}
+		}
 		String16 json = File::readAllText16(filePath);
 		return parseJson16(json, param);
 	}
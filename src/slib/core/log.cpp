@@ -13,6 +13,8 @@
 #include "slib/core/file.h"
 #include "slib/core/variant.h"
 #include "slib/core/safe_static.h"
+#include "slib/core/time.h"
+#include "slib/core/string_buffer.h"
 
 #if defined(SLIB_PLATFORM_IS_ANDROID)
 #include <android/log.h>
@@ -54,6 +56,10 @@ namespace slib
 		log(tag, content);
 	}
 
+	void Logger::flush()
+	{
+	}
+
 	static String _Log_getLineString(const String& tag, const String& content)
 	{
 		return String::format("%s [%s] %s", Time::now(), tag, content);
@@ -85,6 +91,256 @@ namespace slib
 		}
 	}
 	
+	AsyncFileLoggerParam::AsyncFileLoggerParam()
+	{
+		maxFileSize = 0;
+		rotationInterval = 0;
+		maxBackupFiles = 5;
+		
+		flushInterval = 200;
+		maxBufferSize = 8 * 1024 * 1024;
+		flagBlockWhenFull = sl_false;
+	}
+
+	AsyncFileLoggerParam::~AsyncFileLoggerParam()
+	{
+	}
+
+
+	struct AsyncFileLogger::Line
+	{
+		Line* next;
+		String content;
+	};
+
+	SLIB_DEFINE_OBJECT(AsyncFileLogger, Logger)
+
+	AsyncFileLogger::AsyncFileLogger()
+	{
+		m_lines = sl_null;
+		m_sizePending = 0;
+		m_nDropped = 0;
+		m_nDroppedReported = 0;
+		m_flagRunning = sl_false;
+		m_sizeFile = 0;
+		m_timeOpened = 0;
+	}
+
+	AsyncFileLogger::~AsyncFileLogger()
+	{
+		release();
+	}
+
+	Ref<AsyncFileLogger> AsyncFileLogger::create(const AsyncFileLoggerParam& param)
+	{
+		if (param.fileName.isEmpty()) {
+			return sl_null;
+		}
+		Ref<AsyncFileLogger> ret = new AsyncFileLogger;
+		if (ret.isNotNull()) {
+			ret->m_param = param;
+			if (ret->m_param.flushInterval == 0) {
+				ret->m_param.flushInterval = 1;
+			}
+			ret->m_eventSpace = Event::create();
+			if (ret->m_eventSpace.isNotNull()) {
+				ret->m_thread = Thread::create(SLIB_FUNCTION_CLASS(AsyncFileLogger, _runWriter, ret.get()));
+				if (ret->m_thread.isNotNull()) {
+					ret->m_flagRunning = sl_true;
+					if (ret->m_thread->start()) {
+						return ret;
+					}
+					ret->m_flagRunning = sl_false;
+				}
+			}
+		}
+		return sl_null;
+	}
+
+	void AsyncFileLogger::release()
+	{
+		ObjectLocker lock(this);
+		if (m_flagRunning) {
+			m_flagRunning = sl_false;
+			lock.unlock();
+			m_thread->finishAndWait();
+		} else {
+			lock.unlock();
+		}
+		// writes the remaining lines
+		_write();
+		MutexLocker lockWrite(&m_lockWrite);
+		m_file.setNull();
+	}
+
+	sl_uint64 AsyncFileLogger::getDroppedLinesCount()
+	{
+		return (sl_uint64)(Base::interlockedAdd64(&m_nDropped, 0));
+	}
+
+	void AsyncFileLogger::log(const String& tag, const String& content)
+	{
+		_push(_Log_getLineString(tag, content) + "\r\n");
+	}
+
+	void AsyncFileLogger::flush()
+	{
+		_write();
+	}
+
+	void AsyncFileLogger::_push(const String& content)
+	{
+		sl_reg size = (sl_reg)(content.getLength());
+		if (!size) {
+			return;
+		}
+		sl_reg maxSize = (sl_reg)(m_param.maxBufferSize);
+		if (Base::interlockedAdd(&m_sizePending, size) > maxSize) {
+			if (m_param.flagBlockWhenFull && m_flagRunning) {
+				// backpressure: waits until the writer makes room
+				do {
+					Base::interlockedAdd(&m_sizePending, -size);
+					m_thread->wake();
+					m_eventSpace->wait(10);
+					if (!m_flagRunning) {
+						Base::interlockedAdd(&m_sizePending, size);
+						break;
+					}
+				} while (Base::interlockedAdd(&m_sizePending, size) > maxSize);
+			} else {
+				Base::interlockedAdd(&m_sizePending, -size);
+				Base::interlockedIncrement64(&m_nDropped);
+				return;
+			}
+		}
+		Line* line = new Line;
+		if (!line) {
+			Base::interlockedAdd(&m_sizePending, -size);
+			return;
+		}
+		line->content = content;
+		// lock-free push (LIFO), reversed by the writer
+		Line* head;
+		do {
+			head = m_lines;
+			line->next = head;
+		} while (!(Base::interlockedCompareExchangePtr((void**)&m_lines, line, head)));
+		if (Base::interlockedAdd(&m_sizePending, 0) > (maxSize >> 1)) {
+			m_thread->wake();
+		}
+	}
+
+	AsyncFileLogger::Line* AsyncFileLogger::_popAll()
+	{
+		Line* head;
+		do {
+			head = m_lines;
+			if (!head) {
+				return sl_null;
+			}
+		} while (!(Base::interlockedCompareExchangePtr((void**)&m_lines, sl_null, head)));
+		// restores the order of logging
+		Line* prev = sl_null;
+		while (head) {
+			Line* next = head->next;
+			head->next = prev;
+			prev = head;
+			head = next;
+		}
+		return prev;
+	}
+
+	void AsyncFileLogger::_runWriter()
+	{
+		Ref<Thread> thread = Thread::getCurrent();
+		if (thread.isNull()) {
+			return;
+		}
+		while (thread->isNotStopping()) {
+			_write();
+			thread->wait(m_param.flushInterval);
+		}
+	}
+
+	void AsyncFileLogger::_write()
+	{
+		MutexLocker lock(&m_lockWrite);
+		Line* lines = _popAll();
+		sl_int64 nDropped = Base::interlockedAdd64(&m_nDropped, 0);
+		if (!lines) {
+			return;
+		}
+		StringBuffer buf;
+		sl_reg size = 0;
+		while (lines) {
+			Line* line = lines;
+			lines = line->next;
+			size += (sl_reg)(line->content.getLength());
+			buf.add(line->content);
+			delete line;
+		}
+		if (nDropped != m_nDroppedReported) {
+			buf.add(_Log_getLineString("AsyncFileLogger", String::format("%d lines are dropped", nDropped - m_nDroppedReported)) + "\r\n");
+			m_nDroppedReported = nDropped;
+		}
+		String content = buf.merge();
+		sl_size len = content.getLength();
+		if (m_param.maxFileSize && m_sizeFile > 0 && m_sizeFile + len > m_param.maxFileSize) {
+			_rotate();
+		} else if (m_param.rotationInterval && m_file.isNotNull() && Time::now().toInt() - m_timeOpened >= (sl_int64)(m_param.rotationInterval) * 1000) {
+			_rotate();
+		}
+		if (m_file.isNull()) {
+			_openFile();
+		}
+		if (m_file.isNotNull()) {
+			if (m_file->write(content.getData(), len) == (sl_reg)len) {
+				m_sizeFile += len;
+			} else {
+				// reopens at next time
+				m_file.setNull();
+			}
+		}
+		Base::interlockedAdd(&m_sizePending, -size);
+		m_eventSpace->set();
+	}
+
+	sl_bool AsyncFileLogger::_openFile()
+	{
+		m_file = File::openForAppend(m_param.fileName);
+		if (m_file.isNotNull()) {
+			m_sizeFile = m_file->getSize();
+			m_timeOpened = Time::now().toInt();
+			return sl_true;
+		}
+		return sl_false;
+	}
+
+	void AsyncFileLogger::_rotate()
+	{
+		m_file.setNull();
+		const String& fileName = m_param.fileName;
+		sl_uint32 n = m_param.maxBackupFiles;
+		if (n) {
+			String last = fileName + "." + String::fromUint32(n);
+			if (File::exists(last)) {
+				File::deleteFile(last);
+			}
+			for (sl_uint32 i = n - 1; i > 0; i--) {
+				String path = fileName + "." + String::fromUint32(i);
+				if (File::exists(path)) {
+					File::rename(path, fileName + "." + String::fromUint32(i + 1));
+				}
+			}
+			File::rename(fileName, fileName + ".1");
+		} else {
+			File::deleteFile(fileName);
+		}
+		m_sizeFile = 0;
+		_openFile();
+	}
+
+	
 	class ConsoleLogger : public Logger
 	{
 	public:
@@ -192,6 +448,22 @@ namespace slib
 		}
 	}
 
+	void LoggerSet::flush()
+	{
+		{
+			ListLocker< Ref<Logger> > list(m_listLoggers);
+			for (sl_size i = 0; i < list.count; i++) {
+				list[i]->flush();
+			}
+		}
+		{
+			ListLocker< Ref<Logger> > list(m_listErrorLoggers);
+			for (sl_size i = 0; i < list.count; i++) {
+				list[i]->flush();
+			}
+		}
+	}
+
 	Ref<LoggerSet> Logger::global()
 	{
 		Ref<Logger> console(getConsoleLogger());
@@ -216,6 +488,18 @@ namespace slib
 		return new FileLogger(fileName);
 	}
 
+	Ref<Logger> Logger::createAsyncFileLogger(const String& fileName)
+	{
+		AsyncFileLoggerParam param;
+		param.fileName = fileName;
+		return AsyncFileLogger::create(param);
+	}
+
+	Ref<Logger> Logger::createAsyncFileLogger(const AsyncFileLoggerParam& param)
+	{
+		return AsyncFileLogger::create(param);
+	}
+
 	void Logger::logGlobal(const String& tag, const String& content)
 	{
 		Ref<LoggerSet> log = global();
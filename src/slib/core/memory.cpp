@@ -317,6 +317,8 @@ namespace slib
 
 	MemoryData::MemoryData(const MemoryData& other) = default;
 
+	MemoryData& MemoryData::operator=(const MemoryData& other) = default;
+
 	MemoryData::~MemoryData()
 	{
 	}
@@ -594,6 +596,43 @@ namespace slib
 		ObjectLocker lock(this);
 		return pop_NoLock(data);
 	}
+
+	sl_bool MemoryQueue::pop_NoLock(MemoryData& data, sl_size sizeMax)
+	{
+		if (sizeMax == 0) {
+			return sl_false;
+		}
+		MemoryData mem = m_memCurrent;
+		sl_size pos = m_posCurrent;
+		m_memCurrent.size = 0;
+		m_posCurrent = 0;
+		if (mem.size == 0) {
+			if (!(m_queue.pop_NoLock(&mem))) {
+				return sl_false;
+			}
+			pos = 0;
+		}
+		if (pos >= mem.size) {
+			return sl_false;
+		}
+		sl_size n = mem.size - pos;
+		if (n > sizeMax) {
+			n = sizeMax;
+			m_posCurrent = pos + n;
+			m_memCurrent = mem;
+		}
+		data.data = (sl_uint8*)(mem.data) + pos;
+		data.size = n;
+		data.refer = mem.refer;
+		m_size -= n;
+		return sl_true;
+	}
+
+	sl_bool MemoryQueue::pop(MemoryData& data, sl_size sizeMax)
+	{
+		ObjectLocker lock(this);
+		return pop_NoLock(data, sizeMax);
+	}
 	
 	sl_size MemoryQueue::pop_NoLock(void* _buf, sl_size size)
 	{
@@ -678,4 +717,10 @@ namespace slib
 		return merge_NoLock();
 	}
 
+
+	sl_uint32 Hash<Memory>::operator()(const Memory& mem) const
+	{
+		return HashBytes(mem.getData(), mem.getSize());
+	}
+
 }
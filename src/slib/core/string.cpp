@@ -28,6 +28,11 @@ namespace slib
 			return Base::findMemory(mem, pattern, count);
 		}
 		
+		SLIB_INLINE static const void* findMemory(const sl_char8* mem, sl_size count, const sl_char8* pattern, sl_size countPattern)
+		{
+			return Base::findMemory(mem, count, pattern, countPattern);
+		}
+		
 		SLIB_INLINE static const void* findMemoryReverse(const sl_char8* mem, sl_char8 pattern, sl_size count)
 		{
 			return Base::findMemoryReverse(mem, pattern, count);
@@ -52,6 +57,11 @@ namespace slib
 			return Base::findMemory2((sl_uint16*)mem, pattern, count);
 		}
 		
+		SLIB_INLINE static const void* findMemory(const sl_char16* mem, sl_size count, const sl_char16* pattern, sl_size countPattern)
+		{
+			return Base::findMemory2((sl_uint16*)mem, count, (sl_uint16*)pattern, countPattern);
+		}
+		
 		SLIB_INLINE static const void* findMemoryReverse(const sl_char16* mem, sl_char16 pattern, sl_size count)
 		{
 			return Base::findMemoryReverse2((sl_uint16*)mem, pattern, count);
@@ -231,6 +241,45 @@ namespace slib
 	}
 
 
+	// the text converted from other encoding is written to a container of the maximum length, and the container is shrunk to the written length
+	static StringContainer* _String_shrinkContainer(StringContainer* container, sl_size len)
+	{
+		if (len == container->len) {
+			return container;
+		}
+		if (len == 0) {
+			Base::freeMemory(container);
+			return _String_Empty.container;
+		}
+		sl_char8* buf = (sl_char8*)(Base::reallocMemory(container, sizeof(StringContainer) + len + 1));
+		if (buf) {
+			container = reinterpret_cast<StringContainer*>(buf);
+			container->sz = buf + sizeof(StringContainer);
+		}
+		container->len = len;
+		container->sz[len] = 0;
+		return container;
+	}
+
+	static StringContainer16* _String16_shrinkContainer(StringContainer16* container, sl_size len)
+	{
+		if (len == container->len) {
+			return container;
+		}
+		if (len == 0) {
+			Base::freeMemory(container);
+			return _String16_Empty.container;
+		}
+		sl_char8* buf = (sl_char8*)(Base::reallocMemory(container, sizeof(StringContainer16) + ((len + 1) << 1)));
+		if (buf) {
+			container = reinterpret_cast<StringContainer16*>(buf);
+			container->sz = (sl_char16*)((void*)(buf + sizeof(StringContainer16)));
+		}
+		container->len = len;
+		container->sz[len] = 0;
+		return container;
+	}
+
 	SLIB_INLINE StringContainer* String::_create(sl_char8 ch, sl_size nRepeatCount)
 	{
 		StringContainer* container = _alloc(nRepeatCount);
@@ -271,11 +320,11 @@ namespace slib
 			if (lenUtf8 < 0) {
 				lenUtf8 = Base::getStringLength(utf8);
 			}
-			sl_size len = Charsets::utf8ToUtf16(utf8, lenUtf8, sl_null, -1);
-			StringContainer16* container = _alloc(len);
-			if (container && len > 0) {
-				Charsets::utf8ToUtf16(utf8, lenUtf8, container->sz, len);
-				container->sz[len] = 0;
+			// a UTF-8 byte is decoded to a UTF-16 character at most
+			StringContainer16* container = _alloc(lenUtf8);
+			if (container && lenUtf8 > 0) {
+				sl_size len = Charsets::utf8ToUtf16(utf8, lenUtf8, container->sz, lenUtf8);
+				container = _String16_shrinkContainer(container, len);
 			}
 			return container;
 		}
@@ -288,11 +337,12 @@ namespace slib
 			if (lenUtf16 < 0) {
 				lenUtf16 = Base::getStringLength2(utf16);
 			}
-			sl_size len = Charsets::utf16ToUtf8(utf16, lenUtf16, sl_null, -1);
-			StringContainer* container = _alloc(len);
-			if (container && len > 0) {
-				Charsets::utf16ToUtf8(utf16, lenUtf16, container->sz, len);
-				container->sz[len] = 0;
+			// a UTF-16 character is encoded to 3 UTF-8 bytes at most
+			sl_size lenMax = lenUtf16 * 3;
+			StringContainer* container = _alloc(lenMax);
+			if (container && lenMax > 0) {
+				sl_size len = Charsets::utf16ToUtf8(utf16, lenUtf16, container->sz, lenMax);
+				container = _String_shrinkContainer(container, len);
 			}
 			return container;
 		}
@@ -394,13 +444,12 @@ namespace slib
 		if (len2_u16 < 0) {
 			len2_u16 = Base::getStringLength2(s2_u16);
 		}
-		sl_size len2 = Charsets::utf16ToUtf8(s2_u16, len2_u16, sl_null, -1);
-		sl_size len = len1 + len2;
-		StringContainer* s = _alloc(len);
-		if (s && len > 0) {
+		sl_size lenMax = len1 + len2_u16 * 3;
+		StringContainer* s = _alloc(lenMax);
+		if (s && lenMax > 0) {
 			Base::copyMemory(s->sz, s1, len1);
-			Charsets::utf16ToUtf8(s2_u16, len2_u16, s->sz + len1, len2);
-			s->sz[len] = 0;
+			sl_size len2 = Charsets::utf16ToUtf8(s2_u16, len2_u16, s->sz + len1, len2_u16 * 3);
+			s = _String_shrinkContainer(s, len1 + len2);
 		}
 		return s;
 	}
@@ -413,13 +462,12 @@ namespace slib
 		if (len2 < 0) {
 			len2 = Base::getStringLength(s2);
 		}
-		sl_size len1 = Charsets::utf16ToUtf8(s1_u16, len1_u16, sl_null, -1);
-		sl_size len = len1 + len2;
-		StringContainer* s = _alloc(len);
-		if (s && len > 0) {
-			Charsets::utf16ToUtf8(s1_u16, len1_u16, s->sz, len1);
+		sl_size lenMax = len1_u16 * 3 + len2;
+		StringContainer* s = _alloc(lenMax);
+		if (s && lenMax > 0) {
+			sl_size len1 = Charsets::utf16ToUtf8(s1_u16, len1_u16, s->sz, len1_u16 * 3);
 			Base::copyMemory(s->sz + len1, s2, len2);
-			s->sz[len] = 0;
+			s = _String_shrinkContainer(s, len1 + len2);
 		}
 		return s;
 	}
@@ -470,13 +518,12 @@ namespace slib
 		if (len2_u8 < 0) {
 			len2_u8 = Base::getStringLength(s2_u8);
 		}
-		sl_size len2 = Charsets::utf8ToUtf16(s2_u8, len2_u8, sl_null, -1);
-		sl_size len = len1 + len2;
-		StringContainer16* s = _alloc(len);
-		if (s && len > 0) {
+		sl_size lenMax = len1 + len2_u8;
+		StringContainer16* s = _alloc(lenMax);
+		if (s && lenMax > 0) {
 			Base::copyMemory(s->sz, s1, len1*sizeof(sl_char16));
-			Charsets::utf8ToUtf16(s2_u8, len2_u8, s->sz + len1, len2);
-			s->sz[len] = 0;
+			sl_size len2 = Charsets::utf8ToUtf16(s2_u8, len2_u8, s->sz + len1, len2_u8);
+			s = _String16_shrinkContainer(s, len1 + len2);
 		}
 		return s;
 	}
@@ -489,13 +536,12 @@ namespace slib
 		if (len2 < 0) {
 			len2 = Base::getStringLength2(s2);
 		}
-		sl_size len1 = Charsets::utf8ToUtf16(s1_u8, len1_u8, sl_null, -1);
-		sl_size len = len1 + len2;
-		StringContainer16* s = _alloc(len);
-		if (s && len > 0) {
-			Charsets::utf8ToUtf16(s1_u8, len1_u8, s->sz, len1);
+		sl_size lenMax = len1_u8 + len2;
+		StringContainer16* s = _alloc(lenMax);
+		if (s && lenMax > 0) {
+			sl_size len1 = Charsets::utf8ToUtf16(s1_u8, len1_u8, s->sz, len1_u8);
 			Base::copyMemory(s->sz + len1, s2, len2*sizeof(sl_char16));
-			s->sz[len] = 0;
+			s = _String16_shrinkContainer(s, len1 + len2);
 		}
 		return s;
 	}
@@ -1596,13 +1642,7 @@ namespace slib
 	template <class CT>
 	SLIB_INLINE sl_uint32 _String_calcHash(const CT* buf, sl_size len)
 	{
-		sl_uint32 hash = 0;
-		for (sl_size i = 0; i < len; i++) {
-			sl_uint32 ch = buf[i];
-			hash = hash * 31 + ch;
-		}
-		hash = Rehash(hash);
-		return hash;
+		return HashBytes(buf, len * sizeof(CT));
 	}
 
 	sl_uint32 String::getHashCode() const
@@ -4514,20 +4554,125 @@ namespace slib
 				return -1;
 			}
 		}
-		while (start <= count - countPat) {
-			const CT* pt = (const CT*)(TT::findMemory(buf + start, bufPat[0], count - start - countPat + 1));
-			if (pt == sl_null) {
-				return -1;
-			}
-			if (TT::compareMemory(pt + 1, bufPat + 1, countPat - 1) == 0) {
-				return (sl_reg)(pt - buf);
+		const CT* pt = (const CT*)(TT::findMemory(buf + start, count - start, bufPat, countPat));
+		if (pt) {
+			return (sl_reg)(pt - buf);
+		}
+		return -1;
+	}
+
+	// positions of the matches found in a pass. the first ones are kept on the stack
+	class _String_MatchPositions
+	{
+	public:
+		sl_size count;
+		sl_size positions[64];
+		List<sl_size> positionsMore;
+
+	public:
+		_String_MatchPositions()
+		{
+			count = 0;
+		}
+
+	public:
+		SLIB_INLINE void add(sl_size pos)
+		{
+			if (count < 64) {
+				positions[count] = pos;
 			} else {
-				start = (sl_size)(pt - buf + 1);
+				positionsMore.add_NoLock(pos);
+			}
+			count++;
+		}
+
+		SLIB_INLINE sl_size get(sl_size index) const
+		{
+			if (index < 64) {
+				return positions[index];
+			}
+			return positionsMore.getData()[index - 64];
+		}
+
+	};
+
+	template <class CT, class TT>
+	static void _String_findAll(const CT* buf, sl_size count, const CT* pattern, sl_size countPat, _String_MatchPositions& matches)
+	{
+		sl_size start = 0;
+		while (start + countPat <= count) {
+			const CT* pt = (const CT*)(TT::findMemory(buf + start, count - start, pattern, countPat));
+			if (!pt) {
+				break;
+			}
+			sl_size index = (sl_size)(pt - buf);
+			matches.add(index);
+			start = index + countPat;
+		}
+	}
+
+	template <class ST, class CT, class TT>
+	SLIB_INLINE sl_reg _String_indexOfAny(const ST& str, const ST* patterns, sl_size nPatterns, sl_reg _start, sl_size* outIndexPattern)
+	{
+		sl_size count = str.getLength();
+		sl_size start = _start < 0 ? 0 : (sl_size)_start;
+		const CT* buf = str.getData();
+		// the patterns are searched by the vectorized search window by window, so that a rare pattern is not searched far beyond the nearest match.
+		// in a window, each pattern is searched only for the positions before the nearest match of the previous patterns
+		const sl_size sizeWindow = 1024;
+		for (sl_size pos = start; pos < count; pos += sizeWindow) {
+			sl_size end = count - pos > sizeWindow ? pos + sizeWindow : count;
+			sl_reg index = -1;
+			for (sl_size k = 0; k < nPatterns && pos < end; k++) {
+				sl_size len = patterns[k].getLength();
+				if (!len) {
+					continue;
+				}
+				sl_size size = end - pos + len - 1;
+				if (size > count - pos) {
+					size = count - pos;
+				}
+				if (len > size) {
+					continue;
+				}
+				const CT* pt = (const CT*)(TT::findMemory(buf + pos, size, patterns[k].getData(), len));
+				if (pt) {
+					index = (sl_reg)(pt - buf);
+					end = (sl_size)index;
+					if (outIndexPattern) {
+						*outIndexPattern = k;
+					}
+				}
+			}
+			if (index >= 0) {
+				return index;
 			}
 		}
 		return -1;
 	}
 
+	sl_reg String::indexOfAny(const String* patterns, sl_size nPatterns, sl_reg start, sl_size* outIndexPattern) const
+	{
+		return _String_indexOfAny<String, sl_char8, _TemplateFunc8>(*this, patterns, nPatterns, start, outIndexPattern);
+	}
+
+	sl_reg String16::indexOfAny(const String16* patterns, sl_size nPatterns, sl_reg start, sl_size* outIndexPattern) const
+	{
+		return _String_indexOfAny<String16, sl_char16, _TemplateFunc16>(*this, patterns, nPatterns, start, outIndexPattern);
+	}
+
+	sl_reg Atomic<String>::indexOfAny(const String* patterns, sl_size nPatterns, sl_reg start, sl_size* outIndexPattern) const
+	{
+		String s(*this);
+		return s.indexOfAny(patterns, nPatterns, start, outIndexPattern);
+	}
+
+	sl_reg Atomic<String16>::indexOfAny(const String16* patterns, sl_size nPatterns, sl_reg start, sl_size* outIndexPattern) const
+	{
+		String16 s(*this);
+		return s.indexOfAny(patterns, nPatterns, start, outIndexPattern);
+	}
+
 	sl_reg String::indexOf(const String& pattern, sl_reg start) const
 	{
 		return _String_indexOf<String, sl_char8, _TemplateFunc8>(*this, pattern.getData(), pattern.getLength(), start);
@@ -5218,64 +5363,48 @@ namespace slib
 	}
 
 
-	struct STRING_REPLACE_SUBSET
-	{
-		sl_reg start;
-		sl_reg len;
-	};
-
-	template <class ST, class CT>
-	SLIB_INLINE ST _String_replaceAll(const ST& str, const CT* pattern, sl_reg countPat, const CT* bufReplace, sl_reg countReplace)
+	template <class ST, class CT, class TT>
+	SLIB_INLINE ST _String_replaceAll(const ST& str, const CT* pattern, sl_size countPat, const CT* bufReplace, sl_size countReplace)
 	{
 		if (countPat == 0) {
 			return sl_null;
 		}
-		sl_reg count = str.getLength();
+		sl_size count = str.getLength();
 		if (count == 0) {
 			return sl_null;
 		}
-		LinkedQueue<STRING_REPLACE_SUBSET> queue;
-		STRING_REPLACE_SUBSET subset;
 		const CT* buf = str.getData();
-		sl_reg size = 0;
-		sl_reg start = 0;
-		while (start <= count + countPat - 1) {
-			sl_reg index = str.indexOf(pattern, start);
-			if (index < 0) {
-				index = count;
-			} else {
-				size += countReplace;
-			}
-			subset.start = start;
-			subset.len = index - start;
-			queue.push_NoLock(subset);
-			size += subset.len;
-			start = index + countPat;
+		_String_MatchPositions matches;
+		_String_findAll<CT, TT>(buf, count, pattern, countPat, matches);
+		sl_size nMatches = matches.count;
+		if (!nMatches) {
+			return str;
 		}
-
-		ST ret = ST::allocate(size);
+		ST ret = ST::allocate(count - nMatches * countPat + nMatches * countReplace);
 		if (ret.isNotNull()) {
 			CT* out = ret.getData();
-			while (queue.pop_NoLock(&subset)) {
-				Base::copyMemory(out, buf + subset.start, subset.len*sizeof(CT));
-				out += subset.len;
-				if (queue.isNotEmpty()) {
-					Base::copyMemory(out, bufReplace, countReplace*sizeof(CT));
-					out += countReplace;
-				}
+			sl_size start = 0;
+			for (sl_size i = 0; i < nMatches; i++) {
+				sl_size index = matches.get(i);
+				Base::copyMemory(out, buf + start, (index - start) * sizeof(CT));
+				out += index - start;
+				Base::copyMemory(out, bufReplace, countReplace * sizeof(CT));
+				out += countReplace;
+				start = index + countPat;
 			}
+			Base::copyMemory(out, buf + start, (count - start) * sizeof(CT));
 		}
 		return ret;
 	}
 
 	String String::replaceAll(const String& pattern, const String& replacement) const
 	{
-		return _String_replaceAll<String, sl_char8>(*this, pattern.getData(), pattern.getLength(), replacement.getData(), replacement.getLength());
+		return _String_replaceAll<String, sl_char8, _TemplateFunc8>(*this, pattern.getData(), pattern.getLength(), replacement.getData(), replacement.getLength());
 	}
 
 	String16 String16::replaceAll(const String16& pattern, const String16& replacement) const
 	{
-		return _String_replaceAll<String16, sl_char16>(*this, pattern.getData(), pattern.getLength(), replacement.getData(), replacement.getLength());
+		return _String_replaceAll<String16, sl_char16, _TemplateFunc16>(*this, pattern.getData(), pattern.getLength(), replacement.getData(), replacement.getLength());
 	}
 
 	String Atomic<String>::replaceAll(const String& pattern, const String& replacement) const
@@ -5292,12 +5421,12 @@ namespace slib
 
 	String String::replaceAll(const String& pattern, const sl_char8* replacement) const
 	{
-		return _String_replaceAll<String, sl_char8>(*this, pattern.getData(), pattern.getLength(), replacement, Base::getStringLength(replacement));
+		return _String_replaceAll<String, sl_char8, _TemplateFunc8>(*this, pattern.getData(), pattern.getLength(), replacement, Base::getStringLength(replacement));
 	}
 
 	String16 String16::replaceAll(const String16& pattern, const sl_char16* replacement) const
 	{
-		return _String_replaceAll<String16, sl_char16>(*this, pattern.getData(), pattern.getLength(), replacement, Base::getStringLength2(replacement));
+		return _String_replaceAll<String16, sl_char16, _TemplateFunc16>(*this, pattern.getData(), pattern.getLength(), replacement, Base::getStringLength2(replacement));
 	}
 
 	String Atomic<String>::replaceAll(const String& pattern, const sl_char8* replacement) const
@@ -5314,12 +5443,12 @@ namespace slib
 
 	String String::replaceAll(const sl_char8* pattern, const String& replacement) const
 	{
-		return _String_replaceAll<String, sl_char8>(*this, pattern, Base::getStringLength(pattern), replacement.getData(), replacement.getLength());
+		return _String_replaceAll<String, sl_char8, _TemplateFunc8>(*this, pattern, Base::getStringLength(pattern), replacement.getData(), replacement.getLength());
 	}
 
 	String16 String16::replaceAll(const sl_char16* pattern, const String16& replacement) const
 	{
-		return _String_replaceAll<String16, sl_char16>(*this, pattern, Base::getStringLength2(pattern), replacement.getData(), replacement.getLength());
+		return _String_replaceAll<String16, sl_char16, _TemplateFunc16>(*this, pattern, Base::getStringLength2(pattern), replacement.getData(), replacement.getLength());
 	}
 
 	String Atomic<String>::replaceAll(const sl_char8* pattern, const String& replacement) const
@@ -5336,12 +5465,12 @@ namespace slib
 
 	String String::replaceAll(const sl_char8* pattern, const sl_char8* replacement) const
 	{
-		return _String_replaceAll<String, sl_char8>(*this, pattern, Base::getStringLength(pattern), replacement, Base::getStringLength(replacement));
+		return _String_replaceAll<String, sl_char8, _TemplateFunc8>(*this, pattern, Base::getStringLength(pattern), replacement, Base::getStringLength(replacement));
 	}
 
 	String16 String16::replaceAll(const sl_char16* pattern, const sl_char16* replacement) const
 	{
-		return _String_replaceAll<String16, sl_char16>(*this, pattern, Base::getStringLength2(pattern), replacement, Base::getStringLength2(replacement));
+		return _String_replaceAll<String16, sl_char16, _TemplateFunc16>(*this, pattern, Base::getStringLength2(pattern), replacement, Base::getStringLength2(replacement));
 	}
 
 	String Atomic<String>::replaceAll(const sl_char8* pattern, const sl_char8* replacement) const
@@ -5494,13 +5623,19 @@ namespace slib
 		}
 		CList<ST>* ret = CList<ST>::create();
 		if (ret) {
-			sl_reg start = 0;
+			const CT* buf = str.getData();
+			sl_size count = str.getLength();
+			sl_size start = 0;
 			while (1) {
-				sl_reg index = _String_indexOf<ST, CT, TT>(str, pattern, countPattern, start);
-				if (index < 0) {
+				const CT* pt = sl_null;
+				if (start + countPattern <= count) {
+					pt = (const CT*)(TT::findMemory(buf + start, count - start, pattern, countPattern));
+				}
+				if (!pt) {
 					ret->add_NoLock(str.substring(start));
 					break;
 				}
+				sl_size index = (sl_size)(pt - buf);
 				ret->add_NoLock(str.substring(start, index));
 				start = index + countPattern;
 			}
@@ -113,11 +113,30 @@ namespace slib
 		}
 	}
 
+	sl_uint64 System::getTickCount64()
+	{
+		struct timeval tv;
+		if (gettimeofday(&tv, 0) == 0) {
+			return (sl_uint64)(tv.tv_sec) * 1000 + tv.tv_usec / 1000;
+		} else {
+			return 0;
+		}
+	}
+
 	sl_uint32 System::getProcessId()
 	{
 		return getpid();
 	}
 
+	sl_uint32 System::getProcessorsCount()
+	{
+		long n = sysconf(_SC_NPROCESSORS_ONLN);
+		if (n > 0) {
+			return (sl_uint32)n;
+		}
+		return 1;
+	}
+
 	sl_uint32 System::getThreadId()
 	{
 #if defined(SLIB_PLATFORM_IS_APPLE)
@@ -88,11 +88,37 @@ namespace slib
 #endif
 	}
 
+	sl_uint64 System::getTickCount64()
+	{
+#if defined(SLIB_PLATFORM_IS_WIN32)
+		// GetTickCount64() is not available before Vista
+		LARGE_INTEGER freq, count;
+		if (::QueryPerformanceFrequency(&freq) && ::QueryPerformanceCounter(&count) && freq.QuadPart > 0) {
+			sl_uint64 f = (sl_uint64)(freq.QuadPart);
+			sl_uint64 c = (sl_uint64)(count.QuadPart);
+			return c / f * 1000 + c % f * 1000 / f;
+		}
+		return ::GetTickCount();
+#else
+		return (sl_uint64)(::GetTickCount64());
+#endif
+	}
+
 	sl_uint32 System::getProcessId()
 	{
 		return ::GetCurrentProcessId();
 	}
 
+	sl_uint32 System::getProcessorsCount()
+	{
+		SYSTEM_INFO si;
+		::GetSystemInfo(&si);
+		if (si.dwNumberOfProcessors > 0) {
+			return si.dwNumberOfProcessors;
+		}
+		return 1;
+	}
+
 	sl_uint32 System::getThreadId()
 	{
 		return ::GetCurrentThreadId();
@@ -127,6 +127,12 @@ namespace slib
 		}
 	}
 
+	sl_bool Thread::setCurrentThreadAffinity(sl_uint32 indexProcessor)
+	{
+		// Darwin does not support binding threads to processors
+		return sl_false;
+	}
+
 }
 
 #endif
@@ -10,20 +10,260 @@
 
 #include "slib/core/thread_pool.h"
 
+#include "slib/core/system.h"
+#include "slib/core/time.h"
+#include "slib/core/timer_wheel.h"
+
+#define _SLIB_THREAD_POOL_STEALING_QUEUE_SIZE 4096
+#define _SLIB_THREAD_POOL_PARK_TIMEOUT 5000
+
 namespace slib
 {
 
+	/*
+		Chase-Lev deque with fixed capacity.
+		Only the owner worker calls `push` and `pop` (bottom side), other workers call `steal` (top side).
+	*/
+	class _ThreadPoolStealingQueue
+	{
+	public:
+		_ThreadPoolStealingQueue()
+		{
+			m_top = 0;
+			m_bottom = 0;
+			Base::zeroMemory(m_tasks, sizeof(m_tasks));
+		}
+
+		~_ThreadPoolStealingQueue()
+		{
+			for (sl_reg i = m_top; i < m_bottom; i++) {
+				Callable<void()>* task = m_tasks[i & (_SLIB_THREAD_POOL_STEALING_QUEUE_SIZE - 1)];
+				if (task) {
+					task->decreaseReference();
+				}
+			}
+		}
+
+	public:
+		sl_bool push(const Function<void()>& task)
+		{
+			sl_reg b = m_bottom;
+			sl_reg t = Base::interlockedAdd(&m_top, 0);
+			if (b - t >= _SLIB_THREAD_POOL_STEALING_QUEUE_SIZE) {
+				return sl_false;
+			}
+			Callable<void()>* callable = task.ref.get();
+			callable->increaseReference();
+			m_tasks[b & (_SLIB_THREAD_POOL_STEALING_QUEUE_SIZE - 1)] = callable;
+			// full barrier: the slot must be visible before the new bottom
+			Base::interlockedIncrement(&m_bottom);
+			return sl_true;
+		}
+
+		sl_bool pop(Function<void()>* _out)
+		{
+			sl_reg b = Base::interlockedDecrement(&m_bottom);
+			sl_reg t = Base::interlockedAdd(&m_top, 0);
+			if (t > b) {
+				m_bottom = b + 1;
+				return sl_false;
+			}
+			Callable<void()>* callable = m_tasks[b & (_SLIB_THREAD_POOL_STEALING_QUEUE_SIZE - 1)];
+			if (t == b) {
+				// last element: race against the thieves
+				sl_bool flagWin = Base::interlockedCompareExchange(&m_top, t + 1, t);
+				m_bottom = t + 1;
+				if (!flagWin) {
+					return sl_false;
+				}
+			}
+			_take(callable, _out);
+			return sl_true;
+		}
+
+		sl_bool steal(Function<void()>* _out)
+		{
+			for (;;) {
+				sl_reg t = Base::interlockedAdd(&m_top, 0);
+				sl_reg b = Base::interlockedAdd(&m_bottom, 0);
+				if (t >= b) {
+					return sl_false;
+				}
+				Callable<void()>* callable = m_tasks[t & (_SLIB_THREAD_POOL_STEALING_QUEUE_SIZE - 1)];
+				if (Base::interlockedCompareExchange(&m_top, t + 1, t)) {
+					_take(callable, _out);
+					return sl_true;
+				}
+			}
+		}
+
+	private:
+		static void _take(Callable<void()>* callable, Function<void()>* _out)
+		{
+			_out->ref = callable;
+			callable->decreaseReference();
+		}
+
+	private:
+		Callable<void()>* m_tasks[_SLIB_THREAD_POOL_STEALING_QUEUE_SIZE];
+		sl_reg m_top;
+		sl_reg m_bottom;
+
+	};
+
+	class _ThreadPoolStealingWorker
+	{
+	public:
+		ThreadPool* pool;
+		Ref<Thread> thread;
+		_ThreadPoolStealingQueue local;
+		LinkedQueue< Function<void()> > inbox;
+		Ref<Event> eventPark;
+		sl_int32 flagParked;
+		sl_uint32 seed;
+
+	public:
+		_ThreadPoolStealingWorker(ThreadPool* _pool, sl_uint32 index): pool(_pool), eventPark(Event::create()), flagParked(0), seed(index * 2654435761u + 1)
+		{
+		}
+
+	public:
+		sl_uint32 random()
+		{
+			// xorshift32
+			sl_uint32 x = seed;
+			x ^= x << 13;
+			x ^= x >> 17;
+			x ^= x << 5;
+			seed = x;
+			return x;
+		}
+
+	};
+
+	SLIB_THREAD _ThreadPoolStealingWorker* _gt_threadPoolStealingWorkerCurrent = sl_null;
+
+	/*
+		Runs the delayed tasks on the timer wheel, and hands the expired tasks to the pool.
+		Ticks are milliseconds elapsed since the timer is created.
+	*/
+	class _ThreadPoolTimer
+	{
+	public:
+		_ThreadPoolTimer(ThreadPool* pool): m_pool(pool), m_event(Event::create())
+		{
+			m_tickWake = SLIB_UINT64_MAX;
+			m_flagRunning = sl_true;
+		}
+
+		~_ThreadPoolTimer()
+		{
+			release();
+		}
+
+	public:
+		sl_bool start()
+		{
+			m_thread = Thread::start(SLIB_FUNCTION_CLASS(_ThreadPoolTimer, run, this));
+			return m_thread.isNotNull();
+		}
+
+		void release()
+		{
+			m_flagRunning = sl_false;
+			if (m_thread.isNotNull()) {
+				m_thread->finish();
+				m_event->set();
+				m_thread->finishAndWait();
+				m_thread.setNull();
+			}
+			MutexLocker lock(&m_lock);
+			m_wheel.removeAll();
+		}
+
+		sl_bool add(const Function<void()>& task, sl_uint64 delay_ms)
+		{
+			MutexLocker lock(&m_lock);
+			if (!m_flagRunning) {
+				return sl_false;
+			}
+			// the elapsed time is truncated to milliseconds, so one more tick keeps the delay as a minimum
+			sl_uint64 tick = m_timeCounter.getElapsedMilliseconds() + delay_ms + 1;
+			if (!(m_wheel.add(tick, task))) {
+				return sl_false;
+			}
+			if (tick < m_tickWake) {
+				m_tickWake = tick;
+				m_event->set();
+			}
+			return sl_true;
+		}
+
+		void run()
+		{
+			while (m_flagRunning && Thread::isNotStoppingCurrent()) {
+				List< Function<void()> > expired;
+				sl_int32 timeout = -1;
+				{
+					MutexLocker lock(&m_lock);
+					sl_uint64 now = m_timeCounter.getElapsedMilliseconds();
+					m_wheel.advance(now, expired);
+					m_tickWake = m_wheel.getNextTick();
+					if (m_tickWake != SLIB_UINT64_MAX) {
+						sl_uint64 t = m_tickWake - now;
+						timeout = t < 0x7FFFFFFF ? (sl_int32)t : 0x7FFFFFFF;
+					}
+				}
+				ListElements< Function<void()> > tasks(expired);
+				for (sl_size i = 0; i < tasks.count; i++) {
+					m_pool->addTask(tasks[i]);
+				}
+				m_event->wait(timeout);
+			}
+		}
+
+	private:
+		ThreadPool* m_pool;
+		Ref<Thread> m_thread;
+		Ref<Event> m_event;
+		sl_bool m_flagRunning;
+
+		Mutex m_lock;
+		TimeCounter m_timeCounter;
+		TimerWheel< Function<void()> > m_wheel;
+		sl_uint64 m_tickWake;
+
+	};
+
+
 	SLIB_DEFINE_OBJECT(ThreadPool, Dispatcher)
 
 	ThreadPool::ThreadPool()
 	{
 		setThreadStackSize(SLIB_THREAD_DEFAULT_STACK_SIZE);
 		m_flagRunning = sl_true;
+
+		m_flagWorkStealing = sl_false;
+		m_stealingWorkers = sl_null;
+		m_nStealingWorkers = 0;
+		m_nParkedWorkers = 0;
+		m_indexNextInbox = 0;
+
+		m_timer = sl_null;
 	}
 
 	ThreadPool::~ThreadPool()
 	{
 		release();
+		if (m_stealingWorkers) {
+			for (sl_uint32 i = 0; i < m_nStealingWorkers; i++) {
+				delete m_stealingWorkers[i];
+			}
+			delete[] m_stealingWorkers;
+		}
+		if (m_timer) {
+			delete m_timer;
+		}
 	}
 
 	Ref<ThreadPool> ThreadPool::create(sl_uint32 minThreads, sl_uint32 maxThreads)
@@ -36,6 +276,43 @@ namespace slib
 		return ret;
 	}
 
+	Ref<ThreadPool> ThreadPool::createWorkStealing(sl_uint32 nWorkers)
+	{
+		if (nWorkers == 0) {
+			nWorkers = System::getProcessorsCount();
+		}
+		Ref<ThreadPool> ret = new ThreadPool();
+		if (ret.isNull()) {
+			return sl_null;
+		}
+		ret->setMinimumThreadsCount(nWorkers);
+		ret->setMaximumThreadsCount(nWorkers);
+		ret->m_flagWorkStealing = sl_true;
+		ret->m_stealingWorkers = new _ThreadPoolStealingWorker*[nWorkers];
+		if (!(ret->m_stealingWorkers)) {
+			return sl_null;
+		}
+		sl_uint32 i;
+		for (i = 0; i < nWorkers; i++) {
+			ret->m_stealingWorkers[i] = new _ThreadPoolStealingWorker(ret.get(), i);
+			if (!(ret->m_stealingWorkers[i]) || ret->m_stealingWorkers[i]->eventPark.isNull()) {
+				ret->m_nStealingWorkers = i + 1;
+				return sl_null;
+			}
+		}
+		ret->m_nStealingWorkers = nWorkers;
+		// all workers must exist before any of them starts stealing
+		for (i = 0; i < nWorkers; i++) {
+			_ThreadPoolStealingWorker* worker = ret->m_stealingWorkers[i];
+			worker->thread = Thread::start(Function<void()>::bindClass(ret.get(), &ThreadPool::onRunStealingWorker, worker), ret->getThreadStackSize());
+			if (worker->thread.isNull()) {
+				ret->release();
+				return sl_null;
+			}
+		}
+		return ret;
+	}
+
 	void ThreadPool::release()
 	{
 		ObjectLocker lock(this);
@@ -43,6 +320,30 @@ namespace slib
 			return;
 		}
 		m_flagRunning = sl_false;
+		lock.unlock();
+		
+		// the timer thread and the workers may be waiting for the object lock in `addTask`
+		if (m_timer) {
+			m_timer->release();
+		}
+		
+		if (m_flagWorkStealing) {
+			sl_uint32 i;
+			for (i = 0; i < m_nStealingWorkers; i++) {
+				_ThreadPoolStealingWorker* worker = m_stealingWorkers[i];
+				if (worker && worker->thread.isNotNull()) {
+					worker->thread->finish();
+					worker->eventPark->set();
+				}
+			}
+			for (i = 0; i < m_nStealingWorkers; i++) {
+				_ThreadPoolStealingWorker* worker = m_stealingWorkers[i];
+				if (worker && worker->thread.isNotNull()) {
+					worker->thread->finishAndWait();
+				}
+			}
+			return;
+		}
 		
 		ListElements< Ref<Thread> > threads(m_threadWorkers);
 		sl_size i;
@@ -61,14 +362,25 @@ namespace slib
 
 	sl_uint32 ThreadPool::getThreadsCount()
 	{
+		if (m_flagWorkStealing) {
+			return m_nStealingWorkers;
+		}
 		return (sl_uint32)(m_threadWorkers.getCount());
 	}
 
+	sl_bool ThreadPool::isWorkStealing()
+	{
+		return m_flagWorkStealing;
+	}
+
 	sl_bool ThreadPool::addTask(const Function<void()>& task)
 	{
 		if (task.isNull()) {
 			return sl_false;
 		}
+		if (m_flagWorkStealing) {
+			return _addTask_Stealing(task);
+		}
 		ObjectLocker lock(this);
 		if (!m_flagRunning) {
 			return sl_false;
@@ -104,7 +416,30 @@ namespace slib
 
 	sl_bool ThreadPool::dispatch(const Function<void()>& callback, sl_uint64 delay_ms)
 	{
-		return addTask(callback);
+		if (delay_ms == 0) {
+			return addTask(callback);
+		}
+		if (callback.isNull()) {
+			return sl_false;
+		}
+		if (!m_timer) {
+			ObjectLocker lock(this);
+			if (!m_flagRunning) {
+				return sl_false;
+			}
+			if (!m_timer) {
+				_ThreadPoolTimer* timer = new _ThreadPoolTimer(this);
+				if (!timer) {
+					return sl_false;
+				}
+				if (!(timer->start())) {
+					delete timer;
+					return sl_false;
+				}
+				m_timer = timer;
+			}
+		}
+		return m_timer->add(callback, delay_ms);
 	}
 
 	void ThreadPool::onRunWorker()
@@ -127,4 +462,96 @@ namespace slib
 		}
 	}
 
+	sl_bool ThreadPool::_addTask_Stealing(const Function<void()>& task)
+	{
+		if (!m_flagRunning) {
+			return sl_false;
+		}
+		_ThreadPoolStealingWorker* worker = _gt_threadPoolStealingWorkerCurrent;
+		if (worker && worker->pool == this) {
+			// submitted by our own worker: LIFO push on its deque, no lock at all
+			if (!(worker->local.push(task))) {
+				if (!(worker->inbox.push(task))) {
+					return sl_false;
+				}
+			}
+		} else {
+			// spread the external submitters over the inboxes to avoid a single contended queue
+			sl_uint32 index = ((sl_uint32)(Base::interlockedIncrement32(&m_indexNextInbox))) % m_nStealingWorkers;
+			if (!(m_stealingWorkers[index]->inbox.push(task))) {
+				return sl_false;
+			}
+		}
+		_wakeWorker_Stealing();
+		return sl_true;
+	}
+
+	sl_bool ThreadPool::_findTask_Stealing(_ThreadPoolStealingWorker* worker, Function<void()>* _out)
+	{
+		if (worker->local.pop(_out)) {
+			return sl_true;
+		}
+		if (worker->inbox.pop(_out)) {
+			return sl_true;
+		}
+		sl_uint32 n = m_nStealingWorkers;
+		sl_uint32 start = worker->random();
+		for (sl_uint32 i = 0; i < n; i++) {
+			_ThreadPoolStealingWorker* victim = m_stealingWorkers[(start + i) % n];
+			if (victim != worker) {
+				if (victim->local.steal(_out)) {
+					return sl_true;
+				}
+				if (victim->inbox.pop(_out)) {
+					return sl_true;
+				}
+			}
+		}
+		return sl_false;
+	}
+
+	void ThreadPool::_wakeWorker_Stealing()
+	{
+		// full barrier: the pushed task must be visible before checking the parked workers
+		if (Base::interlockedAdd32(&m_nParkedWorkers, 0) <= 0) {
+			return;
+		}
+		sl_uint32 n = m_nStealingWorkers;
+		sl_uint32 start = (sl_uint32)(Base::interlockedIncrement32(&m_indexNextInbox));
+		for (sl_uint32 i = 0; i < n; i++) {
+			_ThreadPoolStealingWorker* worker = m_stealingWorkers[(start + i) % n];
+			if (Base::interlockedCompareExchange32(&(worker->flagParked), 0, 1)) {
+				Base::interlockedDecrement32(&m_nParkedWorkers);
+				worker->eventPark->set();
+				return;
+			}
+		}
+	}
+
+	void ThreadPool::onRunStealingWorker(_ThreadPoolStealingWorker* worker)
+	{
+		_gt_threadPoolStealingWorkerCurrent = worker;
+		while (m_flagRunning && Thread::isNotStoppingCurrent()) {
+			Function<void()> task;
+			if (_findTask_Stealing(worker, &task)) {
+				task();
+				continue;
+			}
+			// park: announce first, then check again so that a concurrent submitter cannot miss us
+			worker->flagParked = 1;
+			Base::interlockedIncrement32(&m_nParkedWorkers);
+			sl_bool flagFound = _findTask_Stealing(worker, &task);
+			if (!flagFound) {
+				worker->eventPark->wait(_SLIB_THREAD_POOL_PARK_TIMEOUT);
+			}
+			if (Base::interlockedCompareExchange32(&(worker->flagParked), 0, 1)) {
+				Base::interlockedDecrement32(&m_nParkedWorkers);
+			}
+			if (flagFound) {
+				task();
+			}
+		}
+		_gt_threadPoolStealingWorkerCurrent = sl_null;
+	}
+
 }
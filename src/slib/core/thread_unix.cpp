@@ -13,6 +13,7 @@
 #if defined(SLIB_PLATFORM_IS_UNIX) && !defined(SLIB_PLATFORM_IS_APPLE)
 
 #include <pthread.h>
+#include <sched.h>
 #include <time.h>
 
 #include "slib/core/thread.h"
@@ -78,6 +79,18 @@ namespace slib
 	{
 	}
 
+	sl_bool Thread::setCurrentThreadAffinity(sl_uint32 indexProcessor)
+	{
+#if defined(SLIB_PLATFORM_IS_LINUX) && defined(CPU_SET)
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		CPU_SET(indexProcessor, &set);
+		return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+		return sl_false;
+#endif
+	}
+
 #define _UNIX_SCHED_POLICY SCHED_FIFO
 	static int _thread_getUnixPriority(ThreadPriority priority)
 	{
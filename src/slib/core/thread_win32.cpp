@@ -83,6 +83,14 @@ namespace slib
 		}
 	}
 
+	sl_bool Thread::setCurrentThreadAffinity(sl_uint32 indexProcessor)
+	{
+		if (indexProcessor >= sizeof(DWORD_PTR) * 8) {
+			return sl_false;
+		}
+		return SetThreadAffinityMask(GetCurrentThread(), ((DWORD_PTR)1) << indexProcessor) != 0;
+	}
+
 	void Thread::_nativeClose()
 	{
 		if (m_handle) {
@@ -2353,6 +2353,20 @@ namespace slib
 
 	Ref<XmlDocument> Xml::parseXmlFromTextFile(const String& filePath, XmlParseParam& param)
 	{
+		// UTF-8 text is parsed in the mapped file, without reading and converting to UTF-16
+		Memory mem = File::mapAllBytes(filePath);
+		if (mem.isNotNull()) {
+			const sl_char8* sz = (const sl_char8*)(mem.getData());
+			sl_size len = mem.getSize();
+			sl_bool flagUTF16 = len % 2 == 0 && ((sz[0] == (sl_char8)0xFF && sz[1] == (sl_char8)0xFE) || (sz[0] == (sl_char8)0xFE && sz[1] == (sl_char8)0xFF));
+			if (!flagUTF16) {
+				if (len >= 3 && sz[0] == (sl_char8)0xEF && sz[1] == (sl_char8)0xBB && sz[2] == (sl_char8)0xBF) {
+					sz += 3;
+					len -= 3;
+				}
+				return _private_Xml_Parser<String, sl_char8, StringBuffer>::parseXml(filePath, sz, len, param);
+			}
+		}
 		String16 xml = File::readAllText16(filePath);
 		return _private_Xml_Parser<String16, sl_char16, StringBuffer16>::parseXml(filePath, xml.getData(), xml.getLength(), param);
 	}
@@ -2360,8 +2374,7 @@ namespace slib
 	Ref<XmlDocument> Xml::parseXmlFromTextFile(const String& filePath)
 	{
 		XmlParseParam param;
-		String16 xml = File::readAllText16(filePath);
-		return _private_Xml_Parser<String16, sl_char16, StringBuffer16>::parseXml(filePath, xml.getData(), xml.getLength(), param);
+		return parseXmlFromTextFile(filePath, param);
 	}
 
 	
@@ -17,6 +17,8 @@ namespace slib
 
 	Database::Database()
 	{
+		m_flagInTransaction = sl_false;
+		m_nStatementCacheSize = 32;
 	}
 
 	Database::~Database()
@@ -112,4 +114,154 @@ namespace slib
 		return sl_null;
 	}
 
+	sl_bool Database::beginTransaction()
+	{
+		ObjectLocker lock(this);
+		if (m_flagInTransaction) {
+			return sl_false;
+		}
+		if (execute("BEGIN") >= 0) {
+			m_flagInTransaction = sl_true;
+			return sl_true;
+		}
+		return sl_false;
+	}
+
+	sl_bool Database::commit()
+	{
+		ObjectLocker lock(this);
+		if (!m_flagInTransaction) {
+			return sl_false;
+		}
+		if (execute("COMMIT") >= 0) {
+			m_flagInTransaction = sl_false;
+			return sl_true;
+		}
+		return sl_false;
+	}
+
+	sl_bool Database::rollback()
+	{
+		ObjectLocker lock(this);
+		if (!m_flagInTransaction) {
+			return sl_false;
+		}
+		m_flagInTransaction = sl_false;
+		return execute("ROLLBACK") >= 0;
+	}
+
+	sl_bool Database::isInTransaction()
+	{
+		return m_flagInTransaction;
+	}
+
+	sl_int64 Database::executeMany(const String& sql, const List< List<Variant> >& rows)
+	{
+		ListLocker< List<Variant> > list(rows);
+		if (!(list.count)) {
+			return 0;
+		}
+		// other threads must not run their statements inside of this transaction
+		ObjectLocker lock(this);
+		Ref<DatabaseStatement> statement = prepareStatement(sql);
+		if (statement.isNull()) {
+			return -1;
+		}
+		sl_bool flagTransaction = sl_false;
+		if (!m_flagInTransaction) {
+			if (!(beginTransaction())) {
+				return -1;
+			}
+			flagTransaction = sl_true;
+		}
+		sl_int64 total = 0;
+		for (sl_size i = 0; i < list.count; i++) {
+			ListLocker<Variant> params(list[i]);
+			sl_int64 n = statement->executeBy(params.data, (sl_uint32)(params.count));
+			if (n < 0) {
+				if (flagTransaction) {
+					rollback();
+				}
+				return -1;
+			}
+			total += n;
+		}
+		if (flagTransaction) {
+			if (!(commit())) {
+				rollback();
+				return -1;
+			}
+		}
+		return total;
+	}
+
+	sl_uint32 Database::getStatementCacheSize()
+	{
+		return m_nStatementCacheSize;
+	}
+
+	void Database::setStatementCacheSize(sl_uint32 size)
+	{
+		ObjectLocker lock(this);
+		m_nStatementCacheSize = size;
+		while (m_listCachedStatements.getCount() > size) {
+			CachedStatement item;
+			if (m_listCachedStatements.popBack_NoLock(&item)) {
+				m_mapCachedStatements.remove(item.sql);
+				_freeCachedStatement(item.statement);
+			}
+		}
+	}
+
+	void Database::clearStatementCache()
+	{
+		ObjectLocker lock(this);
+		CachedStatement item;
+		while (m_listCachedStatements.popBack_NoLock(&item)) {
+			_freeCachedStatement(item.statement);
+		}
+		m_mapCachedStatements.removeAll();
+	}
+
+	void* Database::_takeCachedStatement(const String& sql)
+	{
+		ObjectLocker lock(this);
+		Link<CachedStatement>* link;
+		if (m_mapCachedStatements.remove(sql, &link)) {
+			void* statement = link->value.statement;
+			m_listCachedStatements.removeItem_NoLock(link);
+			return statement;
+		}
+		return sl_null;
+	}
+
+	void Database::_returnCachedStatement(const String& sql, void* statement)
+	{
+		ObjectLocker lock(this);
+		if (!m_nStatementCacheSize || m_mapCachedStatements.search(sql)) {
+			// the same SQL was prepared again while this statement was in use
+			_freeCachedStatement(statement);
+			return;
+		}
+		CachedStatement item;
+		item.sql = sql;
+		item.statement = statement;
+		Link<CachedStatement>* link = m_listCachedStatements.pushFront_NoLock(item);
+		if (!link) {
+			_freeCachedStatement(statement);
+			return;
+		}
+		m_mapCachedStatements.put(sql, link);
+		if (m_listCachedStatements.getCount() > m_nStatementCacheSize) {
+			if (m_listCachedStatements.popBack_NoLock(&item)) {
+				m_mapCachedStatements.remove(item.sql);
+				_freeCachedStatement(item.statement);
+			}
+		}
+	}
+
+	void Database::_freeCachedStatement(void* statement)
+	{
+	}
+
 }
@@ -13,6 +13,21 @@
 namespace slib
 {
 
+	enum _DatabaseColumnBindingType
+	{
+		_DatabaseColumnBinding_Int32,
+		_DatabaseColumnBinding_Uint32,
+		_DatabaseColumnBinding_Int64,
+		_DatabaseColumnBinding_Uint64,
+		_DatabaseColumnBinding_Float,
+		_DatabaseColumnBinding_Double,
+		_DatabaseColumnBinding_Boolean,
+		_DatabaseColumnBinding_String,
+		_DatabaseColumnBinding_Time,
+		_DatabaseColumnBinding_Memory,
+		_DatabaseColumnBinding_Variant
+	};
+
 	SLIB_DEFINE_OBJECT(DatabaseCursor, Object)
 
 	DatabaseCursor::DatabaseCursor()
@@ -172,4 +187,140 @@ namespace slib
 		return sl_null;
 	}
 
+	void DatabaseCursor::bindColumn(sl_uint32 index, sl_int32* out)
+	{
+		_bindColumn(index, _DatabaseColumnBinding_Int32, out);
+	}
+
+	void DatabaseCursor::bindColumn(sl_uint32 index, sl_uint32* out)
+	{
+		_bindColumn(index, _DatabaseColumnBinding_Uint32, out);
+	}
+
+	void DatabaseCursor::bindColumn(sl_uint32 index, sl_int64* out)
+	{
+		_bindColumn(index, _DatabaseColumnBinding_Int64, out);
+	}
+
+	void DatabaseCursor::bindColumn(sl_uint32 index, sl_uint64* out)
+	{
+		_bindColumn(index, _DatabaseColumnBinding_Uint64, out);
+	}
+
+	void DatabaseCursor::bindColumn(sl_uint32 index, float* out)
+	{
+		_bindColumn(index, _DatabaseColumnBinding_Float, out);
+	}
+
+	void DatabaseCursor::bindColumn(sl_uint32 index, double* out)
+	{
+		_bindColumn(index, _DatabaseColumnBinding_Double, out);
+	}
+
+	void DatabaseCursor::bindColumn(sl_uint32 index, sl_bool* out)
+	{
+		_bindColumn(index, _DatabaseColumnBinding_Boolean, out);
+	}
+
+	void DatabaseCursor::bindColumn(sl_uint32 index, String* out)
+	{
+		_bindColumn(index, _DatabaseColumnBinding_String, out);
+	}
+
+	void DatabaseCursor::bindColumn(sl_uint32 index, Time* out)
+	{
+		_bindColumn(index, _DatabaseColumnBinding_Time, out);
+	}
+
+	void DatabaseCursor::bindColumn(sl_uint32 index, Memory* out)
+	{
+		_bindColumn(index, _DatabaseColumnBinding_Memory, out);
+	}
+
+	void DatabaseCursor::bindColumn(sl_uint32 index, Variant* out)
+	{
+		_bindColumn(index, _DatabaseColumnBinding_Variant, out);
+	}
+
+	void DatabaseCursor::unbindColumns()
+	{
+		m_listBindings.setNull();
+	}
+
+	sl_bool DatabaseCursor::fetch()
+	{
+		if (moveNext()) {
+			_storeBoundColumns(0);
+			return sl_true;
+		}
+		return sl_false;
+	}
+
+	sl_uint32 DatabaseCursor::fetchBlock(sl_uint32 n)
+	{
+		for (sl_uint32 i = 0; i < n; i++) {
+			if (!(moveNext())) {
+				return i;
+			}
+			_storeBoundColumns(i);
+		}
+		return n;
+	}
+
+	void DatabaseCursor::_bindColumn(sl_uint32 index, sl_uint32 type, void* out)
+	{
+		if (!out) {
+			return;
+		}
+		ColumnBinding binding;
+		binding.index = index;
+		binding.type = type;
+		binding.out = out;
+		m_listBindings.add_NoLock(binding);
+	}
+
+	void DatabaseCursor::_storeBoundColumns(sl_uint32 row)
+	{
+		ListElements<ColumnBinding> bindings(m_listBindings);
+		for (sl_size i = 0; i < bindings.count; i++) {
+			ColumnBinding& binding = bindings[i];
+			sl_uint32 index = binding.index;
+			switch (binding.type) {
+			case _DatabaseColumnBinding_Int32:
+				((sl_int32*)(binding.out))[row] = getInt32(index);
+				break;
+			case _DatabaseColumnBinding_Uint32:
+				((sl_uint32*)(binding.out))[row] = getUint32(index);
+				break;
+			case _DatabaseColumnBinding_Int64:
+				((sl_int64*)(binding.out))[row] = getInt64(index);
+				break;
+			case _DatabaseColumnBinding_Uint64:
+				((sl_uint64*)(binding.out))[row] = getUint64(index);
+				break;
+			case _DatabaseColumnBinding_Float:
+				((float*)(binding.out))[row] = getFloat(index);
+				break;
+			case _DatabaseColumnBinding_Double:
+				((double*)(binding.out))[row] = getDouble(index);
+				break;
+			case _DatabaseColumnBinding_Boolean:
+				((sl_bool*)(binding.out))[row] = getInt64(index) != 0;
+				break;
+			case _DatabaseColumnBinding_String:
+				((String*)(binding.out))[row] = getString(index);
+				break;
+			case _DatabaseColumnBinding_Time:
+				((Time*)(binding.out))[row] = getTime(index);
+				break;
+			case _DatabaseColumnBinding_Memory:
+				((Memory*)(binding.out))[row] = getBlob(index);
+				break;
+			case _DatabaseColumnBinding_Variant:
+				((Variant*)(binding.out))[row] = getValue(index);
+				break;
+			}
+		}
+	}
+
 }
@@ -14,6 +14,7 @@
 
 #include "thirdparty/mariadb-connector/mysql.h"
 #include "thirdparty/mariadb-connector/errmsg.h"
+#include "thirdparty/mariadb-connector/mysqld_error.h"
 
 #include "slib/core/thread.h"
 #include "slib/core/scoped.h"
@@ -110,6 +111,7 @@ namespace slib
 
 		~_MySQL_Database()
 		{
+			clearStatementCache();
 			::mysql_close(m_mysql);
 		}
 
@@ -287,6 +289,75 @@ namespace slib
 				return sl_null;
 			}
 
+			// parses the numeric column in place, without creating the string
+			template <class T>
+			T _parseNumber(sl_uint32 index, T defaultValue, sl_reg (*parse)(sl_int32 radix, T* value, const sl_char8* str, sl_size posBegin, sl_size posEnd))
+			{
+				if (m_row && index < m_nColumnNames) {
+					const sl_char8* str = m_row[index];
+					sl_size len = (sl_size)(m_lengths[index]);
+					if (str && len) {
+						T value;
+						if (parse(10, &value, str, 0, len) == (sl_reg)len) {
+							return value;
+						}
+					}
+				}
+				return defaultValue;
+			}
+
+			template <class T>
+			T _parseReal(sl_uint32 index, T defaultValue, sl_reg (*parse)(T* value, const sl_char8* str, sl_size posBegin, sl_size posEnd))
+			{
+				if (m_row && index < m_nColumnNames) {
+					const sl_char8* str = m_row[index];
+					sl_size len = (sl_size)(m_lengths[index]);
+					if (str && len) {
+						T value;
+						if (parse(&value, str, 0, len) == (sl_reg)len) {
+							return value;
+						}
+					}
+				}
+				return defaultValue;
+			}
+
+			// override
+			sl_int64 getInt64(sl_uint32 index, sl_int64 defaultValue)
+			{
+				return _parseNumber<sl_int64>(index, defaultValue, &(String::parseInt64));
+			}
+
+			// override
+			sl_uint64 getUint64(sl_uint32 index, sl_uint64 defaultValue)
+			{
+				return _parseNumber<sl_uint64>(index, defaultValue, &(String::parseUint64));
+			}
+
+			// override
+			sl_int32 getInt32(sl_uint32 index, sl_int32 defaultValue)
+			{
+				return _parseNumber<sl_int32>(index, defaultValue, &(String::parseInt32));
+			}
+
+			// override
+			sl_uint32 getUint32(sl_uint32 index, sl_uint32 defaultValue)
+			{
+				return _parseNumber<sl_uint32>(index, defaultValue, &(String::parseUint32));
+			}
+
+			// override
+			float getFloat(sl_uint32 index, float defaultValue)
+			{
+				return _parseReal<float>(index, defaultValue, &(String::parseFloat));
+			}
+
+			// override
+			double getDouble(sl_uint32 index, double defaultValue)
+			{
+				return _parseReal<double>(index, defaultValue, &(String::parseDouble));
+			}
+
 			// override
 			Memory getBlob(sl_uint32 index)
 			{
@@ -911,7 +982,11 @@ namespace slib
 
 			~_DatabaseStatement()
 			{
-				close();
+				if (m_statement) {
+					::mysql_stmt_free_result(m_statement);
+					((_MySQL_Database*)(m_db.get()))->_returnCachedStatement(m_sql, m_statement);
+					m_statement = sl_null;
+				}
 			}
 
 			sl_bool prepare()
@@ -1048,7 +1123,8 @@ namespace slib
 						return sl_true;
 					} else {
 						int err = ::mysql_stmt_errno(m_statement);
-						if (err == CR_SERVER_LOST || err == CR_SERVER_GONE_ERROR) {
+						// only the errors raised before the statement runs are retried: the connection is lost, or the cached statement is invalidated by reconnection
+						if (err == CR_SERVER_LOST || err == CR_SERVER_GONE_ERROR || err == ER_UNKNOWN_STMT_HANDLER) {
 							if (prepare()) {
 								if (_bind(params, nParams)) {
 									if (0 == ::mysql_stmt_execute(m_statement)) {
@@ -1185,6 +1261,11 @@ namespace slib
 			ObjectLocker lock(this);
 			Ref<_DatabaseStatement> ret = new _DatabaseStatement(this, sql);
 			if (ret.isNotNull()) {
+				MYSQL_STMT* statement = (MYSQL_STMT*)(_takeCachedStatement(sql));
+				if (statement) {
+					ret->m_statement = statement;
+					return ret;
+				}
 				if (ret->prepare()) {
 					return ret;
 				}
@@ -1192,6 +1273,12 @@ namespace slib
 			return sl_null;
 		}
 
+		// override
+		void _freeCachedStatement(void* statement)
+		{
+			::mysql_stmt_close((MYSQL_STMT*)statement);
+		}
+
 		// override
 		String getErrorMessage()
 		{
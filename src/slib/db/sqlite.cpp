@@ -13,6 +13,8 @@
 #include "slib/db/sqlite.h"
 
 #include "slib/core/file.h"
+#include "slib/core/thread.h"
+#include "slib/core/system.h"
 
 namespace slib
 {	
@@ -39,6 +41,7 @@ namespace slib
 
 		~_Sqlite3Database()
 		{
+			clearStatementCache();
 			::sqlite3_close(m_db);
 		}
 
@@ -60,6 +63,34 @@ namespace slib
 			return ret;
 		}
 
+		static Ref<_Sqlite3Database> open(const String& filePath, sl_bool flagCreate, sl_bool flagReader, const SQLiteDatabasePoolParam& param)
+		{
+			int flags = SQLITE_OPEN_READWRITE;
+			if (flagCreate) {
+				flags |= SQLITE_OPEN_CREATE;
+			}
+			sqlite3* db = sl_null;
+			if (SQLITE_OK == ::sqlite3_open_v2(filePath.getData(), &db, flags, sl_null)) {
+				::sqlite3_busy_timeout(db, (int)(param.busyTimeout));
+				String pragmas = String::format("PRAGMA synchronous=NORMAL; PRAGMA temp_store=MEMORY; PRAGMA cache_size=%d; PRAGMA mmap_size=%s;", param.cacheSize, String::fromUint64(param.mmapSize));
+				if (flagReader) {
+					pragmas += "PRAGMA query_only=1;";
+				} else {
+					// WAL mode is persistent in the database file, so that it is set only by the writer
+					pragmas = "PRAGMA journal_mode=WAL;" + pragmas;
+				}
+				if (SQLITE_OK == ::sqlite3_exec(db, pragmas.getData(), 0, 0, sl_null)) {
+					Ref<_Sqlite3Database> ret = new _Sqlite3Database();
+					if (ret.isNotNull()) {
+						ret->m_db = db;
+						return ret;
+					}
+				}
+			}
+			::sqlite3_close(db);
+			return sl_null;
+		}
+
 		// override
 		sl_int64 execute(const String& sql)
 		{
@@ -94,11 +125,14 @@ namespace slib
 			String* m_columnNames;
 			HashMap<String, sl_int32> m_mapColumnIndexes;
 
+			sl_bool m_flagFinished;
+
 			_DatabaseCursor(Database* db, DatabaseStatement* statementObj, sqlite3_stmt* statement)
 			{
 				m_db = db;
 				m_statementObj = statementObj;
 				m_statement = statement;
+				m_flagFinished = sl_false;
 
 				sl_int32 cols = ::sqlite3_column_count(statement);
 				for (sl_int32 i = 0; i < cols; i++) {
@@ -344,10 +378,15 @@ namespace slib
 			// override
 			sl_bool moveNext()
 			{
+				// stepping again after the last row restarts the query
+				if (m_flagFinished) {
+					return sl_false;
+				}
 				sl_int32 nRet = ::sqlite3_step(m_statement);
 				if (nRet == SQLITE_ROW) {
 					return sl_true;
 				}
+				m_flagFinished = sl_true;
 				return sl_false;
 			}
 
@@ -358,18 +397,22 @@ namespace slib
 		public:
 			sqlite3* m_sqlite;
 			sqlite3_stmt* m_statement;
+			String m_sql;
 			Array<Variant> m_boundParams;
 
-			_DatabaseStatement(_Sqlite3Database* db, sqlite3_stmt* statement)
+			_DatabaseStatement(_Sqlite3Database* db, sqlite3_stmt* statement, const String& sql)
 			{
 				m_db = db;
 				m_sqlite = db->m_db;
 				m_statement = statement;
+				m_sql = sql;
 			}
 
 			~_DatabaseStatement()
 			{
-				::sqlite3_finalize(m_statement);
+				::sqlite3_reset(m_statement);
+				::sqlite3_clear_bindings(m_statement);
+				((_Sqlite3Database*)(m_db.get()))->_returnCachedStatement(m_sql, m_statement);
 			}
 
 			sl_bool _execute(const Variant* _params, sl_uint32 nParams)
@@ -394,34 +437,34 @@ namespace slib
 							Variant& var = (params.getData())[i];
 							switch (var.getType()) {
 							case VariantType::Null:
-								iRet = ::sqlite3_bind_null(m_statement, i);
+								iRet = ::sqlite3_bind_null(m_statement, i + 1);
 								break;
 							case VariantType::Boolean:
 							case VariantType::Int32:
-								iRet = ::sqlite3_bind_int(m_statement, i, var.getInt32());
+								iRet = ::sqlite3_bind_int(m_statement, i + 1, var.getInt32());
 								break;
 							case VariantType::Uint32:
 							case VariantType::Int64:
 							case VariantType::Uint64:
-								iRet = ::sqlite3_bind_int64(m_statement, i, var.getInt64());
+								iRet = ::sqlite3_bind_int64(m_statement, i + 1, var.getInt64());
 								break;
 							case VariantType::Float:
 							case VariantType::Double:
-								iRet = ::sqlite3_bind_double(m_statement, i, var.getDouble());
+								iRet = ::sqlite3_bind_double(m_statement, i + 1, var.getDouble());
 								break;
 							default:
 								if (var.isMemory()) {
 									Memory mem = var.getMemory();
 									sl_size size = mem.getSize();
 									if (size > 0x7fffffff) {
-										iRet = ::sqlite3_bind_blob64(m_statement, i, mem.getData(), size, SQLITE_STATIC);
+										iRet = ::sqlite3_bind_blob64(m_statement, i + 1, mem.getData(), size, SQLITE_STATIC);
 									} else {
-										iRet = ::sqlite3_bind_blob(m_statement, i, mem.getData(), (sl_uint32)size, SQLITE_STATIC);
+										iRet = ::sqlite3_bind_blob(m_statement, i + 1, mem.getData(), (sl_uint32)size, SQLITE_STATIC);
 									}
 								} else {
 									String str = var.getString();
 									var = str;
-									iRet = ::sqlite3_bind_text(m_statement, i, str.getData(), (sl_uint32)(str.getLength()), SQLITE_STATIC);
+									iRet = ::sqlite3_bind_text(m_statement, i + 1, str.getData(), (sl_uint32)(str.getLength()), SQLITE_STATIC);
 								}
 							}
 							if (iRet != SQLITE_OK) {
@@ -471,17 +514,39 @@ namespace slib
 		{
 			ObjectLocker lock(this);
 			Ref<DatabaseStatement> ret;
-			sqlite3_stmt* statement = sl_null;
-			if (SQLITE_OK == ::sqlite3_prepare_v2(m_db, sql.getData(), -1, &statement, sl_null)) {
-				ret = new _DatabaseStatement(this, statement);
-				if (ret.isNotNull()) {
+			sqlite3_stmt* statement = (sqlite3_stmt*)(_takeCachedStatement(sql));
+			if (!statement) {
+				if (SQLITE_OK != ::sqlite3_prepare_v2(m_db, sql.getData(), -1, &statement, sl_null)) {
 					return ret;
 				}
-				::sqlite3_finalize(statement);
 			}
+			ret = new _DatabaseStatement(this, statement, sql);
+			if (ret.isNotNull()) {
+				return ret;
+			}
+			::sqlite3_finalize(statement);
 			return ret;
 		}
 
+		// returns null when the statement may write to the database
+		Ref<DatabaseStatement> prepareReadOnlyStatement(const String& sql)
+		{
+			ObjectLocker lock(this);
+			Ref<DatabaseStatement> ret = prepareStatement(sql);
+			if (ret.isNotNull()) {
+				if (::sqlite3_stmt_readonly(((_DatabaseStatement*)(ret.get()))->m_statement)) {
+					return ret;
+				}
+			}
+			return sl_null;
+		}
+
+		// override
+		void _freeCachedStatement(void* statement)
+		{
+			::sqlite3_finalize((sqlite3_stmt*)statement);
+		}
+
 		// override
 		String getErrorMessage()
 		{
@@ -494,4 +559,163 @@ namespace slib
 		return _Sqlite3Database::connect(path);
 	}
 
+
+	SQLiteDatabasePoolParam::SQLiteDatabasePoolParam()
+	{
+		readersCount = 0;
+		flagCreate = sl_true;
+
+		busyTimeout = 5000;
+		cacheSize = -16384;
+		mmapSize = 256 * 1024 * 1024;
+	}
+
+	SQLiteDatabasePoolParam::~SQLiteDatabasePoolParam()
+	{
+	}
+
+	SLIB_DEFINE_OBJECT(SQLiteDatabasePool, Database)
+
+	SQLiteDatabasePool::SQLiteDatabasePool()
+	{
+		m_idThreadTransaction = 0;
+	}
+
+	SQLiteDatabasePool::~SQLiteDatabasePool()
+	{
+	}
+
+	Ref<SQLiteDatabasePool> SQLiteDatabasePool::open(const SQLiteDatabasePoolParam& param)
+	{
+		Ref<_Sqlite3Database> writer = _Sqlite3Database::open(param.filePath, param.flagCreate, sl_false, param);
+		if (writer.isNull()) {
+			return sl_null;
+		}
+		sl_uint32 nReaders = param.readersCount;
+		if (!nReaders) {
+			nReaders = System::getProcessorsCount();
+			if (!nReaders) {
+				nReaders = 1;
+			}
+		}
+		Array< Ref<SQLiteDatabase> > readers = Array< Ref<SQLiteDatabase> >::create(nReaders);
+		if (readers.isNull()) {
+			return sl_null;
+		}
+		for (sl_uint32 i = 0; i < nReaders; i++) {
+			Ref<_Sqlite3Database> reader = _Sqlite3Database::open(param.filePath, sl_false, sl_true, param);
+			if (reader.isNull()) {
+				return sl_null;
+			}
+			readers[i] = reader;
+		}
+		Ref<SQLiteDatabasePool> ret = new SQLiteDatabasePool;
+		if (ret.isNotNull()) {
+			ret->m_writer = writer;
+			ret->m_readers = readers;
+			return ret;
+		}
+		return sl_null;
+	}
+
+	Ref<SQLiteDatabasePool> SQLiteDatabasePool::open(const String& filePath)
+	{
+		SQLiteDatabasePoolParam param;
+		param.filePath = filePath;
+		return open(param);
+	}
+
+	Ref<SQLiteDatabase> SQLiteDatabasePool::getWriter()
+	{
+		return m_writer;
+	}
+
+	Ref<SQLiteDatabase> SQLiteDatabasePool::getReader()
+	{
+		// thread unique ids are sequential, so that the threads are distributed evenly
+		sl_uint64 id = Thread::getCurrentThreadUniqueId();
+		return m_readers[(sl_size)(id % m_readers.getCount())];
+	}
+
+	sl_uint32 SQLiteDatabasePool::getReadersCount()
+	{
+		return (sl_uint32)(m_readers.getCount());
+	}
+
+	Ref<DatabaseStatement> SQLiteDatabasePool::prepareStatement(const String& sql)
+	{
+		sl_bool flagTransaction;
+		{
+			ObjectLocker lock(this);
+			flagTransaction = m_idThreadTransaction == Thread::getCurrentThreadUniqueId();
+		}
+		// only the thread running the transaction sees its uncommitted rows: the other threads keep reading on their readers
+		if (!flagTransaction) {
+			// filters out the obvious writes before preparing on the reader
+			sl_char8* s = sql.getData();
+			sl_size len = sql.getLength();
+			sl_size pos = 0;
+			while (pos < len && (s[pos] == ' ' || s[pos] == '\t' || s[pos] == '\r' || s[pos] == '\n')) {
+				pos++;
+			}
+			if (pos + 4 <= len) {
+				String keyword = String(s + pos, 4).toLower();
+				if (keyword == "sele" || keyword == "with") {
+					Ref<SQLiteDatabase> reader = getReader();
+					Ref<DatabaseStatement> ret = ((_Sqlite3Database*)(reader.get()))->prepareReadOnlyStatement(sql);
+					if (ret.isNotNull()) {
+						return ret;
+					}
+				}
+			}
+		}
+		return m_writer->prepareStatement(sql);
+	}
+
+	String SQLiteDatabasePool::getErrorMessage()
+	{
+		return m_writer->getErrorMessage();
+	}
+
+	// the pool is not locked while the writer runs the statements, so that the other threads keep preparing on their readers during the commit
+	sl_bool SQLiteDatabasePool::beginTransaction()
+	{
+		sl_bool ret = m_writer->beginTransaction();
+		ObjectLocker lock(this);
+		if (ret) {
+			m_idThreadTransaction = Thread::getCurrentThreadUniqueId();
+		}
+		_updateTransactionOwner();
+		return ret;
+	}
+
+	sl_bool SQLiteDatabasePool::commit()
+	{
+		sl_bool ret = m_writer->commit();
+		ObjectLocker lock(this);
+		_updateTransactionOwner();
+		return ret;
+	}
+
+	sl_bool SQLiteDatabasePool::rollback()
+	{
+		sl_bool ret = m_writer->rollback();
+		ObjectLocker lock(this);
+		_updateTransactionOwner();
+		return ret;
+	}
+
+	void SQLiteDatabasePool::_updateTransactionOwner()
+	{
+		m_flagInTransaction = m_writer->isInTransaction();
+		if (!m_flagInTransaction) {
+			m_idThreadTransaction = 0;
+		}
+	}
+
+	sl_int64 SQLiteDatabasePool::executeMany(const String& sql, const List< List<Variant> >& rows)
+	{
+		return m_writer->executeMany(sql, rows);
+	}
+
 }
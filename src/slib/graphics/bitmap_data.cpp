@@ -12,6 +12,32 @@
 
 #include "slib/graphics/yuv.h"
 
+#if defined(SLIB_ARCH_IS_X64) || defined(SLIB_ARCH_IS_X86)
+#	if defined(SLIB_ARCH_IS_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#		define _BITMAP_DATA_USE_SSE2
+#		include <emmintrin.h>
+#		if defined(SLIB_COMPILER_IS_VC)
+#			include <intrin.h>
+#			include <immintrin.h>
+#			define _BITMAP_DATA_USE_AVX2
+#			define _BITMAP_DATA_TARGET_SSSE3
+#			define _BITMAP_DATA_TARGET_AVX2
+#		elif defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 5)
+// the instructions of SSSE3 and AVX2 are enabled per function, and selected at runtime
+#			include <immintrin.h>
+#			define _BITMAP_DATA_USE_AVX2
+#			define _BITMAP_DATA_TARGET_SSSE3 __attribute__((target("ssse3")))
+#			define _BITMAP_DATA_TARGET_AVX2 __attribute__((target("avx2")))
+#		else
+#			include <tmmintrin.h>
+#			define _BITMAP_DATA_TARGET_SSSE3 __attribute__((target("ssse3")))
+#		endif
+#	endif
+#elif (defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(SLIB_ARCH_IS_ARM64)) && !defined(__ARM_BIG_ENDIAN)
+#	define _BITMAP_DATA_USE_NEON
+#	include <arm_neon.h>
+#endif
+
 namespace slib
 {
 
@@ -1759,6 +1785,1008 @@ namespace slib
 		}
 	}
 
+/*
+	Row kernels for the common conversions.
+
+	The kernels produce the same results as the sample procs above bit by bit, so they are used whenever available.
+	SSE2 and NEON are selected at compile time, and SSSE3 and AVX2 are detected at runtime.
+*/
+
+	class _BitmapData_RowKernels
+	{
+	public:
+		// RGBA <-> BGRA
+		void (*swapRB)(const sl_uint8* src, sl_uint8* dst, sl_uint32 n);
+
+		// RGB -> RGBA, or BGR -> RGBA if `flagSwapRB`
+		void (*expand24To32)(const sl_uint8* src, sl_uint8* dst, sl_uint32 n, sl_bool flagSwapRB);
+
+		// RGBA -> RGB, or RGBA -> BGR if `flagSwapRB`
+		void (*pack32To24)(const sl_uint8* src, sl_uint8* dst, sl_uint32 n, sl_bool flagSwapRB);
+
+		// alpha is the last component
+		void (*premultiply)(const sl_uint8* src, sl_uint8* dst, sl_uint32 n);
+
+		void (*unpremultiply)(const sl_uint8* src, sl_uint8* dst, sl_uint32 n);
+
+		// one row of YUV420 to RGBA (or BGRA). U and V are shared by 2 pixels, `strideUV` is 1 (planar) or 2 (semi-planar)
+		void (*convertYUV420ToRGBA)(const sl_uint8* y, const sl_uint8* u, const sl_uint8* v, sl_uint32 strideUV, sl_uint8* dst, sl_uint32 n, sl_bool flagBGRA);
+
+		// two rows of RGBA (or BGRA) to YUV420
+		void (*convertRGBAToYUV420)(const sl_uint8* src0, const sl_uint8* src1, sl_uint8* y0, sl_uint8* y1, sl_uint8* u, sl_uint8* v, sl_uint32 strideUV, sl_uint32 n, sl_bool flagBGRA);
+
+	public:
+		static const _BitmapData_RowKernels& get();
+
+	};
+
+	static void _BitmapData_swapRB_Generic(const sl_uint8* src, sl_uint8* dst, sl_uint32 n)
+	{
+		for (sl_uint32 i = 0; i < n; i++) {
+			sl_uint8 r = src[0];
+			sl_uint8 g = src[1];
+			sl_uint8 b = src[2];
+			sl_uint8 a = src[3];
+			dst[0] = b;
+			dst[1] = g;
+			dst[2] = r;
+			dst[3] = a;
+			src += 4;
+			dst += 4;
+		}
+	}
+
+	static void _BitmapData_expand24To32_Generic(const sl_uint8* src, sl_uint8* dst, sl_uint32 n, sl_bool flagSwapRB)
+	{
+		sl_uint32 ir = flagSwapRB ? 2 : 0;
+		sl_uint32 ib = 2 - ir;
+		for (sl_uint32 i = 0; i < n; i++) {
+			sl_uint8 r = src[ir];
+			sl_uint8 g = src[1];
+			sl_uint8 b = src[ib];
+			dst[0] = r;
+			dst[1] = g;
+			dst[2] = b;
+			dst[3] = 255;
+			src += 3;
+			dst += 4;
+		}
+	}
+
+	static void _BitmapData_pack32To24_Generic(const sl_uint8* src, sl_uint8* dst, sl_uint32 n, sl_bool flagSwapRB)
+	{
+		sl_uint32 ir = flagSwapRB ? 2 : 0;
+		sl_uint32 ib = 2 - ir;
+		for (sl_uint32 i = 0; i < n; i++) {
+			sl_uint8 r = src[0];
+			sl_uint8 g = src[1];
+			sl_uint8 b = src[2];
+			dst[ir] = r;
+			dst[1] = g;
+			dst[ib] = b;
+			src += 4;
+			dst += 3;
+		}
+	}
+
+	static void _BitmapData_premultiply_Generic(const sl_uint8* src, sl_uint8* dst, sl_uint32 n)
+	{
+		for (sl_uint32 i = 0; i < n; i++) {
+			Color c(src[0], src[1], src[2], src[3]);
+			c.convertNPAtoPA();
+			dst[0] = c.r;
+			dst[1] = c.g;
+			dst[2] = c.b;
+			dst[3] = c.a;
+			src += 4;
+			dst += 4;
+		}
+	}
+
+	static void _BitmapData_unpremultiply_Generic(const sl_uint8* src, sl_uint8* dst, sl_uint32 n)
+	{
+		for (sl_uint32 i = 0; i < n; i++) {
+			Color c(src[0], src[1], src[2], src[3]);
+			c.convertPAtoNPA();
+			dst[0] = c.r;
+			dst[1] = c.g;
+			dst[2] = c.b;
+			dst[3] = c.a;
+			src += 4;
+			dst += 4;
+		}
+	}
+
+	static void _BitmapData_convertYUV420ToRGBA_Generic(const sl_uint8* y, const sl_uint8* u, const sl_uint8* v, sl_uint32 strideUV, sl_uint8* dst, sl_uint32 n, sl_bool flagBGRA)
+	{
+		sl_uint32 ir = flagBGRA ? 2 : 0;
+		sl_uint32 ib = 2 - ir;
+		for (sl_uint32 i = 0; i < n; i += 2) {
+			YUV::convertYUVToRGB(y[0], *u, *v, dst[ir], dst[1], dst[ib]);
+			dst[3] = 255;
+			YUV::convertYUVToRGB(y[1], *u, *v, dst[4 + ir], dst[5], dst[4 + ib]);
+			dst[7] = 255;
+			y += 2;
+			u += strideUV;
+			v += strideUV;
+			dst += 8;
+		}
+	}
+
+	static void _BitmapData_convertRGBAToYUV420_Generic(const sl_uint8* s0, const sl_uint8* s1, sl_uint8* y0, sl_uint8* y1, sl_uint8* u, sl_uint8* v, sl_uint32 strideUV, sl_uint32 n, sl_bool flagBGRA)
+	{
+		sl_uint32 ir = flagBGRA ? 2 : 0;
+		sl_uint32 ib = 2 - ir;
+		sl_uint8 U, V;
+		sl_uint32 TU, TV;
+		for (sl_uint32 i = 0; i < n; i += 2) {
+			YUV::convertRGBToYUV(s0[ir], s0[1], s0[ib], y0[0], U, V);
+			TU = U;
+			TV = V;
+			YUV::convertRGBToYUV(s0[4 + ir], s0[5], s0[4 + ib], y0[1], U, V);
+			TU += U;
+			TV += V;
+			YUV::convertRGBToYUV(s1[ir], s1[1], s1[ib], y1[0], U, V);
+			TU += U;
+			TV += V;
+			YUV::convertRGBToYUV(s1[4 + ir], s1[5], s1[4 + ib], y1[1], U, V);
+			TU += U;
+			TV += V;
+			*u = (sl_uint8)(TU >> 2);
+			*v = (sl_uint8)(TV >> 2);
+			s0 += 8;
+			s1 += 8;
+			y0 += 2;
+			y1 += 2;
+			u += strideUV;
+			v += strideUV;
+		}
+	}
+
+// constants of `YUV::convertYUVToRGB`, see yuv.cpp
+#define _BITMAP_DATA_YUV_YG 18997
+#define _BITMAP_DATA_YUV_BB (-17544)
+#define _BITMAP_DATA_YUV_BG 8696
+#define _BITMAP_DATA_YUV_BR (-14216)
+
+#if defined(_BITMAP_DATA_USE_SSE2)
+
+	static void _BitmapData_swapRB_SSE2(const sl_uint8* src, sl_uint8* dst, sl_uint32 n)
+	{
+		__m128i maskGA = _mm_set1_epi32(0xFF00FF00);
+		__m128i maskR = _mm_set1_epi32(0x000000FF);
+		__m128i maskB = _mm_set1_epi32(0x00FF0000);
+		sl_uint32 i = 0;
+		for (; i + 4 <= n; i += 4) {
+			__m128i x = _mm_loadu_si128((const __m128i*)(src + (i << 2)));
+			__m128i r = _mm_and_si128(_mm_srli_epi32(x, 16), maskR);
+			__m128i b = _mm_and_si128(_mm_slli_epi32(x, 16), maskB);
+			_mm_storeu_si128((__m128i*)(dst + (i << 2)), _mm_or_si128(_mm_and_si128(x, maskGA), _mm_or_si128(r, b)));
+		}
+		_BitmapData_swapRB_Generic(src + (i << 2), dst + (i << 2), n - i);
+	}
+
+	static void _BitmapData_premultiply_SSE2(const sl_uint8* src, sl_uint8* dst, sl_uint32 n)
+	{
+		__m128i zero = _mm_setzero_si128();
+		__m128i one = _mm_set1_epi16(1);
+		__m128i maskA = _mm_set1_epi32(0xFF000000);
+		sl_uint32 i = 0;
+		for (; i + 4 <= n; i += 4) {
+			__m128i x = _mm_loadu_si128((const __m128i*)(src + (i << 2)));
+			__m128i lo = _mm_unpacklo_epi8(x, zero);
+			__m128i hi = _mm_unpackhi_epi8(x, zero);
+			__m128i alo = _mm_add_epi16(_mm_shufflehi_epi16(_mm_shufflelo_epi16(lo, 0xFF), 0xFF), one);
+			__m128i ahi = _mm_add_epi16(_mm_shufflehi_epi16(_mm_shufflelo_epi16(hi, 0xFF), 0xFF), one);
+			lo = _mm_srli_epi16(_mm_mullo_epi16(lo, alo), 8);
+			hi = _mm_srli_epi16(_mm_mullo_epi16(hi, ahi), 8);
+			__m128i c = _mm_packus_epi16(lo, hi);
+			_mm_storeu_si128((__m128i*)(dst + (i << 2)), _mm_or_si128(_mm_andnot_si128(maskA, c), _mm_and_si128(maskA, x)));
+		}
+		_BitmapData_premultiply_Generic(src + (i << 2), dst + (i << 2), n - i);
+	}
+
+	// (c << 8) / (a + 1) is exact in single precision, because the dividend is less than 2^24
+	static void _BitmapData_unpremultiply_SSE2(const sl_uint8* src, sl_uint8* dst, sl_uint32 n)
+	{
+		__m128i mask = _mm_set1_epi32(0xFF);
+		__m128i one = _mm_set1_epi32(1);
+		__m128i maskA = _mm_set1_epi32(0xFF000000);
+		sl_uint32 i = 0;
+		for (; i + 4 <= n; i += 4) {
+			__m128i x = _mm_loadu_si128((const __m128i*)(src + (i << 2)));
+			__m128 a = _mm_cvtepi32_ps(_mm_add_epi32(_mm_srli_epi32(x, 24), one));
+			__m128i r = _mm_cvttps_epi32(_mm_div_ps(_mm_cvtepi32_ps(_mm_slli_epi32(_mm_and_si128(x, mask), 8)), a));
+			__m128i g = _mm_cvttps_epi32(_mm_div_ps(_mm_cvtepi32_ps(_mm_and_si128(x, _mm_set1_epi32(0xFF00))), a));
+			__m128i b = _mm_cvttps_epi32(_mm_div_ps(_mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(x, 8), _mm_set1_epi32(0xFF00))), a));
+			// clamp to 255
+			__m128i m = _mm_cmpgt_epi32(r, mask);
+			r = _mm_or_si128(_mm_andnot_si128(m, r), _mm_and_si128(m, mask));
+			m = _mm_cmpgt_epi32(g, mask);
+			g = _mm_or_si128(_mm_andnot_si128(m, g), _mm_and_si128(m, mask));
+			m = _mm_cmpgt_epi32(b, mask);
+			b = _mm_or_si128(_mm_andnot_si128(m, b), _mm_and_si128(m, mask));
+			__m128i c = _mm_or_si128(_mm_or_si128(r, _mm_slli_epi32(g, 8)), _mm_or_si128(_mm_slli_epi32(b, 16), _mm_and_si128(x, maskA)));
+			_mm_storeu_si128((__m128i*)(dst + (i << 2)), c);
+		}
+		_BitmapData_unpremultiply_Generic(src + (i << 2), dst + (i << 2), n - i);
+	}
+
+	// 8 pixels of 16 bits from Y (duplicated as Y * 0x0101), U and V
+	SLIB_INLINE static void _BitmapData_convertYUVToRGB_SSE2(__m128i yy, __m128i u, __m128i v, __m128i& r, __m128i& g, __m128i& b)
+	{
+		__m128i y1 = _mm_mulhi_epu16(yy, _mm_set1_epi16(_BITMAP_DATA_YUV_YG));
+		// B can exceed the 16 bits range, but the saturated value is also clamped to 255
+		b = _mm_srai_epi16(_mm_adds_epi16(_mm_add_epi16(y1, _mm_set1_epi16(_BITMAP_DATA_YUV_BB)), _mm_slli_epi16(u, 7)), 6);
+		g = _mm_srai_epi16(_mm_sub_epi16(_mm_add_epi16(y1, _mm_set1_epi16(_BITMAP_DATA_YUV_BG)), _mm_add_epi16(_mm_mullo_epi16(v, _mm_set1_epi16(52)), _mm_mullo_epi16(u, _mm_set1_epi16(25)))), 6);
+		r = _mm_srai_epi16(_mm_add_epi16(_mm_add_epi16(y1, _mm_set1_epi16(_BITMAP_DATA_YUV_BR)), _mm_mullo_epi16(v, _mm_set1_epi16(102))), 6);
+	}
+
+	static void _BitmapData_convertYUV420ToRGBA_SSE2(const sl_uint8* y, const sl_uint8* u, const sl_uint8* v, sl_uint32 strideUV, sl_uint8* dst, sl_uint32 n, sl_bool flagBGRA)
+	{
+		__m128i zero = _mm_setzero_si128();
+		__m128i alpha = _mm_set1_epi8((char)255);
+		__m128i mask = _mm_set1_epi16(0xFF);
+		sl_uint32 i = 0;
+		for (; i + 16 <= n; i += 16) {
+			__m128i U, V;
+			if (strideUV == 2) {
+				if (u < v) {
+					__m128i uv = _mm_loadu_si128((const __m128i*)(u + i));
+					U = _mm_and_si128(uv, mask);
+					V = _mm_srli_epi16(uv, 8);
+				} else {
+					__m128i vu = _mm_loadu_si128((const __m128i*)(v + i));
+					V = _mm_and_si128(vu, mask);
+					U = _mm_srli_epi16(vu, 8);
+				}
+			} else {
+				U = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(u + (i >> 1))), zero);
+				V = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(v + (i >> 1))), zero);
+			}
+			__m128i Y = _mm_loadu_si128((const __m128i*)(y + i));
+			__m128i rl, gl, bl, rh, gh, bh;
+			_BitmapData_convertYUVToRGB_SSE2(_mm_unpacklo_epi8(Y, Y), _mm_unpacklo_epi16(U, U), _mm_unpacklo_epi16(V, V), rl, gl, bl);
+			_BitmapData_convertYUVToRGB_SSE2(_mm_unpackhi_epi8(Y, Y), _mm_unpackhi_epi16(U, U), _mm_unpackhi_epi16(V, V), rh, gh, bh);
+			__m128i R = _mm_packus_epi16(rl, rh);
+			__m128i G = _mm_packus_epi16(gl, gh);
+			__m128i B = _mm_packus_epi16(bl, bh);
+			if (flagBGRA) {
+				__m128i t = R;
+				R = B;
+				B = t;
+			}
+			__m128i rg = _mm_unpacklo_epi8(R, G);
+			__m128i ba = _mm_unpacklo_epi8(B, alpha);
+			__m128i* p = (__m128i*)(dst + (i << 2));
+			_mm_storeu_si128(p, _mm_unpacklo_epi16(rg, ba));
+			_mm_storeu_si128(p + 1, _mm_unpackhi_epi16(rg, ba));
+			rg = _mm_unpackhi_epi8(R, G);
+			ba = _mm_unpackhi_epi8(B, alpha);
+			_mm_storeu_si128(p + 2, _mm_unpacklo_epi16(rg, ba));
+			_mm_storeu_si128(p + 3, _mm_unpackhi_epi16(rg, ba));
+		}
+		sl_uint32 k = (i >> 1) * strideUV;
+		_BitmapData_convertYUV420ToRGBA_Generic(y + i, u + k, v + k, strideUV, dst + (i << 2), n - i, flagBGRA);
+	}
+
+	// 8 pixels of RGBA to 16 bits Y, and 16 bits U, V of each pixel
+	SLIB_INLINE static void _BitmapData_convertRGBToYUV_SSE2(__m128i x0, __m128i x1, sl_bool flagBGRA, __m128i& Y, __m128i& U, __m128i& V)
+	{
+		__m128i mask = _mm_set1_epi32(0xFF);
+		__m128i r = _mm_packs_epi32(_mm_and_si128(x0, mask), _mm_and_si128(x1, mask));
+		__m128i g = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(x0, 8), mask), _mm_and_si128(_mm_srli_epi32(x1, 8), mask));
+		__m128i b = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(x0, 16), mask), _mm_and_si128(_mm_srli_epi32(x1, 16), mask));
+		if (flagBGRA) {
+			__m128i t = r;
+			r = b;
+			b = t;
+		}
+		// the sums are in the range of unsigned 16 bits, and never need clamping
+		Y = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(r, _mm_set1_epi16(66)), _mm_mullo_epi16(g, _mm_set1_epi16(129))), _mm_add_epi16(_mm_mullo_epi16(b, _mm_set1_epi16(25)), _mm_set1_epi16(0x1080))), 8);
+		U = _mm_srli_epi16(_mm_add_epi16(_mm_sub_epi16(_mm_mullo_epi16(b, _mm_set1_epi16(112)), _mm_add_epi16(_mm_mullo_epi16(g, _mm_set1_epi16(74)), _mm_mullo_epi16(r, _mm_set1_epi16(38)))), _mm_set1_epi16((short)0x8080)), 8);
+		V = _mm_srli_epi16(_mm_add_epi16(_mm_sub_epi16(_mm_mullo_epi16(r, _mm_set1_epi16(112)), _mm_add_epi16(_mm_mullo_epi16(g, _mm_set1_epi16(94)), _mm_mullo_epi16(b, _mm_set1_epi16(18)))), _mm_set1_epi16((short)0x8080)), 8);
+	}
+
+	// averages 2x2 blocks of U (or V) from the upper and lower rows of 8 pixels, and packs 4 values into the lowest 32 bits of 16-bit lanes
+	SLIB_INLINE static __m128i _BitmapData_averageUV_SSE2(__m128i up, __m128i down)
+	{
+		__m128i s = _mm_srli_epi32(_mm_madd_epi16(_mm_add_epi16(up, down), _mm_set1_epi16(1)), 2);
+		return _mm_packs_epi32(s, s);
+	}
+
+	static void _BitmapData_convertRGBAToYUV420_SSE2(const sl_uint8* s0, const sl_uint8* s1, sl_uint8* y0, sl_uint8* y1, sl_uint8* u, sl_uint8* v, sl_uint32 strideUV, sl_uint32 n, sl_bool flagBGRA)
+	{
+		sl_uint32 i = 0;
+		for (; i + 16 <= n; i += 16) {
+			const __m128i* p0 = (const __m128i*)(s0 + (i << 2));
+			const __m128i* p1 = (const __m128i*)(s1 + (i << 2));
+			__m128i Y0l, U0l, V0l, Y0h, U0h, V0h, Y1l, U1l, V1l, Y1h, U1h, V1h;
+			_BitmapData_convertRGBToYUV_SSE2(_mm_loadu_si128(p0), _mm_loadu_si128(p0 + 1), flagBGRA, Y0l, U0l, V0l);
+			_BitmapData_convertRGBToYUV_SSE2(_mm_loadu_si128(p0 + 2), _mm_loadu_si128(p0 + 3), flagBGRA, Y0h, U0h, V0h);
+			_BitmapData_convertRGBToYUV_SSE2(_mm_loadu_si128(p1), _mm_loadu_si128(p1 + 1), flagBGRA, Y1l, U1l, V1l);
+			_BitmapData_convertRGBToYUV_SSE2(_mm_loadu_si128(p1 + 2), _mm_loadu_si128(p1 + 3), flagBGRA, Y1h, U1h, V1h);
+			_mm_storeu_si128((__m128i*)(y0 + i), _mm_packus_epi16(Y0l, Y0h));
+			_mm_storeu_si128((__m128i*)(y1 + i), _mm_packus_epi16(Y1l, Y1h));
+			__m128i U = _mm_unpacklo_epi64(_BitmapData_averageUV_SSE2(U0l, U1l), _BitmapData_averageUV_SSE2(U0h, U1h));
+			__m128i V = _mm_unpacklo_epi64(_BitmapData_averageUV_SSE2(V0l, V1l), _BitmapData_averageUV_SSE2(V0h, V1h));
+			if (strideUV == 2) {
+				__m128i uv;
+				if (u < v) {
+					uv = _mm_or_si128(U, _mm_slli_epi16(V, 8));
+					_mm_storeu_si128((__m128i*)(u + i), uv);
+				} else {
+					uv = _mm_or_si128(V, _mm_slli_epi16(U, 8));
+					_mm_storeu_si128((__m128i*)(v + i), uv);
+				}
+			} else {
+				_mm_storel_epi64((__m128i*)(u + (i >> 1)), _mm_packus_epi16(U, U));
+				_mm_storel_epi64((__m128i*)(v + (i >> 1)), _mm_packus_epi16(V, V));
+			}
+		}
+		sl_uint32 k = (i >> 1) * strideUV;
+		_BitmapData_convertRGBAToYUV420_Generic(s0 + (i << 2), s1 + (i << 2), y0 + i, y1 + i, u + k, v + k, strideUV, n - i, flagBGRA);
+	}
+
+	_BITMAP_DATA_TARGET_SSSE3 static void _BitmapData_expand24To32_SSSE3(const sl_uint8* src, sl_uint8* dst, sl_uint32 n, sl_bool flagSwapRB)
+	{
+		__m128i shuffle;
+		if (flagSwapRB) {
+			shuffle = _mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1);
+		} else {
+			shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+		}
+		__m128i alpha = _mm_set1_epi32(0xFF000000);
+		sl_uint32 i = 0;
+		for (; i + 16 <= n; i += 16) {
+			const __m128i* s = (const __m128i*)(src + i * 3);
+			__m128i v0 = _mm_loadu_si128(s);
+			__m128i v1 = _mm_loadu_si128(s + 1);
+			__m128i v2 = _mm_loadu_si128(s + 2);
+			__m128i* d = (__m128i*)(dst + (i << 2));
+			_mm_storeu_si128(d, _mm_or_si128(_mm_shuffle_epi8(v0, shuffle), alpha));
+			_mm_storeu_si128(d + 1, _mm_or_si128(_mm_shuffle_epi8(_mm_alignr_epi8(v1, v0, 12), shuffle), alpha));
+			_mm_storeu_si128(d + 2, _mm_or_si128(_mm_shuffle_epi8(_mm_alignr_epi8(v2, v1, 8), shuffle), alpha));
+			_mm_storeu_si128(d + 3, _mm_or_si128(_mm_shuffle_epi8(_mm_srli_si128(v2, 4), shuffle), alpha));
+		}
+		_BitmapData_expand24To32_Generic(src + i * 3, dst + (i << 2), n - i, flagSwapRB);
+	}
+
+	_BITMAP_DATA_TARGET_SSSE3 static void _BitmapData_pack32To24_SSSE3(const sl_uint8* src, sl_uint8* dst, sl_uint32 n, sl_bool flagSwapRB)
+	{
+		__m128i shuffle;
+		if (flagSwapRB) {
+			shuffle = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+		} else {
+			shuffle = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+		}
+		sl_uint32 i = 0;
+		for (; i + 16 <= n; i += 16) {
+			const __m128i* s = (const __m128i*)(src + (i << 2));
+			__m128i v0 = _mm_shuffle_epi8(_mm_loadu_si128(s), shuffle);
+			__m128i v1 = _mm_shuffle_epi8(_mm_loadu_si128(s + 1), shuffle);
+			__m128i v2 = _mm_shuffle_epi8(_mm_loadu_si128(s + 2), shuffle);
+			__m128i v3 = _mm_shuffle_epi8(_mm_loadu_si128(s + 3), shuffle);
+			__m128i* d = (__m128i*)(dst + i * 3);
+			_mm_storeu_si128(d, _mm_or_si128(v0, _mm_slli_si128(v1, 12)));
+			_mm_storeu_si128(d + 1, _mm_or_si128(_mm_srli_si128(v1, 4), _mm_slli_si128(v2, 8)));
+			_mm_storeu_si128(d + 2, _mm_or_si128(_mm_srli_si128(v2, 8), _mm_slli_si128(v3, 4)));
+		}
+		_BitmapData_pack32To24_Generic(src + (i << 2), dst + i * 3, n - i, flagSwapRB);
+	}
+
+#endif
+
+#if defined(_BITMAP_DATA_USE_AVX2)
+
+	_BITMAP_DATA_TARGET_AVX2 static void _BitmapData_swapRB_AVX2(const sl_uint8* src, sl_uint8* dst, sl_uint32 n)
+	{
+		__m256i shuffle = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15, 2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+		sl_uint32 i = 0;
+		for (; i + 8 <= n; i += 8) {
+			__m256i x = _mm256_loadu_si256((const __m256i*)(src + (i << 2)));
+			_mm256_storeu_si256((__m256i*)(dst + (i << 2)), _mm256_shuffle_epi8(x, shuffle));
+		}
+		_BitmapData_swapRB_SSE2(src + (i << 2), dst + (i << 2), n - i);
+	}
+
+	_BITMAP_DATA_TARGET_AVX2 static void _BitmapData_expand24To32_AVX2(const sl_uint8* src, sl_uint8* dst, sl_uint32 n, sl_bool flagSwapRB)
+	{
+		__m256i shuffle;
+		if (flagSwapRB) {
+			shuffle = _mm256_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1, 2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1);
+		} else {
+			shuffle = _mm256_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+		}
+		__m256i alpha = _mm256_set1_epi32(0xFF000000);
+		sl_uint32 i = 0;
+		// each lane loads 4 pixels (12 bytes) by 16 bytes, so the last load needs 4 more bytes
+		for (; i + 10 <= n; i += 8) {
+			const sl_uint8* s = src + i * 3;
+			__m256i x = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)s)), _mm_loadu_si128((const __m128i*)(s + 12)), 1);
+			_mm256_storeu_si256((__m256i*)(dst + (i << 2)), _mm256_or_si256(_mm256_shuffle_epi8(x, shuffle), alpha));
+		}
+		_BitmapData_expand24To32_SSSE3(src + i * 3, dst + (i << 2), n - i, flagSwapRB);
+	}
+
+	_BITMAP_DATA_TARGET_AVX2 static void _BitmapData_premultiply_AVX2(const sl_uint8* src, sl_uint8* dst, sl_uint32 n)
+	{
+		__m256i zero = _mm256_setzero_si256();
+		__m256i one = _mm256_set1_epi16(1);
+		__m256i maskA = _mm256_set1_epi32(0xFF000000);
+		sl_uint32 i = 0;
+		for (; i + 8 <= n; i += 8) {
+			__m256i x = _mm256_loadu_si256((const __m256i*)(src + (i << 2)));
+			__m256i lo = _mm256_unpacklo_epi8(x, zero);
+			__m256i hi = _mm256_unpackhi_epi8(x, zero);
+			__m256i alo = _mm256_add_epi16(_mm256_shufflehi_epi16(_mm256_shufflelo_epi16(lo, 0xFF), 0xFF), one);
+			__m256i ahi = _mm256_add_epi16(_mm256_shufflehi_epi16(_mm256_shufflelo_epi16(hi, 0xFF), 0xFF), one);
+			lo = _mm256_srli_epi16(_mm256_mullo_epi16(lo, alo), 8);
+			hi = _mm256_srli_epi16(_mm256_mullo_epi16(hi, ahi), 8);
+			__m256i c = _mm256_packus_epi16(lo, hi);
+			_mm256_storeu_si256((__m256i*)(dst + (i << 2)), _mm256_blendv_epi8(c, x, maskA));
+		}
+		_BitmapData_premultiply_SSE2(src + (i << 2), dst + (i << 2), n - i);
+	}
+
+	_BITMAP_DATA_TARGET_AVX2 static void _BitmapData_unpremultiply_AVX2(const sl_uint8* src, sl_uint8* dst, sl_uint32 n)
+	{
+		__m256i mask = _mm256_set1_epi32(0xFF);
+		__m256i mask2 = _mm256_set1_epi32(0xFF00);
+		__m256i one = _mm256_set1_epi32(1);
+		__m256i maskA = _mm256_set1_epi32(0xFF000000);
+		sl_uint32 i = 0;
+		for (; i + 8 <= n; i += 8) {
+			__m256i x = _mm256_loadu_si256((const __m256i*)(src + (i << 2)));
+			__m256 a = _mm256_cvtepi32_ps(_mm256_add_epi32(_mm256_srli_epi32(x, 24), one));
+			__m256i r = _mm256_cvttps_epi32(_mm256_div_ps(_mm256_cvtepi32_ps(_mm256_slli_epi32(_mm256_and_si256(x, mask), 8)), a));
+			__m256i g = _mm256_cvttps_epi32(_mm256_div_ps(_mm256_cvtepi32_ps(_mm256_and_si256(x, mask2)), a));
+			__m256i b = _mm256_cvttps_epi32(_mm256_div_ps(_mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(x, 8), mask2)), a));
+			r = _mm256_min_epi32(r, mask);
+			g = _mm256_min_epi32(g, mask);
+			b = _mm256_min_epi32(b, mask);
+			__m256i c = _mm256_or_si256(_mm256_or_si256(r, _mm256_slli_epi32(g, 8)), _mm256_or_si256(_mm256_slli_epi32(b, 16), _mm256_and_si256(x, maskA)));
+			_mm256_storeu_si256((__m256i*)(dst + (i << 2)), c);
+		}
+		_BitmapData_unpremultiply_SSE2(src + (i << 2), dst + (i << 2), n - i);
+	}
+
+	_BITMAP_DATA_TARGET_AVX2 SLIB_INLINE static void _BitmapData_convertYUVToRGB_AVX2(__m256i yy, __m256i u, __m256i v, __m256i& r, __m256i& g, __m256i& b)
+	{
+		__m256i y1 = _mm256_mulhi_epu16(yy, _mm256_set1_epi16(_BITMAP_DATA_YUV_YG));
+		b = _mm256_srai_epi16(_mm256_adds_epi16(_mm256_add_epi16(y1, _mm256_set1_epi16(_BITMAP_DATA_YUV_BB)), _mm256_slli_epi16(u, 7)), 6);
+		g = _mm256_srai_epi16(_mm256_sub_epi16(_mm256_add_epi16(y1, _mm256_set1_epi16(_BITMAP_DATA_YUV_BG)), _mm256_add_epi16(_mm256_mullo_epi16(v, _mm256_set1_epi16(52)), _mm256_mullo_epi16(u, _mm256_set1_epi16(25)))), 6);
+		r = _mm256_srai_epi16(_mm256_add_epi16(_mm256_add_epi16(y1, _mm256_set1_epi16(_BITMAP_DATA_YUV_BR)), _mm256_mullo_epi16(v, _mm256_set1_epi16(102))), 6);
+	}
+
+	// each 128-bit lane converts 16 pixels like the SSE2 version, and the lanes are reordered only when storing
+	_BITMAP_DATA_TARGET_AVX2 static void _BitmapData_convertYUV420ToRGBA_AVX2(const sl_uint8* y, const sl_uint8* u, const sl_uint8* v, sl_uint32 strideUV, sl_uint8* dst, sl_uint32 n, sl_bool flagBGRA)
+	{
+		__m256i alpha = _mm256_set1_epi8((char)255);
+		__m256i mask = _mm256_set1_epi16(0xFF);
+		sl_uint32 i = 0;
+		for (; i + 32 <= n; i += 32) {
+			__m256i U, V;
+			if (strideUV == 2) {
+				if (u < v) {
+					__m256i uv = _mm256_loadu_si256((const __m256i*)(u + i));
+					U = _mm256_and_si256(uv, mask);
+					V = _mm256_srli_epi16(uv, 8);
+				} else {
+					__m256i vu = _mm256_loadu_si256((const __m256i*)(v + i));
+					V = _mm256_and_si256(vu, mask);
+					U = _mm256_srli_epi16(vu, 8);
+				}
+			} else {
+				U = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(u + (i >> 1))));
+				V = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(v + (i >> 1))));
+			}
+			__m256i Y = _mm256_loadu_si256((const __m256i*)(y + i));
+			__m256i rl, gl, bl, rh, gh, bh;
+			_BitmapData_convertYUVToRGB_AVX2(_mm256_unpacklo_epi8(Y, Y), _mm256_unpacklo_epi16(U, U), _mm256_unpacklo_epi16(V, V), rl, gl, bl);
+			_BitmapData_convertYUVToRGB_AVX2(_mm256_unpackhi_epi8(Y, Y), _mm256_unpackhi_epi16(U, U), _mm256_unpackhi_epi16(V, V), rh, gh, bh);
+			__m256i R = _mm256_packus_epi16(rl, rh);
+			__m256i G = _mm256_packus_epi16(gl, gh);
+			__m256i B = _mm256_packus_epi16(bl, bh);
+			if (flagBGRA) {
+				__m256i t = R;
+				R = B;
+				B = t;
+			}
+			__m256i rg = _mm256_unpacklo_epi8(R, G);
+			__m256i ba = _mm256_unpacklo_epi8(B, alpha);
+			__m256i c0 = _mm256_unpacklo_epi16(rg, ba);
+			__m256i c1 = _mm256_unpackhi_epi16(rg, ba);
+			rg = _mm256_unpackhi_epi8(R, G);
+			ba = _mm256_unpackhi_epi8(B, alpha);
+			__m256i c2 = _mm256_unpacklo_epi16(rg, ba);
+			__m256i c3 = _mm256_unpackhi_epi16(rg, ba);
+			__m256i* p = (__m256i*)(dst + (i << 2));
+			_mm256_storeu_si256(p, _mm256_permute2x128_si256(c0, c1, 0x20));
+			_mm256_storeu_si256(p + 1, _mm256_permute2x128_si256(c2, c3, 0x20));
+			_mm256_storeu_si256(p + 2, _mm256_permute2x128_si256(c0, c1, 0x31));
+			_mm256_storeu_si256(p + 3, _mm256_permute2x128_si256(c2, c3, 0x31));
+		}
+		sl_uint32 k = (i >> 1) * strideUV;
+		_BitmapData_convertYUV420ToRGBA_SSE2(y + i, u + k, v + k, strideUV, dst + (i << 2), n - i, flagBGRA);
+	}
+
+	// 16 pixels of RGBA to 16 bits Y, U, V in the pixel order
+	_BITMAP_DATA_TARGET_AVX2 SLIB_INLINE static void _BitmapData_convertRGBToYUV_AVX2(__m256i x0, __m256i x1, sl_bool flagBGRA, __m256i& Y, __m256i& U, __m256i& V)
+	{
+		__m256i mask = _mm256_set1_epi32(0xFF);
+		// `packs` works in the lanes, so the 64-bit blocks are reordered
+		__m256i r = _mm256_permute4x64_epi64(_mm256_packs_epi32(_mm256_and_si256(x0, mask), _mm256_and_si256(x1, mask)), 0xD8);
+		__m256i g = _mm256_permute4x64_epi64(_mm256_packs_epi32(_mm256_and_si256(_mm256_srli_epi32(x0, 8), mask), _mm256_and_si256(_mm256_srli_epi32(x1, 8), mask)), 0xD8);
+		__m256i b = _mm256_permute4x64_epi64(_mm256_packs_epi32(_mm256_and_si256(_mm256_srli_epi32(x0, 16), mask), _mm256_and_si256(_mm256_srli_epi32(x1, 16), mask)), 0xD8);
+		if (flagBGRA) {
+			__m256i t = r;
+			r = b;
+			b = t;
+		}
+		Y = _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(_mm256_mullo_epi16(r, _mm256_set1_epi16(66)), _mm256_mullo_epi16(g, _mm256_set1_epi16(129))), _mm256_add_epi16(_mm256_mullo_epi16(b, _mm256_set1_epi16(25)), _mm256_set1_epi16(0x1080))), 8);
+		U = _mm256_srli_epi16(_mm256_add_epi16(_mm256_sub_epi16(_mm256_mullo_epi16(b, _mm256_set1_epi16(112)), _mm256_add_epi16(_mm256_mullo_epi16(g, _mm256_set1_epi16(74)), _mm256_mullo_epi16(r, _mm256_set1_epi16(38)))), _mm256_set1_epi16((short)0x8080)), 8);
+		V = _mm256_srli_epi16(_mm256_add_epi16(_mm256_sub_epi16(_mm256_mullo_epi16(r, _mm256_set1_epi16(112)), _mm256_add_epi16(_mm256_mullo_epi16(g, _mm256_set1_epi16(94)), _mm256_mullo_epi16(b, _mm256_set1_epi16(18)))), _mm256_set1_epi16((short)0x8080)), 8);
+	}
+
+	// 8 averaged values of 16 bits in the lower 128 bits
+	_BITMAP_DATA_TARGET_AVX2 SLIB_INLINE static __m128i _BitmapData_averageUV_AVX2(__m256i up, __m256i down)
+	{
+		__m256i s = _mm256_srli_epi32(_mm256_madd_epi16(_mm256_add_epi16(up, down), _mm256_set1_epi16(1)), 2);
+		return _mm256_castsi256_si128(_mm256_permute4x64_epi64(_mm256_packs_epi32(s, s), 0x08));
+	}
+
+	_BITMAP_DATA_TARGET_AVX2 static void _BitmapData_convertRGBAToYUV420_AVX2(const sl_uint8* s0, const sl_uint8* s1, sl_uint8* y0, sl_uint8* y1, sl_uint8* u, sl_uint8* v, sl_uint32 strideUV, sl_uint32 n, sl_bool flagBGRA)
+	{
+		sl_uint32 i = 0;
+		for (; i + 16 <= n; i += 16) {
+			const __m256i* p0 = (const __m256i*)(s0 + (i << 2));
+			const __m256i* p1 = (const __m256i*)(s1 + (i << 2));
+			__m256i Y0, U0, V0, Y1, U1, V1;
+			_BitmapData_convertRGBToYUV_AVX2(_mm256_loadu_si256(p0), _mm256_loadu_si256(p0 + 1), flagBGRA, Y0, U0, V0);
+			_BitmapData_convertRGBToYUV_AVX2(_mm256_loadu_si256(p1), _mm256_loadu_si256(p1 + 1), flagBGRA, Y1, U1, V1);
+			_mm_storeu_si128((__m128i*)(y0 + i), _mm256_castsi256_si128(_mm256_permute4x64_epi64(_mm256_packus_epi16(Y0, Y0), 0x08)));
+			_mm_storeu_si128((__m128i*)(y1 + i), _mm256_castsi256_si128(_mm256_permute4x64_epi64(_mm256_packus_epi16(Y1, Y1), 0x08)));
+			__m128i U = _BitmapData_averageUV_AVX2(U0, U1);
+			__m128i V = _BitmapData_averageUV_AVX2(V0, V1);
+			if (strideUV == 2) {
+				if (u < v) {
+					_mm_storeu_si128((__m128i*)(u + i), _mm_or_si128(U, _mm_slli_epi16(V, 8)));
+				} else {
+					_mm_storeu_si128((__m128i*)(v + i), _mm_or_si128(V, _mm_slli_epi16(U, 8)));
+				}
+			} else {
+				_mm_storel_epi64((__m128i*)(u + (i >> 1)), _mm_packus_epi16(U, U));
+				_mm_storel_epi64((__m128i*)(v + (i >> 1)), _mm_packus_epi16(V, V));
+			}
+		}
+		sl_uint32 k = (i >> 1) * strideUV;
+		_BitmapData_convertRGBAToYUV420_Generic(s0 + (i << 2), s1 + (i << 2), y0 + i, y1 + i, u + k, v + k, strideUV, n - i, flagBGRA);
+	}
+
+#endif
+
+#if defined(_BITMAP_DATA_USE_NEON)
+
+	static void _BitmapData_swapRB_NEON(const sl_uint8* src, sl_uint8* dst, sl_uint32 n)
+	{
+		sl_uint32 i = 0;
+		for (; i + 16 <= n; i += 16) {
+			uint8x16x4_t x = vld4q_u8(src + (i << 2));
+			uint8x16_t t = x.val[0];
+			x.val[0] = x.val[2];
+			x.val[2] = t;
+			vst4q_u8(dst + (i << 2), x);
+		}
+		_BitmapData_swapRB_Generic(src + (i << 2), dst + (i << 2), n - i);
+	}
+
+	static void _BitmapData_expand24To32_NEON(const sl_uint8* src, sl_uint8* dst, sl_uint32 n, sl_bool flagSwapRB)
+	{
+		sl_uint32 ir = flagSwapRB ? 2 : 0;
+		sl_uint32 ib = 2 - ir;
+		sl_uint32 i = 0;
+		for (; i + 16 <= n; i += 16) {
+			uint8x16x3_t x = vld3q_u8(src + i * 3);
+			uint8x16x4_t y;
+			y.val[0] = x.val[ir];
+			y.val[1] = x.val[1];
+			y.val[2] = x.val[ib];
+			y.val[3] = vdupq_n_u8(255);
+			vst4q_u8(dst + (i << 2), y);
+		}
+		_BitmapData_expand24To32_Generic(src + i * 3, dst + (i << 2), n - i, flagSwapRB);
+	}
+
+	static void _BitmapData_pack32To24_NEON(const sl_uint8* src, sl_uint8* dst, sl_uint32 n, sl_bool flagSwapRB)
+	{
+		sl_uint32 ir = flagSwapRB ? 2 : 0;
+		sl_uint32 ib = 2 - ir;
+		sl_uint32 i = 0;
+		for (; i + 16 <= n; i += 16) {
+			uint8x16x4_t x = vld4q_u8(src + (i << 2));
+			uint8x16x3_t y;
+			y.val[ir] = x.val[0];
+			y.val[1] = x.val[1];
+			y.val[ib] = x.val[2];
+			vst3q_u8(dst + i * 3, y);
+		}
+		_BitmapData_pack32To24_Generic(src + (i << 2), dst + i * 3, n - i, flagSwapRB);
+	}
+
+	SLIB_INLINE static uint8x8_t _BitmapData_premultiply_NEON(uint8x8_t c, uint16x8_t a)
+	{
+		return vshrn_n_u16(vmulq_u16(vmovl_u8(c), a), 8);
+	}
+
+	static void _BitmapData_premultiply_NEON(const sl_uint8* src, sl_uint8* dst, sl_uint32 n)
+	{
+		uint16x8_t one = vdupq_n_u16(1);
+		sl_uint32 i = 0;
+		for (; i + 16 <= n; i += 16) {
+			uint8x16x4_t x = vld4q_u8(src + (i << 2));
+			uint16x8_t alo = vaddw_u8(one, vget_low_u8(x.val[3]));
+			uint16x8_t ahi = vaddw_u8(one, vget_high_u8(x.val[3]));
+			for (int k = 0; k < 3; k++) {
+				x.val[k] = vcombine_u8(_BitmapData_premultiply_NEON(vget_low_u8(x.val[k]), alo), _BitmapData_premultiply_NEON(vget_high_u8(x.val[k]), ahi));
+			}
+			vst4q_u8(dst + (i << 2), x);
+		}
+		_BitmapData_premultiply_Generic(src + (i << 2), dst + (i << 2), n - i);
+	}
+
+#if defined(SLIB_ARCH_IS_ARM64)
+	SLIB_INLINE static uint16x4_t _BitmapData_unpremultiply_NEON(uint16x4_t c, float32x4_t a)
+	{
+		uint32x4_t q = vcvtq_u32_f32(vdivq_f32(vcvtq_f32_u32(vshll_n_u16(c, 8)), a));
+		return vmovn_u32(vminq_u32(q, vdupq_n_u32(255)));
+	}
+
+	static void _BitmapData_unpremultiply_NEON(const sl_uint8* src, sl_uint8* dst, sl_uint32 n)
+	{
+		uint16x8_t one = vdupq_n_u16(1);
+		sl_uint32 i = 0;
+		for (; i + 8 <= n; i += 8) {
+			uint8x8x4_t x = vld4_u8(src + (i << 2));
+			uint16x8_t a = vaddw_u8(one, x.val[3]);
+			float32x4_t alo = vcvtq_f32_u32(vmovl_u16(vget_low_u16(a)));
+			float32x4_t ahi = vcvtq_f32_u32(vmovl_u16(vget_high_u16(a)));
+			for (int k = 0; k < 3; k++) {
+				uint16x8_t c = vmovl_u8(x.val[k]);
+				x.val[k] = vmovn_u16(vcombine_u16(_BitmapData_unpremultiply_NEON(vget_low_u16(c), alo), _BitmapData_unpremultiply_NEON(vget_high_u16(c), ahi)));
+			}
+			vst4_u8(dst + (i << 2), x);
+		}
+		_BitmapData_unpremultiply_Generic(src + (i << 2), dst + (i << 2), n - i);
+	}
+#endif
+
+	SLIB_INLINE static void _BitmapData_convertYUVToRGB_NEON(uint8x8_t y, uint16x8_t u, uint16x8_t v, uint8x8_t& r, uint8x8_t& g, uint8x8_t& b)
+	{
+		uint16x8_t yy = vmulq_n_u16(vmovl_u8(y), 0x0101);
+		uint16x4_t yg = vdup_n_u16(_BITMAP_DATA_YUV_YG);
+		int16x8_t y1 = vreinterpretq_s16_u16(vcombine_u16(vshrn_n_u32(vmull_u16(vget_low_u16(yy), yg), 16), vshrn_n_u32(vmull_u16(vget_high_u16(yy), yg), 16)));
+		int16x8_t su = vreinterpretq_s16_u16(u);
+		int16x8_t sv = vreinterpretq_s16_u16(v);
+		b = vqmovun_s16(vshrq_n_s16(vqaddq_s16(vaddq_s16(y1, vdupq_n_s16(_BITMAP_DATA_YUV_BB)), vshlq_n_s16(su, 7)), 6));
+		g = vqmovun_s16(vshrq_n_s16(vsubq_s16(vaddq_s16(y1, vdupq_n_s16(_BITMAP_DATA_YUV_BG)), vaddq_s16(vmulq_n_s16(sv, 52), vmulq_n_s16(su, 25))), 6));
+		r = vqmovun_s16(vshrq_n_s16(vaddq_s16(vaddq_s16(y1, vdupq_n_s16(_BITMAP_DATA_YUV_BR)), vmulq_n_s16(sv, 102)), 6));
+	}
+
+	static void _BitmapData_convertYUV420ToRGBA_NEON(const sl_uint8* y, const sl_uint8* u, const sl_uint8* v, sl_uint32 strideUV, sl_uint8* dst, sl_uint32 n, sl_bool flagBGRA)
+	{
+		sl_uint32 ir = flagBGRA ? 2 : 0;
+		sl_uint32 ib = 2 - ir;
+		sl_uint32 i = 0;
+		for (; i + 16 <= n; i += 16) {
+			uint8x8_t U, V;
+			if (strideUV == 2) {
+				if (u < v) {
+					uint8x8x2_t uv = vld2_u8(u + i);
+					U = uv.val[0];
+					V = uv.val[1];
+				} else {
+					uint8x8x2_t vu = vld2_u8(v + i);
+					V = vu.val[0];
+					U = vu.val[1];
+				}
+			} else {
+				U = vld1_u8(u + (i >> 1));
+				V = vld1_u8(v + (i >> 1));
+			}
+			uint8x8x2_t UU = vzip_u8(U, U);
+			uint8x8x2_t VV = vzip_u8(V, V);
+			uint8x16_t Y = vld1q_u8(y + i);
+			uint8x8_t rl, gl, bl, rh, gh, bh;
+			_BitmapData_convertYUVToRGB_NEON(vget_low_u8(Y), vmovl_u8(UU.val[0]), vmovl_u8(VV.val[0]), rl, gl, bl);
+			_BitmapData_convertYUVToRGB_NEON(vget_high_u8(Y), vmovl_u8(UU.val[1]), vmovl_u8(VV.val[1]), rh, gh, bh);
+			uint8x16x4_t c;
+			c.val[ir] = vcombine_u8(rl, rh);
+			c.val[1] = vcombine_u8(gl, gh);
+			c.val[ib] = vcombine_u8(bl, bh);
+			c.val[3] = vdupq_n_u8(255);
+			vst4q_u8(dst + (i << 2), c);
+		}
+		sl_uint32 k = (i >> 1) * strideUV;
+		_BitmapData_convertYUV420ToRGBA_Generic(y + i, u + k, v + k, strideUV, dst + (i << 2), n - i, flagBGRA);
+	}
+
+	// 16 bits Y, U, V of 8 pixels
+	SLIB_INLINE static void _BitmapData_convertRGBToYUV_NEON(uint8x8_t r, uint8x8_t g, uint8x8_t b, uint16x8_t& Y, uint16x8_t& U, uint16x8_t& V)
+	{
+		Y = vshrq_n_u16(vaddq_u16(vmlal_u8(vmlal_u8(vmull_u8(r, vdup_n_u8(66)), g, vdup_n_u8(129)), b, vdup_n_u8(25)), vdupq_n_u16(0x1080)), 8);
+		U = vshrq_n_u16(vaddq_u16(vmlsl_u8(vmlsl_u8(vmull_u8(b, vdup_n_u8(112)), g, vdup_n_u8(74)), r, vdup_n_u8(38)), vdupq_n_u16(0x8080)), 8);
+		V = vshrq_n_u16(vaddq_u16(vmlsl_u8(vmlsl_u8(vmull_u8(r, vdup_n_u8(112)), g, vdup_n_u8(94)), b, vdup_n_u8(18)), vdupq_n_u16(0x8080)), 8);
+	}
+
+	static void _BitmapData_convertRGBAToYUV420_NEON(const sl_uint8* s0, const sl_uint8* s1, sl_uint8* y0, sl_uint8* y1, sl_uint8* u, sl_uint8* v, sl_uint32 strideUV, sl_uint32 n, sl_bool flagBGRA)
+	{
+		sl_uint32 ir = flagBGRA ? 2 : 0;
+		sl_uint32 ib = 2 - ir;
+		sl_uint32 i = 0;
+		for (; i + 16 <= n; i += 16) {
+			uint8x16x4_t x0 = vld4q_u8(s0 + (i << 2));
+			uint8x16x4_t x1 = vld4q_u8(s1 + (i << 2));
+			uint16x8_t Y, U0l, V0l, U0h, V0h, U1l, V1l, U1h, V1h;
+			_BitmapData_convertRGBToYUV_NEON(vget_low_u8(x0.val[ir]), vget_low_u8(x0.val[1]), vget_low_u8(x0.val[ib]), Y, U0l, V0l);
+			uint8x8_t yl = vmovn_u16(Y);
+			_BitmapData_convertRGBToYUV_NEON(vget_high_u8(x0.val[ir]), vget_high_u8(x0.val[1]), vget_high_u8(x0.val[ib]), Y, U0h, V0h);
+			vst1q_u8(y0 + i, vcombine_u8(yl, vmovn_u16(Y)));
+			_BitmapData_convertRGBToYUV_NEON(vget_low_u8(x1.val[ir]), vget_low_u8(x1.val[1]), vget_low_u8(x1.val[ib]), Y, U1l, V1l);
+			yl = vmovn_u16(Y);
+			_BitmapData_convertRGBToYUV_NEON(vget_high_u8(x1.val[ir]), vget_high_u8(x1.val[1]), vget_high_u8(x1.val[ib]), Y, U1h, V1h);
+			vst1q_u8(y1 + i, vcombine_u8(yl, vmovn_u16(Y)));
+			// sums of the horizontal pairs, then divided by 4
+			uint8x8_t U = vmovn_u16(vshrq_n_u16(vcombine_u16(vmovn_u32(vpaddlq_u16(vaddq_u16(U0l, U1l))), vmovn_u32(vpaddlq_u16(vaddq_u16(U0h, U1h)))), 2));
+			uint8x8_t V = vmovn_u16(vshrq_n_u16(vcombine_u16(vmovn_u32(vpaddlq_u16(vaddq_u16(V0l, V1l))), vmovn_u32(vpaddlq_u16(vaddq_u16(V0h, V1h)))), 2));
+			if (strideUV == 2) {
+				uint8x8x2_t uv;
+				if (u < v) {
+					uv.val[0] = U;
+					uv.val[1] = V;
+					vst2_u8(u + i, uv);
+				} else {
+					uv.val[0] = V;
+					uv.val[1] = U;
+					vst2_u8(v + i, uv);
+				}
+			} else {
+				vst1_u8(u + (i >> 1), U);
+				vst1_u8(v + (i >> 1), V);
+			}
+		}
+		sl_uint32 k = (i >> 1) * strideUV;
+		_BitmapData_convertRGBAToYUV420_Generic(s0 + (i << 2), s1 + (i << 2), y0 + i, y1 + i, u + k, v + k, strideUV, n - i, flagBGRA);
+	}
+
+#endif
+
+#if defined(_BITMAP_DATA_USE_SSE2)
+#	define _BITMAP_DATA_CPU_SSSE3 1
+#	define _BITMAP_DATA_CPU_AVX2 2
+
+	static sl_uint32 _BitmapData_detectCpuFeatures()
+	{
+		sl_uint32 features = 0;
+#if defined(SLIB_COMPILER_IS_VC)
+		int info[4];
+		__cpuid(info, 0);
+		int nIds = info[0];
+		__cpuid(info, 1);
+		if (info[2] & (1 << 9)) {
+			features |= _BITMAP_DATA_CPU_SSSE3;
+		}
+		// AVX and OSXSAVE, and the OS saves YMM registers
+		if ((info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6 && nIds >= 7) {
+			__cpuidex(info, 7, 0);
+			if (info[1] & (1 << 5)) {
+				features |= _BITMAP_DATA_CPU_AVX2;
+			}
+		}
+#else
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("ssse3")) {
+			features |= _BITMAP_DATA_CPU_SSSE3;
+		}
+		if (__builtin_cpu_supports("avx2")) {
+			features |= _BITMAP_DATA_CPU_AVX2;
+		}
+#endif
+		return features;
+	}
+#endif
+
+	static _BitmapData_RowKernels _BitmapData_createRowKernels()
+	{
+		_BitmapData_RowKernels k;
+		k.swapRB = _BitmapData_swapRB_Generic;
+		k.expand24To32 = _BitmapData_expand24To32_Generic;
+		k.pack32To24 = _BitmapData_pack32To24_Generic;
+		k.premultiply = _BitmapData_premultiply_Generic;
+		k.unpremultiply = _BitmapData_unpremultiply_Generic;
+		k.convertYUV420ToRGBA = _BitmapData_convertYUV420ToRGBA_Generic;
+		k.convertRGBAToYUV420 = _BitmapData_convertRGBAToYUV420_Generic;
+#if defined(_BITMAP_DATA_USE_SSE2)
+		k.swapRB = _BitmapData_swapRB_SSE2;
+		k.premultiply = _BitmapData_premultiply_SSE2;
+		k.unpremultiply = _BitmapData_unpremultiply_SSE2;
+		k.convertYUV420ToRGBA = _BitmapData_convertYUV420ToRGBA_SSE2;
+		k.convertRGBAToYUV420 = _BitmapData_convertRGBAToYUV420_SSE2;
+		sl_uint32 features = _BitmapData_detectCpuFeatures();
+		if (features & _BITMAP_DATA_CPU_SSSE3) {
+			k.expand24To32 = _BitmapData_expand24To32_SSSE3;
+			k.pack32To24 = _BitmapData_pack32To24_SSSE3;
+		}
+#	if defined(_BITMAP_DATA_USE_AVX2)
+		if ((features & _BITMAP_DATA_CPU_AVX2) && (features & _BITMAP_DATA_CPU_SSSE3)) {
+			k.swapRB = _BitmapData_swapRB_AVX2;
+			k.expand24To32 = _BitmapData_expand24To32_AVX2;
+			k.premultiply = _BitmapData_premultiply_AVX2;
+			k.unpremultiply = _BitmapData_unpremultiply_AVX2;
+			k.convertYUV420ToRGBA = _BitmapData_convertYUV420ToRGBA_AVX2;
+			k.convertRGBAToYUV420 = _BitmapData_convertRGBAToYUV420_AVX2;
+		}
+#	endif
+#elif defined(_BITMAP_DATA_USE_NEON)
+		k.swapRB = _BitmapData_swapRB_NEON;
+		k.expand24To32 = _BitmapData_expand24To32_NEON;
+		k.pack32To24 = _BitmapData_pack32To24_NEON;
+		k.premultiply = _BitmapData_premultiply_NEON;
+#	if defined(SLIB_ARCH_IS_ARM64)
+		k.unpremultiply = _BitmapData_unpremultiply_NEON;
+#	endif
+		k.convertYUV420ToRGBA = _BitmapData_convertYUV420ToRGBA_NEON;
+		k.convertRGBAToYUV420 = _BitmapData_convertRGBAToYUV420_NEON;
+#endif
+		return k;
+	}
+
+	const _BitmapData_RowKernels& _BitmapData_RowKernels::get()
+	{
+		static _BitmapData_RowKernels kernels = _BitmapData_createRowKernels();
+		return kernels;
+	}
+
+	// returns 0 for RGBA, 1 for BGRA, -1 for the others. `flagPA` receives whether the alpha is premultiplied
+	static sl_int32 _BitmapData_getRGBA32Order(BitmapFormat format, sl_bool& flagPA)
+	{
+		switch (format) {
+			case BitmapFormat::RGBA:
+				flagPA = sl_false;
+				return 0;
+			case BitmapFormat::BGRA:
+				flagPA = sl_false;
+				return 1;
+			case BitmapFormat::RGBA_PA:
+				flagPA = sl_true;
+				return 0;
+			case BitmapFormat::BGRA_PA:
+				flagPA = sl_true;
+				return 1;
+			default:
+				break;
+		}
+		return -1;
+	}
+
+	static sl_bool _BitmapData_copyPixels_Normal_Kernel(sl_uint32 width, sl_uint32 height, BitmapFormat src_format, sl_uint8** src_planes, sl_int32* src_pitches, BitmapFormat dst_format, sl_uint8** dst_planes, sl_int32* dst_pitches)
+	{
+		const _BitmapData_RowKernels& kernels = _BitmapData_RowKernels::get();
+		sl_bool flagSrcPA = sl_false, flagDstPA = sl_false;
+		sl_int32 orderSrc = _BitmapData_getRGBA32Order(src_format, flagSrcPA);
+		sl_int32 orderDst = _BitmapData_getRGBA32Order(dst_format, flagDstPA);
+		sl_uint8* sr = src_planes[0];
+		sl_uint8* dr = dst_planes[0];
+		if (orderSrc >= 0 && orderDst >= 0) {
+			void (*kernel)(const sl_uint8*, sl_uint8*, sl_uint32);
+			if (flagSrcPA == flagDstPA) {
+				if (orderSrc == orderDst) {
+					return sl_false;
+				}
+				kernel = kernels.swapRB;
+			} else {
+				if (orderSrc != orderDst) {
+					return sl_false;
+				}
+				kernel = flagDstPA ? kernels.premultiply : kernels.unpremultiply;
+			}
+			for (sl_uint32 i = 0; i < height; i++) {
+				kernel(sr, dr, width);
+				sr += src_pitches[0];
+				dr += dst_pitches[0];
+			}
+			return sl_true;
+		}
+		if ((src_format == BitmapFormat::RGB || src_format == BitmapFormat::BGR) && orderDst >= 0) {
+			// opaque pixels are not changed by premultiplying
+			sl_bool flagSwap = (src_format == BitmapFormat::BGR) != (orderDst == 1);
+			for (sl_uint32 i = 0; i < height; i++) {
+				kernels.expand24To32(sr, dr, width, flagSwap);
+				sr += src_pitches[0];
+				dr += dst_pitches[0];
+			}
+			return sl_true;
+		}
+		if (orderSrc >= 0 && !flagSrcPA && (dst_format == BitmapFormat::RGB || dst_format == BitmapFormat::BGR)) {
+			sl_bool flagSwap = (dst_format == BitmapFormat::BGR) != (orderSrc == 1);
+			for (sl_uint32 i = 0; i < height; i++) {
+				kernels.pack32To24(sr, dr, width, flagSwap);
+				sr += src_pitches[0];
+				dr += dst_pitches[0];
+			}
+			return sl_true;
+		}
+		return sl_false;
+	}
+
+	static sl_bool _BitmapData_copyPixels_YUV420ToRGBA_Kernel(sl_uint32 width, sl_uint32 height, BitmapData& src, BitmapFormat dst_format, sl_uint8** dst_planes, sl_int32* dst_pitches)
+	{
+		sl_bool flagPA;
+		sl_int32 order = _BitmapData_getRGBA32Order(dst_format, flagPA);
+		if (order < 0) {
+			return sl_false;
+		}
+		ColorComponentBuffer src_cb[3];
+		if (src.getColorComponentBuffers(src_cb) != 3) {
+			return sl_false;
+		}
+		sl_uint32 strideUV = (sl_uint32)(src_cb[1].sample_stride);
+		if (strideUV != 1 && strideUV != 2) {
+			return sl_false;
+		}
+		const _BitmapData_RowKernels& kernels = _BitmapData_RowKernels::get();
+		sl_uint8* sry = (sl_uint8*)(src_cb[0].data);
+		sl_uint8* sru = (sl_uint8*)(src_cb[1].data);
+		sl_uint8* srv = (sl_uint8*)(src_cb[2].data);
+		sl_uint8* dr = dst_planes[0];
+		// like the sample procs, the last column and row are not converted for odd sizes
+		width &= ~((sl_uint32)1);
+		height &= ~((sl_uint32)1);
+		// opaque pixels are not changed by premultiplying
+		for (sl_uint32 i = 0; i < height; i++) {
+			kernels.convertYUV420ToRGBA(sry, sru, srv, strideUV, dr, width, order == 1);
+			sry += src_cb[0].pitch;
+			if (i & 1) {
+				sru += src_cb[1].pitch;
+				srv += src_cb[2].pitch;
+			}
+			dr += dst_pitches[0];
+		}
+		return sl_true;
+	}
+
+	static sl_bool _BitmapData_copyPixels_RGBAToYUV420_Kernel(sl_uint32 width, sl_uint32 height, BitmapFormat src_format, sl_uint8** src_planes, sl_int32* src_pitches, BitmapData& dst)
+	{
+		sl_bool flagPA;
+		sl_int32 order = _BitmapData_getRGBA32Order(src_format, flagPA);
+		if (order < 0 || flagPA) {
+			return sl_false;
+		}
+		ColorComponentBuffer dst_cb[3];
+		if (dst.getColorComponentBuffers(dst_cb) != 3) {
+			return sl_false;
+		}
+		sl_uint32 strideUV = (sl_uint32)(dst_cb[1].sample_stride);
+		if (strideUV != 1 && strideUV != 2) {
+			return sl_false;
+		}
+		const _BitmapData_RowKernels& kernels = _BitmapData_RowKernels::get();
+		sl_uint8* sr = src_planes[0];
+		sl_uint8* dry = (sl_uint8*)(dst_cb[0].data);
+		sl_uint8* dru = (sl_uint8*)(dst_cb[1].data);
+		sl_uint8* drv = (sl_uint8*)(dst_cb[2].data);
+		width &= ~((sl_uint32)1);
+		height &= ~((sl_uint32)1);
+		for (sl_uint32 i = 0; i < height; i += 2) {
+			kernels.convertRGBAToYUV420(sr, sr + src_pitches[0], dry, dry + dst_cb[0].pitch, dru, drv, strideUV, width, order == 1);
+			sr += src_pitches[0] + src_pitches[0];
+			dry += dst_cb[0].pitch + dst_cb[0].pitch;
+			dru += dst_cb[1].pitch;
+			drv += dst_cb[2].pitch;
+		}
+		return sl_true;
+	}
+
 	void BitmapData::copyPixelsFrom(const BitmapData& _other) const
 	{
 		BitmapData dst(*this);
@@ -1861,7 +2889,9 @@ namespace slib
 					_BitmapData_copyPixels_YUV420ToYUV(width, height, src, dst.format, dst_planes, dst_pitches);
 				} else {
 					// yuv420 -> other normal
-					_BitmapData_copyPixels_YUV420ToOther(width, height, src, dst.format, dst_planes, dst_pitches);
+					if (!(_BitmapData_copyPixels_YUV420ToRGBA_Kernel(width, height, src, dst.format, dst_planes, dst_pitches))) {
+						_BitmapData_copyPixels_YUV420ToOther(width, height, src, dst.format, dst_planes, dst_pitches);
+					}
 				}
 			}
 		} else {
@@ -1871,7 +2901,9 @@ namespace slib
 					_BitmapData_copyPixels_YUVToYUV420(width, height, src.format, src_planes, src_pitches, dst);
 				} else {
 					// other normal -> yuv420
-					_BitmapData_copyPixels_OtherToYUV420(width, height, src.format, src_planes, src_pitches, dst);
+					if (!(_BitmapData_copyPixels_RGBAToYUV420_Kernel(width, height, src.format, src_planes, src_pitches, dst))) {
+						_BitmapData_copyPixels_OtherToYUV420(width, height, src.format, src_planes, src_pitches, dst);
+					}
 				}
 			} else {
 				// normal -> normal
@@ -1890,19 +2922,15 @@ namespace slib
 						sl_uint8* sr = (sl_uint8*)(src_planes[iPlane]);
 						sl_uint8* dr = (sl_uint8*)(dst_planes[iPlane]);
 						for (sl_uint32 i = 0; i < height; i++) {
-							sl_uint8* ss = sr;
-							sl_uint8* ds = dr;
-							for (sl_uint32 j = 0; j < row_size; j++) {
-								*ds = *ss;
-								ss++;
-								ds++;
-							}
+							Base::copyMemory(dr, sr, row_size);
 							sr += src_pitches[iPlane];
 							dr += dst_pitches[iPlane];
 						}
 					}
 				} else {
-					_BitmapData_copyPixels_Normal(width, height, src.format, src_planes, src_pitches, dst.format, dst_planes, dst_pitches);
+					if (!(_BitmapData_copyPixels_Normal_Kernel(width, height, src.format, src_planes, src_pitches, dst.format, dst_planes, dst_pitches))) {
+						_BitmapData_copyPixels_Normal(width, height, src.format, src_planes, src_pitches, dst.format, dst_planes, dst_pitches);
+					}
 				}
 			}
 		}
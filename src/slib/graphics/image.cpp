@@ -9,13 +9,25 @@
  */
 
 #include "slib/graphics/image.h"
+#include "slib/graphics/jpeg.h"
 
 #include "slib/core/file.h"
 #include "slib/core/asset.h"
 #include "slib/core/scoped.h"
+#include "slib/core/thread_pool.h"
+#include "slib/core/event.h"
+#include "slib/core/system.h"
 
 #include "image_stb.h"
 
+#if defined(__SSE2__) || defined(SLIB_ARCH_IS_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#	define _IMAGE_RESAMPLE_USE_SSE2
+#	include <emmintrin.h>
+#elif (defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(SLIB_ARCH_IS_ARM64)) && !defined(__ARM_BIG_ENDIAN)
+#	define _IMAGE_RESAMPLE_USE_NEON
+#	include <arm_neon.h>
+#endif
+
 namespace slib
 {
 
@@ -440,520 +452,6 @@ namespace slib
 		
 	};
 
-	struct _ImageStretch_FilterParam
-	{
-		sl_bool flagBox;
-		float filterSize;
-	};
-
-	class _ImageStretch_Smooth_LinearFilter
-	{
-	public:
-		SLIB_INLINE static void getColorAt(Color& _out, const Color* colors, float fx, float fy, sl_uint32 stride, const _ImageStretch_FilterParam& px, const _ImageStretch_FilterParam& py)
-		{
-			const Color& c00 = *colors;
-			const Color& c01 = colors[1];
-			const Color& c10 = colors[stride];
-			const Color& c11 = colors[stride + 1];
-			float sx = 1 - fx;
-			float ex = fx;
-			float sy = 1 - fy;
-			float ey = fy;
-			float f00 = sx * sy;
-			float f01 = ex * sy;
-			float f10 = sx * ey;
-			float f11 = ex * ey;
-			float r = (float)(c00.r) * f00 + (float)(c01.r) * f01 + (float)(c10.r) * f10 + (float)(c11.r) * f11;
-			float g = (float)(c00.g) * f00 + (float)(c01.g) * f01 + (float)(c10.g) * f10 + (float)(c11.g) * f11;
-			float b = (float)(c00.b) * f00 + (float)(c01.b) * f01 + (float)(c10.b) * f10 + (float)(c11.b) * f11;
-			float a = (float)(c00.a) * f00 + (float)(c01.a) * f01 + (float)(c10.a) * f10 + (float)(c11.a) * f11;
-			_out.r = (sl_uint8)(r);
-			_out.g = (sl_uint8)(g);
-			_out.b = (sl_uint8)(b);
-			_out.a = (sl_uint8)(a);
-		}
-		
-		SLIB_INLINE static void getColorAtX(Color& _out, const Color* colors, float fx, const _ImageStretch_FilterParam& px)
-		{
-			const Color& c0 = *colors;
-			const Color& c1 = colors[1];
-			float f0 = 1 - fx;
-			float f1 = fx;
-			float r = (float)(c0.r) * f0 + (float)(c1.r) * f1;
-			float g = (float)(c0.g) * f0 + (float)(c1.g) * f1;
-			float b = (float)(c0.b) * f0 + (float)(c1.b) * f1;
-			float a = (float)(c0.a) * f0 + (float)(c1.a) * f1;
-			_out.r = (sl_uint8)(r);
-			_out.g = (sl_uint8)(g);
-			_out.b = (sl_uint8)(b);
-			_out.a = (sl_uint8)(a);
-		}
-		
-		SLIB_INLINE static void getColorAtY(Color& _out, const Color* colors, float fy, sl_uint32 stride, const _ImageStretch_FilterParam& py)
-		{
-			const Color& c0 = *colors;
-			const Color& c1 = colors[stride];
-			float f0 = 1 - fy;
-			float f1 = fy;
-			float r = (float)(c0.r) * f0 + (float)(c1.r) * f1;
-			float g = (float)(c0.g) * f0 + (float)(c1.g) * f1;
-			float b = (float)(c0.b) * f0 + (float)(c1.b) * f1;
-			float a = (float)(c0.a) * f0 + (float)(c1.a) * f1;
-			_out.r = (sl_uint8)(r);
-			_out.g = (sl_uint8)(g);
-			_out.b = (sl_uint8)(b);
-			_out.a = (sl_uint8)(a);
-		}
-
-	};
-
-	class _ImageStretch_Smooth_BoxFilter
-	{
-	public:
-		SLIB_INLINE static void prepareFilter(float f, const _ImageStretch_FilterParam& p, float& s, float& e, int& n, float& area)
-		{
-			if (p.flagBox) {
-				s = 1 - f;
-				e = f + p.filterSize; // p.filterSize > 1
-				n = (int)(e - 0.0001);
-				e -= (float)n;
-				n -= 1;
-				area = p.filterSize;
-			} else {
-				s = 1 - f;
-				e = f;
-				n = 0;
-				area = 1;
-			}
-		}
-		
-		SLIB_INLINE static void getColorAt(Color& _out, const Color* colors, float fx, float fy, sl_uint32 stride, const _ImageStretch_FilterParam& px, const _ImageStretch_FilterParam& py)
-		{
-			float sx, ex, ax; int nx;
-			prepareFilter(fx, px, sx, ex, nx, ax);
-			float sy, ey, ay; int ny;
-			prepareFilter(fy, py, sy, ey, ny, ay);
-			int ix, iy;
-			float r = sx * (float)(colors[0].r) + ex * (float)(colors[nx + 1].r);
-			float g = sx * (float)(colors[0].g) + ex * (float)(colors[nx + 1].g);
-			float b = sx * (float)(colors[0].b) + ex * (float)(colors[nx + 1].b);
-			float a = sx * (float)(colors[0].a) + ex * (float)(colors[nx + 1].a);
-			for (ix = 0; ix < nx; ix++) {
-				r += (float)(colors[1 + ix].r);
-				g += (float)(colors[1 + ix].g);
-				b += (float)(colors[1 + ix].b);
-				a += (float)(colors[1 + ix].a);
-			}
-			r *= sy;
-			g *= sy;
-			b *= sy;
-			a *= sy;
-			colors += stride;
-			for (iy = 0; iy < ny; iy++) {
-				r += sx * (float)(colors[0].r) + ex * (float)(colors[nx + 1].r);
-				g += sx * (float)(colors[0].g) + ex * (float)(colors[nx + 1].g);
-				b += sx * (float)(colors[0].b) + ex * (float)(colors[nx + 1].b);
-				a += sx * (float)(colors[0].a) + ex * (float)(colors[nx + 1].a);
-				for (ix = 0; ix < nx; ix++) {
-					r += (float)(colors[1 + ix].r);
-					g += (float)(colors[1 + ix].g);
-					b += (float)(colors[1 + ix].b);
-					a += (float)(colors[1 + ix].a);
-				}
-				colors += stride;
-			}
-			r += ey * (sx * (float)(colors[0].r) + ex * (float)(colors[nx + 1].r));
-			g += ey * (sx * (float)(colors[0].g) + ex * (float)(colors[nx + 1].g));
-			b += ey * (sx * (float)(colors[0].b) + ex * (float)(colors[nx + 1].b));
-			a += ey * (sx * (float)(colors[0].a) + ex * (float)(colors[nx + 1].a));
-			for (ix = 0; ix < nx; ix++) {
-				r += ey * (float)(colors[1 + ix].r);
-				g += ey * (float)(colors[1 + ix].g);
-				b += ey * (float)(colors[1 + ix].b);
-				a += ey * (float)(colors[1 + ix].a);
-			}
-			float area = ax * ay;
-			_out.r = (sl_uint8)(r / area);
-			_out.g = (sl_uint8)(g / area);
-			_out.b = (sl_uint8)(b / area);
-			_out.a = (sl_uint8)(a / area);
-		}
-		
-		SLIB_INLINE static void getColorAtX(Color& _out, const Color* colors, float fx, const _ImageStretch_FilterParam& px)
-		{
-			float sx, ex, ax; int nx;
-			prepareFilter(fx, px, sx, ex, nx, ax);
-			int ix;
-			float r = sx * (float)(colors[0].r) + ex * (float)(colors[nx + 1].r);
-			float g = sx * (float)(colors[0].g) + ex * (float)(colors[nx + 1].g);
-			float b = sx * (float)(colors[0].b) + ex * (float)(colors[nx + 1].b);
-			float a = sx * (float)(colors[0].a) + ex * (float)(colors[nx + 1].a);
-			for (ix = 0; ix < nx; ix++) {
-				r += (float)(colors[1 + ix].r);
-				g += (float)(colors[1 + ix].g);
-				b += (float)(colors[1 + ix].b);
-				a += (float)(colors[1 + ix].a);
-			}
-			_out.r = (sl_uint8)(r / ax);
-			_out.g = (sl_uint8)(g / ax);
-			_out.b = (sl_uint8)(b / ax);
-			_out.a = (sl_uint8)(a / ax);
-		}
-		
-		SLIB_INLINE static void getColorAtY(Color& _out, const Color* colors, float fy, sl_uint32 stride, const _ImageStretch_FilterParam& py)
-		{
-			float sy, ey, ay; int ny;
-			prepareFilter(fy, py, sy, ey, ny, ay);
-			int iy;
-			float r = sy * (float)(colors[0].r);
-			float g = sy * (float)(colors[0].g);
-			float b = sy * (float)(colors[0].b);
-			float a = sy * (float)(colors[0].a);
-			colors += stride;
-			for (iy = 0; iy < ny; iy++) {
-				r += (float)(colors[0].r);
-				g += (float)(colors[0].g);
-				b += (float)(colors[0].b);
-				a += (float)(colors[0].a);
-				colors += stride;
-			}
-			r += ey * (float)(colors[0].r);
-			g += ey * (float)(colors[0].g);
-			b += ey * (float)(colors[0].b);
-			a += ey * (float)(colors[0].a);
-			_out.r = (sl_uint8)(r / ay);
-			_out.g = (sl_uint8)(g / ay);
-			_out.b = (sl_uint8)(b / ay);
-			_out.a = (sl_uint8)(a / ay);
-		}
-		
-	};
-
-	SLIB_INLINE static void _ImageStretch_Smooth_Prepare(sl_int32 sw, sl_int32 dw, float& step, float& sx_start, sl_int32& dx_start, sl_int32& dx_end, _ImageStretch_FilterParam& param)
-	{
-		if (sw >= dw) {
-			step = (float)(sw) / (float)(dw);
-			param.flagBox = sl_true;
-			param.filterSize = step;
-			sx_start = 0;
-			dx_start = 0;
-			dx_end = dw;
-		} else {
-			step = (float)(sw - 1) / (float)(dw - 1);
-			param.flagBox = sl_false;
-			param.filterSize = 1;
-			sx_start = step;
-			dx_start = 1;
-			dx_end = dw - 1;
-		}
-	}
-
-	template <class FILTER>
-	class _ImageStretch_Smooth
-	{
-	public:
-		template <class BLEND_OP>
-		static void stretchX(ImageDesc& dst, const ImageDesc& src)
-		{
-			sl_int32 sw = src.width;
-			sl_int32 dw = dst.width;
-			float sx_step, sx_start;
-			sl_int32 isx, dx_start, dx_end;
-			_ImageStretch_FilterParam px;
-			_ImageStretch_Smooth_Prepare(sw, dw, sx_step, sx_start, dx_start, dx_end, px);
-			
-			sl_int32 dx, dy;
-			sl_int32 dh = dst.height;
-			float sx;
-			
-			Color* colorsDst;
-			const Color* colorsSrc;
-			Color color;
-			
-			if (dx_start) {
-				// left
-				colorsDst = dst.colors;
-				colorsSrc = src.colors;
-				for (dy = 0; dy < dh; dy++) {
-					BLEND_OP::blend(*colorsDst, *colorsSrc);
-					colorsDst += dst.stride;
-					colorsSrc += src.stride;
-				}
-				// right
-				colorsDst = dst.colors + (dw - 1);
-				colorsSrc = src.colors + (sw - 1);
-				for (dy = 0; dy < dh; dy++) {
-					BLEND_OP::blend(*colorsDst, *colorsSrc);
-					colorsDst += dst.stride;
-					colorsSrc += src.stride;
-				}
-			}
-			
-			colorsDst = dst.colors;
-			colorsSrc = src.colors;
-			for (dy = 0; dy < dh; dy++) {
-				for (dx = dx_start; dx < dx_end; dx++) {
-					sx = sx_start + (float)(dx) * sx_step;
-					isx = (sl_int32)sx;
-					FILTER::getColorAtX(color, colorsSrc + isx, sx - (float)isx, px);
-					BLEND_OP::blend(colorsDst[dx], color);
-				}
-				colorsDst += dst.stride;
-				colorsSrc += src.stride;
-			}
-		}
-		
-		template <class BLEND_OP>
-		static void stretchY(ImageDesc& dst, const ImageDesc& src)
-		{
-			sl_int32 sh = src.height;
-			sl_int32 dh = dst.height;
-			float sy_step, sy_start;
-			sl_int32 isy, dy_start, dy_end;
-			_ImageStretch_FilterParam py;
-			_ImageStretch_Smooth_Prepare(sh, dh, sy_step, sy_start, dy_start, dy_end, py);
-			
-			sl_int32 dx, dy;
-			sl_int32 dw = dst.width;
-			float sy;
-			
-			Color* colorsDst;
-			const Color* colorsSrc;
-			Color color;
-			
-			if (dy_start) {
-				// top
-				colorsDst = dst.colors;
-				colorsSrc = src.colors;
-				for (dx = 0; dx < dw; dx++) {
-					BLEND_OP::blend(colorsDst[dx], colorsSrc[dx]);
-				}
-				// bottom
-				colorsDst = dst.colors + (sl_uint32)(dh - 1) * dst.stride;
-				colorsSrc = src.colors + (sl_uint32)(sh - 1) * src.stride;
-				for (dx = 0; dx < dw; dx++) {
-					BLEND_OP::blend(colorsDst[dx], colorsSrc[dx]);
-				}
-			}
-			
-			colorsDst = dst.colors + dy_start * dst.stride;
-			colorsSrc = src.colors;
-			for (dy = dy_start; dy < dy_end; dy++) {
-				sy = sy_start + (float)(dy) * sy_step;
-				isy = (sl_int32)sy;
-				float fsy = sy - (float)isy;
-				const Color* lineSrc = colorsSrc + (sl_uint32)isy * src.stride;
-				for (dx = 0; dx < dw; dx++) {
-					FILTER::getColorAtY(color, lineSrc + dx, fsy, src.stride, py);
-					BLEND_OP::blend(colorsDst[dx], color);
-				}
-				colorsDst += dst.stride;
-			}
-		}
-		
-		template <class BLEND_OP>
-		static void stretchOneRowSrc(ImageDesc& dst, const ImageDesc& src)
-		{
-			sl_int32 sw = src.width;
-			sl_int32 dw = dst.width;
-			float sx_step, sx_start;
-			sl_int32 isx, dx_start, dx_end;
-			_ImageStretch_FilterParam px;
-			_ImageStretch_Smooth_Prepare(sw, dw, sx_step, sx_start, dx_start, dx_end, px);
-			
-			sl_int32 dx, dy;
-			sl_int32 dh = dst.height;
-			float sx;
-			
-			Color* colorsDst;
-			Color color;
-			
-			if (dx_start) {
-				// left
-				colorsDst = dst.colors;
-				color = *(src.colors);
-				for (dy = 0; dy < dh; dy++) {
-					BLEND_OP::blend(*colorsDst, color);
-					colorsDst += dst.stride;
-				}
-				// right
-				colorsDst = dst.colors + (dw - 1);
-				color = *(src.colors + (sw - 1));
-				for (dy = 0; dy < dh; dy++) {
-					BLEND_OP::blend(*colorsDst, color);
-					colorsDst += dst.stride;
-				}
-			}
-			
-			for (dx = dx_start; dx < dx_end; dx++) {
-				sx = sx_start + (float)(dx) * sx_step;
-				isx = (sl_int32)sx;
-				FILTER::getColorAtX(color, src.colors + isx, sx - (float)isx, px);
-				colorsDst = dst.colors + dx;
-				for (dy = 0; dy < dh; dy++) {
-					BLEND_OP::blend(*(colorsDst), color);
-					colorsDst += dst.stride;
-				}
-			}
-		}
-		
-		template <class BLEND_OP>
-		static void stretchOneColSrc(ImageDesc& dst, const ImageDesc& src)
-		{
-			sl_int32 sh = src.height;
-			sl_int32 dh = dst.height;
-			float sy_step, sy_start;
-			sl_int32 isy, dy_start, dy_end;
-			_ImageStretch_FilterParam py;
-			_ImageStretch_Smooth_Prepare(sh, dh, sy_step, sy_start, dy_start, dy_end, py);
-			
-			sl_int32 dx, dy;
-			sl_int32 dw = dst.width;
-			float sy;
-			
-			Color* colorsDst;
-			Color color;
-			
-			if (dy_start) {
-				// top
-				colorsDst = dst.colors;
-				color = *(src.colors);
-				for (dx = 0; dx < dw; dx++) {
-					BLEND_OP::blend(colorsDst[dx], color);
-				}
-				// bottom
-				colorsDst = dst.colors + (dh - 1) * dst.stride;
-				color = *(src.colors + (sh - 1) * src.stride);
-				for (dx = 0; dx < dw; dx++) {
-					BLEND_OP::blend(colorsDst[dx], color);
-				}
-			}
-			
-			colorsDst = dst.colors + dy_start * dst.stride;
-			for (dy = dy_start; dy < dy_end; dy++) {
-				sy = sy_start + (float)(dy) * sy_step;
-				isy = (sl_int32)sy;
-				float fsy = sy - (float)isy;
-				FILTER::getColorAtY(color, src.colors + isy * src.stride, fsy, src.stride, py);
-				for (dx = 0; dx < dw; dx++) {
-					BLEND_OP::blend(colorsDst[dx], color);
-				}
-				colorsDst += dst.stride;
-			}
-		}
-		
-		template <class BLEND_OP>
-		static void stretch(ImageDesc& dst, const ImageDesc& src)
-		{
-			if (src.width == dst.width) {
-				stretchY<BLEND_OP>(dst, src);
-				return;
-			}
-			if (src.height == dst.height) {
-				stretchX<BLEND_OP>(dst, src);
-				return;
-			}
-			if (src.width == 1) {
-				stretchOneColSrc<BLEND_OP>(dst, src);
-				return;
-			}
-			if (src.height == 1) {
-				stretchOneRowSrc<BLEND_OP>(dst, src);
-				return;
-			}
-
-			sl_int32 sw = src.width;
-			sl_int32 dw = dst.width;
-			float sx_step, sx_start;
-			sl_int32 isx, dx_start, dx_end;
-			_ImageStretch_FilterParam px;
-			_ImageStretch_Smooth_Prepare(sw, dw, sx_step, sx_start, dx_start, dx_end, px);
-			
-			sl_int32 sh = src.height;
-			sl_int32 dh = dst.height;
-			float sy_step, sy_start;
-			sl_int32 isy, dy_start, dy_end;
-			_ImageStretch_FilterParam py;
-			_ImageStretch_Smooth_Prepare(sh, dh, sy_step, sy_start, dy_start, dy_end, py);
-			
-			sl_int32 dx, dy;
-			float sx, sy;
-			
-			Color color;
-			Color* colorsDst;
-			const Color* colorsSrc;
-			
-			// 4-corners
-			if (dx_start && dy_start) {
-				colorsDst = dst.colors;
-				colorsSrc = src.colors;
-				BLEND_OP::blend(colorsDst[0], colorsSrc[0]);
-				BLEND_OP::blend(colorsDst[dw - 1], colorsSrc[sw - 1]);
-				BLEND_OP::blend(colorsDst[(dh - 1) * dst.stride], colorsSrc[(sh - 1) * src.stride]);
-				BLEND_OP::blend(colorsDst[(dh - 1) * dst.stride + dw - 1], colorsSrc[(sh - 1) * src.stride + sw - 1]);
-			}
-			
-			if (dy_start) {
-				// top
-				colorsDst = dst.colors;
-				colorsSrc = src.colors;
-				for (dx = dx_start; dx < dx_end; dx++) {
-					sx = sx_start + (float)(dx) * sx_step;
-					isx = (sl_int32)sx;
-					FILTER::getColorAtX(color, colorsSrc + isx, sx - (float)isx, px);
-					BLEND_OP::blend(colorsDst[dx], color);
-				}
-				// bottom
-				colorsDst = dst.colors + (dh - 1) * dst.stride;
-				colorsSrc = src.colors + (sh - 1) * src.stride;
-				for (dx = dx_start; dx < dx_end; dx++) {
-					sx = sx_start + (float)(dx) * sx_step;
-					isx = (sl_int32)sx;
-					FILTER::getColorAtX(color, colorsSrc + isx, sx - (float)isx, px);
-					BLEND_OP::blend(colorsDst[dx], color);
-				}
-			}
-			if (dx_start) {
-				// left
-				colorsDst = dst.colors + dy_start * dst.stride;
-				colorsSrc = src.colors;
-				for (dy = dy_start; dy < dy_end; dy++) {
-					sy = sy_start + (float)(dy) * sy_step;
-					isy = (sl_int32)sy;
-					FILTER::getColorAtY(color, colorsSrc + isy * src.stride, sy - (float)isy, src.stride, py);
-					BLEND_OP::blend(*colorsDst, color);
-					colorsDst += dst.stride;
-				}
-				// right
-				colorsDst = dst.colors + (dy_start * dst.stride + dw - 1);
-				colorsSrc = src.colors + (sw - 1);
-				for (dy = dy_start; dy < dy_end; dy++) {
-					sy = sy_start + (float)(dy) * sy_step;
-					isy = (sl_int32)sy;
-					FILTER::getColorAtY(color, colorsSrc + isy * src.stride, sy - (float)isy, src.stride, py);
-					BLEND_OP::blend(*colorsDst, color);
-					colorsDst += dst.stride;
-				}
-			}
-			
-			colorsDst = dst.colors + dy_start * dst.stride;
-			colorsSrc = src.colors;
-			for (dy = dy_start; dy < dy_end; dy++) {
-				sy = sy_start + (float)(dy) * sy_step;
-				isy = (sl_int32)sy;
-				float fsy = sy - (float)isy;
-				const Color* lineSrc = colorsSrc + isy * src.stride;
-				for (dx = dx_start; dx < dx_end; dx++) {
-					sx = sx_start + (float)(dx) * sx_step;
-					isx = (sl_int32)sx;
-					FILTER::getColorAt(color, lineSrc + isx, sx - (float)isx, fsy, src.stride, px, py);
-					BLEND_OP::blend(colorsDst[dx], color);
-				}
-				colorsDst += dst.stride;
-			}
-		}
-	};
-
 	class _ImageStretch_Smooth_IntBox
 	{
 	public:
@@ -1078,7 +576,580 @@ namespace slib
 		}
 	};
 
+/*
+	Separable resampler used by the smooth stretch modes.
+
+	Each axis is converted to a list of integer filter coefficients, then the rows are filtered horizontally into 8-bit intermediate rows and filtered vertically.
+	The output rows are divided into bands, and every band recomputes the intermediate rows it needs.
+	So the result of a pixel does not depend on how the bands are distributed to the threads.
+*/
+
+#define _IMAGE_RESAMPLE_PRECISION 14
+#define _IMAGE_RESAMPLE_ONE (1 << _IMAGE_RESAMPLE_PRECISION)
+#define _IMAGE_RESAMPLE_ROUND (1 << (_IMAGE_RESAMPLE_PRECISION - 1))
+#define _IMAGE_RESAMPLE_BAND_MIN_ROWS 16
+#define _IMAGE_RESAMPLE_PARALLEL_MIN_PIXELS 65536
+
+	enum class _ImageResample_Filter
+	{
+		// samples at `dx * sw / dw`, the filter of `StretchMode::Linear` when downscaling
+		Linear,
+		// maps the first and the last pixels to each other, the filter of upscaling
+		LinearAligned,
+		// averages the covered area
+		Box,
+		Lanczos3
+	};
+
+	// every output pixel reads `nTaps` consecutive source pixels from `starts[i]`, which is in the range of the source
+	class _ImageResample_Axis
+	{
+	public:
+		sl_uint32 nTaps;
+		sl_int32* starts;
+		sl_int16* weights;
+		Memory memory;
+
+	public:
+		_ImageResample_Axis(): nTaps(0), starts(sl_null), weights(sl_null)
+		{
+		}
+
+	public:
+		static double lanczos3(double x)
+		{
+			if (x < 0) {
+				x = -x;
+			}
+			if (x < 1e-8) {
+				return 1;
+			}
+			if (x >= 3) {
+				return 0;
+			}
+			x *= SLIB_PI_LONG;
+			return 3 * Math::sin(x) * Math::sin(x / 3) / (x * x);
+		}
+
+		sl_bool prepare(sl_uint32 sw, sl_uint32 dw, _ImageResample_Filter filter)
+		{
+			double scale = (double)sw / (double)dw;
+			double support;
+			switch (filter) {
+				case _ImageResample_Filter::Box:
+					support = scale / 2 + 1;
+					break;
+				case _ImageResample_Filter::Lanczos3:
+					support = 3 * (scale > 1 ? scale : 1);
+					break;
+				default:
+					support = 1;
+					break;
+			}
+			sl_uint32 nMaxRaw = (sl_uint32)(2 * support) + 3;
+			if (nMaxRaw > sw) {
+				nMaxRaw = sw;
+			}
+			SLIB_SCOPED_BUFFER(double, 64, raw, nMaxRaw);
+			if (!raw) {
+				return sl_false;
+			}
+			Memory memRaw = Memory::create((sl_size)dw * (nMaxRaw * sizeof(sl_int16) + 2 * sizeof(sl_int32)));
+			if (memRaw.isNull()) {
+				return sl_false;
+			}
+			sl_int16* rawWeights = (sl_int16*)(memRaw.getData());
+			sl_int32* rawStarts = (sl_int32*)(rawWeights + (sl_size)dw * nMaxRaw);
+			sl_int32* rawCounts = rawStarts + dw;
+			nTaps = 1;
+			for (sl_uint32 i = 0; i < dw; i++) {
+				for (sl_uint32 k = 0; k < nMaxRaw; k++) {
+					raw[k] = 0;
+				}
+				// contributions of the source pixels, accumulated on the edge pixels when out of range
+				sl_int32 lo, hi;
+				switch (filter) {
+					case _ImageResample_Filter::Linear:
+					case _ImageResample_Filter::LinearAligned:
+						{
+							double pos;
+							if (filter == _ImageResample_Filter::Linear) {
+								pos = (double)i * scale;
+							} else {
+								pos = dw > 1 ? (double)i * (double)(sw - 1) / (double)(dw - 1) : 0;
+							}
+							lo = (sl_int32)pos;
+							if (lo > (sl_int32)sw - 1) {
+								lo = (sl_int32)sw - 1;
+							}
+							double f = pos - (double)lo;
+							hi = lo + 1 < (sl_int32)sw ? lo + 1 : lo;
+							raw[0] += 1 - f;
+							raw[hi - lo] += f;
+							break;
+						}
+					case _ImageResample_Filter::Box:
+						{
+							double b = (double)i * scale;
+							double e = b + scale;
+							lo = (sl_int32)b;
+							hi = (sl_int32)Math::ceil(e) - 1;
+							if (hi > (sl_int32)sw - 1) {
+								hi = (sl_int32)sw - 1;
+							}
+							if (hi < lo) {
+								hi = lo;
+							}
+							for (sl_int32 j = lo; j <= hi; j++) {
+								double s = (double)j > b ? (double)j : b;
+								double t = (double)(j + 1) < e ? (double)(j + 1) : e;
+								if (t > s) {
+									raw[j - lo] += t - s;
+								}
+							}
+							break;
+						}
+					default:
+						{
+							double fscale = scale > 1 ? scale : 1;
+							double center = ((double)i + 0.5) * scale;
+							sl_int32 j0 = (sl_int32)Math::floor(center - support);
+							sl_int32 j1 = (sl_int32)Math::ceil(center + support);
+							lo = j0 < 0 ? 0 : j0;
+							hi = j1 > (sl_int32)sw - 1 ? (sl_int32)sw - 1 : j1;
+							if (hi - lo + 1 > (sl_int32)nMaxRaw) {
+								hi = lo + (sl_int32)nMaxRaw - 1;
+							}
+							for (sl_int32 j = j0; j <= j1; j++) {
+								double w = lanczos3(((double)j + 0.5 - center) / fscale);
+								sl_int32 k = Math::clamp(j, lo, hi) - lo;
+								raw[k] += w;
+							}
+							break;
+						}
+				}
+				// quantize, keeping the sum exactly one
+				sl_int32 n = hi - lo + 1;
+				double sum = 0;
+				for (sl_int32 k = 0; k < n; k++) {
+					sum += raw[k];
+				}
+				if (sum == 0) {
+					sum = 1;
+				}
+				sl_int16* w = rawWeights + (sl_size)i * nMaxRaw;
+				sl_int32 total = 0;
+				sl_int32 kMax = 0;
+				for (sl_int32 k = 0; k < n; k++) {
+					double v = raw[k] / sum * _IMAGE_RESAMPLE_ONE;
+					sl_int32 q = (sl_int32)(v < 0 ? v - 0.5 : v + 0.5);
+					w[k] = (sl_int16)q;
+					total += q;
+					if (raw[k] > raw[kMax]) {
+						kMax = k;
+					}
+				}
+				w[kMax] = (sl_int16)(w[kMax] + _IMAGE_RESAMPLE_ONE - total);
+				// trim zero weights
+				sl_int32 s = 0;
+				while (s < n - 1 && !(w[s])) {
+					s++;
+				}
+				while (n > s + 1 && !(w[n - 1])) {
+					n--;
+				}
+				rawStarts[i] = lo + s;
+				rawCounts[i] = n - s;
+				if (s) {
+					for (sl_int32 k = s; k < n; k++) {
+						w[k - s] = w[k];
+					}
+				}
+				if ((sl_uint32)(n - s) > nTaps) {
+					nTaps = n - s;
+				}
+			}
+			// align to `nTaps` taps
+			memory = Memory::create((sl_size)dw * (nTaps * sizeof(sl_int16) + sizeof(sl_int32)));
+			if (memory.isNull()) {
+				return sl_false;
+			}
+			starts = (sl_int32*)(memory.getData());
+			weights = (sl_int16*)(starts + dw);
+			for (sl_uint32 i = 0; i < dw; i++) {
+				sl_int32 start = rawStarts[i];
+				sl_int32 n = rawCounts[i];
+				sl_int32 startAligned = start;
+				if (startAligned + (sl_int32)nTaps > (sl_int32)sw) {
+					startAligned = (sl_int32)sw - (sl_int32)nTaps;
+				}
+				starts[i] = startAligned;
+				sl_int16* w = weights + (sl_size)i * nTaps;
+				const sl_int16* r = rawWeights + (sl_size)i * nMaxRaw;
+				for (sl_uint32 k = 0; k < nTaps; k++) {
+					sl_int32 t = startAligned + (sl_int32)k - start;
+					w[k] = (t >= 0 && t < n) ? r[t] : 0;
+				}
+			}
+			return sl_true;
+		}
+
+	};
+
+	SLIB_INLINE static sl_uint8 _ImageResample_clamp(sl_int32 v)
+	{
+		return (sl_uint8)(Math::clamp0_255((v + _IMAGE_RESAMPLE_ROUND) >> _IMAGE_RESAMPLE_PRECISION));
+	}
+
+	static void _ImageResample_filterRow(const Color* src, Color* dst, sl_uint32 dw, const _ImageResample_Axis& axis)
+	{
+		sl_uint32 nTaps = axis.nTaps;
+#if defined(_IMAGE_RESAMPLE_USE_SSE2)
+		__m128i zero = _mm_setzero_si128();
+		__m128i round = _mm_set1_epi32(_IMAGE_RESAMPLE_ROUND);
+#endif
+		for (sl_uint32 i = 0; i < dw; i++) {
+			const sl_uint8* s = (const sl_uint8*)(src + axis.starts[i]);
+			const sl_int16* w = axis.weights + (sl_size)i * nTaps;
+			sl_uint32 k = 0;
+#if defined(_IMAGE_RESAMPLE_USE_SSE2)
+			__m128i acc = _mm_setzero_si128();
+			for (; k + 2 <= nTaps; k += 2) {
+				// [r0 r1 g0 g1 b0 b1 a0 a1] * [w0 w1 ...]
+				__m128i p = _mm_unpacklo_epi8(_mm_cvtsi32_si128(*((const int*)(s + (k << 2)))), _mm_cvtsi32_si128(*((const int*)(s + (k << 2) + 4))));
+				p = _mm_unpacklo_epi8(p, zero);
+				acc = _mm_add_epi32(acc, _mm_madd_epi16(p, _mm_set1_epi32((sl_uint16)(w[k]) | ((sl_uint32)(sl_uint16)(w[k + 1]) << 16))));
+			}
+			if (k < nTaps) {
+				__m128i p = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(*((const int*)(s + (k << 2)))), zero), zero);
+				acc = _mm_add_epi32(acc, _mm_madd_epi16(p, _mm_set1_epi32((sl_uint16)(w[k]))));
+			}
+			acc = _mm_srai_epi32(_mm_add_epi32(acc, round), _IMAGE_RESAMPLE_PRECISION);
+			acc = _mm_packs_epi32(acc, acc);
+			*((int*)(dst + i)) = _mm_cvtsi128_si32(_mm_packus_epi16(acc, acc));
+#elif defined(_IMAGE_RESAMPLE_USE_NEON)
+			int32x4_t acc = vdupq_n_s32(0);
+			for (; k < nTaps; k++) {
+				int16x4_t p = vget_low_s16(vreinterpretq_s16_u16(vmovl_u8(vcreate_u8((sl_uint64)(*((const sl_uint32*)(s + (k << 2))))))));
+				acc = vmlal_n_s16(acc, p, w[k]);
+			}
+			int16x4_t v = vqmovn_s32(vrshrq_n_s32(acc, _IMAGE_RESAMPLE_PRECISION));
+			uint8x8_t c = vqmovun_s16(vcombine_s16(v, v));
+			*((sl_uint32*)(dst + i)) = vget_lane_u32(vreinterpret_u32_u8(c), 0);
+#else
+			sl_int32 acc[4] = {0, 0, 0, 0};
+			for (; k < nTaps; k++) {
+				sl_int32 f = w[k];
+				const sl_uint8* p = s + (k << 2);
+				acc[0] += (sl_int32)(p[0]) * f;
+				acc[1] += (sl_int32)(p[1]) * f;
+				acc[2] += (sl_int32)(p[2]) * f;
+				acc[3] += (sl_int32)(p[3]) * f;
+			}
+			sl_uint8* d = (sl_uint8*)(dst + i);
+			d[0] = _ImageResample_clamp(acc[0]);
+			d[1] = _ImageResample_clamp(acc[1]);
+			d[2] = _ImageResample_clamp(acc[2]);
+			d[3] = _ImageResample_clamp(acc[3]);
+#endif
+		}
+	}
+
+	// `rows` are the `nTaps` source rows of the output row
+	static void _ImageResample_filterColumn(const Color* const* rows, const sl_int16* w, sl_uint32 nTaps, Color* dst, sl_uint32 width)
+	{
+		sl_uint32 x = 0;
+		sl_uint32 k;
+#if defined(_IMAGE_RESAMPLE_USE_SSE2)
+		__m128i zero = _mm_setzero_si128();
+		__m128i round = _mm_set1_epi32(_IMAGE_RESAMPLE_ROUND);
+		for (; x + 4 <= width; x += 4) {
+			__m128i acc0 = _mm_setzero_si128();
+			__m128i acc1 = acc0, acc2 = acc0, acc3 = acc0;
+			for (k = 0; k + 2 <= nTaps; k += 2) {
+				__m128i a = _mm_loadu_si128((const __m128i*)(rows[k] + x));
+				__m128i b = _mm_loadu_si128((const __m128i*)(rows[k + 1] + x));
+				__m128i f = _mm_set1_epi32((sl_uint16)(w[k]) | ((sl_uint32)(sl_uint16)(w[k + 1]) << 16));
+				__m128i lo = _mm_unpacklo_epi8(a, b);
+				__m128i hi = _mm_unpackhi_epi8(a, b);
+				acc0 = _mm_add_epi32(acc0, _mm_madd_epi16(_mm_unpacklo_epi8(lo, zero), f));
+				acc1 = _mm_add_epi32(acc1, _mm_madd_epi16(_mm_unpackhi_epi8(lo, zero), f));
+				acc2 = _mm_add_epi32(acc2, _mm_madd_epi16(_mm_unpacklo_epi8(hi, zero), f));
+				acc3 = _mm_add_epi32(acc3, _mm_madd_epi16(_mm_unpackhi_epi8(hi, zero), f));
+			}
+			if (k < nTaps) {
+				__m128i a = _mm_loadu_si128((const __m128i*)(rows[k] + x));
+				__m128i f = _mm_set1_epi32((sl_uint16)(w[k]));
+				__m128i lo = _mm_unpacklo_epi8(a, zero);
+				__m128i hi = _mm_unpackhi_epi8(a, zero);
+				acc0 = _mm_add_epi32(acc0, _mm_madd_epi16(_mm_unpacklo_epi16(lo, zero), f));
+				acc1 = _mm_add_epi32(acc1, _mm_madd_epi16(_mm_unpackhi_epi16(lo, zero), f));
+				acc2 = _mm_add_epi32(acc2, _mm_madd_epi16(_mm_unpacklo_epi16(hi, zero), f));
+				acc3 = _mm_add_epi32(acc3, _mm_madd_epi16(_mm_unpackhi_epi16(hi, zero), f));
+			}
+			acc0 = _mm_srai_epi32(_mm_add_epi32(acc0, round), _IMAGE_RESAMPLE_PRECISION);
+			acc1 = _mm_srai_epi32(_mm_add_epi32(acc1, round), _IMAGE_RESAMPLE_PRECISION);
+			acc2 = _mm_srai_epi32(_mm_add_epi32(acc2, round), _IMAGE_RESAMPLE_PRECISION);
+			acc3 = _mm_srai_epi32(_mm_add_epi32(acc3, round), _IMAGE_RESAMPLE_PRECISION);
+			_mm_storeu_si128((__m128i*)(dst + x), _mm_packus_epi16(_mm_packs_epi32(acc0, acc1), _mm_packs_epi32(acc2, acc3)));
+		}
+#elif defined(_IMAGE_RESAMPLE_USE_NEON)
+		for (; x + 4 <= width; x += 4) {
+			int32x4_t acc0 = vdupq_n_s32(0);
+			int32x4_t acc1 = acc0, acc2 = acc0, acc3 = acc0;
+			for (k = 0; k < nTaps; k++) {
+				uint8x16_t a = vld1q_u8((const sl_uint8*)(rows[k] + x));
+				int16x8_t lo = vreinterpretq_s16_u16(vmovl_u8(vget_low_u8(a)));
+				int16x8_t hi = vreinterpretq_s16_u16(vmovl_u8(vget_high_u8(a)));
+				sl_int16 f = w[k];
+				acc0 = vmlal_n_s16(acc0, vget_low_s16(lo), f);
+				acc1 = vmlal_n_s16(acc1, vget_high_s16(lo), f);
+				acc2 = vmlal_n_s16(acc2, vget_low_s16(hi), f);
+				acc3 = vmlal_n_s16(acc3, vget_high_s16(hi), f);
+			}
+			int16x8_t lo = vcombine_s16(vqmovn_s32(vrshrq_n_s32(acc0, _IMAGE_RESAMPLE_PRECISION)), vqmovn_s32(vrshrq_n_s32(acc1, _IMAGE_RESAMPLE_PRECISION)));
+			int16x8_t hi = vcombine_s16(vqmovn_s32(vrshrq_n_s32(acc2, _IMAGE_RESAMPLE_PRECISION)), vqmovn_s32(vrshrq_n_s32(acc3, _IMAGE_RESAMPLE_PRECISION)));
+			vst1q_u8((sl_uint8*)(dst + x), vcombine_u8(vqmovun_s16(lo), vqmovun_s16(hi)));
+		}
+#endif
+		for (; x < width; x++) {
+			sl_int32 acc[4] = {0, 0, 0, 0};
+			for (k = 0; k < nTaps; k++) {
+				sl_int32 f = w[k];
+				const sl_uint8* p = (const sl_uint8*)(rows[k] + x);
+				acc[0] += (sl_int32)(p[0]) * f;
+				acc[1] += (sl_int32)(p[1]) * f;
+				acc[2] += (sl_int32)(p[2]) * f;
+				acc[3] += (sl_int32)(p[3]) * f;
+			}
+			sl_uint8* d = (sl_uint8*)(dst + x);
+			d[0] = _ImageResample_clamp(acc[0]);
+			d[1] = _ImageResample_clamp(acc[1]);
+			d[2] = _ImageResample_clamp(acc[2]);
+			d[3] = _ImageResample_clamp(acc[3]);
+		}
+	}
+
+	class _ImageResampler : public Referable
+	{
+	public:
+		ImageDesc dst;
+		ImageDesc src;
+		BlendMode blend;
+
+		sl_bool flagStretchX;
+		sl_bool flagStretchY;
+		_ImageResample_Axis axisX;
+		_ImageResample_Axis axisY;
+
+		sl_uint32 nRowsPerBand;
+		sl_int32 nBands;
+		sl_int32 indexNextBand;
+		sl_int32 nFinishedBands;
+		Ref<Event> eventFinished;
+
+	public:
+		static _ImageResample_Filter getFilter(StretchMode stretch, sl_uint32 sw, sl_uint32 dw)
+		{
+			if (stretch == StretchMode::Lanczos) {
+				return _ImageResample_Filter::Lanczos3;
+			}
+			if (sw < dw) {
+				return _ImageResample_Filter::LinearAligned;
+			}
+			if (stretch == StretchMode::Linear) {
+				return _ImageResample_Filter::Linear;
+			}
+			return _ImageResample_Filter::Box;
+		}
+
+		sl_bool prepare(ImageDesc& _dst, const ImageDesc& _src, BlendMode _blend, StretchMode stretch)
+		{
+			dst = _dst;
+			src = _src;
+			blend = _blend;
+			flagStretchX = src.width != dst.width;
+			flagStretchY = src.height != dst.height;
+			if (flagStretchX) {
+				if (!(axisX.prepare(src.width, dst.width, getFilter(stretch, src.width, dst.width)))) {
+					return sl_false;
+				}
+			}
+			if (flagStretchY) {
+				if (!(axisY.prepare(src.height, dst.height, getFilter(stretch, src.height, dst.height)))) {
+					return sl_false;
+				}
+			}
+			nRowsPerBand = dst.height;
+			nBands = 1;
+			indexNextBand = 0;
+			nFinishedBands = 0;
+			return sl_true;
+		}
+
+		void writeRow(Color* dst, const Color* src, sl_uint32 width)
+		{
+			if (blend == BlendMode::SrcAlpha) {
+				for (sl_uint32 i = 0; i < width; i++) {
+					_ImageBlend_SrcAlpha::blend(dst[i], src[i]);
+				}
+			} else {
+				Base::copyMemory(dst, src, width << 2);
+			}
+		}
+
+		void runBand(sl_uint32 dy0, sl_uint32 dy1)
+		{
+			sl_uint32 dw = dst.width;
+			sl_bool flagDirect = blend == BlendMode::Copy;
+			Color* rowOut = sl_null;
+			Memory memRow;
+			if (!flagDirect) {
+				memRow = Memory::create(dw << 2);
+				if (memRow.isNull()) {
+					return;
+				}
+				rowOut = (Color*)(memRow.getData());
+			}
+			if (!flagStretchY) {
+				for (sl_uint32 dy = dy0; dy < dy1; dy++) {
+					Color* d = dst.colors + (sl_reg)dy * dst.stride;
+					const Color* s = src.colors + (sl_reg)dy * src.stride;
+					if (flagDirect) {
+						_ImageResample_filterRow(s, d, dw, axisX);
+					} else {
+						_ImageResample_filterRow(s, rowOut, dw, axisX);
+						writeRow(d, rowOut, dw);
+					}
+				}
+				return;
+			}
+			sl_uint32 nTaps = axisY.nTaps;
+			SLIB_SCOPED_BUFFER(const Color*, 64, taps, nTaps);
+			if (!taps) {
+				return;
+			}
+			// ring of the horizontally filtered rows, because the windows of the output rows only move forward
+			Color* ring = sl_null;
+			Memory memRing;
+			if (flagStretchX) {
+				memRing = Memory::create((sl_size)nTaps * dw * 4);
+				if (memRing.isNull()) {
+					return;
+				}
+				ring = (Color*)(memRing.getData());
+			}
+			sl_int32 syNext = 0;
+			for (sl_uint32 dy = dy0; dy < dy1; dy++) {
+				sl_int32 start = axisY.starts[dy];
+				if (ring) {
+					sl_int32 end = start + (sl_int32)nTaps;
+					if (syNext < start) {
+						syNext = start;
+					}
+					for (; syNext < end; syNext++) {
+						_ImageResample_filterRow(src.colors + (sl_reg)syNext * src.stride, ring + (sl_size)((sl_uint32)syNext % nTaps) * dw, dw, axisX);
+					}
+					for (sl_uint32 k = 0; k < nTaps; k++) {
+						taps[k] = ring + (sl_size)(((sl_uint32)start + k) % nTaps) * dw;
+					}
+				} else {
+					for (sl_uint32 k = 0; k < nTaps; k++) {
+						taps[k] = src.colors + (sl_reg)(start + (sl_int32)k) * src.stride;
+					}
+				}
+				const sl_int16* w = axisY.weights + (sl_size)dy * nTaps;
+				Color* d = dst.colors + (sl_reg)dy * dst.stride;
+				if (flagDirect) {
+					_ImageResample_filterColumn(taps, w, nTaps, d, dw);
+				} else {
+					_ImageResample_filterColumn(taps, w, nTaps, rowOut, dw);
+					writeRow(d, rowOut, dw);
+				}
+			}
+		}
+
+		void runBands()
+		{
+			for (;;) {
+				sl_int32 index = Base::interlockedIncrement32(&indexNextBand) - 1;
+				if (index >= nBands) {
+					return;
+				}
+				sl_uint32 dy0 = (sl_uint32)index * nRowsPerBand;
+				sl_uint32 dy1 = dy0 + nRowsPerBand;
+				if (dy1 > dst.height) {
+					dy1 = dst.height;
+				}
+				runBand(dy0, dy1);
+				if (Base::interlockedIncrement32(&nFinishedBands) == nBands) {
+					if (eventFinished.isNotNull()) {
+						eventFinished->set();
+					}
+				}
+			}
+		}
+
+		void run(const Ref<ThreadPool>& threadPool)
+		{
+			sl_uint32 nWorkers = 0;
+			if (threadPool.isNotNull() && (sl_uint64)(dst.width) * dst.height >= _IMAGE_RESAMPLE_PARALLEL_MIN_PIXELS) {
+				nWorkers = System::getProcessorsCount();
+			}
+			if (nWorkers > 1) {
+				// a few bands per thread to balance the load
+				sl_uint32 n = nWorkers * 4;
+				nRowsPerBand = (dst.height + n - 1) / n;
+				if (nRowsPerBand < _IMAGE_RESAMPLE_BAND_MIN_ROWS) {
+					nRowsPerBand = _IMAGE_RESAMPLE_BAND_MIN_ROWS;
+				}
+				nBands = (sl_int32)((dst.height + nRowsPerBand - 1) / nRowsPerBand);
+				if ((sl_uint32)nBands < nWorkers) {
+					nWorkers = nBands;
+				}
+			}
+			if (nWorkers > 1) {
+				eventFinished = Event::create();
+			}
+			if (eventFinished.isNull()) {
+				nRowsPerBand = dst.height;
+				nBands = 1;
+				runBands();
+				return;
+			}
+			// the current thread also runs the bands, so the result comes even if the pool is busy
+			for (sl_uint32 i = 1; i < nWorkers; i++) {
+				if (!(threadPool->addTask(SLIB_FUNCTION_REF(_ImageResampler, runBands, this)))) {
+					break;
+				}
+			}
+			runBands();
+			while (Base::interlockedAdd32(&nFinishedBands, 0) < nBands) {
+				eventFinished->wait();
+			}
+		}
+
+	};
+
+	static sl_bool _ImageResample_stretch(ImageDesc& dst, const ImageDesc& src, BlendMode blend, StretchMode stretch, const Ref<ThreadPool>& threadPool)
+	{
+		Ref<_ImageResampler> resampler = new _ImageResampler;
+		if (resampler.isNull()) {
+			return sl_false;
+		}
+		if (!(resampler->prepare(dst, src, blend, stretch))) {
+			return sl_false;
+		}
+		resampler->run(threadPool);
+		return sl_true;
+	}
+
 	void Image::draw(ImageDesc& dst, const ImageDesc& src, BlendMode blend, StretchMode stretch)
+	{
+		draw(dst, src, blend, stretch, sl_null);
+	}
+
+	void Image::draw(ImageDesc& dst, const ImageDesc& src, BlendMode blend, StretchMode stretch, const Ref<ThreadPool>& threadPool)
 	{
 		if (src.width == 0 || src.height == 0 || src.stride == 0 || src.colors == sl_null) {
 			return;
@@ -1096,19 +1167,15 @@ namespace slib
 		}
 		if (stretch == StretchMode::Nearest) {
 			_ImageStretch::template stretch<_ImageStretch_Nearest>(dst, src, blend);
-		} else if (stretch == StretchMode::Linear) {
-			_ImageStretch::template stretch< _ImageStretch_Smooth<_ImageStretch_Smooth_LinearFilter> >(dst, src, blend);
-		} else {
-			if (src.width <= dst.width && src.height <= dst.height) {
-				_ImageStretch::template stretch< _ImageStretch_Smooth<_ImageStretch_Smooth_LinearFilter> >(dst, src, blend);
-				return;
-			}
+			return;
+		}
+		if (stretch == StretchMode::Box) {
 			if (src.width % dst.width == 0 && src.height % dst.height == 0) {
 				_ImageStretch::template stretch<_ImageStretch_Smooth_IntBox>(dst, src, blend);
 				return;
 			}
-			_ImageStretch::template stretch< _ImageStretch_Smooth<_ImageStretch_Smooth_BoxFilter> >(dst, src, blend);
 		}
+		_ImageResample_stretch(dst, src, blend, stretch, threadPool);
 	}
 
 	void Image::drawImage(sl_int32 dx, sl_int32 dy, sl_int32 dw, sl_int32 dh
@@ -1231,11 +1298,16 @@ namespace slib
 	}
 
 	Ref<Image> Image::scale(sl_uint32 width, sl_uint32 height, StretchMode stretch) const
+	{
+		return scale(width, height, stretch, sl_null);
+	}
+
+	Ref<Image> Image::scale(sl_uint32 width, sl_uint32 height, StretchMode stretch, const Ref<ThreadPool>& threadPool) const
 	{
 		if (width > 0 && height > 0) {
 			Ref<Image> ret = Image::create(width, height);
 			if (ret.isNotNull()) {
-				draw(ret->m_desc, m_desc, BlendMode::Copy, stretch);
+				draw(ret->m_desc, m_desc, BlendMode::Copy, stretch, threadPool);
 			}
 			return ret;
 		}
@@ -1243,13 +1315,18 @@ namespace slib
 	}
 
 	Ref<Image> Image::scaleToSmall(sl_uint32 requiredWidth, sl_uint32 requiredHeight, StretchMode stretch) const
+	{
+		return scaleToSmall(requiredWidth, requiredHeight, stretch, sl_null);
+	}
+
+	Ref<Image> Image::scaleToSmall(sl_uint32 requiredWidth, sl_uint32 requiredHeight, StretchMode stretch, const Ref<ThreadPool>& threadPool) const
 	{
 		sl_uint32 width = SLIB_MIN(requiredWidth, m_desc.width);
 		sl_uint32 height = SLIB_MIN(requiredHeight, m_desc.height);
 		if (width > 0 && height > 0) {
 			Ref<Image> ret = Image::create(width, height);
 			if (ret.isNotNull()) {
-				draw(ret->m_desc, m_desc, BlendMode::Copy, stretch);
+				draw(ret->m_desc, m_desc, BlendMode::Copy, stretch, threadPool);
 			}
 			return ret;
 		}
@@ -1281,7 +1358,17 @@ namespace slib
 
 	Ref<Image> Image::loadFromMemory(const void* mem, sl_size size, sl_uint32 width, sl_uint32 height)
 	{
-		Ref<Image> ret = Image_STB::loadImage(mem, size);
+		Ref<Image> ret;
+		if (width && height && getFileType(mem, size) == ImageFileType::JPEG) {
+			// decodes at the reduced DCT scale, before the final scaling
+			JpegDecodeParam param;
+			param.requiredWidth = width;
+			param.requiredHeight = height;
+			ret = JpegDecoder::decode(mem, size, param);
+		}
+		if (ret.isNull()) {
+			ret = Image_STB::loadImage(mem, size);
+		}
 		if (ret.isNotNull()) {
 			if (width == 0 || height == 0) {
 				return ret;
@@ -9,11 +9,14 @@
  */
 
 #include "slib/graphics/image.h"
+#include "slib/graphics/jpeg.h"
 
 #include "slib/core/file.h"
 #include "slib/core/scoped.h"
+#include "slib/core/async.h"
 
 #include <stdio.h>
+#include <string.h>
 #include <setjmp.h>
 #if defined(SLIB_PLATFORM_IS_APPLE)
 #include <stdlib.h>
@@ -41,56 +44,561 @@ namespace slib
 
 	Ref<Image> Image::loadFromJPEG(const void* content, sl_size size)
 	{
+		return JpegDecoder::decode(content, size, JpegDecodeParam());
+	}
+
+	Ref<Image> Image::loadFromJPEG(const void* content, sl_size size, const JpegDecodeParam& param)
+	{
+		return JpegDecoder::decode(content, size, param);
+	}
+
+
+	JpegDecodeParam::JpegDecodeParam()
+	: requiredWidth(0), requiredHeight(0), flagFast(sl_false)
+	{
+	}
+
+	JpegDecodeParam::~JpegDecodeParam()
+	{
+	}
+
+
+#define JPEG_DECODER_STATE_HEADER 0
+#define JPEG_DECODER_STATE_START 1
+#define JPEG_DECODER_STATE_ROWS 2
+#define JPEG_DECODER_STATE_FINISH 3
+#define JPEG_DECODER_STATE_COMPLETED 4
+#define JPEG_DECODER_STATE_ERROR 5
+
+#define JPEG_DECODER_BUFFER_SIZE_MIN 16384
+
+	class _JpegDecoderContext
+	{
+	public:
 		jpeg_decompress_struct cinfo;
 		_slib_image_ext_jpeg_error_mgr jerr;
-		cinfo.err = jpeg_std_error(&(jerr.pub));
-		jerr.pub.error_exit = _slib_image_jpeg_error_exit;
-
-		Ref<Image> ret;
+		jpeg_source_mgr src;
+
+		// unconsumed input. `src.next_input_byte` points in this buffer, except when the content is given at once
+		sl_uint8* buffer;
+		sl_size sizeBuffer;
+		// bytes to be skipped from the following input
+		sl_size sizeSkip;
+		sl_bool flagEnd;
+		JOCTET eoi[2];
+
+		sl_uint8* rows;
+		JSAMPROW* rowPointers;
+		sl_uint32 nRows;
+		sl_uint32 sizeRow;
+
+	public:
+		_JpegDecoderContext()
+		{
+			buffer = sl_null;
+			sizeBuffer = 0;
+			sizeSkip = 0;
+			flagEnd = sl_false;
+			rows = sl_null;
+			rowPointers = sl_null;
+			nRows = 0;
+			sizeRow = 0;
+
+			cinfo.err = jpeg_std_error(&(jerr.pub));
+			jerr.pub.error_exit = _slib_image_jpeg_error_exit;
+			jpeg_create_decompress(&cinfo);
+			cinfo.client_data = this;
+
+			src.next_input_byte = sl_null;
+			src.bytes_in_buffer = 0;
+			src.init_source = &initSource;
+			src.fill_input_buffer = &fillInputBuffer;
+			src.skip_input_data = &skipInputData;
+			src.resync_to_restart = jpeg_resync_to_restart;
+			src.term_source = &termSource;
+			cinfo.src = &src;
+		}
 
-		if (setjmp(jerr.setjmp_buffer)) {
+		~_JpegDecoderContext()
+		{
 			jpeg_destroy_decompress(&cinfo);
-			return sl_null;
+			if (buffer) {
+				Base::freeMemory(buffer);
+			}
+			if (rows) {
+				Base::freeMemory(rows);
+			}
+			if (rowPointers) {
+				Base::freeMemory(rowPointers);
+			}
 		}
 
-		jpeg_create_decompress(&cinfo);
+	public:
+		static void initSource(j_decompress_ptr cinfo)
+		{
+		}
 
-		jpeg_mem_src(&cinfo, (unsigned char*)content, (sl_uint32)size);
+		static boolean fillInputBuffer(j_decompress_ptr cinfo)
+		{
+			_JpegDecoderContext* context = (_JpegDecoderContext*)(cinfo->client_data);
+			if (context->flagEnd) {
+				// inserts a fake EOI marker for the truncated data, like the standard sources
+				context->eoi[0] = (JOCTET)0xFF;
+				context->eoi[1] = (JOCTET)JPEG_EOI;
+				cinfo->src->next_input_byte = context->eoi;
+				cinfo->src->bytes_in_buffer = 2;
+				return 1;
+			}
+			// suspends until more data is put
+			return 0;
+		}
 
-		jpeg_read_header(&cinfo, 1);
+		static void skipInputData(j_decompress_ptr cinfo, long num_bytes)
+		{
+			if (num_bytes <= 0) {
+				return;
+			}
+			_JpegDecoderContext* context = (_JpegDecoderContext*)(cinfo->client_data);
+			jpeg_source_mgr* src = cinfo->src;
+			sl_size n = (sl_size)num_bytes;
+			if (n <= src->bytes_in_buffer) {
+				src->next_input_byte += n;
+				src->bytes_in_buffer -= n;
+			} else {
+				context->sizeSkip += n - src->bytes_in_buffer;
+				src->next_input_byte += src->bytes_in_buffer;
+				src->bytes_in_buffer = 0;
+			}
+		}
 
-		cinfo.out_color_space = JCS_RGB;
+		static void termSource(j_decompress_ptr cinfo)
+		{
+		}
 
-		jpeg_start_decompress(&cinfo);
+		sl_bool append(const sl_uint8* data, sl_size size)
+		{
+			if (sizeSkip) {
+				sl_size n = SLIB_MIN(sizeSkip, size);
+				data += n;
+				size -= n;
+				sizeSkip -= n;
+			}
+			if (!size) {
+				return sl_true;
+			}
+			sl_size nRemain = src.bytes_in_buffer;
+			const JOCTET* remain = src.next_input_byte;
+			sl_size nTotal = nRemain + size;
+			if (nTotal > sizeBuffer) {
+				sl_size n = sizeBuffer << 1;
+				if (n < nTotal) {
+					n = nTotal;
+				}
+				if (n < JPEG_DECODER_BUFFER_SIZE_MIN) {
+					n = JPEG_DECODER_BUFFER_SIZE_MIN;
+				}
+				sl_uint8* bufferNew = (sl_uint8*)(Base::createMemory(n));
+				if (!bufferNew) {
+					return sl_false;
+				}
+				if (nRemain) {
+					Base::copyMemory(bufferNew, remain, nRemain);
+				}
+				if (buffer) {
+					Base::freeMemory(buffer);
+				}
+				buffer = bufferNew;
+				sizeBuffer = n;
+			} else if (nRemain && remain != buffer) {
+				memmove(buffer, remain, nRemain);
+			}
+			Base::copyMemory(buffer + nRemain, data, size);
+			src.next_input_byte = buffer;
+			src.bytes_in_buffer = nTotal;
+			return sl_true;
+		}
 
-		sl_uint32 width = cinfo.output_width;
-		sl_uint32 height = cinfo.output_height;
-		ret = Image::create(width, height);
-		if (ret.isNotNull()) {
-			JSAMPROW row_pointer[1];
-			SLIB_SCOPED_BUFFER(sl_uint8, 4096, row, width*3);
-			if (row) {
-				row_pointer[0] = (JSAMPROW)(row);
-				Color* pixels = ret->getColors();
-				sl_uint32 stride = ret->getStride();
-				while (cinfo.output_scanline < height) {
-					jpeg_read_scanlines(&cinfo, row_pointer, 1);
-					sl_uint8* p = row;
-					for (sl_uint32 i = 0; i < width; i++) {
-						pixels[i].r = *(p++);
-						pixels[i].g = *(p++);
-						pixels[i].b = *(p++);
-						pixels[i].a = 255;
+		void prepareOutput(const JpegDecodeParam& param)
+		{
+			cinfo.out_color_space = JCS_RGB;
+			unsigned int num = 8;
+			if (param.requiredWidth || param.requiredHeight) {
+				while (num > 1) {
+					unsigned int n = num >> 1;
+					// libjpeg rounds up the scaled size
+					if (((sl_uint64)(cinfo.image_width) * n + 7) / 8 < param.requiredWidth) {
+						break;
+					}
+					if (((sl_uint64)(cinfo.image_height) * n + 7) / 8 < param.requiredHeight) {
+						break;
 					}
-					pixels += stride;
+					num = n;
 				}
 			}
+			cinfo.scale_num = num;
+			cinfo.scale_denom = 8;
+			if (param.flagFast) {
+				cinfo.dct_method = JDCT_IFAST;
+				cinfo.do_fancy_upsampling = 0;
+			}
+			jpeg_calc_output_dimensions(&cinfo);
 		}
 
-		jpeg_finish_decompress(&cinfo);
-		jpeg_destroy_decompress(&cinfo);
+		sl_bool prepareRows()
+		{
+			nRows = cinfo.rec_outbuf_height > 0 ? (sl_uint32)(cinfo.rec_outbuf_height) : 1;
+			sizeRow = cinfo.output_width * 3;
+			rows = (sl_uint8*)(Base::createMemory(nRows * sizeRow));
+			if (!rows) {
+				return sl_false;
+			}
+			rowPointers = (JSAMPROW*)(Base::createMemory(nRows * sizeof(JSAMPROW)));
+			if (!rowPointers) {
+				return sl_false;
+			}
+			for (sl_uint32 i = 0; i < nRows; i++) {
+				rowPointers[i] = (JSAMPROW)(rows + i * sizeRow);
+			}
+			return sl_true;
+		}
 
-		return ret;
+		// converts the decoded RGB rows to the format of `output`
+		void writeRows(const BitmapData& output, sl_uint32 y, sl_uint32 n)
+		{
+			if (y >= output.height) {
+				return;
+			}
+			if (n > output.height - y) {
+				n = output.height - y;
+			}
+			BitmapData dst(output);
+			sl_uint32 nPlanes = BitmapFormats::getPlanesCount(dst.format);
+			for (sl_uint32 i = 0; i < nPlanes; i++) {
+				dst.planeData(i) = (sl_uint8*)(dst.planeData(i)) + (sl_reg)y * dst.planePitch(i);
+			}
+			dst.height = n;
+			if (dst.width > cinfo.output_width) {
+				dst.width = cinfo.output_width;
+			}
+			BitmapData src;
+			src.width = dst.width;
+			src.height = n;
+			src.format = BitmapFormat::RGB;
+			src.data = rows;
+			src.pitch = (sl_int32)sizeRow;
+			dst.copyPixelsFrom(src);
+		}
+
+	};
+
+
+	SLIB_DEFINE_OBJECT(JpegDecoder, Object)
+
+	JpegDecoder::JpegDecoder()
+	{
+		m_context = sl_null;
+		m_state = JPEG_DECODER_STATE_HEADER;
+		m_flagOutput = sl_false;
+	}
+
+	JpegDecoder::~JpegDecoder()
+	{
+		if (m_context) {
+			delete m_context;
+		}
+	}
+
+	Ref<JpegDecoder> JpegDecoder::create(const JpegDecodeParam& param)
+	{
+		Ref<JpegDecoder> ret = new JpegDecoder;
+		if (ret.isNotNull()) {
+			ret->m_param = param;
+			ret->m_context = new _JpegDecoderContext;
+			if (ret->m_context) {
+				return ret;
+			}
+		}
+		return sl_null;
+	}
+
+	sl_bool JpegDecoder::put(const void* data, sl_size size)
+	{
+		ObjectLocker lock(this);
+		if (m_state >= JPEG_DECODER_STATE_COMPLETED) {
+			// the data after EOI is ignored
+			return m_state == JPEG_DECODER_STATE_COMPLETED;
+		}
+		if (!(m_context->append((const sl_uint8*)data, size))) {
+			m_state = JPEG_DECODER_STATE_ERROR;
+			return sl_false;
+		}
+		return _process();
+	}
+
+	sl_bool JpegDecoder::finish()
+	{
+		ObjectLocker lock(this);
+		if (m_state < JPEG_DECODER_STATE_COMPLETED) {
+			m_context->flagEnd = sl_true;
+			_process();
+		}
+		return m_state == JPEG_DECODER_STATE_COMPLETED;
+	}
+
+	sl_bool JpegDecoder::isHeaderDecoded()
+	{
+		return m_state != JPEG_DECODER_STATE_HEADER && m_state != JPEG_DECODER_STATE_ERROR;
+	}
+
+	sl_bool JpegDecoder::isCompleted()
+	{
+		return m_state == JPEG_DECODER_STATE_COMPLETED;
+	}
+
+	sl_bool JpegDecoder::isError()
+	{
+		return m_state == JPEG_DECODER_STATE_ERROR;
+	}
+
+	sl_uint32 JpegDecoder::getWidth()
+	{
+		if (isHeaderDecoded()) {
+			return m_context->cinfo.output_width;
+		}
+		return 0;
+	}
+
+	sl_uint32 JpegDecoder::getHeight()
+	{
+		if (isHeaderDecoded()) {
+			return m_context->cinfo.output_height;
+		}
+		return 0;
+	}
+
+	sl_uint32 JpegDecoder::getOriginalWidth()
+	{
+		if (isHeaderDecoded()) {
+			return m_context->cinfo.image_width;
+		}
+		return 0;
+	}
+
+	sl_uint32 JpegDecoder::getOriginalHeight()
+	{
+		if (isHeaderDecoded()) {
+			return m_context->cinfo.image_height;
+		}
+		return 0;
+	}
+
+	sl_uint32 JpegDecoder::getDecodedRowsCount()
+	{
+		if (m_state == JPEG_DECODER_STATE_ROWS || m_state == JPEG_DECODER_STATE_FINISH || m_state == JPEG_DECODER_STATE_COMPLETED) {
+			return m_context->cinfo.output_scanline;
+		}
+		return 0;
+	}
+
+	sl_bool JpegDecoder::setOutput(const BitmapData& output)
+	{
+		ObjectLocker lock(this);
+		if (m_state > JPEG_DECODER_STATE_START) {
+			return sl_false;
+		}
+		if (BitmapFormats::isYUV_420(output.format)) {
+			return sl_false;
+		}
+		m_output = output;
+		m_flagOutput = sl_true;
+		m_image.setNull();
+		return sl_true;
+	}
+
+	Ref<Image> JpegDecoder::getImage()
+	{
+		return m_image;
+	}
+
+	sl_bool JpegDecoder::_process()
+	{
+		_JpegDecoderContext* context = m_context;
+		jpeg_decompress_struct& cinfo = context->cinfo;
+		if (setjmp(context->jerr.setjmp_buffer)) {
+			m_state = JPEG_DECODER_STATE_ERROR;
+			return sl_false;
+		}
+		if (m_state == JPEG_DECODER_STATE_HEADER) {
+			if (jpeg_read_header(&cinfo, 1) != JPEG_HEADER_OK) {
+				return sl_true;
+			}
+			context->prepareOutput(m_param);
+			m_state = JPEG_DECODER_STATE_START;
+		}
+		if (m_state == JPEG_DECODER_STATE_START) {
+			// progressive images are buffered by libjpeg until all the scans arrive
+			if (!(jpeg_start_decompress(&cinfo))) {
+				return sl_true;
+			}
+			if (!(context->prepareRows())) {
+				m_state = JPEG_DECODER_STATE_ERROR;
+				return sl_false;
+			}
+			if (!m_flagOutput) {
+				m_image = Image::create(cinfo.output_width, cinfo.output_height);
+				if (m_image.isNull()) {
+					m_state = JPEG_DECODER_STATE_ERROR;
+					return sl_false;
+				}
+				m_output = BitmapData(m_image->getWidth(), m_image->getHeight(), m_image->getColors(), m_image->getStride());
+			}
+			m_state = JPEG_DECODER_STATE_ROWS;
+		}
+		if (m_state == JPEG_DECODER_STATE_ROWS) {
+			while (cinfo.output_scanline < cinfo.output_height) {
+				sl_uint32 y = cinfo.output_scanline;
+				sl_uint32 n = (sl_uint32)(jpeg_read_scanlines(&cinfo, context->rowPointers, context->nRows));
+				if (!n) {
+					return sl_true;
+				}
+				context->writeRows(m_output, y, n);
+			}
+			m_state = JPEG_DECODER_STATE_FINISH;
+		}
+		if (m_state == JPEG_DECODER_STATE_FINISH) {
+			if (!(jpeg_finish_decompress(&cinfo))) {
+				return sl_true;
+			}
+			m_state = JPEG_DECODER_STATE_COMPLETED;
+		}
+		return sl_true;
+	}
+
+	sl_bool JpegDecoder::getSize(const void* content, sl_size size, const JpegDecodeParam& param, sl_uint32* outWidth, sl_uint32* outHeight)
+	{
+		Ref<JpegDecoder> decoder = create(param);
+		if (decoder.isNull()) {
+			return sl_false;
+		}
+		_JpegDecoderContext* context = decoder->m_context;
+		jpeg_decompress_struct& cinfo = context->cinfo;
+		if (setjmp(context->jerr.setjmp_buffer)) {
+			return sl_false;
+		}
+		context->src.next_input_byte = (const JOCTET*)content;
+		context->src.bytes_in_buffer = size;
+		context->flagEnd = sl_true;
+		if (jpeg_read_header(&cinfo, 1) != JPEG_HEADER_OK) {
+			return sl_false;
+		}
+		context->prepareOutput(param);
+		if (outWidth) {
+			*outWidth = cinfo.output_width;
+		}
+		if (outHeight) {
+			*outHeight = cinfo.output_height;
+		}
+		return sl_true;
+	}
+
+	Ref<Image> JpegDecoder::decode(const void* content, sl_size size, const JpegDecodeParam& param)
+	{
+		Ref<JpegDecoder> decoder = create(param);
+		if (decoder.isNotNull()) {
+			// decodes the content without copying
+			_JpegDecoderContext* context = decoder->m_context;
+			context->src.next_input_byte = (const JOCTET*)content;
+			context->src.bytes_in_buffer = size;
+			context->flagEnd = sl_true;
+			if (decoder->_process() && decoder->isCompleted()) {
+				return decoder->m_image;
+			}
+		}
+		return sl_null;
+	}
+
+	sl_bool JpegDecoder::decode(const void* content, sl_size size, const BitmapData& output, const JpegDecodeParam& param)
+	{
+		Ref<JpegDecoder> decoder = create(param);
+		if (decoder.isNotNull()) {
+			if (!(decoder->setOutput(output))) {
+				return sl_false;
+			}
+			_JpegDecoderContext* context = decoder->m_context;
+			context->src.next_input_byte = (const JOCTET*)content;
+			context->src.bytes_in_buffer = size;
+			context->flagEnd = sl_true;
+			if (decoder->_process()) {
+				return decoder->isCompleted();
+			}
+		}
+		return sl_false;
+	}
+
+#define JPEG_DECODER_ASYNC_READ_SIZE 65536
+
+	class _JpegDecoder_AsyncReader : public Referable
+	{
+	public:
+		Ref<AsyncStream> m_stream;
+		Ref<JpegDecoder> m_decoder;
+		Function<void(Image*)> m_callback;
+		Memory m_buffer;
+
+	public:
+		sl_bool read()
+		{
+			return m_stream->read(m_buffer.getData(), (sl_uint32)(m_buffer.getSize()), SLIB_FUNCTION_REF(_JpegDecoder_AsyncReader, onRead, this));
+		}
+
+		void onRead(AsyncStreamResult* result)
+		{
+			if (result->size) {
+				if (!(m_decoder->put(result->data, result->size))) {
+					m_callback(sl_null);
+					return;
+				}
+				if (m_decoder->isCompleted()) {
+					m_callback(m_decoder->getImage().get());
+					return;
+				}
+			}
+			if (result->flagError || !(result->size)) {
+				// end of the stream
+				if (m_decoder->finish()) {
+					m_callback(m_decoder->getImage().get());
+				} else {
+					m_callback(sl_null);
+				}
+				return;
+			}
+			if (!(read())) {
+				m_callback(sl_null);
+			}
+		}
+
+	};
+
+	sl_bool JpegDecoder::decode(const Ref<AsyncStream>& stream, const JpegDecodeParam& param, const Function<void(Image*)>& callback)
+	{
+		if (stream.isNull()) {
+			return sl_false;
+		}
+		Ref<_JpegDecoder_AsyncReader> reader = new _JpegDecoder_AsyncReader;
+		if (reader.isNull()) {
+			return sl_false;
+		}
+		reader->m_decoder = create(param);
+		if (reader->m_decoder.isNull()) {
+			return sl_false;
+		}
+		reader->m_buffer = Memory::create(JPEG_DECODER_ASYNC_READ_SIZE);
+		if (reader->m_buffer.isNull()) {
+			return sl_false;
+		}
+		reader->m_stream = stream;
+		reader->m_callback = callback;
+		return reader->read();
 	}
 
 	Memory Image::saveToJPEG(const Ref<Image>& image, float quality)
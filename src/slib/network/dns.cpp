@@ -14,6 +14,10 @@
 #include "slib/core/scoped.h"
 #include "slib/core/mio.h"
 #include "slib/core/log.h"
+#include "slib/core/linked_list.h"
+#include "slib/core/hashtable.h"
+#include "slib/core/new_helper.h"
+#include "slib/core/system.h"
 
 #define _MAX_NAME SLIB_NETWORK_DNS_NAME_MAX_LENGTH
 
@@ -535,6 +539,9 @@ namespace slib
 	{
 		id = 0;
 		flagQuestion = sl_false;
+		responseCode = DnsResponseCode::NoError;
+		flagTruncated = sl_false;
+		minimumTTL = 0xFFFFFFFF;
 	}
 
 	DnsPacket::~DnsPacket()
@@ -556,6 +563,8 @@ namespace slib
 				flagQuestion = sl_false;
 			}
 			id = header->getId();
+			responseCode = header->getResponseCode();
+			flagTruncated = header->isTC();
 			
 			sl_uint32 i, n;
 			sl_uint32 offset = sizeof(DnsHeader);
@@ -583,6 +592,24 @@ namespace slib
 					break;
 				}
 				DnsRecordType type = record.getType();
+				if (type == DnsRecordType::OPT) {
+					// TTL field holds the EDNS flags
+					continue;
+				}
+				sl_uint32 TTL = record.getTTL();
+				if (type == DnsRecordType::SOA) {
+					// MINIMUM is the last field of SOA data
+					sl_uint32 sizeData = record.getDataLength();
+					if (sizeData >= 20) {
+						sl_uint32 ttlNegative = MIO::readUint32BE(buf + record.getDataOffset() + sizeData - 4);
+						if (ttlNegative < TTL) {
+							TTL = ttlNegative;
+						}
+					}
+				}
+				if (TTL < minimumTTL) {
+					minimumTTL = TTL;
+				}
 				if (type == DnsRecordType::A) {
 					DnsPacket::Address item;
 					item.name = record.getName();
@@ -700,7 +727,7 @@ namespace slib
 			recordQuestion.setName(hostName);
 			recordQuestion.setType(DnsRecordType::A);
 			offset = recordQuestion.buildRecord(buf, offset, 1024);
-			if (offset == 0) {
+			if (offset > 0) {
 				return Memory::create(buf, offset);
 			}
 		}
@@ -824,6 +851,13 @@ namespace slib
 		flagEncryptDefaultForward = sl_false;
 
 		flagAutoStart = sl_true;
+
+		flagCache = sl_true;
+		cacheMemorySize = 4 * 1024 * 1024;
+		cacheShardsCount = 16;
+		cacheMinimumTTL = 0;
+		cacheMaximumTTL = 86400;
+		negativeCacheTTL = 300;
 	}
 
 	DnsServerParam::~DnsServerParam()
@@ -841,8 +875,310 @@ namespace slib
 		IPv4Address defaultForwardAddressIp = IPv4Address(8, 8, 4, 4);
 		defaultForwardAddressIp.parse(conf.getItem("forward_dns").getString());
 		defaultForwardAddress = SocketAddress(defaultForwardAddressIp, SLIB_NETWORK_DNS_PORT);
+
+		flagCache = conf.getItem("cache").getBoolean(sl_true);
+		cacheMemorySize = (sl_size)(conf.getItem("cache_memory").getUint64(4 * 1024 * 1024));
+		cacheShardsCount = conf.getItem("cache_shards").getUint32(16);
+		cacheMinimumTTL = conf.getItem("cache_min_ttl").getUint32(0);
+		cacheMaximumTTL = conf.getItem("cache_max_ttl").getUint32(86400);
+		negativeCacheTTL = conf.getItem("negative_cache_ttl").getUint32(300);
+	}
+
+
+	DnsServerStatistics::DnsServerStatistics()
+	{
+		questionsCount = 0;
+		cacheHitsCount = 0;
+		negativeCacheHitsCount = 0;
+		coalescedQuestionsCount = 0;
+		forwardedQuestionsCount = 0;
+		forwardedAnswersCount = 0;
+		averageForwardLatency = 0;
+		maximumForwardLatency = 0;
+		cacheEntriesCount = 0;
+		cacheMemorySize = 0;
+	}
+
+	DnsServerStatistics::~DnsServerStatistics()
+	{
+	}
+
+	double DnsServerStatistics::getCacheHitRate() const
+	{
+		if (questionsCount) {
+			return (double)cacheHitsCount / (double)questionsCount;
+		}
+		return 0;
+	}
+
+
+	// offsets of the TTL fields of the response records in `packet`
+	static sl_bool _DnsServer_getTTLOffsets(const void* packet, sl_uint32 size, List<sl_uint16>& offsets)
+	{
+		if (size < sizeof(DnsHeader) || size > 0xFFFF) {
+			return sl_false;
+		}
+		const DnsHeader* header = (const DnsHeader*)packet;
+		sl_uint32 offset = sizeof(DnsHeader);
+		sl_uint32 n = header->getQuestionsCount();
+		for (sl_uint32 i = 0; i < n; i++) {
+			DnsQuestionRecord record;
+			offset = record.parseRecord(packet, offset, size);
+			if (!offset) {
+				return sl_false;
+			}
+		}
+		n = header->getAnswersCount() + header->getAuthoritiesCount() + header->getAdditionalsCount();
+		for (sl_uint32 i = 0; i < n; i++) {
+			DnsResponseRecord record;
+			offset = record.parseRecord(packet, offset, size);
+			if (!offset) {
+				return sl_false;
+			}
+			if (record.getType() != DnsRecordType::OPT) {
+				// TTL and RDLENGTH precede the data
+				offsets.add_NoLock((sl_uint16)(record.getDataOffset() - 6));
+			}
+		}
+		return sl_true;
 	}
 
+	/*
+		Key of the cached answer for the question in `packet`. The answer depends on the EDNS payload size and DO bit, and on the CD bit.
+		Returns null if the question is not cacheable: the answers for EDNS Client Subnet queries are specific to the clients.
+	*/
+	static String _DnsServer_getCacheKey(const void* packet, sl_uint32 size)
+	{
+		const DnsHeader* header = (const DnsHeader*)packet;
+		if (header->getQuestionsCount() != 1) {
+			return sl_null;
+		}
+		DnsQuestionRecord question;
+		sl_uint32 offset = question.parseRecord(packet, sizeof(DnsHeader), size);
+		if (!offset) {
+			return sl_null;
+		}
+		String edns = "-";
+		sl_uint32 n = header->getAnswersCount() + header->getAuthoritiesCount() + header->getAdditionalsCount();
+		for (sl_uint32 i = 0; i < n; i++) {
+			DnsResponseRecord record;
+			offset = record.parseRecord(packet, offset, size);
+			if (!offset) {
+				return sl_null;
+			}
+			if (record.getType() == DnsRecordType::OPT) {
+				const sl_uint8* data = (const sl_uint8*)packet + record.getDataOffset();
+				sl_uint32 sizeData = record.getDataLength();
+				sl_uint32 pos = 0;
+				while (pos + 4 <= sizeData) {
+					sl_uint16 code = MIO::readUint16BE(data + pos);
+					if (code == 8) {
+						// EDNS Client Subnet (RFC 7871)
+						return sl_null;
+					}
+					pos += 4 + MIO::readUint16BE(data + pos + 2);
+				}
+				// DO bit is the highest bit of the lower 16 bits
+				edns = String::format("%d/%d", (sl_uint32)(record.getClass()), (record.getTTL() & 0x8000) ? 1 : 0);
+			}
+		}
+		return String::format("%d:%d:%s:%d:%s", (sl_uint32)(question.getType()), (sl_uint32)(question.getClass()), question.getName().toLower(), header->isCD() ? 1 : 0, edns);
+	}
+
+	/*
+		Sharded LRU cache of the pre-encoded answers. The answers are stored with zero id, and the id is patched on the hit.
+		The TTLs of the records are decreased to the remaining lifetime of the entry on the hit.
+	*/
+	class _DnsServerCache : public Referable
+	{
+	public:
+		struct Entry
+		{
+			String key;
+			Memory answer;
+			List<sl_uint16> offsetsTTL;
+			sl_uint64 tickExpire;
+			sl_bool flagNegative;
+		};
+
+		class Shard
+		{
+		public:
+			Mutex lock;
+			// front is the most recently used
+			CLinkedList<Entry> lru;
+			HashTable< String, Link<Entry>* > map;
+			sl_size sizeMemory;
+
+		public:
+			Shard()
+			{
+				sizeMemory = 0;
+			}
+
+		public:
+			static sl_size getEntrySize(const Entry& entry)
+			{
+				return entry.key.getLength() + entry.answer.getSize() + (entry.offsetsTTL.getCount() << 1) + sizeof(Link<Entry>) + 64;
+			}
+
+			void remove(Link<Entry>* link)
+			{
+				map.remove(link->value.key);
+				sizeMemory -= getEntrySize(link->value);
+				lru.removeItem_NoLock(link);
+			}
+
+		};
+
+		Shard* m_shards;
+		sl_uint32 m_nShards;
+		sl_size m_sizeLimitPerShard;
+
+	public:
+		_DnsServerCache()
+		{
+			m_shards = sl_null;
+			m_nShards = 0;
+			m_sizeLimitPerShard = 0;
+		}
+
+		~_DnsServerCache()
+		{
+			if (m_shards) {
+				NewHelper<Shard>::free(m_shards, m_nShards);
+			}
+		}
+
+	public:
+		static Ref<_DnsServerCache> create(sl_size sizeMemory, sl_uint32 nShards)
+		{
+			if (!nShards) {
+				nShards = 1;
+			}
+			Ref<_DnsServerCache> ret = new _DnsServerCache;
+			if (ret.isNotNull()) {
+				ret->m_shards = NewHelper<Shard>::create(nShards);
+				if (ret->m_shards) {
+					ret->m_nShards = nShards;
+					ret->m_sizeLimitPerShard = sizeMemory / nShards;
+					return ret;
+				}
+			}
+			return sl_null;
+		}
+
+		Shard& getShard(const String& key)
+		{
+			return m_shards[key.getHashCode() % m_nShards];
+		}
+
+		// returns a copy of the answer, which is owned by the caller
+		sl_bool get(const String& key, Memory& packet, sl_bool& flagNegative)
+		{
+			Memory answer;
+			List<sl_uint16> offsetsTTL;
+			sl_uint64 tickRemaining;
+			{
+				Shard& shard = getShard(key);
+				MutexLocker lock(&(shard.lock));
+				Link<Entry>* link;
+				if (!(shard.map.get(key, &link))) {
+					return sl_false;
+				}
+				sl_uint64 tickCurrent = System::getTickCount64();
+				if (link->value.tickExpire <= tickCurrent) {
+					shard.remove(link);
+					return sl_false;
+				}
+				tickRemaining = link->value.tickExpire - tickCurrent;
+				answer = link->value.answer;
+				offsetsTTL = link->value.offsetsTTL;
+				flagNegative = link->value.flagNegative;
+				if (link != shard.lru.getFront()) {
+					Entry entry = link->value;
+					shard.lru.removeItem_NoLock(link);
+					link = shard.lru.pushFront_NoLock(entry);
+					if (link) {
+						shard.map.put(key, link);
+					} else {
+						shard.map.remove(key);
+						shard.sizeMemory -= Shard::getEntrySize(entry);
+					}
+				}
+			}
+			packet = answer.duplicate();
+			if (packet.isEmpty()) {
+				return sl_false;
+			}
+			sl_uint8* data = (sl_uint8*)(packet.getData());
+			sl_uint32 TTL = (sl_uint32)(tickRemaining / 1000);
+			ListElements<sl_uint16> offsets(offsetsTTL);
+			for (sl_size i = 0; i < offsets.count; i++) {
+				MIO::writeUint32BE(data + offsets[i], TTL);
+			}
+			return sl_true;
+		}
+
+		void put(const String& key, const Memory& answer, sl_uint32 TTL, sl_bool flagNegative)
+		{
+			Entry entry;
+			entry.key = key;
+			entry.answer = answer;
+			if (!(_DnsServer_getTTLOffsets(answer.getData(), (sl_uint32)(answer.getSize()), entry.offsetsTTL))) {
+				return;
+			}
+			entry.tickExpire = System::getTickCount64() + (sl_uint64)TTL * 1000;
+			entry.flagNegative = flagNegative;
+			sl_size size = Shard::getEntrySize(entry);
+			if (size > m_sizeLimitPerShard) {
+				return;
+			}
+			Shard& shard = getShard(key);
+			MutexLocker lock(&(shard.lock));
+			Link<Entry>* link;
+			if (shard.map.get(key, &link)) {
+				shard.remove(link);
+			}
+			while (shard.sizeMemory + size > m_sizeLimitPerShard) {
+				link = shard.lru.getBack();
+				if (!link) {
+					break;
+				}
+				shard.remove(link);
+			}
+			link = shard.lru.pushFront_NoLock(entry);
+			if (link) {
+				shard.map.put(key, link);
+				shard.sizeMemory += size;
+			}
+		}
+
+		void clear()
+		{
+			for (sl_uint32 i = 0; i < m_nShards; i++) {
+				Shard& shard = m_shards[i];
+				MutexLocker lock(&(shard.lock));
+				shard.map.removeAll();
+				shard.lru.removeAll_NoLock();
+				shard.sizeMemory = 0;
+			}
+		}
+
+		void getStatistics(sl_size& nEntries, sl_size& sizeMemory)
+		{
+			nEntries = 0;
+			sizeMemory = 0;
+			for (sl_uint32 i = 0; i < m_nShards; i++) {
+				Shard& shard = m_shards[i];
+				MutexLocker lock(&(shard.lock));
+				nEntries += shard.lru.getCount();
+				sizeMemory += shard.sizeMemory;
+			}
+		}
+
+	};
+
 
 	SLIB_DEFINE_OBJECT(DnsServer, Object)
 
@@ -855,6 +1191,19 @@ namespace slib
 
 		m_flagEncryptDefaultForward = sl_false;
 		m_flagProxy = sl_false;
+
+		m_cacheMinimumTTL = 0;
+		m_cacheMaximumTTL = 0;
+		m_negativeCacheTTL = 0;
+
+		m_nQuestions = 0;
+		m_nCacheHits = 0;
+		m_nNegativeCacheHits = 0;
+		m_nCoalescedQuestions = 0;
+		m_nForwardedQuestions = 0;
+		m_nForwardedAnswers = 0;
+		m_sumForwardLatency = 0;
+		m_maxForwardLatency = 0;
 	}
 
 	DnsServer::~DnsServer()
@@ -904,6 +1253,13 @@ namespace slib
 
 				ret->m_listener = param.listener;
 
+				if (param.flagCache && param.cacheMemorySize) {
+					ret->m_cache = _DnsServerCache::create(param.cacheMemorySize, param.cacheShardsCount);
+					ret->m_cacheMinimumTTL = param.cacheMinimumTTL;
+					ret->m_cacheMaximumTTL = param.cacheMaximumTTL;
+					ret->m_negativeCacheTTL = param.negativeCacheTTL;
+				}
+
 				ret->m_flagInit = sl_true;
 				if (param.flagAutoStart) {
 					ret->start();
@@ -956,11 +1312,40 @@ namespace slib
 		return m_flagRunning;
 	}
 
+	DnsServerStatistics DnsServer::getStatistics()
+	{
+		DnsServerStatistics ret;
+		ret.questionsCount = m_nQuestions;
+		ret.cacheHitsCount = m_nCacheHits;
+		ret.negativeCacheHitsCount = m_nNegativeCacheHits;
+		ret.coalescedQuestionsCount = m_nCoalescedQuestions;
+		ret.forwardedQuestionsCount = m_nForwardedQuestions;
+		ret.forwardedAnswersCount = m_nForwardedAnswers;
+		if (m_nForwardedAnswers) {
+			ret.averageForwardLatency = (sl_uint32)(m_sumForwardLatency / m_nForwardedAnswers);
+		}
+		ret.maximumForwardLatency = (sl_uint32)m_maxForwardLatency;
+		Ref<_DnsServerCache> cache = m_cache;
+		if (cache.isNotNull()) {
+			cache->getStatistics(ret.cacheEntriesCount, ret.cacheMemorySize);
+		}
+		return ret;
+	}
+
+	void DnsServer::clearCache()
+	{
+		Ref<_DnsServerCache> cache = m_cache;
+		if (cache.isNotNull()) {
+			cache->clear();
+		}
+	}
+
 	void DnsServer::_processReceivedDnsQuestion(const SocketAddress& clientAddress, sl_uint16 id, const String& hostName, sl_bool flagEncryptedRequest)
 	{
 		if (hostName.indexOf('.') < 0) {
 			return;
 		}
+		Base::interlockedIncrement64(&m_nQuestions);
 		DnsResolveHostParam rp;
 		rp.clientAddress = clientAddress;
 		rp.hostName = hostName;
@@ -978,6 +1363,17 @@ namespace slib
 			_sendPacket(flagEncryptedRequest, clientAddress, _buildHostAddressAnswerPacket(id, hostName, rp.hostAddress, flagEncryptedRequest));
 		}
 		
+		String cacheKey;
+		if (rp.hostAddress.isZero() && m_cache.isNotNull()) {
+			cacheKey = "A:" + rp.forwardAddress.toString() + ":" + hostName.toLower();
+			if (_answerFromCache(cacheKey, clientAddress, id, flagEncryptedRequest)) {
+				return;
+			}
+			if (_coalesceQuestion(cacheKey, clientAddress, id, flagEncryptedRequest)) {
+				return;
+			}
+		}
+		
 		// forward DNS request
 		{
 			sl_uint16 idForward = m_lastForwardId++;
@@ -991,7 +1387,10 @@ namespace slib
 			} else {
 				fe.clientAddress = clientAddress;
 			}
+			fe.cacheKey = cacheKey;
+			fe.tickSent = System::getTickCount();
 			m_mapForward.put(idForward, fe);
+			_registerForward(idForward, cacheKey);
 			_sendPacket(rp.flagEncryptForward, rp.forwardAddress, _buildQuestionPacket(idForward, hostName, rp.flagEncryptForward));
 		}
 
@@ -1003,9 +1402,9 @@ namespace slib
 		sl_uint16 idForward = packet.id;
 
 		ForwardElement fe;
-		if (m_mapForward.get(idForward, &fe)) {
+		if (m_mapForward.remove(idForward, &fe)) {
 
-			m_mapForward.remove(idForward);
+			_onForwardAnswer(fe.tickSent);
 
 			String reqNameLower = fe.requestedHostName.toLower();
 
@@ -1074,9 +1473,20 @@ namespace slib
 					aliasesProcess = aliasesNoProcess;
 				}
 			}
-			if (fe.clientAddress.isValid()) {
+			if (fe.clientAddress.isValid() && fe.cacheKey.isEmpty()) {
 				_sendPacket(fe.flagEncrypted, fe.clientAddress, _buildHostAddressAnswerPacket(fe.requestedId, fe.requestedHostName, resolvedAddress, fe.flagEncrypted));
 			}
+			if (fe.cacheKey.isNotEmpty()) {
+				Memory answer = DnsPacket::buildHostAddressAnswerPacket(0, fe.requestedHostName, resolvedAddress);
+				if (fe.clientAddress.isValid()) {
+					_sendCachedAnswer(answer, fe.clientAddress, fe.requestedId, fe.flagEncrypted);
+				}
+				ListElements<ForwardClient> clients(fe.coalescedClients);
+				for (sl_size i = 0; i < clients.count; i++) {
+					_sendCachedAnswer(answer, clients[i].clientAddress, clients[i].requestedId, clients[i].flagEncrypted);
+				}
+				_cacheAnswer(idForward, fe.cacheKey, packet, answer, resolvedAddress.isZero());
+			}
 		}
 	}
 
@@ -1084,12 +1494,29 @@ namespace slib
 	{
 		DnsHeader* header = (DnsHeader*)data;
 
+		Base::interlockedIncrement64(&m_nQuestions);
+
+		String cacheKey;
+		if (m_cache.isNotNull()) {
+			cacheKey = _DnsServer_getCacheKey(data, size);
+			if (cacheKey.isNotEmpty()) {
+				if (_answerFromCache(cacheKey, clientAddress, header->getId(), flagEncryptedRequest)) {
+					return;
+				}
+				if (_coalesceQuestion(cacheKey, clientAddress, header->getId(), flagEncryptedRequest)) {
+					return;
+				}
+			}
+		}
+
 		sl_uint16 idForward = m_lastForwardId++;
 
 		ForwardElement fe;
 		fe.requestedId = header->getId();
 		fe.flagEncrypted = flagEncryptedRequest;
 		fe.clientAddress = clientAddress;
+		fe.cacheKey = cacheKey;
+		fe.tickSent = System::getTickCount();
 
 		header->setId(idForward);
 		Memory packet = Memory::create(data, size);
@@ -1101,6 +1528,7 @@ namespace slib
 		}
 
 		m_mapForward.put(idForward, fe);
+		_registerForward(idForward, cacheKey);
 
 		_sendPacket(m_flagEncryptDefaultForward, m_defaultForwardAddress, packet);
 
@@ -1111,9 +1539,29 @@ namespace slib
 		DnsHeader* header = (DnsHeader*)data;
 		sl_uint16 idForward = header->getId();
 		ForwardElement fe;
-		if (m_mapForward.get(idForward, &fe)) {
+		if (m_mapForward.remove(idForward, &fe)) {
 
-			m_mapForward.remove(idForward);
+			_onForwardAnswer(fe.tickSent);
+
+			if (fe.cacheKey.isNotEmpty()) {
+				header->setId(0);
+				Memory answer = Memory::create(data, size);
+				if (answer.isEmpty()) {
+					return;
+				}
+				_sendCachedAnswer(answer, fe.clientAddress, fe.requestedId, fe.flagEncrypted);
+				ListElements<ForwardClient> clients(fe.coalescedClients);
+				for (sl_size i = 0; i < clients.count; i++) {
+					_sendCachedAnswer(answer, clients[i].clientAddress, clients[i].requestedId, clients[i].flagEncrypted);
+				}
+				DnsPacket packet;
+				if (packet.parsePacket(data, size)) {
+					_cacheAnswer(idForward, fe.cacheKey, packet, answer, header->getAnswersCount() == 0);
+				} else {
+					_cacheAnswer(idForward, fe.cacheKey, packet, sl_null, sl_false);
+				}
+				return;
+			}
 
 			header->setId(fe.requestedId);
 			Memory packet = Memory::create(data, size);
@@ -1202,6 +1650,137 @@ namespace slib
 		}
 	}
 
+	sl_bool DnsServer::_answerFromCache(const String& key, const SocketAddress& clientAddress, sl_uint16 id, sl_bool flagEncrypted)
+	{
+		Ref<_DnsServerCache> cache = m_cache;
+		if (cache.isNull()) {
+			return sl_false;
+		}
+		Memory packet;
+		sl_bool flagNegative = sl_false;
+		if (cache->get(key, packet, flagNegative)) {
+			Base::interlockedIncrement64(&m_nCacheHits);
+			if (flagNegative) {
+				Base::interlockedIncrement64(&m_nNegativeCacheHits);
+			}
+			_sendAnswerPacket(packet, clientAddress, id, flagEncrypted);
+			return sl_true;
+		}
+		return sl_false;
+	}
+
+#define DNS_SERVER_COALESCE_TIMEOUT 3000
+
+	sl_bool DnsServer::_coalesceQuestion(const String& key, const SocketAddress& clientAddress, sl_uint16 id, sl_bool flagEncrypted)
+	{
+		ObjectLocker lock(this);
+		sl_uint16 idForward;
+		if (m_mapPendingQuestions.get_NoLock(key, &idForward)) {
+			// the answer thread takes the element out of the map under this lock
+			ObjectLocker lockForward(&m_mapForward);
+			ForwardElement* fe = m_mapForward.getItemPointer(idForward);
+			if (fe && fe->cacheKey == key && System::getTickCount() - fe->tickSent < DNS_SERVER_COALESCE_TIMEOUT) {
+				ForwardClient client;
+				client.clientAddress = clientAddress;
+				client.requestedId = id;
+				client.flagEncrypted = flagEncrypted;
+				fe->coalescedClients.add_NoLock(client);
+				Base::interlockedIncrement64(&m_nCoalescedQuestions);
+				return sl_true;
+			}
+			// the question is lost, or the forward id is reused
+			m_mapPendingQuestions.remove_NoLock(key);
+		}
+		return sl_false;
+	}
+
+	void DnsServer::_registerForward(sl_uint16 idForward, const String& key)
+	{
+		Base::interlockedIncrement64(&m_nForwardedQuestions);
+		if (key.isNotEmpty()) {
+			ObjectLocker lock(this);
+			m_mapPendingQuestions.put_NoLock(key, idForward);
+		}
+	}
+
+	void DnsServer::_onForwardAnswer(sl_uint32 tickSent)
+	{
+		sl_uint32 latency = System::getTickCount() - tickSent;
+		Base::interlockedIncrement64(&m_nForwardedAnswers);
+		Base::interlockedAdd64(&m_sumForwardLatency, latency);
+		// called by the receiving threads
+		sl_int32 latencyMax = m_maxForwardLatency;
+		while ((sl_int32)latency > latencyMax) {
+			if (Base::interlockedCompareExchange32(&m_maxForwardLatency, (sl_int32)latency, latencyMax)) {
+				break;
+			}
+			latencyMax = m_maxForwardLatency;
+		}
+	}
+
+	void DnsServer::_cacheAnswer(sl_uint16 idForward, const String& key, const DnsPacket& packet, const Memory& answer, sl_bool flagNoData)
+	{
+		{
+			ObjectLocker lock(this);
+			sl_uint16 idPending;
+			if (m_mapPendingQuestions.get_NoLock(key, &idPending) && idPending == idForward) {
+				m_mapPendingQuestions.remove_NoLock(key);
+			}
+		}
+		Ref<_DnsServerCache> cache = m_cache;
+		if (cache.isNull() || answer.isEmpty() || packet.flagTruncated) {
+			return;
+		}
+		sl_bool flagNegative;
+		if (packet.responseCode == DnsResponseCode::NameError) {
+			flagNegative = sl_true;
+		} else if (packet.responseCode == DnsResponseCode::NoError) {
+			flagNegative = flagNoData;
+		} else {
+			// temporary failures are not cached
+			return;
+		}
+		sl_uint32 TTL = packet.minimumTTL;
+		if (flagNegative) {
+			if (TTL > m_negativeCacheTTL) {
+				TTL = m_negativeCacheTTL;
+			}
+		} else if (TTL == 0xFFFFFFFF) {
+			return;
+		}
+		if (TTL < m_cacheMinimumTTL) {
+			TTL = m_cacheMinimumTTL;
+		}
+		if (TTL > m_cacheMaximumTTL) {
+			TTL = m_cacheMaximumTTL;
+		}
+		if (!TTL) {
+			return;
+		}
+		cache->put(key, answer, TTL, flagNegative);
+	}
+
+	void DnsServer::_sendCachedAnswer(const Memory& answer, const SocketAddress& clientAddress, sl_uint16 id, sl_bool flagEncrypted)
+	{
+		if (answer.getSize() < sizeof(DnsHeader)) {
+			return;
+		}
+		Memory packet = answer.duplicate();
+		if (packet.isEmpty()) {
+			return;
+		}
+		_sendAnswerPacket(packet, clientAddress, id, flagEncrypted);
+	}
+
+	void DnsServer::_sendAnswerPacket(Memory& packet, const SocketAddress& clientAddress, sl_uint16 id, sl_bool flagEncrypted)
+	{
+		((DnsHeader*)(packet.getData()))->setId(id);
+		if (flagEncrypted) {
+			packet = m_encrypt.encrypt_CBC_PKCS7Padding(packet);
+		}
+		_sendPacket(flagEncrypted, clientAddress, packet);
+	}
+
 	void DnsServer::_resolveDnsHost(DnsResolveHostParam& param)
 	{
 		PtrLocker<IDnsServerListener> listener(m_listener);
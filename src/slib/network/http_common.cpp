@@ -14,6 +14,21 @@
 #include "slib/core/safe_static.h"
 #include "slib/core/variant.h"
 
+#if defined(__AVX2__)
+#	define _HTTP_HEADER_SCAN_USE_AVX2
+#	include <immintrin.h>
+#elif defined(__SSE2__) || defined(SLIB_ARCH_IS_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#	define _HTTP_HEADER_SCAN_USE_SSE2
+#	include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(SLIB_ARCH_IS_ARM64)
+#	define _HTTP_HEADER_SCAN_USE_NEON
+#	include <arm_neon.h>
+#endif
+
+#if defined(SLIB_COMPILER_IS_VC)
+#	include <intrin.h>
+#endif
+
 namespace slib
 {
 
@@ -157,7 +172,18 @@ namespace slib
 	DEFINE_HTTP_HEADER(Origin, "Origin")
 	DEFINE_HTTP_HEADER(AccessControlAllowOrigin, "Access-Control-Allow-Origin")
 
-	sl_reg HttpHeaders::parseHeaders(Map<String, String>& map, const void* _data, sl_size size)
+	sl_reg HttpHeaders::parseHeaders(Map<String, String>& map, const void* data, sl_size size)
+	{
+		List<HttpHeaderView> views;
+		sl_reg iRet = parseHeaders(views, data, size);
+		ListElements<HttpHeaderView> items(views);
+		for (sl_size i = 0; i < items.count; i++) {
+			map.put_NoLock(items[i].getName(), items[i].getValue(), MapPutMode::AddAlways);
+		}
+		return iRet;
+	}
+
+	sl_reg HttpHeaders::parseHeaders(List<HttpHeaderView>& list, const void* _data, sl_size size)
 	{
 		const sl_char8* data = (const sl_char8*)_data;
 		sl_size posCurrent = 0;
@@ -165,19 +191,11 @@ namespace slib
 		// headers
 		for (;;) {
 			sl_size posStart = posCurrent;
-			sl_size indexSplit = 0;
-			while (posCurrent < size) {
-				sl_char8 ch = data[posCurrent];
-				if (ch == '\r') {
-					break;
-				}
-				if (indexSplit == 0) {
-					if (ch == ':') {
-						indexSplit = posCurrent;
-					}
-				}
-				posCurrent++;
+			const sl_char8* pCR = (const sl_char8*)(Base::findMemory(data + posStart, '\r', size - posStart));
+			if (!pCR) {
+				return 0;
 			}
+			posCurrent = pCR - data;
 			if (posCurrent >= size - 1) {
 				return 0;
 			}
@@ -190,11 +208,12 @@ namespace slib
 				break;
 			}
 
-			String name;
-			String value;
-			if (indexSplit != 0) {
-				name = String::fromUtf8(data + posStart, indexSplit - posStart);
-				sl_size startValue = indexSplit + 1;
+			HttpHeaderView view;
+			view.name = data + posStart;
+			const sl_char8* pSplit = (const sl_char8*)(Base::findMemory(data + posStart, ':', posCurrent - posStart));
+			if (pSplit) {
+				view.nameLength = pSplit - view.name;
+				sl_size startValue = pSplit + 1 - data;
 				sl_size endValue = posCurrent;
 				while (startValue < endValue) {
 					if (data[startValue] != ' ' && data[startValue] != '\t') {
@@ -208,16 +227,161 @@ namespace slib
 					}
 					endValue--;
 				}
-				value = Url::decodeUriComponentByUTF8(String::fromUtf8(data + startValue, endValue - startValue));
+				view.value = data + startValue;
+				view.valueLength = endValue - startValue;
 			} else {
-				name = String::fromUtf8(data + posStart, posCurrent - posStart);
+				view.nameLength = posCurrent - posStart;
+			}
+			if (!(list.add_NoLock(view))) {
+				return -1;
 			}
-			map.put_NoLock(name, value, MapPutMode::AddAlways);
 			posCurrent += 2;
 		}
 		return posCurrent;
 	}
 
+	SLIB_INLINE static sl_uint32 _HttpHeaders_getLowestBit(sl_uint64 mask)
+	{
+#if defined(SLIB_COMPILER_IS_VC)
+#	if defined(SLIB_ARCH_IS_64BIT)
+		unsigned long index;
+		_BitScanForward64(&index, mask);
+		return (sl_uint32)index;
+#	else
+		unsigned long index;
+		if ((sl_uint32)mask) {
+			_BitScanForward(&index, (sl_uint32)mask);
+			return (sl_uint32)index;
+		}
+		_BitScanForward(&index, (sl_uint32)(mask >> 32));
+		return (sl_uint32)index + 32;
+#	endif
+#else
+		return (sl_uint32)(__builtin_ctzll(mask));
+#endif
+	}
+
+	/*
+		Compares 4 loads shifted by one byte against [CR][LF][CR][LF] at once, so that every bit of the mask marks a terminator starting there.
+	*/
+	sl_size HttpHeaders::findHeaderEnd(const void* _data, sl_size size)
+	{
+		const sl_uint8* data = (const sl_uint8*)_data;
+		if (size < 4) {
+			return 0;
+		}
+		// number of the positions where the terminator can start
+		sl_size n = size - 3;
+		sl_size i = 0;
+#if defined(_HTTP_HEADER_SCAN_USE_AVX2)
+		{
+			__m256i cr = _mm256_set1_epi8('\r');
+			__m256i lf = _mm256_set1_epi8('\n');
+			for (; i + 32 <= n; i += 32) {
+				const sl_uint8* p = data + i;
+				__m256i m0 = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)p), cr);
+				__m256i m1 = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(p + 1)), lf);
+				__m256i m2 = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(p + 2)), cr);
+				__m256i m3 = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(p + 3)), lf);
+				sl_uint32 mask = (sl_uint32)(_mm256_movemask_epi8(_mm256_and_si256(_mm256_and_si256(m0, m1), _mm256_and_si256(m2, m3))));
+				if (mask) {
+					return i + _HttpHeaders_getLowestBit(mask) + 4;
+				}
+			}
+		}
+#elif defined(_HTTP_HEADER_SCAN_USE_SSE2)
+		{
+			__m128i cr = _mm_set1_epi8('\r');
+			__m128i lf = _mm_set1_epi8('\n');
+			for (; i + 16 <= n; i += 16) {
+				const sl_uint8* p = data + i;
+				__m128i m0 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)p), cr);
+				__m128i m1 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(p + 1)), lf);
+				__m128i m2 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(p + 2)), cr);
+				__m128i m3 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(p + 3)), lf);
+				sl_uint32 mask = (sl_uint32)(_mm_movemask_epi8(_mm_and_si128(_mm_and_si128(m0, m1), _mm_and_si128(m2, m3))));
+				if (mask) {
+					return i + _HttpHeaders_getLowestBit(mask) + 4;
+				}
+			}
+		}
+#elif defined(_HTTP_HEADER_SCAN_USE_NEON)
+		{
+			uint8x16_t cr = vdupq_n_u8('\r');
+			uint8x16_t lf = vdupq_n_u8('\n');
+			for (; i + 16 <= n; i += 16) {
+				const sl_uint8* p = data + i;
+				uint8x16_t m0 = vceqq_u8(vld1q_u8(p), cr);
+				uint8x16_t m1 = vceqq_u8(vld1q_u8(p + 1), lf);
+				uint8x16_t m2 = vceqq_u8(vld1q_u8(p + 2), cr);
+				uint8x16_t m3 = vceqq_u8(vld1q_u8(p + 3), lf);
+				uint8x16_t m = vandq_u8(vandq_u8(m0, m1), vandq_u8(m2, m3));
+				// 4 bits per byte
+				sl_uint64 mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(m), 4)), 0);
+				if (mask) {
+					return i + (_HttpHeaders_getLowestBit(mask) >> 2) + 4;
+				}
+			}
+		}
+#endif
+		for (; i < n; i++) {
+			if (data[i] == '\r' && data[i + 1] == '\n' && data[i + 2] == '\r' && data[i + 3] == '\n') {
+				return i + 4;
+			}
+		}
+		return 0;
+	}
+
+
+	HttpHeaderView::HttpHeaderView()
+	{
+		name = sl_null;
+		nameLength = 0;
+		value = sl_null;
+		valueLength = 0;
+	}
+
+	HttpHeaderView::~HttpHeaderView()
+	{
+	}
+
+	String HttpHeaderView::getName() const
+	{
+		return String::fromUtf8(name, nameLength);
+	}
+
+	String HttpHeaderView::getValue() const
+	{
+		if (!value) {
+			return sl_null;
+		}
+		String str = String::fromUtf8(value, valueLength);
+		if (Base::findMemory(value, '%', valueLength)) {
+			return Url::decodeUriComponentByUTF8(str);
+		}
+		return str;
+	}
+
+	sl_bool HttpHeaderView::equalsName(const sl_char8* other, sl_size len) const
+	{
+		if (len != nameLength) {
+			return sl_false;
+		}
+		for (sl_size i = 0; i < len; i++) {
+			sl_char8 c1 = name[i];
+			sl_char8 c2 = other[i];
+			if (c1 != c2 && SLIB_CHAR_UPPER_TO_LOWER(c1) != SLIB_CHAR_UPPER_TO_LOWER(c2)) {
+				return sl_false;
+			}
+		}
+		return sl_true;
+	}
+
+	sl_bool HttpHeaderView::equalsName(const String& other) const
+	{
+		return equalsName(other.getData(), other.getLength());
+	}
+
 
 /***********************************************************************
 							HttpRequest
@@ -233,6 +397,7 @@ namespace slib
 		m_methodTextUpper = s2;
 		
 		m_requestHeaders.initHash(0, HashIgnoreCaseString(), EqualsIgnoreCaseString());
+		m_flagRequestHeadersNotBuilt = sl_false;
 	}
 
 	HttpRequest::~HttpRequest()
@@ -300,46 +465,87 @@ namespace slib
 
 	const Map<String, String>& HttpRequest::getRequestHeaders() const
 	{
+		_buildRequestHeaders();
 		return m_requestHeaders;
 	}
 
+	const List<HttpHeaderView>& HttpRequest::getRequestHeaderViews() const
+	{
+		return m_requestHeaderViews;
+	}
+
 	String HttpRequest::getRequestHeader(String name) const
 	{
+		if (m_flagRequestHeadersNotBuilt) {
+			const HttpHeaderView* view = _findRequestHeaderView(name);
+			if (view) {
+				return view->getValue();
+			}
+			return sl_null;
+		}
 		return m_requestHeaders.getValue_NoLock(name, String::null());
 	}
 
 	List<String> HttpRequest::getRequestHeaderValues(String name) const
 	{
+		if (m_flagRequestHeadersNotBuilt) {
+			List<String> ret;
+			ListElements<HttpHeaderView> views(m_requestHeaderViews);
+			// same order as the hash map, which returns the last added value first
+			for (sl_size i = views.count; i > 0; i--) {
+				if (views[i - 1].equalsName(name)) {
+					ret.add_NoLock(views[i - 1].getValue());
+				}
+			}
+			return ret;
+		}
 		return m_requestHeaders.getValues_NoLock(name);
 	}
 
 	void HttpRequest::setRequestHeader(String name, String value)
 	{
+		_buildRequestHeaders();
 		m_requestHeaders.put_NoLock(name, value);
 	}
 
 	void HttpRequest::addRequestHeader(String name, String value)
 	{
+		_buildRequestHeaders();
 		m_requestHeaders.put_NoLock(name, value, MapPutMode::AddAlways);
 	}
 
 	sl_bool HttpRequest::containsRequestHeader(String name) const
 	{
+		if (m_flagRequestHeadersNotBuilt) {
+			return _findRequestHeaderView(name) != sl_null;
+		}
 		return m_requestHeaders.contains_NoLock(name);
 	}
 
 	void HttpRequest::removeRequestHeader(String name)
 	{
+		_buildRequestHeaders();
 		m_requestHeaders.removeItems_NoLock(name);
 	}
 
 	void HttpRequest::clearRequestHeaders()
 	{
+		m_flagRequestHeadersNotBuilt = sl_false;
 		m_requestHeaders.removeAll_NoLock();
 	}
 
 	sl_uint64 HttpRequest::getRequestContentLengthHeader() const
 	{
+		if (m_flagRequestHeadersNotBuilt) {
+			const HttpHeaderView* view = _findRequestHeaderView(HttpHeaders::ContentLength);
+			if (view && view->valueLength) {
+				sl_uint64 value;
+				if (String::parseUint64(10, &value, view->value, 0, view->valueLength) == (sl_reg)(view->valueLength)) {
+					return value;
+				}
+			}
+			return 0;
+		}
 		String headerContentLength = getRequestHeader(HttpHeaders::ContentLength);
 		if (headerContentLength.isNotEmpty()) {
 			return headerContentLength.parseUint64();
@@ -592,6 +798,7 @@ namespace slib
 		msg.addStatic(strVersion.getData(), strVersion.getLength());
 		msg.addStatic("\r\n", 2);
 
+		_buildRequestHeaders();
 		Iterator< Pair<String, String> > iterator = m_requestHeaders.toIterator();
 		Pair<String, String> pair;
 		while (iterator.next(&pair)) {
@@ -607,6 +814,18 @@ namespace slib
 	}
 
 	sl_reg HttpRequest::parseRequestPacket(const void* packet, sl_size size)
+	{
+		// the views must point to the memory owned by this request
+		return parseRequestPacket(Memory::create(packet, size));
+	}
+
+	sl_reg HttpRequest::parseRequestPacket(const Memory& packet)
+	{
+		m_requestHeaderPacket = packet;
+		return _parseRequestPacket(packet.getData(), packet.getSize());
+	}
+
+	sl_reg HttpRequest::_parseRequestPacket(const void* packet, sl_size size)
 	{
 		const sl_char8* data = (const sl_char8*)packet;
 		sl_size posCurrent = 0;
@@ -674,14 +893,40 @@ namespace slib
 		setRequestVersion(String::fromUtf8(data + posStart, posCurrent - posStart));
 		posCurrent += 2;
 
-		sl_reg iRet = HttpHeaders::parseHeaders(m_requestHeaders, data + posCurrent, size - posCurrent);
+		List<HttpHeaderView> views;
+		sl_reg iRet = HttpHeaders::parseHeaders(views, data + posCurrent, size - posCurrent);
+		m_requestHeaderViews = views;
 		if (iRet > 0) {
+			m_flagRequestHeadersNotBuilt = sl_true;
 			return posCurrent + iRet;
 		} else {
 			return iRet;
 		}
 	}
 
+	const HttpHeaderView* HttpRequest::_findRequestHeaderView(const String& name) const
+	{
+		ListElements<HttpHeaderView> views(m_requestHeaderViews);
+		// the last one is returned like the hash map
+		for (sl_size i = views.count; i > 0; i--) {
+			if (views[i - 1].equalsName(name)) {
+				return views.data + (i - 1);
+			}
+		}
+		return sl_null;
+	}
+
+	void HttpRequest::_buildRequestHeaders() const
+	{
+		if (m_flagRequestHeadersNotBuilt) {
+			ListElements<HttpHeaderView> views(m_requestHeaderViews);
+			for (sl_size i = 0; i < views.count; i++) {
+				m_requestHeaders.put_NoLock(views[i].getName(), views[i].getValue(), MapPutMode::AddAlways);
+			}
+			m_flagRequestHeadersNotBuilt = sl_false;
+		}
+	}
+
 
 /***********************************************************************
 							HttpResponse
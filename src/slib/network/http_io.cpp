@@ -10,6 +10,8 @@
 
 #include "slib/network/http_io.h"
 
+#include "slib/network/http_common.h"
+
 namespace slib
 {
 
@@ -59,6 +61,11 @@ namespace slib
 		m_bufferOutput.copyFromFile(path, dispatcher);
 	}
 
+	void HttpOutputBuffer::copyFromFile(const String& path, sl_uint64 offset, sl_uint64 size, const Ref<Dispatcher>& dispatcher)
+	{
+		m_bufferOutput.copyFromFile(path, offset, size, dispatcher);
+	}
+
 	sl_uint64 HttpOutputBuffer::getOutputLength() const
 	{
 		return m_bufferOutput.getOutputLength();
@@ -85,25 +92,21 @@ namespace slib
 		}
 		sl_bool flagFound = sl_false;
 		const sl_uint8* buf = (const sl_uint8*)(_buf);
-		if (size > 0 && m_last[0] == '\r' && m_last[1] == '\n' && m_last[2] == '\r' && buf[0] == '\n') {
+		// the terminator across the previous chunk
+		if (m_last[0] == '\r' && m_last[1] == '\n' && m_last[2] == '\r' && buf[0] == '\n') {
 			posBody = 1;
 			flagFound = sl_true;
-		}
-		if (size > 1 && m_last[1] == '\r' && m_last[2] == '\n' && buf[0] == '\r' && buf[1] == '\n') {
+		} else if (size > 1 && m_last[1] == '\r' && m_last[2] == '\n' && buf[0] == '\r' && buf[1] == '\n') {
 			posBody = 2;
 			flagFound = sl_true;
-		}
-		if (size > 2 && m_last[2] == '\r' && buf[0] == '\n' && buf[1] == '\r' && buf[2] == '\n') {
+		} else if (size > 2 && m_last[2] == '\r' && buf[0] == '\n' && buf[1] == '\r' && buf[2] == '\n') {
 			posBody = 3;
 			flagFound = sl_true;
-		}
-		if (size > 3) {
-			for (sl_size i = 0; i <= size - 4; i++) {
-				if (buf[i] == '\r' && buf[i + 1] == '\n' && buf[i + 2] == '\r' && buf[i + 3] == '\n') {
-					posBody = 4 + i;
-					flagFound = sl_true;
-					break;
-				}
+		} else {
+			sl_size pos = HttpHeaders::findHeaderEnd(buf, size);
+			if (pos) {
+				posBody = pos;
+				flagFound = sl_true;
 			}
 		}
 		if (flagFound) {
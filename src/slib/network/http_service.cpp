@@ -16,6 +16,7 @@
 #include "slib/core/log.h"
 #include "slib/core/json.h"
 #include "slib/core/content_type.h"
+#include "slib/core/system.h"
 
 #define SERVICE_TAG "HTTP SERVICE"
 
@@ -103,6 +104,14 @@ namespace slib
 
 	Ref<AsyncIoLoop> HttpServiceContext::getAsyncIoLoop()
 	{
+		// the loop serving this connection when the service runs several loops
+		Ref<AsyncStream> io = getIO();
+		if (io.isNotNull()) {
+			Ref<AsyncIoLoop> loop = io->getIoLoop();
+			if (loop.isNotNull()) {
+				return loop;
+			}
+		}
 		Ref<HttpService> service = getService();
 		if (service.isNotNull()) {
 			return service->getAsyncIoLoop();
@@ -159,6 +168,10 @@ namespace slib
 	{
 		m_flagClosed = sl_true;
 		m_flagReading = sl_false;
+		m_tickLastActive = 0;
+		m_nRequestsProcessing = 0;
+		m_flagWritingResponse = sl_false;
+		m_entryIdle = sl_null;
 	}
 
 	HttpServiceConnection::~HttpServiceConnection()
@@ -210,6 +223,7 @@ namespace slib
 
 	void HttpServiceConnection::start(const void* data, sl_uint32 size)
 	{
+		_setActive();
 		m_contextCurrent.setNull();
 		if (data && size > 0) {
 			_processInput(data, size);
@@ -233,6 +247,11 @@ namespace slib
 		return m_contextCurrent;
 	}
 
+	void HttpServiceConnection::_setActive()
+	{
+		m_tickLastActive = System::getTickCount64() / 1000;
+	}
+
 	void HttpServiceConnection::_read()
 	{
 		ObjectLocker lock(this);
@@ -289,7 +308,7 @@ namespace slib
 				}
 				context->m_requestHeaderReader.clear();
 				Memory header = context->getRawRequestHeader();
-				sl_reg iRet = context->parseRequestPacket(header.getData(), header.getSize());
+				sl_reg iRet = context->parseRequestPacket(header);
 				if (iRet != (sl_reg)(context->m_requestHeader.getSize())) {
 					sendResponse_BadRequest();
 					return;
@@ -306,6 +325,8 @@ namespace slib
 				}
 				context->applyQueryToParameters();
 				if (service->preprocessRequest(context)) {
+					// the connection is taken over by the service
+					service->_unwatchIdle(this);
 					return;
 				}
 			} else {
@@ -340,6 +361,8 @@ namespace slib
 					}
 				}
 				
+				Base::interlockedIncrement32(&m_nRequestsProcessing);
+				
 				if (context->isProcessingByThread()) {
 					Ref<ThreadPool> threadPool = service->getThreadPool();
 					if (threadPool.isNotNull()) {
@@ -384,6 +407,8 @@ namespace slib
 			close();
 			return;
 		}
+		m_flagWritingResponse = sl_true;
+		Base::interlockedDecrement32(&m_nRequestsProcessing);
 		if (!(m_output->write(header))) {
 			close();
 			return;
@@ -399,12 +424,15 @@ namespace slib
 		if (result->flagError) {
 			close();
 		} else {
+			_setActive();
 			_processInput(result->data, result->size);
 		}
 	}
 
 	void HttpServiceConnection::onAsyncOutputComplete(AsyncOutput* output)
 	{
+		_setActive();
+		m_flagWritingResponse = sl_false;
 	}
 
 	void HttpServiceConnection::onAsyncOutputError(AsyncOutput* output)
@@ -518,12 +546,14 @@ namespace slib
 	class _DefaultHttpServiceConnectionProvider : public HttpServiceConnectionProvider, public IAsyncTcpServerListener
 	{
 	public:
-		Ref<AsyncTcpServer> m_server;
-		Ref<AsyncIoLoop> m_loop;
+		CList< Ref<AsyncTcpServer> > m_servers;
+		Ref<AsyncIoLoopGroup> m_loops;
+		sl_bool m_flagDistributeConnections;
 
 	public:
 		_DefaultHttpServiceConnectionProvider()
 		{
+			m_flagDistributeConnections = sl_false;
 		}
 
 		~_DefaultHttpServiceConnectionProvider()
@@ -534,21 +564,36 @@ namespace slib
 	public:
 		static Ref<HttpServiceConnectionProvider> create(HttpService* service, const SocketAddress& addressListen)
 		{
-			Ref<AsyncIoLoop> loop = service->getAsyncIoLoop();
-			if (loop.isNotNull()) {
+			Ref<AsyncIoLoopGroup> loops = service->getAsyncIoLoopGroup();
+			if (loops.isNotNull()) {
 				Ref<_DefaultHttpServiceConnectionProvider> ret = new _DefaultHttpServiceConnectionProvider;
 				if (ret.isNotNull()) {
-					ret->m_loop = loop;
+					ret->m_loops = loops;
 					ret->setService(service);
-					AsyncTcpServerParam sp;
-					sp.bindAddress = addressListen;
-					sp.listener.setWeak(ret);
-					sp.ioLoop = loop;
-					Ref<AsyncTcpServer> server = AsyncTcpServer::create(sp);
-					if (server.isNotNull()) {
-						ret->m_server = server;
-						return ret;
+					sl_uint32 nLoops = loops->getLoopsCount();
+					sl_uint32 nServers = 1;
+					if (nLoops > 1) {
+						if (service->getParam().flagUseReusePort) {
+							// every loop accepts on its own listener, the kernel balances the connections
+							nServers = nLoops;
+						} else {
+							ret->m_flagDistributeConnections = sl_true;
+						}
 					}
+					for (sl_uint32 i = 0; i < nServers; i++) {
+						AsyncTcpServerParam sp;
+						sp.bindAddress = addressListen;
+						sp.flagReusePort = nServers > 1;
+						sp.listener.setWeak(ret);
+						sp.ioLoop = loops->getLoop(i);
+						Ref<AsyncTcpServer> server = AsyncTcpServer::create(sp);
+						if (server.isNull()) {
+							ret->release();
+							return sl_null;
+						}
+						ret->m_servers.add_NoLock(server);
+					}
+					return ret;
 				}
 			}
 			return sl_null;
@@ -557,8 +602,9 @@ namespace slib
 		void release()
 		{
 			ObjectLocker lock(this);
-			if (m_server.isNotNull()) {
-				m_server->close();
+			ListElements< Ref<AsyncTcpServer> > servers(m_servers);
+			for (sl_size i = 0; i < servers.count; i++) {
+				servers[i]->close();
 			}
 		}
 
@@ -566,7 +612,12 @@ namespace slib
 		{
 			Ref<HttpService> service = getService();
 			if (service.isNotNull()) {
-				Ref<AsyncIoLoop> loop = m_loop;
+				Ref<AsyncIoLoop> loop;
+				if (m_flagDistributeConnections) {
+					loop = m_loops->getNextLoop();
+				} else {
+					loop = socketListen->getIoLoop();
+				}
 				if (loop.isNull()) {
 					return;
 				}
@@ -607,11 +658,20 @@ namespace slib
 		maxThreadsCount = 32;
 		flagProcessByThreads = sl_true;
 		
+		ioLoopsCount = 1;
+#if defined(SLIB_PLATFORM_IS_LINUX)
+		flagUseReusePort = sl_true;
+#else
+		flagUseReusePort = sl_false;
+#endif
+		
 		flagUseAsset = sl_false;
 		
 		maxRequestHeadersSize = 0x10000; // 64KB
 		maxRequestBodySize = 0x2000000; // 32MB
 		
+		connectionIdleTimeout = 0;
+		
 		flagAllowCrossOrigin = sl_false;
 		flagAlwaysRespondAcceptRangesHeader = sl_true;
 		
@@ -639,13 +699,14 @@ namespace slib
 
 	sl_bool HttpService::_init(const HttpServiceParam& param)
 	{
-		Ref<AsyncIoLoop> ioLoop = AsyncIoLoop::create(sl_false);
-		if (ioLoop.isNotNull()) {
+		Ref<AsyncIoLoopGroup> ioLoopGroup = AsyncIoLoopGroup::create(param.ioLoopsCount, sl_false);
+		if (ioLoopGroup.isNotNull()) {
 			Ref<ThreadPool> threadPool = ThreadPool::create();
 			if (threadPool.isNotNull()) {
 				threadPool->setMaximumThreadsCount(param.maxThreadsCount);
 				
-				m_ioLoop = ioLoop;
+				m_ioLoop = ioLoopGroup->getLoop(0);
+				m_ioLoopGroup = ioLoopGroup;
 				m_threadPool = threadPool;
 				m_param = param;
 				if (param.port) {
@@ -656,8 +717,16 @@ namespace slib
 				if (param.processor.isNotNull()) {
 					addProcessor(param.processor);
 				}
+				if (param.connectionIdleTimeout) {
+					List<HttpServiceConnection*> expired;
+					m_wheelIdle.advance(System::getTickCount64() / 1000, expired);
+					m_timerIdle = Timer::start(SLIB_FUNCTION_WEAKREF(HttpService, _onIdleTimer, this), 1000);
+					if (m_timerIdle.isNull()) {
+						return sl_false;
+					}
+				}
 				
-				ioLoop->start();
+				ioLoopGroup->start();
 
 				return sl_true;
 			}
@@ -694,11 +763,18 @@ namespace slib
 		}
 		m_connectionProviders.removeAll();
 		
-		Ref<AsyncIoLoop> ioLoop = m_ioLoop;
-		if (ioLoop.isNotNull()) {
-			ioLoop->release();
-			m_ioLoop.setNull();
+		Ref<Timer> timerIdle = m_timerIdle;
+		if (timerIdle.isNotNull()) {
+			timerIdle->stopAndWait();
+			m_timerIdle.setNull();
 		}
+		
+		Ref<AsyncIoLoopGroup> ioLoopGroup = m_ioLoopGroup;
+		if (ioLoopGroup.isNotNull()) {
+			ioLoopGroup->release();
+			m_ioLoopGroup.setNull();
+		}
+		m_ioLoop.setNull();
 		Ref<ThreadPool> threadPool = m_threadPool;
 		if (threadPool.isNotNull()) {
 			threadPool->release();
@@ -718,6 +794,11 @@ namespace slib
 		return m_ioLoop;
 	}
 
+	Ref<AsyncIoLoopGroup> HttpService::getAsyncIoLoopGroup()
+	{
+		return m_ioLoopGroup;
+	}
+
 	Ref<ThreadPool> HttpService::getThreadPool()
 	{
 		return m_threadPool;
@@ -861,12 +942,9 @@ namespace slib
 				
 				if (processRangeRequest(context, totalSize, rangeHeader, start, len)) {
 
-					Ref<AsyncFile> file = AsyncFile::openForRead(path, m_threadPool);
-					if (file.isNotNull()) {
-						file->seek(start);
-						context->copyFrom(file.get(), len);
-						return sl_true;
-					}
+					// sent by sendfile() when the connection is a plain socket
+					context->copyFromFile(path, start, len, m_threadPool);
+					return sl_true;
 					
 				} else {
 					return sl_true;
@@ -980,6 +1058,7 @@ namespace slib
 			connection->setRemoteAddress(remoteAddress);
 			connection->setLocalAddress(localAddress);
 			m_connections.put(connection.get(), connection);
+			_watchIdle(connection.get());
 			connection->start();
 		}
 		return connection;
@@ -990,9 +1069,69 @@ namespace slib
 		if (m_param.flagLogDebug) {
 			Log(SERVICE_TAG, "[%s] Connection Closed", String::fromPointerValue(connection));
 		}
+		_unwatchIdle(connection);
 		m_connections.remove(connection);
 	}
 
+	void HttpService::_watchIdle(HttpServiceConnection* connection)
+	{
+		sl_uint32 timeout = m_param.connectionIdleTimeout;
+		if (!timeout) {
+			return;
+		}
+		connection->_setActive();
+		MutexLocker lock(&m_lockIdle);
+		if (!(connection->m_entryIdle)) {
+			connection->m_entryIdle = m_wheelIdle.add(connection->m_tickLastActive + timeout, connection);
+		}
+	}
+
+	void HttpService::_unwatchIdle(HttpServiceConnection* connection)
+	{
+		MutexLocker lock(&m_lockIdle);
+		if (connection->m_entryIdle) {
+			m_wheelIdle.remove(connection->m_entryIdle);
+			connection->m_entryIdle = sl_null;
+		}
+	}
+
+	void HttpService::_onIdleTimer(Timer* timer)
+	{
+		sl_uint32 timeout = m_param.connectionIdleTimeout;
+		sl_uint64 now = System::getTickCount64() / 1000;
+		List< Ref<HttpServiceConnection> > connectionsIdle;
+		{
+			MutexLocker lock(&m_lockIdle);
+			List<HttpServiceConnection*> expired;
+			m_wheelIdle.advance(now, expired);
+			ListElements<HttpServiceConnection*> items(expired);
+			for (sl_size i = 0; i < items.count; i++) {
+				HttpServiceConnection* connection = items[i];
+				connection->m_entryIdle = sl_null;
+				// the activities after the connection was scheduled are applied lazily here
+				sl_uint64 tickExpire = connection->m_tickLastActive + timeout;
+				if (connection->m_nRequestsProcessing > 0 || connection->m_flagWritingResponse) {
+					tickExpire = now + timeout;
+				}
+				if (tickExpire > now) {
+					connection->m_entryIdle = m_wheelIdle.add(tickExpire, connection);
+				} else {
+					Ref<HttpServiceConnection> ref;
+					if (m_connections.get(connection, &ref)) {
+						connectionsIdle.add_NoLock(ref);
+					}
+				}
+			}
+		}
+		ListElements< Ref<HttpServiceConnection> > items(connectionsIdle);
+		for (sl_size i = 0; i < items.count; i++) {
+			if (m_param.flagLogDebug) {
+				Log(SERVICE_TAG, "[%s] Connection Idle Timeout", String::fromPointerValue(items[i].get()));
+			}
+			items[i]->close();
+		}
+	}
+
 	void HttpService::addProcessor(const Ptr<IHttpServiceProcessor>& processor)
 	{
 		m_processors.add(processor);
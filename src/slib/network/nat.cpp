@@ -11,6 +11,13 @@
 #include "slib/network/nat.h"
 
 #include "slib/core/new_helper.h"
+#include "slib/core/flat_hashtable.h"
+#include "slib/core/spin_lock.h"
+#include "slib/core/math.h"
+#include "slib/core/system.h"
+#include "slib/core/timer_wheel.h"
+
+#define NAT_INVALID_INDEX 0xFFFFFFFF
 
 namespace slib
 {
@@ -26,6 +33,11 @@ namespace slib
 		udpPortEnd = 60000;
 
 		icmpEchoIdentifier = 30000;
+
+		tcpIdleTimeout = 7440;
+		udpIdleTimeout = 300;
+
+		shardsCount = 16;
 	}
 
 	NatTableParam::~NatTableParam()
@@ -50,8 +62,8 @@ namespace slib
 	{
 		ObjectLocker lock(this);
 		m_param = param;
-		m_mappingTcp.setup(param.tcpPortBegin, param.tcpPortEnd);
-		m_mappingUdp.setup(param.udpPortBegin, param.udpPortEnd);
+		m_mappingTcp.setup(param.tcpPortBegin, param.tcpPortEnd, param.shardsCount, param.tcpIdleTimeout);
+		m_mappingUdp.setup(param.udpPortBegin, param.udpPortEnd, param.shardsCount, param.udpIdleTimeout);
 	}
 
 	sl_bool NatTable::translateOutgoingPacket(IPv4Packet* ipHeader, void* ipContent, sl_uint32 sizeContent)
@@ -62,25 +74,32 @@ namespace slib
 		}
 		if (ipHeader->isTCP()) {
 			TcpSegment* tcp = (TcpSegment*)(ipContent);
-			if (tcp->check(ipHeader, sizeContent)) {
+			if (sizeContent >= sizeof(TcpSegment)) {
+				IPv4Address sourceAddress = ipHeader->getSourceAddress();
+				sl_uint16 sourcePort = tcp->getSourcePort();
 				sl_uint16 targetPort;
-				if (m_mappingTcp.mapToExternalPort(SocketAddress(ipHeader->getSourceAddress(), tcp->getSourcePort()), targetPort)) {
+				if (m_mappingTcp.mapToExternalPort(SocketAddress(sourceAddress, sourcePort), targetPort)) {
+					// checksums are updated incrementally (RFC 1624), so the corrupted segment still fails at the receiver
 					tcp->setSourcePort(targetPort);
+					tcp->adjustChecksum(sourcePort, targetPort);
+					tcp->adjustChecksum(sourceAddress, addressTarget);
 					ipHeader->setSourceAddress(addressTarget);
-					tcp->updateChecksum(ipHeader, sizeContent);
-					ipHeader->updateChecksum();
+					ipHeader->adjustChecksum(sourceAddress, addressTarget);
 					return sl_true;
 				}
 			}
 		} else if (ipHeader->isUDP()) {
 			UdpDatagram* udp = (UdpDatagram*)(ipContent);
-			if (udp->check(ipHeader, sizeContent)) {
+			if (sizeContent >= UdpDatagram::HeaderSize && sizeContent == udp->getTotalSize()) {
+				IPv4Address sourceAddress = ipHeader->getSourceAddress();
+				sl_uint16 sourcePort = udp->getSourcePort();
 				sl_uint16 targetPort;
-				if (m_mappingUdp.mapToExternalPort(SocketAddress(ipHeader->getSourceAddress(), udp->getSourcePort()), targetPort)) {
+				if (m_mappingUdp.mapToExternalPort(SocketAddress(sourceAddress, sourcePort), targetPort)) {
 					udp->setSourcePort(targetPort);
+					udp->adjustChecksum(sourcePort, targetPort);
+					udp->adjustChecksum(sourceAddress, addressTarget);
 					ipHeader->setSourceAddress(addressTarget);
-					udp->updateChecksum(ipHeader);
-					ipHeader->updateChecksum();
+					ipHeader->adjustChecksum(sourceAddress, addressTarget);
 					return sl_true;
 				}
 			}
@@ -116,25 +135,31 @@ namespace slib
 		}
 		if (ipHeader->isTCP()) {
 			TcpSegment* tcp = (TcpSegment*)(ipContent);
-			if (tcp->check(ipHeader, sizeContent)) {
+			if (sizeContent >= sizeof(TcpSegment)) {
+				sl_uint16 targetPort = tcp->getDestinationPort();
 				SocketAddress addressSource;
-				if (m_mappingTcp.mapToInternalAddress(tcp->getDestinationPort(), addressSource)) {
-					ipHeader->setDestinationAddress(addressSource.ip.getIPv4());
+				if (m_mappingTcp.mapToInternalAddress(targetPort, addressSource)) {
+					IPv4Address sourceAddress = addressSource.ip.getIPv4();
 					tcp->setDestinationPort(addressSource.port);
-					tcp->updateChecksum(ipHeader, sizeContent);
-					ipHeader->updateChecksum();
+					tcp->adjustChecksum(targetPort, addressSource.port);
+					tcp->adjustChecksum(addressTarget, sourceAddress);
+					ipHeader->setDestinationAddress(sourceAddress);
+					ipHeader->adjustChecksum(addressTarget, sourceAddress);
 					return sl_true;
 				}
 			}
 		} else if (ipHeader->isUDP()) {
 			UdpDatagram* udp = (UdpDatagram*)(ipHeader->getContent());
-			if (udp->check(ipHeader, sizeContent)) {
+			if (sizeContent >= UdpDatagram::HeaderSize && sizeContent == udp->getTotalSize()) {
+				sl_uint16 targetPort = udp->getDestinationPort();
 				SocketAddress addressSource;
-				if (m_mappingUdp.mapToInternalAddress(udp->getDestinationPort(), addressSource)) {
-					ipHeader->setDestinationAddress(addressSource.ip.getIPv4());
+				if (m_mappingUdp.mapToInternalAddress(targetPort, addressSource)) {
+					IPv4Address sourceAddress = addressSource.ip.getIPv4();
 					udp->setDestinationPort(addressSource.port);
-					udp->updateChecksum(ipHeader);
-					ipHeader->updateChecksum();
+					udp->adjustChecksum(targetPort, addressSource.port);
+					udp->adjustChecksum(addressTarget, sourceAddress);
+					ipHeader->setDestinationAddress(sourceAddress);
+					ipHeader->adjustChecksum(addressTarget, sourceAddress);
 					return sl_true;
 				}
 			}
@@ -193,6 +218,7 @@ namespace slib
 
 	sl_uint16 NatTable::getMappedIcmpEchoSequenceNumber(const IcmpEchoAddress& address)
 	{
+		ObjectLocker lock(this);
 		IcmpEchoElement element;
 		if (m_mapIcmpEchoOutgoing.get(address, &element)) {
 			return element.sequenceNumberTarget;
@@ -208,21 +234,186 @@ namespace slib
 		return sn;
 	}
 
-	_NatTablePort::_NatTablePort()
+
+	sl_uint32 NatTable::getTcpMappingsCount()
 	{
-		flagActive = sl_false;
-		timeLastAccess.setZero();
+		return m_mappingTcp.getMappingsCount();
 	}
 
-	_NatTablePort::~_NatTablePort()
+	sl_uint32 NatTable::getUdpMappingsCount()
 	{
+		return m_mappingUdp.getMappingsCount();
 	}
 
+
+	struct _NatTableMappingEntry
+	{
+		SocketAddress address;
+		sl_uint64 tickLastAccess;
+		// scheduled at the expiry known when it was linked. the accesses after that are applied lazily when it expires
+		TimerWheelEntry<sl_uint32>* timer;
+	};
+
+	class _NatTableMappingShard
+	{
+	public:
+		SpinLock m_lock;
+
+		FlatHashTable<SocketAddress, sl_uint32> m_mapIndices;
+		_NatTableMappingEntry* m_entries;
+		sl_uint32 m_nEntries;
+
+		// bit is set for the used port
+		sl_uint64* m_bitmap;
+		sl_uint32 m_nWords;
+		sl_uint32 m_posWord;
+
+		// 1 second per tick
+		TimerWheel<sl_uint32> m_wheel;
+		sl_uint32 m_timeout;
+
+		// milliseconds elapsed since the initialization, accumulated from the wrapping tick count
+		sl_uint64 m_msElapsed;
+		sl_uint32 m_tickCountLast;
+
+	public:
+		_NatTableMappingShard()
+		{
+			m_entries = sl_null;
+			m_nEntries = 0;
+			m_bitmap = sl_null;
+			m_nWords = 0;
+			m_posWord = 0;
+			m_timeout = 0;
+			m_msElapsed = 0;
+			m_tickCountLast = 0;
+		}
+
+		~_NatTableMappingShard()
+		{
+			if (m_entries) {
+				NewHelper<_NatTableMappingEntry>::free(m_entries, m_nEntries);
+			}
+			if (m_bitmap) {
+				Base::freeMemory(m_bitmap);
+			}
+		}
+
+	public:
+		sl_bool init(sl_uint32 nEntries, sl_uint32 timeout, sl_uint32 tickCount)
+		{
+			m_entries = NewHelper<_NatTableMappingEntry>::create(nEntries);
+			if (!m_entries) {
+				return sl_false;
+			}
+			m_nEntries = nEntries;
+			m_nWords = (nEntries + 63) >> 6;
+			m_bitmap = (sl_uint64*)(Base::createMemory(m_nWords << 3));
+			if (!m_bitmap) {
+				return sl_false;
+			}
+			Base::zeroMemory(m_bitmap, m_nWords << 3);
+			if (nEntries & 63) {
+				// the bits after the last port are always used
+				m_bitmap[m_nWords - 1] = ~(((sl_uint64)1 << (nEntries & 63)) - 1);
+			}
+			m_timeout = timeout ? timeout : 1;
+			m_msElapsed = 0;
+			m_tickCountLast = tickCount;
+			return sl_true;
+		}
+
+		sl_uint64 getCurrentTick()
+		{
+			return m_wheel.getCurrentTick();
+		}
+
+		sl_uint32 allocate()
+		{
+			sl_uint32 n = m_nWords;
+			sl_uint32 pos = m_posWord;
+			for (sl_uint32 i = 0; i < n; i++) {
+				sl_uint64 free = ~(m_bitmap[pos]);
+				if (free) {
+					sl_uint32 bit = Math::getLeastSignificantBits(free);
+					m_bitmap[pos] |= ((sl_uint64)1 << bit);
+					m_posWord = pos;
+					return (pos << 6) | bit;
+				}
+				pos++;
+				if (pos >= n) {
+					pos = 0;
+				}
+			}
+			return NAT_INVALID_INDEX;
+		}
+
+		sl_bool schedule(sl_uint32 index)
+		{
+			_NatTableMappingEntry& entry = m_entries[index];
+			entry.timer = m_wheel.add(entry.tickLastAccess + m_timeout, index);
+			return entry.timer != sl_null;
+		}
+
+		// the timer of the entry must be removed or expired
+		void release(sl_uint32 index)
+		{
+			_NatTableMappingEntry& entry = m_entries[index];
+			entry.timer = sl_null;
+			m_mapIndices.remove(entry.address);
+			m_bitmap[index >> 6] &= ~((sl_uint64)1 << (index & 63));
+		}
+
+		void advance(sl_uint32 tickCount)
+		{
+			sl_uint32 delta = tickCount - m_tickCountLast;
+			if (delta >= 0x80000000) {
+				// clock is moved backward
+				delta = 0;
+			}
+			m_tickCountLast = tickCount;
+			m_msElapsed += delta;
+			sl_uint64 tick = m_msElapsed / 1000;
+			if (tick <= m_wheel.getCurrentTick()) {
+				return;
+			}
+			List<sl_uint32> expired;
+			m_wheel.advance(tick, expired);
+			ListElements<sl_uint32> indices(expired);
+			for (sl_size i = 0; i < indices.count; i++) {
+				sl_uint32 index = indices[i];
+				// the mappings accessed after they were scheduled are rescheduled by their last access
+				if (m_entries[index].tickLastAccess + m_timeout <= tick || !(schedule(index))) {
+					release(index);
+				}
+			}
+		}
+
+		// releases the mapping which expires first. the entries accessed after they were scheduled are moved to their real expiry instead
+		sl_uint32 evict()
+		{
+			for (;;) {
+				TimerWheelEntry<sl_uint32>* timer = m_wheel.getFirstEntry();
+				if (!timer) {
+					return NAT_INVALID_INDEX;
+				}
+				sl_uint32 index = timer->value;
+				sl_uint64 tickExpire = m_entries[index].tickLastAccess + m_timeout;
+				if (tickExpire <= timer->tick) {
+					m_wheel.remove(timer);
+					release(index);
+					return allocate();
+				}
+				m_wheel.reschedule(timer, tickExpire);
+			}
+		}
+
+	};
+
 	_NatTableMapping::_NatTableMapping()
 	{
-		m_ports = sl_null;
-		m_nPorts = 0;
-		m_pos = 0;
+		m_shards = sl_null;
+		m_nShards = 0;
 
 		m_portBegin = 0;
 		m_portEnd = 0;
@@ -230,110 +421,122 @@ namespace slib
 
 	_NatTableMapping::~_NatTableMapping()
 	{
-		NewHelper<_NatTablePort>::free(m_ports, m_nPorts);
+		_free();
 	}
 
-	void _NatTableMapping::setup(sl_uint16 portBegin, sl_uint16 portEnd)
+	void _NatTableMapping::_free()
 	{
-		ObjectLocker lock(this);
+		if (m_shards) {
+			NewHelper<_NatTableMappingShard>::free(m_shards, m_nShards);
+			m_shards = sl_null;
+		}
+		m_nShards = 0;
+	}
 
-		m_mapPorts.removeAll_NoLock();
+	void _NatTableMapping::setup(sl_uint16 portBegin, sl_uint16 portEnd, sl_uint32 nShards, sl_uint32 timeout)
+	{
+		ObjectLocker lock(this);
 
-		if (m_ports) {
-			NewHelper<_NatTablePort>::free(m_ports, m_nPorts);
-			m_ports = sl_null;
-		}
-		m_pos = 0;
-		m_nPorts = 0;
+		_free();
 
 		m_portBegin = portBegin;
 		m_portEnd = portEnd;
-		if (portEnd >= portBegin) {
-			m_nPorts = portEnd - portBegin + 1;
-			m_ports = NewHelper<_NatTablePort>::create(m_nPorts);
+		if (portEnd < portBegin) {
+			return;
+		}
+		sl_uint32 nPorts = (sl_uint32)(portEnd - portBegin) + 1;
+		if (nShards < 1) {
+			nShards = 1;
+		}
+		if (nShards > nPorts) {
+			nShards = nPorts;
+		}
+		_NatTableMappingShard* shards = NewHelper<_NatTableMappingShard>::create(nShards);
+		if (!shards) {
+			return;
+		}
+		sl_uint32 tickCount = System::getTickCount();
+		for (sl_uint32 i = 0; i < nShards; i++) {
+			if (!(shards[i].init((nPorts - i + nShards - 1) / nShards, timeout, tickCount))) {
+				NewHelper<_NatTableMappingShard>::free(shards, nShards);
+				return;
+			}
 		}
+		m_shards = shards;
+		m_nShards = nShards;
 	}
 
-	sl_bool _NatTableMapping::mapToExternalPort(const SocketAddress& address, sl_uint16& _port)
+	sl_bool _NatTableMapping::mapToExternalPort(const SocketAddress& address, sl_uint16& port)
 	{
-		ObjectLocker lock(this);
-
-		if (!m_ports) {
+		sl_uint32 nShards = m_nShards;
+		if (!nShards) {
 			return sl_false;
 		}
-		sl_uint32 n = m_nPorts;
-		if (!n) {
-			return sl_false;
-		}
-
-		sl_uint16 port;
-		if (m_mapPorts.get_NoLock(address, &port)) {
-			if (port >= m_portBegin && port <= m_portEnd) {
-				m_ports[port - m_portBegin].timeLastAccess = Time::now();
-				_port = port;
-				return sl_true;
-			} else {
-				m_mapPorts.remove_NoLock(address);
-			}
-		}
+		sl_uint32 hash = Hash<SocketAddress>()(address);
+		hash ^= (hash >> 16);
+		sl_uint32 iShard = hash % nShards;
+		_NatTableMappingShard& shard = m_shards[iShard];
+		sl_uint32 tickCount = System::getTickCount();
 
-		sl_uint16 pos = m_pos;
-		n *= 2;
-		sl_int64 timeAccessMin = 0;
-		sl_int64 timeAccessMax = 0;
-		for (sl_uint32 i = 0; i < n; i++) {
-			if (!(m_ports[pos].flagActive)) {
-				port = pos + m_portBegin;
-				m_ports[pos].flagActive = sl_true;
-				m_ports[pos].addressSource = address;
-				m_ports[pos].timeLastAccess = Time::now();
-				m_mapPorts.put_NoLock(address, port);
-				_port = port;
-				m_pos = (pos + 1) % m_nPorts;
-				return sl_true;
-			} else {
-				sl_int64 t = m_ports[pos].timeLastAccess.toInt();
-				if (t > timeAccessMax) {
-					timeAccessMax = t;
-				}
-				if (timeAccessMin == 0 || t < timeAccessMin) {
-					timeAccessMin = t;
+		SpinLocker lock(&(shard.m_lock));
+		shard.advance(tickCount);
+		sl_uint32 index;
+		if (shard.m_mapIndices.get(address, &index)) {
+			shard.m_entries[index].tickLastAccess = shard.getCurrentTick();
+		} else {
+			index = shard.allocate();
+			if (index == NAT_INVALID_INDEX) {
+				index = shard.evict();
+				if (index == NAT_INVALID_INDEX) {
+					return sl_false;
 				}
 			}
-			pos = (pos + 1) % m_nPorts;
-			if (i == m_nPorts) {
-				sl_int64 mid = (timeAccessMin + timeAccessMax) / 2;
-				for (sl_uint16 k = 0; k < m_nPorts; k++) {
-					if (m_ports[k].flagActive) {
-						if (m_ports[k].timeLastAccess.toInt() <= mid) {
-							m_ports[k].flagActive = sl_false;
-							m_mapPorts.remove_NoLock(m_ports[k].addressSource);
-						}
-					}
-				}
+			_NatTableMappingEntry& entry = shard.m_entries[index];
+			entry.address = address;
+			entry.tickLastAccess = shard.getCurrentTick();
+			if (!(shard.schedule(index))) {
+				shard.release(index);
+				return sl_false;
 			}
+			shard.m_mapIndices.put(address, index);
 		}
-		return sl_false;
+		port = (sl_uint16)(m_portBegin + index * nShards + iShard);
+		return sl_true;
 	}
 
 	sl_bool _NatTableMapping::mapToInternalAddress(sl_uint16 port, SocketAddress& address)
 	{
-		ObjectLocker lock(this);
-		if (!m_ports) {
+		sl_uint32 nShards = m_nShards;
+		if (!nShards) {
 			return sl_false;
 		}
-		if (!m_nPorts) {
+		if (port < m_portBegin || port > m_portEnd) {
 			return sl_false;
 		}
-		if (port >= m_portBegin && port <= m_portEnd) {
-			sl_uint32 k = port - m_portBegin;
-			if (m_ports[k].flagActive) {
-				m_ports[k].timeLastAccess = Time::now();
-				address = m_ports[k].addressSource;
-				return sl_true;
-			}
+		sl_uint32 k = port - m_portBegin;
+		_NatTableMappingShard& shard = m_shards[k % nShards];
+		sl_uint32 index = k / nShards;
+		sl_uint32 tickCount = System::getTickCount();
+
+		SpinLocker lock(&(shard.m_lock));
+		shard.advance(tickCount);
+		if (shard.m_bitmap[index >> 6] & ((sl_uint64)1 << (index & 63))) {
+			_NatTableMappingEntry& entry = shard.m_entries[index];
+			entry.tickLastAccess = shard.getCurrentTick();
+			address = entry.address;
+			return sl_true;
 		}
 		return sl_false;
 	}
-	
+
+	sl_uint32 _NatTableMapping::getMappingsCount()
+	{
+		sl_uint32 n = 0;
+		for (sl_uint32 i = 0; i < m_nShards; i++) {
+			SpinLocker lock(&(m_shards[i].m_lock));
+			n += (sl_uint32)(m_shards[i].m_mapIndices.getCount());
+		}
+		return n;
+	}
+
 }
@@ -19,6 +19,18 @@
 #include "slib/network/tcpip.h"
 #include "slib/network/ethernet.h"
 
+#if defined(SLIB_PLATFORM_IS_LINUX)
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <linux/if_packet.h>
+#include <linux/if_ether.h>
+#if defined(TPACKET3_HDRLEN)
+#define _NET_CAPTURE_SUPPORT_PACKET_RING
+#endif
+#endif
+
 #define TAG "NetCapture"
 
 #define MAX_PACKET_SIZE 65535
@@ -57,6 +69,13 @@ namespace slib
 		
 		preferedLinkDeviceType = NetworkLinkDeviceType::Ethernet;
 		
+		flagUseRingBuffer = sl_false;
+		ringBlockSize = 0x100000; // 1MB
+		ringBlocksCount = 64;
+		ringFrameSize = 2048;
+		ringBlockTimeout = 10;
+		fanoutThreadsCount = 0;
+		
 		flagAutoStart = sl_true;
 	}
 	
@@ -89,6 +108,7 @@ namespace slib
 	{
 		m_listener = param.listener;
 		m_onCapturePacket = param.onCapturePacket;
+		m_onCapturePackets = param.onCapturePackets;
 	}
 	
 	void NetCapture::_onCapturePacket(NetCapturePacket* packet)
@@ -100,6 +120,17 @@ namespace slib
 		m_onCapturePacket(this, packet);
 	}
 	
+	void NetCapture::_onCapturePackets(NetCapturePacket* packets, sl_uint32 nPackets)
+	{
+		if (m_onCapturePackets.isNotNull()) {
+			m_onCapturePackets(this, packets, nPackets);
+		} else {
+			for (sl_uint32 i = 0; i < nPackets; i++) {
+				_onCapturePacket(packets + i);
+			}
+		}
+	}
+	
 	
 	class _NetRawPacketCapture : public NetCapture
 	{
@@ -298,8 +329,354 @@ namespace slib
 		
 	};
 	
+#if defined(_NET_CAPTURE_SUPPORT_PACKET_RING)
+	class _NetPacketRing : public Referable
+	{
+	public:
+		Ref<Socket> m_socket;
+		sl_uint8* m_map;
+		sl_size m_sizeMap;
+		sl_uint32 m_sizeBlock;
+		sl_uint32 m_nBlocks;
+		
+	public:
+		_NetPacketRing()
+		{
+			m_map = sl_null;
+			m_sizeMap = 0;
+			m_sizeBlock = 0;
+			m_nBlocks = 0;
+		}
+		
+		~_NetPacketRing()
+		{
+			if (m_map) {
+				::munmap(m_map, m_sizeMap);
+			}
+		}
+		
+	public:
+		static Ref<_NetPacketRing> open(const NetCaptureParam& param, NetworkLinkDeviceType deviceType, sl_uint32 iface, sl_uint32 fanoutGroup)
+		{
+			Ref<Socket> socket;
+			if (deviceType == NetworkLinkDeviceType::Raw) {
+				socket = Socket::openPacketDatagram(NetworkLinkProtocol::All);
+			} else {
+				socket = Socket::openPacketRaw(NetworkLinkProtocol::All);
+			}
+			if (socket.isNull()) {
+				LogError(TAG, "Failed to create Packet socket");
+				return sl_null;
+			}
+			int fd = (int)(socket->getHandle());
+			
+			int version = TPACKET_V3;
+			if (::setsockopt(fd, SOL_PACKET, PACKET_VERSION, &version, sizeof(version))) {
+				LogError(TAG, "TPACKET_V3 is not supported");
+				return sl_null;
+			}
+			
+			sl_uint32 sizePage = (sl_uint32)(::getpagesize());
+			sl_uint32 sizeBlock = param.ringBlockSize;
+			sizeBlock = (sizeBlock + sizePage - 1) / sizePage * sizePage;
+			if (!sizeBlock) {
+				sizeBlock = sizePage;
+			}
+			sl_uint32 sizeFrame = param.ringFrameSize;
+			if (sizeFrame < TPACKET_ALIGNMENT || sizeFrame > sizeBlock) {
+				sizeFrame = sizeBlock;
+			}
+			sizeFrame = TPACKET_ALIGN(sizeFrame);
+			sl_uint32 nBlocks = param.ringBlocksCount;
+			if (!nBlocks) {
+				nBlocks = 1;
+			}
+			
+			tpacket_req3 req;
+			Base::zeroMemory(&req, sizeof(req));
+			req.tp_block_size = sizeBlock;
+			req.tp_block_nr = nBlocks;
+			req.tp_frame_size = sizeFrame;
+			req.tp_frame_nr = (sizeBlock / sizeFrame) * nBlocks;
+			req.tp_retire_blk_tov = param.ringBlockTimeout;
+			req.tp_feature_req_word = TP_FT_REQ_FILL_RXHASH;
+			if (::setsockopt(fd, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req))) {
+				LogError(TAG, "Failed to create the packet ring: block size=%d, blocks=%d, frame size=%d", sizeBlock, nBlocks, sizeFrame);
+				return sl_null;
+			}
+			
+			sl_size sizeMap = (sl_size)sizeBlock * nBlocks;
+			void* map = ::mmap(sl_null, sizeMap, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_LOCKED, fd, 0);
+			if (map == MAP_FAILED) {
+				// MAP_LOCKED may fail by RLIMIT_MEMLOCK
+				map = ::mmap(sl_null, sizeMap, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+				if (map == MAP_FAILED) {
+					LogError(TAG, "Failed to map the packet ring");
+					return sl_null;
+				}
+			}
+			
+			Ref<_NetPacketRing> ret = new _NetPacketRing;
+			if (ret.isNull()) {
+				::munmap(map, sizeMap);
+				return sl_null;
+			}
+			ret->m_socket = socket;
+			ret->m_map = (sl_uint8*)map;
+			ret->m_sizeMap = sizeMap;
+			ret->m_sizeBlock = sizeBlock;
+			ret->m_nBlocks = nBlocks;
+			
+			if (iface > 0) {
+				sockaddr_ll addr;
+				Base::zeroMemory(&addr, sizeof(addr));
+				addr.sll_family = AF_PACKET;
+				addr.sll_protocol = htons(ETH_P_ALL);
+				addr.sll_ifindex = (int)iface;
+				if (::bind(fd, (sockaddr*)&addr, sizeof(addr))) {
+					LogError(TAG, "Failed to bind the packet socket to the interface: %d", iface);
+					return sl_null;
+				}
+			}
+			
+			if (fanoutGroup) {
+#if defined(PACKET_FANOUT)
+				int fanout = (int)((fanoutGroup & 0xffff) | ((PACKET_FANOUT_HASH | PACKET_FANOUT_FLAG_DEFRAG) << 16));
+				if (::setsockopt(fd, SOL_PACKET, PACKET_FANOUT, &fanout, sizeof(fanout))) {
+					LogError(TAG, "Failed to join the fanout group");
+					return sl_null;
+				}
+#else
+				LogError(TAG, "PACKET_FANOUT is not supported");
+				return sl_null;
+#endif
+			}
+			return ret;
+		}
+		
+	};
+	
+	class _NetRawPacketRingCapture : public NetCapture
+	{
+	public:
+		List< Ref<_NetPacketRing> > m_rings;
+		List< Ref<Thread> > m_threads;
+		
+		NetworkLinkDeviceType m_deviceType;
+		sl_uint32 m_ifaceIndex;
+		
+		sl_bool m_flagInit;
+		sl_bool m_flagRunning;
+		
+	public:
+		_NetRawPacketRingCapture()
+		{
+			m_deviceType = NetworkLinkDeviceType::Ethernet;
+			m_ifaceIndex = 0;
+			
+			m_flagInit = sl_false;
+			m_flagRunning = sl_false;
+		}
+		
+		~_NetRawPacketRingCapture()
+		{
+			release();
+		}
+		
+	public:
+		static Ref<_NetRawPacketRingCapture> create(const NetCaptureParam& param)
+		{
+			sl_uint32 iface = 0;
+			String deviceName = param.deviceName;
+			if (deviceName.isNotEmpty()) {
+				iface = Network::getInterfaceIndexFromName(deviceName);
+				if (iface == 0) {
+					LogError(TAG, "Failed to find the interface index of device: %s", deviceName);
+					return sl_null;
+				}
+			}
+			NetworkLinkDeviceType deviceType = param.preferedLinkDeviceType;
+			if (deviceType != NetworkLinkDeviceType::Raw) {
+				deviceType = NetworkLinkDeviceType::Ethernet;
+			}
+			sl_uint32 nRings = param.fanoutThreadsCount;
+			sl_uint32 fanoutGroup = 0;
+			if (nRings > 1) {
+				static sl_int32 seq = 0;
+				fanoutGroup = (((sl_uint32)(::getpid()) << 4) + (sl_uint32)(Base::interlockedIncrement32(&seq))) & 0xffff;
+				if (!fanoutGroup) {
+					fanoutGroup = 1;
+				}
+			} else {
+				nRings = 1;
+			}
+			Ref<_NetRawPacketRingCapture> ret = new _NetRawPacketRingCapture;
+			if (ret.isNull()) {
+				return sl_null;
+			}
+			ret->_initWithParam(param);
+			ret->m_deviceType = deviceType;
+			ret->m_ifaceIndex = iface;
+			for (sl_uint32 i = 0; i < nRings; i++) {
+				Ref<_NetPacketRing> ring = _NetPacketRing::open(param, deviceType, iface, fanoutGroup);
+				if (ring.isNull()) {
+					return sl_null;
+				}
+				if (iface > 0 && param.flagPromiscuous && !i) {
+					if (!(ring->m_socket->setPromiscuousMode(deviceName, sl_true))) {
+						Log(TAG, "Failed to set promiscuous mode to the network device: %s", deviceName);
+					}
+				}
+				Ref<Thread> thread = Thread::create(SLIB_BIND_CLASS(void(), _NetRawPacketRingCapture, _run, ret.get(), ring));
+				if (thread.isNull()) {
+					LogError(TAG, "Failed to create thread");
+					return sl_null;
+				}
+				ret->m_rings.add_NoLock(ring);
+				ret->m_threads.add_NoLock(thread);
+			}
+			ret->m_flagInit = sl_true;
+			if (param.flagAutoStart) {
+				ret->start();
+			}
+			return ret;
+		}
+		
+		void release()
+		{
+			ObjectLocker lock(this);
+			if (!m_flagInit) {
+				return;
+			}
+			m_flagInit = sl_false;
+			
+			m_flagRunning = sl_false;
+			ListElements< Ref<Thread> > threads(m_threads);
+			for (sl_size i = 0; i < threads.count; i++) {
+				threads[i]->finish();
+			}
+			for (sl_size i = 0; i < threads.count; i++) {
+				threads[i]->finishAndWait();
+			}
+			m_threads.setNull();
+			m_rings.setNull();
+		}
+		
+		void start()
+		{
+			ObjectLocker lock(this);
+			if (!m_flagInit) {
+				return;
+			}
+			if (m_flagRunning) {
+				return;
+			}
+			ListElements< Ref<Thread> > threads(m_threads);
+			for (sl_size i = 0; i < threads.count; i++) {
+				if (threads[i]->start()) {
+					m_flagRunning = sl_true;
+				}
+			}
+		}
+		
+		sl_bool isRunning()
+		{
+			return m_flagRunning;
+		}
+		
+		void _run(Ref<_NetPacketRing> ring)
+		{
+			Ref<Socket> socket = ring->m_socket;
+			socket->setNonBlockingMode(sl_true);
+			Ref<SocketEvent> event = SocketEvent::createRead(socket);
+			if (event.isNull()) {
+				return;
+			}
+			
+			Array<NetCapturePacket> arrPackets;
+			sl_uint32 iBlock = 0;
+			
+			while (Thread::isNotStoppingCurrent()) {
+				tpacket_block_desc* desc = (tpacket_block_desc*)(ring->m_map + (sl_size)iBlock * ring->m_sizeBlock);
+				if (!((*((volatile sl_uint32*)&(desc->hdr.bh1.block_status))) & TP_STATUS_USER)) {
+					event->wait();
+					continue;
+				}
+				// the block is owned by user until it is returned to the kernel
+				__sync_synchronize();
+				sl_uint32 nPackets = desc->hdr.bh1.num_pkts;
+				if (nPackets) {
+					if (arrPackets.getCount() < nPackets) {
+						arrPackets = Array<NetCapturePacket>::create(nPackets < 256 ? 256 : nPackets);
+					}
+					NetCapturePacket* packets = arrPackets.getData();
+					if (packets) {
+						tpacket3_hdr* hdr = (tpacket3_hdr*)((sl_uint8*)desc + desc->hdr.bh1.offset_to_first_pkt);
+						for (sl_uint32 i = 0; i < nPackets; i++) {
+							NetCapturePacket& packet = packets[i];
+							packet.data = (sl_uint8*)hdr + hdr->tp_mac;
+							packet.length = hdr->tp_snaplen;
+							packet.time = (sl_int64)(hdr->tp_sec) * 1000000 + hdr->tp_nsec / 1000;
+							hdr = (tpacket3_hdr*)((sl_uint8*)hdr + hdr->tp_next_offset);
+						}
+						_onCapturePackets(packets, nPackets);
+					}
+				}
+				__sync_synchronize();
+				desc->hdr.bh1.block_status = TP_STATUS_KERNEL;
+				iBlock++;
+				if (iBlock >= ring->m_nBlocks) {
+					iBlock = 0;
+				}
+			}
+		}
+		
+		NetworkLinkDeviceType getLinkType()
+		{
+			return m_deviceType;
+		}
+		
+		sl_bool sendPacket(const void* buf, sl_uint32 size)
+		{
+			if (m_ifaceIndex == 0) {
+				return sl_false;
+			}
+			if (m_flagInit) {
+				L2PacketInfo info;
+				info.type = L2PacketType::OutGoing;
+				info.iface = m_ifaceIndex;
+				if (m_deviceType == NetworkLinkDeviceType::Ethernet) {
+					EthernetFrame* frame = (EthernetFrame*)buf;
+					if (size < EthernetFrame::HeaderSize) {
+						return sl_false;
+					}
+					info.protocol = frame->getProtocol();
+					info.setMacAddress(frame->getDestinationAddress());
+				} else {
+					info.protocol = NetworkLinkProtocol::IPv4;
+					info.clearAddress();
+				}
+				Ref<_NetPacketRing> ring;
+				if (m_rings.getAt(0, &ring)) {
+					sl_uint32 ret = ring->m_socket->sendPacket(buf, size, info);
+					if (ret == size) {
+						return sl_true;
+					}
+				}
+			}
+			return sl_false;
+		}
+		
+	};
+#endif
+	
 	Ref<NetCapture> NetCapture::createRawPacket(const NetCaptureParam& param)
 	{
+#if defined(_NET_CAPTURE_SUPPORT_PACKET_RING)
+		if (param.flagUseRingBuffer) {
+			return _NetRawPacketRingCapture::create(param);
+		}
+#endif
 		return _NetRawPacketCapture::create(param);
 	}
 	
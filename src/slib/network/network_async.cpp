@@ -343,6 +343,7 @@ namespace slib
 	AsyncTcpServerParam::AsyncTcpServerParam()
 	{
 		flagIPv6 = sl_false;
+		flagReusePort = sl_false;
 		
 		flagAutoStart = sl_true;
 		flagLogError = sl_true;
@@ -391,6 +392,9 @@ namespace slib
 			 */
 			socket->setOption_ReuseAddress(sl_true);
 #endif
+			if (param.flagReusePort) {
+				socket->setOption_ReusePort(sl_true);
+			}
 
 			if (!(socket->bind(param.bindAddress))) {
 				if (param.flagLogError) {
@@ -560,6 +564,17 @@ namespace slib
 		}
 	}
 
+	void AsyncUdpSocketInstance::_onReceiveBatch(AsyncUdpDatagram* datagrams, sl_uint32 count)
+	{
+		if (!count) {
+			return;
+		}
+		Ref<AsyncUdpSocket> object = Ref<AsyncUdpSocket>::from(getObject());
+		if (object.isNotNull()) {
+			object->_onReceiveBatch(datagrams, count);
+		}
+	}
+
 
 	IAsyncUdpSocketListener::IAsyncUdpSocketListener()
 	{
@@ -569,6 +584,13 @@ namespace slib
 	{
 	}
 
+	void IAsyncUdpSocketListener::onReceiveBatch(AsyncUdpSocket* socket, AsyncUdpDatagram* datagrams, sl_uint32 count)
+	{
+		for (sl_uint32 i = 0; i < count; i++) {
+			onReceiveFrom(socket, datagrams[i].address, datagrams[i].data, datagrams[i].size);
+		}
+	}
+
 	AsyncUdpSocketParam::AsyncUdpSocketParam()
 	{
 		flagIPv6 = sl_false;
@@ -576,6 +598,8 @@ namespace slib
 		flagAutoStart = sl_false;
 		flagLogError = sl_false;
 		packetSize = 65536;
+		batchSize = 0;
+		flagUseOffload = sl_true;
 	}
 
 	AsyncUdpSocketParam::~AsyncUdpSocketParam()
@@ -635,7 +659,7 @@ namespace slib
 			socket->setOption_Broadcast(sl_true);
 		}
 		
-		Ref<AsyncUdpSocketInstance> instance = _createInstance(socket, param.packetSize);
+		Ref<AsyncUdpSocketInstance> instance = _createInstance(socket, param);
 		if (instance.isNotNull()) {
 			Ref<AsyncIoLoop> loop = param.ioLoop;
 			if (loop.isNull()) {
@@ -648,6 +672,7 @@ namespace slib
 			if (ret.isNotNull()) {
 				ret->m_listener = param.listener;
 				ret->m_onReceiveFrom = param.onReceiveFrom;
+				ret->m_onReceiveBatch = param.onReceiveBatch;
 				instance->setObject(ret.get());
 				ret->setIoInstance(instance.get());
 				ret->setIoLoop(loop);
@@ -744,6 +769,30 @@ namespace slib
 		return sl_false;
 	}
 
+	sl_uint32 AsyncUdpSocket::sendToBatch(const AsyncUdpDatagram* datagrams, sl_uint32 count)
+	{
+		Ref<AsyncIoLoop> loop = getIoLoop();
+		if (loop.isNull()) {
+			return 0;
+		}
+		Ref<AsyncUdpSocketInstance> instance = _getIoInstance();
+		if (instance.isNotNull()) {
+			sl_uint32 nQueued = 0;
+			while (nQueued < count) {
+				const AsyncUdpDatagram& datagram = datagrams[nQueued];
+				if (!(instance->sendTo(datagram.address, Memory::create(datagram.data, datagram.size)))) {
+					break;
+				}
+				nQueued++;
+			}
+			if (nQueued) {
+				loop->requestOrder(instance.get());
+			}
+			return nQueued;
+		}
+		return 0;
+	}
+
 	Ref<AsyncUdpSocketInstance> AsyncUdpSocket::_getIoInstance()
 	{
 		return Ref<AsyncUdpSocketInstance>::from(AsyncIoObject::getIoInstance());
@@ -758,4 +807,19 @@ namespace slib
 		m_onReceiveFrom(this, address, data, sizeReceived);
 	}
 
+	void AsyncUdpSocket::_onReceiveBatch(AsyncUdpDatagram* datagrams, sl_uint32 count)
+	{
+		PtrLocker<IAsyncUdpSocketListener> listener(m_listener);
+		if (listener.isNotNull()) {
+			listener->onReceiveBatch(this, datagrams, count);
+		}
+		if (m_onReceiveBatch.isNotNull()) {
+			m_onReceiveBatch(this, datagrams, count);
+		} else if (m_onReceiveFrom.isNotNull()) {
+			for (sl_uint32 i = 0; i < count; i++) {
+				m_onReceiveFrom(this, datagrams[i].address, datagrams[i].data, datagrams[i].size);
+			}
+		}
+	}
+
 }
@@ -104,6 +104,8 @@ namespace slib
 	protected:
 		void _onReceive(const SocketAddress& address, sl_uint32 size);
 		
+		void _onReceiveBatch(AsyncUdpDatagram* datagrams, sl_uint32 count);
+		
 	protected:
 		AtomicRef<Socket> m_socket;
 
@@ -14,9 +14,65 @@
 
 #include "network_async.h"
 
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <errno.h>
+
+#if defined(SLIB_PLATFORM_IS_LINUX)
+#include <sys/sendfile.h>
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#include <signal.h>
+#include <pthread.h>
+
+#define UDP_BATCH_MAX_SEGMENTS 64
+#define UDP_BATCH_MAX_GSO_SIZE 65000
+#endif
+
 namespace slib
 {
 
+#if defined(SLIB_PLATFORM_IS_LINUX)
+	class _Unix_AsyncTcpSocketFileRequest : public AsyncStreamRequest
+	{
+		SLIB_DECLARE_OBJECT
+
+	public:
+		Ref<File> file;
+		sl_uint64 offset;
+
+	public:
+		_Unix_AsyncTcpSocketFileRequest(const Ref<File>& _file, sl_uint64 _offset, sl_uint32 _size, const Function<void(AsyncStreamResult*)>& callback)
+		 : AsyncStreamRequest(sl_null, _size, sl_null, callback, sl_false), file(_file), offset(_offset)
+		{
+		}
+
+	};
+
+	SLIB_DEFINE_OBJECT(_Unix_AsyncTcpSocketFileRequest, AsyncStreamRequest)
+#endif
+
+	class _Unix_AsyncTcpSocketVectorRequest : public AsyncStreamRequest
+	{
+		SLIB_DECLARE_OBJECT
+
+	public:
+		MemoryData chunks[SLIB_ASYNC_STREAM_WRITEV_MAX_CHUNKS];
+		sl_uint32 nChunks;
+
+	public:
+		_Unix_AsyncTcpSocketVectorRequest(const MemoryData* _chunks, sl_uint32 _nChunks, sl_uint32 _size, const Function<void(AsyncStreamResult*)>& callback)
+		 : AsyncStreamRequest(sl_null, _size, sl_null, callback, sl_false), nChunks(_nChunks)
+		{
+			for (sl_uint32 i = 0; i < _nChunks; i++) {
+				chunks[i] = _chunks[i];
+			}
+		}
+
+	};
+
+	SLIB_DEFINE_OBJECT(_Unix_AsyncTcpSocketVectorRequest, AsyncStreamRequest)
+
 	class _Unix_AsyncTcpSocketInstance : public AsyncTcpSocketInstance
 	{
 	public:
@@ -127,7 +183,20 @@ namespace slib
 					}
 				}
 				sl_uint32 size = request->size - m_sizeWritten;
-				sl_int32 n = socket->send((char*)(request->data) + m_sizeWritten, size);
+				sl_int32 n;
+				_Unix_AsyncTcpSocketVectorRequest* requestVector = CastInstance<_Unix_AsyncTcpSocketVectorRequest>(request.get());
+#if defined(SLIB_PLATFORM_IS_LINUX)
+				_Unix_AsyncTcpSocketFileRequest* requestFile = CastInstance<_Unix_AsyncTcpSocketFileRequest>(request.get());
+#endif
+				if (requestVector) {
+					n = _sendVector(socket.get(), requestVector);
+#if defined(SLIB_PLATFORM_IS_LINUX)
+				} else if (requestFile) {
+					n = _sendFile(socket.get(), requestFile, size);
+#endif
+				} else {
+					n = socket->send((char*)(request->data) + m_sizeWritten, size);
+				}
 				if (n > 0) {
 					m_sizeWritten += n;
 					if (m_sizeWritten >= request->size) {
@@ -149,6 +218,126 @@ namespace slib
 				request.setNull();
 			}
 		}
+
+		sl_bool writeV(const MemoryData* chunks, sl_uint32 nChunks, const Function<void(AsyncStreamResult*)>& callback)
+		{
+			if (nChunks == 0 || nChunks > SLIB_ASYNC_STREAM_WRITEV_MAX_CHUNKS) {
+				return sl_false;
+			}
+			sl_size size = 0;
+			for (sl_uint32 i = 0; i < nChunks; i++) {
+				size += chunks[i].size;
+			}
+			if (size == 0 || size > SLIB_ASYNC_STREAM_WRITEV_MAX_SIZE) {
+				return sl_false;
+			}
+			Ref<AsyncStreamRequest> req = new _Unix_AsyncTcpSocketVectorRequest(chunks, nChunks, (sl_uint32)size, callback);
+			if (req.isNotNull()) {
+				return addWriteRequest(req);
+			}
+			return sl_false;
+		}
+
+		sl_bool isWriteVSupported()
+		{
+			return sl_true;
+		}
+
+		// same convention as `Socket::send()`: 0 when the socket would block. the chunks are sent from `m_sizeWritten` by a sendmsg() call
+		sl_int32 _sendVector(Socket* socket, _Unix_AsyncTcpSocketVectorRequest* request)
+		{
+			struct iovec iov[SLIB_ASYNC_STREAM_WRITEV_MAX_CHUNKS];
+			sl_uint32 nIov = 0;
+			sl_size skip = m_sizeWritten;
+			for (sl_uint32 i = 0; i < request->nChunks; i++) {
+				MemoryData& chunk = request->chunks[i];
+				if (skip >= chunk.size) {
+					skip -= chunk.size;
+					continue;
+				}
+				iov[nIov].iov_base = (sl_uint8*)(chunk.data) + skip;
+				iov[nIov].iov_len = chunk.size - skip;
+				skip = 0;
+				nIov++;
+			}
+			if (!nIov) {
+				return 0;
+			}
+			struct msghdr msg;
+			Base::zeroMemory(&msg, sizeof(msg));
+			msg.msg_iov = iov;
+			msg.msg_iovlen = nIov;
+			int fd = (int)(socket->getHandle());
+			while (1) {
+#if defined(SLIB_PLATFORM_IS_LINUX)
+				ssize_t n = ::sendmsg(fd, &msg, MSG_NOSIGNAL);
+#else
+				// SIGPIPE is suppressed by SO_NOSIGPIPE on Apple platforms
+				ssize_t n = ::sendmsg(fd, &msg, 0);
+#endif
+				if (n > 0) {
+					return (sl_int32)n;
+				}
+				if (n < 0) {
+					if (errno == EINTR) {
+						continue;
+					}
+					if (errno == EAGAIN || errno == EWOULDBLOCK) {
+						return 0;
+					}
+				}
+				return -1;
+			}
+		}
+
+#if defined(SLIB_PLATFORM_IS_LINUX)
+		sl_bool writeFromFile(const Ref<File>& file, sl_uint64 offset, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback)
+		{
+			if (size == 0 || file.isNull()) {
+				return sl_false;
+			}
+			Ref<AsyncStreamRequest> req = new _Unix_AsyncTcpSocketFileRequest(file, offset, size, callback);
+			if (req.isNotNull()) {
+				return addWriteRequest(req);
+			}
+			return sl_false;
+		}
+
+		// same convention as `Socket::send()`: 0 when the socket would block.
+		// sendfile() may return a short count without filling the socket buffer, so it is repeated until it would block; otherwise no write-space event follows
+		sl_int32 _sendFile(Socket* socket, _Unix_AsyncTcpSocketFileRequest* request, sl_uint32 size)
+		{
+			int fdSocket = (int)(socket->getHandle());
+			int fdFile = (int)(request->file->getHandle());
+			off_t offset = (off_t)(request->offset + m_sizeWritten);
+			// sendfile() has no MSG_NOSIGNAL: SIGPIPE is blocked in this thread, and the one raised by a closed peer is consumed
+			sigset_t setPipe, setOld;
+			sigemptyset(&setPipe);
+			sigaddset(&setPipe, SIGPIPE);
+			pthread_sigmask(SIG_BLOCK, &setPipe, &setOld);
+			sl_int32 ret = 0;
+			while ((sl_uint32)ret < size) {
+				ssize_t n = ::sendfile(fdSocket, fdFile, &offset, size - ret);
+				if (n > 0) {
+					ret += (sl_int32)n;
+				} else if (n < 0 && errno == EINTR) {
+					continue;
+				} else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+					break;
+				} else {
+					if (n < 0 && errno == EPIPE) {
+						struct timespec t = {0, 0};
+						sigtimedwait(&setPipe, sl_null, &t);
+					}
+					// the peer is closed, or the file is truncated
+					ret = -1;
+					break;
+				}
+			}
+			pthread_sigmask(SIG_SETMASK, &setOld, sl_null);
+			return ret;
+		}
+#endif
 		
 		void onOrder()
 		{
@@ -294,9 +483,37 @@ namespace slib
 
 	class _Unix_AsyncUdpSocketInstance : public AsyncUdpSocketInstance
 	{
+	public:
+#if defined(SLIB_PLATFORM_IS_LINUX)
+		sl_uint32 m_nBatch;
+		sl_uint32 m_sizePacket;
+		sl_bool m_flagGro;
+		sl_bool m_flagGso;
+		sl_uint32 m_sizeGsoSegmentMax;
+		
+		union ControlBuffer
+		{
+			cmsghdr header;
+			char data[CMSG_SPACE(sizeof(int))];
+		};
+		Array<mmsghdr> m_msgs;
+		Array<iovec> m_iovs;
+		Array<sockaddr_storage> m_addrs;
+		Array<ControlBuffer> m_controls;
+		Array<AsyncUdpDatagram> m_datagrams;
+		Array<SendRequest> m_requests;
+#endif
+		
 	public:
 		_Unix_AsyncUdpSocketInstance()
 		{
+#if defined(SLIB_PLATFORM_IS_LINUX)
+			m_nBatch = 0;
+			m_sizePacket = 0;
+			m_flagGro = sl_false;
+			m_flagGso = sl_false;
+			m_sizeGsoSegmentMax = UDP_BATCH_MAX_GSO_SIZE;
+#endif
 		}
 		
 		~_Unix_AsyncUdpSocketInstance()
@@ -345,6 +562,247 @@ namespace slib
 			}
 		}
 		
+#if defined(SLIB_PLATFORM_IS_LINUX)
+		sl_bool initBatch(const AsyncUdpSocketParam& param)
+		{
+			sl_uint32 n = param.batchSize;
+			m_msgs = Array<mmsghdr>::create(n);
+			m_iovs = Array<iovec>::create(n);
+			m_addrs = Array<sockaddr_storage>::create(n);
+			m_controls = Array<ControlBuffer>::create(n);
+			m_datagrams = Array<AsyncUdpDatagram>::create(n);
+			m_requests = Array<SendRequest>::create(n);
+			if (m_msgs.isNull() || m_iovs.isNull() || m_addrs.isNull() || m_controls.isNull() || m_datagrams.isNull() || m_requests.isNull()) {
+				return sl_false;
+			}
+			m_nBatch = n;
+			m_sizePacket = param.packetSize;
+			if (param.flagUseOffload) {
+				int fd = (int)(getHandle());
+#if defined(UDP_GRO)
+				// coalesced datagrams can not be split if they are truncated
+				if (m_sizePacket >= 65535) {
+					int v = 1;
+					if (!(::setsockopt(fd, IPPROTO_UDP, UDP_GRO, &v, sizeof(v)))) {
+						m_flagGro = sl_true;
+					}
+				}
+#endif
+#if defined(UDP_SEGMENT)
+				int size = 0;
+				socklen_t len = sizeof(size);
+				if (!(::getsockopt(fd, IPPROTO_UDP, UDP_SEGMENT, &size, &len))) {
+					m_flagGso = sl_true;
+				}
+#endif
+			}
+			return sl_true;
+		}
+		
+		static sl_uint32 applyAddress(SocketType type, sockaddr_storage& addr, SocketAddress address)
+		{
+			if (type == SocketType::UdpIPv6) {
+				if (address.ip.isIPv4()) {
+					address.ip = IPv6Address(address.ip.getIPv4());
+				} else if (!(address.ip.isIPv6())) {
+					return 0;
+				}
+			} else if (!(address.ip.isIPv4())) {
+				return 0;
+			}
+			return address.getSystemSocketAddress(&addr);
+		}
+		
+		void processSendBatch(Socket* socket)
+		{
+			int fd = (int)(socket->getHandle());
+			SocketType type = socket->getType();
+			mmsghdr* msgs = m_msgs.getData();
+			iovec* iovs = m_iovs.getData();
+			sockaddr_storage* addrs = m_addrs.getData();
+			ControlBuffer* controls = m_controls.getData();
+			SendRequest* requests = m_requests.getData();
+			while (Thread::isNotStoppingCurrent()) {
+				sl_uint32 nRequests = 0;
+				while (nRequests < m_nBatch && m_queueSendRequests.pop(requests + nRequests)) {
+					nRequests++;
+				}
+				if (!nRequests) {
+					break;
+				}
+				sl_uint32 nMsgs = 0;
+				sl_uint32 i = 0;
+				while (i < nRequests) {
+					SendRequest& request = requests[i];
+					sl_uint32 lenAddr = applyAddress(type, addrs[nMsgs], request.addressTo);
+					if (!lenAddr) {
+						i++;
+						continue;
+					}
+					sl_uint32 sizeSegment = (sl_uint32)(request.data.getSize());
+					sl_uint32 nSegments = 1;
+					// empty datagrams are sent alone, as GSO needs a segment size
+					if (m_flagGso && sizeSegment && sizeSegment <= m_sizeGsoSegmentMax) {
+						// only the last segment can be shorter than the others
+						sl_uint32 sizeTotal = sizeSegment;
+						while (i + nSegments < nRequests && nSegments < UDP_BATCH_MAX_SEGMENTS) {
+							SendRequest& next = requests[i + nSegments];
+							sl_uint32 size = (sl_uint32)(next.data.getSize());
+							if (!size || size > sizeSegment || sizeTotal + size > UDP_BATCH_MAX_GSO_SIZE || !(next.addressTo == request.addressTo)) {
+								break;
+							}
+							sizeTotal += size;
+							nSegments++;
+							if (size < sizeSegment) {
+								break;
+							}
+						}
+					}
+					for (sl_uint32 k = 0; k < nSegments; k++) {
+						Memory& data = requests[i + k].data;
+						iovs[i + k].iov_base = data.getData();
+						iovs[i + k].iov_len = data.getSize();
+					}
+					msghdr& hdr = msgs[nMsgs].msg_hdr;
+					Base::zeroMemory(&hdr, sizeof(hdr));
+					hdr.msg_name = addrs + nMsgs;
+					hdr.msg_namelen = (socklen_t)lenAddr;
+					hdr.msg_iov = iovs + i;
+					hdr.msg_iovlen = nSegments;
+#if defined(UDP_SEGMENT)
+					if (nSegments > 1) {
+						hdr.msg_control = controls[nMsgs].data;
+						hdr.msg_controllen = CMSG_SPACE(sizeof(sl_uint16));
+						cmsghdr* cmsg = CMSG_FIRSTHDR(&hdr);
+						cmsg->cmsg_level = IPPROTO_UDP;
+						cmsg->cmsg_type = UDP_SEGMENT;
+						cmsg->cmsg_len = CMSG_LEN(sizeof(sl_uint16));
+						*((sl_uint16*)(CMSG_DATA(cmsg))) = (sl_uint16)sizeSegment;
+					}
+#endif
+					msgs[nMsgs].msg_len = 0;
+					nMsgs++;
+					i += nSegments;
+				}
+				sl_uint32 iMsg = 0;
+				while (iMsg < nMsgs) {
+					int nSent = ::sendmmsg(fd, msgs + iMsg, nMsgs - iMsg, 0);
+					if (nSent > 0) {
+						iMsg += nSent;
+						continue;
+					}
+					int err = errno;
+					if (err == EAGAIN || err == EWOULDBLOCK) {
+						// same as `sendTo`, the datagrams are dropped when the send buffer is full
+						break;
+					}
+					msghdr& hdr = msgs[iMsg].msg_hdr;
+					if (hdr.msg_control) {
+						sl_uint32 sizeSegment = (sl_uint32)(hdr.msg_iov->iov_len);
+						if (err == EINVAL && sizeSegment > 1) {
+							// the segment exceeds the path MTU: the limit is only lowered
+							if (sizeSegment - 1 < m_sizeGsoSegmentMax) {
+								m_sizeGsoSegmentMax = sizeSegment - 1;
+							}
+						} else {
+							// GSO is not supported by the device or the kernel
+							m_flagGso = sl_false;
+						}
+						// sends the segments one by one
+						msghdr single = hdr;
+						single.msg_control = sl_null;
+						single.msg_controllen = 0;
+						single.msg_iovlen = 1;
+						for (sl_size k = 0; k < hdr.msg_iovlen; k++) {
+							single.msg_iov = hdr.msg_iov + k;
+							::sendmsg(fd, &single, 0);
+						}
+					}
+					iMsg++;
+				}
+				for (i = 0; i < nRequests; i++) {
+					requests[i].data.setNull();
+				}
+			}
+		}
+		
+		void processReceiveBatch(Socket* socket)
+		{
+			int fd = (int)(socket->getHandle());
+			sl_uint8* buf = (sl_uint8*)(m_buffer.getData());
+			mmsghdr* msgs = m_msgs.getData();
+			iovec* iovs = m_iovs.getData();
+			sockaddr_storage* addrs = m_addrs.getData();
+			ControlBuffer* controls = m_controls.getData();
+			AsyncUdpDatagram* datagrams = m_datagrams.getData();
+			sl_uint32 n = m_nBatch;
+			while (Thread::isNotStoppingCurrent()) {
+				for (sl_uint32 i = 0; i < n; i++) {
+					iovs[i].iov_base = buf + (sl_size)i * m_sizePacket;
+					iovs[i].iov_len = m_sizePacket;
+					msghdr& hdr = msgs[i].msg_hdr;
+					Base::zeroMemory(&hdr, sizeof(hdr));
+					hdr.msg_name = addrs + i;
+					hdr.msg_namelen = sizeof(sockaddr_storage);
+					hdr.msg_iov = iovs + i;
+					hdr.msg_iovlen = 1;
+					if (m_flagGro) {
+						hdr.msg_control = controls[i].data;
+						hdr.msg_controllen = sizeof(ControlBuffer);
+					}
+					msgs[i].msg_len = 0;
+				}
+				int nReceived = ::recvmmsg(fd, msgs, n, MSG_DONTWAIT, sl_null);
+				if (nReceived <= 0) {
+					break;
+				}
+				sl_uint32 nDatagrams = 0;
+				for (int i = 0; i < nReceived; i++) {
+					msghdr& hdr = msgs[i].msg_hdr;
+					sl_uint32 size = msgs[i].msg_len;
+					if (!size) {
+						continue;
+					}
+					SocketAddress address;
+					address.setSystemSocketAddress(addrs + i);
+					sl_uint32 sizeSegment = size;
+#if defined(UDP_GRO)
+					if (m_flagGro) {
+						for (cmsghdr* cmsg = CMSG_FIRSTHDR(&hdr); cmsg; cmsg = CMSG_NXTHDR(&hdr, cmsg)) {
+							if (cmsg->cmsg_level == IPPROTO_UDP && cmsg->cmsg_type == UDP_GRO) {
+								int sizeGro = *((int*)(CMSG_DATA(cmsg)));
+								if (sizeGro > 0) {
+									sizeSegment = (sl_uint32)sizeGro;
+								}
+								break;
+							}
+						}
+					}
+#endif
+					// splits the datagrams coalesced by GRO
+					sl_uint8* data = (sl_uint8*)(hdr.msg_iov->iov_base);
+					while (size) {
+						if (nDatagrams >= n) {
+							_onReceiveBatch(datagrams, nDatagrams);
+							nDatagrams = 0;
+						}
+						AsyncUdpDatagram& datagram = datagrams[nDatagrams];
+						datagram.address = address;
+						datagram.data = data;
+						datagram.size = sizeSegment < size ? sizeSegment : size;
+						data += datagram.size;
+						size -= datagram.size;
+						nDatagrams++;
+					}
+				}
+				_onReceiveBatch(datagrams, nDatagrams);
+				if ((sl_uint32)nReceived < n) {
+					break;
+				}
+			}
+		}
+#endif
+		
 		void processSend()
 		{
 			Ref<Socket> socket = m_socket;
@@ -354,6 +812,12 @@ namespace slib
 			if (!(socket->isOpened())) {
 				return;
 			}
+#if defined(SLIB_PLATFORM_IS_LINUX)
+			if (m_nBatch) {
+				processSendBatch(socket.get());
+				return;
+			}
+#endif
 			while (Thread::isNotStoppingCurrent()) {
 				SendRequest request;
 				if (m_queueSendRequests.pop(&request)) {
@@ -373,6 +837,12 @@ namespace slib
 			if (!(socket->isOpened())) {
 				return;
 			}
+#if defined(SLIB_PLATFORM_IS_LINUX)
+			if (m_nBatch) {
+				processReceiveBatch(socket.get());
+				return;
+			}
+#endif
 			void* buf = m_buffer.getData();
 			sl_uint32 sizeBuf = (sl_uint32)(m_buffer.getSize());
 			while (Thread::isNotStoppingCurrent()) {
@@ -388,9 +858,23 @@ namespace slib
 
 	};
 
-	Ref<AsyncUdpSocketInstance> AsyncUdpSocket::_createInstance(const Ref<Socket>& socket, sl_uint32 packetSize)
+	Ref<AsyncUdpSocketInstance> AsyncUdpSocket::_createInstance(const Ref<Socket>& socket, const AsyncUdpSocketParam& param)
 	{
-		Memory buffer = Memory::create(packetSize);
+#if defined(SLIB_PLATFORM_IS_LINUX)
+		if (param.batchSize > 1) {
+			Memory buffer = Memory::create((sl_size)(param.packetSize) * param.batchSize);
+			if (buffer.isNotEmpty()) {
+				Ref<_Unix_AsyncUdpSocketInstance> ret = _Unix_AsyncUdpSocketInstance::create(socket, buffer);
+				if (ret.isNotNull()) {
+					if (ret->initBatch(param)) {
+						return ret;
+					}
+				}
+			}
+			return sl_null;
+		}
+#endif
+		Memory buffer = Memory::create(param.packetSize);
 		if (buffer.isNotEmpty()) {
 			return _Unix_AsyncUdpSocketInstance::create(socket, buffer);
 		}
@@ -593,9 +593,9 @@ namespace slib
 
 	};
 
-	Ref<AsyncUdpSocketInstance> AsyncUdpSocket::_createInstance(const Ref<Socket>& socket, sl_uint32 packetSize)
+	Ref<AsyncUdpSocketInstance> AsyncUdpSocket::_createInstance(const Ref<Socket>& socket, const AsyncUdpSocketParam& param)
 	{
-		Memory buffer = Memory::create(packetSize);
+		Memory buffer = Memory::create(param.packetSize);
 		if (buffer.isNotEmpty()) {
 			return _Win32AsyncUdpSocketInstance::create(socket, buffer);
 		}
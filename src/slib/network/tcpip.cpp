@@ -13,29 +13,102 @@
 #include "slib/network/icmp.h"
 #include "slib/core/mio.h"
 
+#if defined(__AVX2__)
+#	define _TCPIP_CHECKSUM_USE_AVX2
+#	include <immintrin.h>
+#elif defined(__SSE2__) || defined(SLIB_ARCH_IS_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#	define _TCPIP_CHECKSUM_USE_SSE2
+#	include <emmintrin.h>
+#elif (defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(SLIB_ARCH_IS_ARM64)) && !defined(__ARM_BIG_ENDIAN)
+#	define _TCPIP_CHECKSUM_USE_NEON
+#	include <arm_neon.h>
+#endif
+
 namespace slib
 {
 
+	/*
+		The 32-bit words are accumulated into 64-bit lanes in little endian order, and the carries are folded only once at the end.
+		1's complement sum is independent of the byte order (RFC 1071), so the folded sum is swapped to the network order.
+	*/
 	sl_uint16 TCP_IP::calculateOneComplementSum(const void* data, sl_size size, sl_uint32 add)
 	{
-		sl_uint32 sum = add;
-		sl_uint8* p = (sl_uint8*)data;
-		while (size > 1) {
-			sl_uint16 w = *((sl_uint8*)(p));
-			w = (w << 8) | *((sl_uint8*)(p + 1));
-			sum += w; // can be computed in either byte order
+		const sl_uint8* p = (const sl_uint8*)data;
+		sl_uint64 sum = 0;
+#if defined(_TCPIP_CHECKSUM_USE_AVX2)
+		if (size >= 32) {
+			__m256i acc0 = _mm256_setzero_si256();
+			__m256i acc1 = _mm256_setzero_si256();
+			__m256i zero = _mm256_setzero_si256();
+			do {
+				__m256i v = _mm256_loadu_si256((const __m256i*)p);
+				acc0 = _mm256_add_epi64(acc0, _mm256_unpacklo_epi32(v, zero));
+				acc1 = _mm256_add_epi64(acc1, _mm256_unpackhi_epi32(v, zero));
+				p += 32;
+				size -= 32;
+			} while (size >= 32);
+			acc0 = _mm256_add_epi64(acc0, acc1);
+			__m128i s = _mm_add_epi64(_mm256_castsi256_si128(acc0), _mm256_extracti128_si256(acc0, 1));
+			sl_uint64 lanes[2];
+			_mm_storeu_si128((__m128i*)lanes, s);
+			sum = lanes[0] + lanes[1];
+		}
+#elif defined(_TCPIP_CHECKSUM_USE_SSE2)
+		if (size >= 16) {
+			__m128i acc0 = _mm_setzero_si128();
+			__m128i acc1 = _mm_setzero_si128();
+			__m128i zero = _mm_setzero_si128();
+			do {
+				__m128i v = _mm_loadu_si128((const __m128i*)p);
+				acc0 = _mm_add_epi64(acc0, _mm_unpacklo_epi32(v, zero));
+				acc1 = _mm_add_epi64(acc1, _mm_unpackhi_epi32(v, zero));
+				p += 16;
+				size -= 16;
+			} while (size >= 16);
+			sl_uint64 lanes[2];
+			_mm_storeu_si128((__m128i*)lanes, _mm_add_epi64(acc0, acc1));
+			sum = lanes[0] + lanes[1];
+		}
+#elif defined(_TCPIP_CHECKSUM_USE_NEON)
+		if (size >= 16) {
+			uint64x2_t acc = vdupq_n_u64(0);
+			do {
+				acc = vpadalq_u32(acc, vreinterpretq_u32_u8(vld1q_u8(p)));
+				p += 16;
+				size -= 16;
+			} while (size >= 16);
+			sum = vgetq_lane_u64(acc, 0) + vgetq_lane_u64(acc, 1);
+		}
+#endif
+		while (size >= 8) {
+			sum += MIO::readUint32LE(p);
+			sum += MIO::readUint32LE(p + 4);
+			p += 8;
+			size -= 8;
+		}
+		if (size >= 4) {
+			sum += MIO::readUint32LE(p);
+			p += 4;
+			size -= 4;
+		}
+		if (size >= 2) {
+			sum += MIO::readUint16LE(p);
 			p += 2;
 			size -= 2;
 		}
 		if (size) {
-			sl_uint16 w = *((sl_uint8*)p);
-			w = w << 8;
-			sum += w;
+			sum += *p;
 		}
-		while (sum >> 16) {
-			sum = (sum >> 16) + (sum & 0xffff); // 1's complement sum
+		sum = (sum >> 32) + (sum & 0xffffffff);
+		sum = (sum >> 32) + (sum & 0xffffffff);
+		sl_uint32 s = (sl_uint32)((sum >> 16) + (sum & 0xffff));
+		s = (s >> 16) + (s & 0xffff);
+		s = ((s >> 8) & 0xff) | ((s & 0xff) << 8);
+		s += add;
+		while (s >> 16) {
+			s = (s >> 16) + (s & 0xffff); // 1's complement sum
 		}
-		return sum;
+		return (sl_uint16)s;
 	}
 	
 	// Referenced from RFC 1071
@@ -45,6 +118,29 @@ namespace slib
 		return (sl_uint16)(~sum); // 1's complement
 	}
 	
+	// HC' = ~(~HC + ~m + m') (RFC 1624, Eqn. 3)
+	sl_uint16 TCP_IP::adjustChecksum(sl_uint16 checksum, sl_uint16 wordOld, sl_uint16 wordNew)
+	{
+		sl_uint32 sum = (sl_uint16)(~checksum);
+		sum += (sl_uint16)(~wordOld);
+		sum += wordNew;
+		sum = (sum >> 16) + (sum & 0xffff);
+		sum = (sum >> 16) + (sum & 0xffff);
+		return (sl_uint16)(~sum);
+	}
+	
+	sl_uint16 TCP_IP::adjustChecksum32(sl_uint16 checksum, sl_uint32 wordOld, sl_uint32 wordNew)
+	{
+		sl_uint32 sum = (sl_uint16)(~checksum);
+		sum += (sl_uint16)(~(wordOld >> 16));
+		sum += (sl_uint16)(~wordOld);
+		sum += wordNew >> 16;
+		sum += wordNew & 0xffff;
+		sum = (sum >> 16) + (sum & 0xffff);
+		sum = (sum >> 16) + (sum & 0xffff);
+		return (sl_uint16)(~sum);
+	}
+	
 	
 	sl_uint32 IPv4Packet::getVersion() const
 	{
@@ -154,6 +250,11 @@ namespace slib
 		MIO::writeUint16BE(_headerChecksum, TCP_IP::calculateChecksum(this, getHeaderSize()));
 	}
 	
+	void IPv4Packet::adjustChecksum(const IPv4Address& addressOld, const IPv4Address& addressNew)
+	{
+		setChecksum(TCP_IP::adjustChecksum32(getChecksum(), addressOld.getInt(), addressNew.getInt()));
+	}
+	
 	sl_bool IPv4Packet::checkChecksum() const
 	{
 		sl_uint16 checksum = TCP_IP::calculateChecksum(this, getHeaderSize());
@@ -394,6 +495,16 @@ namespace slib
 		return checksum == 0;
 	}
 	
+	void TcpSegment::adjustChecksum(const IPv4Address& addressOld, const IPv4Address& addressNew)
+	{
+		setChecksum(TCP_IP::adjustChecksum32(getChecksum(), addressOld.getInt(), addressNew.getInt()));
+	}
+	
+	void TcpSegment::adjustChecksum(sl_uint16 portOld, sl_uint16 portNew)
+	{
+		setChecksum(TCP_IP::adjustChecksum(getChecksum(), portOld, portNew));
+	}
+	
 	sl_bool TcpSegment::check(IPv4Packet* ip, sl_uint32 sizeTcp) const
 	{
 		if (sizeTcp < sizeof(TcpSegment)) {
@@ -459,6 +570,32 @@ namespace slib
 		return checksum == 0 || checksum == 0xFFFF;
 	}
 	
+	void UdpDatagram::adjustChecksum(const IPv4Address& addressOld, const IPv4Address& addressNew)
+	{
+		sl_uint16 checksum = getChecksum();
+		if (checksum == 0) {
+			return;
+		}
+		checksum = TCP_IP::adjustChecksum32(checksum, addressOld.getInt(), addressNew.getInt());
+		if (checksum == 0) {
+			checksum = 0xFFFF;
+		}
+		setChecksum(checksum);
+	}
+	
+	void UdpDatagram::adjustChecksum(sl_uint16 portOld, sl_uint16 portNew)
+	{
+		sl_uint16 checksum = getChecksum();
+		if (checksum == 0) {
+			return;
+		}
+		checksum = TCP_IP::adjustChecksum(checksum, portOld, portNew);
+		if (checksum == 0) {
+			checksum = 0xFFFF;
+		}
+		setChecksum(checksum);
+	}
+	
 	sl_bool UdpDatagram::check(IPv4Packet* ip, sl_uint32 sizeUdp) const
 	{
 		if (sizeUdp < HeaderSize) {
@@ -56,6 +56,7 @@ namespace slib
 		flagSelfAlive = sl_true;
 		flagStoreResponseContent = sl_true;
 		flagSynchronous = sl_false;
+		flagHttp2 = sl_false;
 	}
 	
 	UrlRequestParam::UrlRequestParam(const UrlRequestParam& other) = default;
@@ -102,6 +103,7 @@ namespace slib
 		m_flagSelfAlive = sl_false;
 		m_flagStoreResponseContent = sl_true;
 		m_flagUseBackgroundSession = sl_false;
+		m_flagHttp2 = sl_false;
 
 	}
 	
@@ -427,6 +429,18 @@ namespace slib
 		return send(rp);
 	}
 	
+	static volatile sl_uint32 _g_url_request_max_connections_per_host = 0;
+	
+	sl_uint32 UrlRequest::getMaxConnectionsPerHost()
+	{
+		return _g_url_request_max_connections_per_host;
+	}
+	
+	void UrlRequest::setMaxConnectionsPerHost(sl_uint32 n)
+	{
+		_g_url_request_max_connections_per_host = n;
+	}
+	
 	const String& UrlRequest::getUrl()
 	{
 		return m_url;
@@ -583,6 +597,11 @@ namespace slib
 		return m_flagError;
 	}
 	
+	String UrlRequest::getLastErrorMessage()
+	{
+		return m_lastErrorMessage;
+	}
+	
 	sl_bool UrlRequest::isClosed()
 	{
 		return m_flagClosed;
@@ -649,6 +668,7 @@ namespace slib
 		m_flagUseBackgroundSession = param.flagUseBackgroundSession;
 		m_flagSelfAlive = param.flagSelfAlive && !(param.flagSynchronous);
 		m_flagStoreResponseContent = param.flagStoreResponseContent;
+		m_flagHttp2 = param.flagHttp2;
 		
 		if (m_flagSelfAlive) {
 			_UrlRequestMap* map = _getUrlRequestMap();
@@ -1,36 +1,162 @@
 #include "slib/core/definition.h"
 
 #if defined(SLIB_PLATFORM_IS_TIZEN)
+#	define _URL_REQUEST_USE_CURL
+#elif defined(SLIB_PLATFORM_IS_LINUX) && defined(SLIB_PLATFORM_IS_DESKTOP) && defined(__has_include)
+// the desktop build doesn't require the libcurl headers: `UrlRequest` is not implemented without them
+#	if __has_include(<curl/curl.h>)
+#		define _URL_REQUEST_USE_CURL
+#	endif
+#endif
+
+#if defined(_URL_REQUEST_USE_CURL)
 
 #include "slib/network/url_request.h"
 
 #include "slib/core/file.h"
 #include "slib/core/log.h"
+#include "slib/core/thread.h"
+#include "slib/core/thread_pool.h"
+#include "slib/core/queue.h"
+#include "slib/core/hashtable.h"
+#include "slib/core/safe_static.h"
 
 #include <curl/curl.h>
+#if defined(SLIB_PLATFORM_IS_TIZEN)
 #include <net_connection.h>
+#endif
 #include <stdlib.h>
 
+#if LIBCURL_VERSION_NUM >= 0x074400
+#define _URL_REQUEST_CURL_USE_MULTI_POLL
+#endif
+
 namespace slib
 {
 
+	class UrlRequest_Impl;
+
+	/*
+		Process-wide `curl_multi` engine.
+
+		All the transfers are driven by one thread, so that the connections (including HTTP/2 multiplexed streams), resolved hosts and TLS sessions are reused across the requests.
+		Completion callbacks are run on a thread pool, so that they can block or send synchronous requests.
+	*/
+	class _UrlRequestCurlEngine
+	{
+	public:
+		CURLM* m_multi;
+		CURLSH* m_share;
+		Ref<Thread> m_thread;
+		Ref<ThreadPool> m_threadPool;
+
+		LinkedQueue< Ref<UrlRequest_Impl> > m_queueRequests;
+		HashTable< CURL*, Ref<UrlRequest_Impl> > m_mapActive;
+		sl_uint32 m_maxConnectionsPerHost;
+
+	public:
+		_UrlRequestCurlEngine()
+		{
+			m_maxConnectionsPerHost = 0;
+			::curl_global_init(CURL_GLOBAL_ALL);
+			m_multi = ::curl_multi_init();
+			m_share = ::curl_share_init();
+			if (m_share) {
+				// all the easy handles are used in the engine thread, so that the shared data need not be locked
+				::curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+				::curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+			}
+			if (m_multi) {
+#if LIBCURL_VERSION_NUM >= 0x072B00
+				::curl_multi_setopt(m_multi, CURLMOPT_PIPELINING, (long)CURLPIPE_MULTIPLEX);
+#endif
+				m_threadPool = ThreadPool::create();
+				m_thread = Thread::start(SLIB_FUNCTION_CLASS(_UrlRequestCurlEngine, run, this));
+			}
+		}
+
+		~_UrlRequestCurlEngine()
+		{
+			if (m_thread.isNotNull()) {
+				m_thread->finish();
+				wake();
+				m_thread->finishAndWait();
+			}
+			if (m_multi) {
+				::curl_multi_cleanup(m_multi);
+			}
+			if (m_share) {
+				::curl_share_cleanup(m_share);
+			}
+		}
+
+	public:
+		sl_bool isRunning()
+		{
+			return m_thread.isNotNull();
+		}
+
+		sl_bool isEngineThread()
+		{
+			return Thread::getCurrent() == m_thread;
+		}
+
+		void addRequest(UrlRequest_Impl* request)
+		{
+			m_queueRequests.push(request);
+			wake();
+		}
+
+		void wake()
+		{
+#if defined(_URL_REQUEST_CURL_USE_MULTI_POLL)
+			::curl_multi_wakeup(m_multi);
+#endif
+		}
+
+		void dispatch(const Function<void()>& task)
+		{
+			if (m_threadPool.isNull() || !(m_threadPool->addTask(task))) {
+				task();
+			}
+		}
+
+		void run();
+
+		void _startRequests();
+
+		void _finishRequests();
+
+	};
+
+	SLIB_SAFE_STATIC_GETTER(_UrlRequestCurlEngine, _getUrlRequestCurlEngine)
+
 	class UrlRequest_Impl : public UrlRequest
 	{
 	public:
 		CURL* m_curl;
-		sl_bool m_flagClosed;
+		curl_slist* m_headerChunk;
+#if defined(SLIB_PLATFORM_IS_TIZEN)
+		connection_h m_connection;
+#endif
 		sl_bool m_flagProcessResponse;
 
+		friend class _UrlRequestCurlEngine;
+
 	public:
 		UrlRequest_Impl()
 		{
 			m_curl = sl_null;
-			m_flagClosed = sl_false;
+			m_headerChunk = sl_null;
+#if defined(SLIB_PLATFORM_IS_TIZEN)
+			m_connection = sl_null;
+#endif
 			m_flagProcessResponse = sl_false;
 		}
 
 		~UrlRequest_Impl()
 		{
+			_free();
 		}
 
 	public:
@@ -46,47 +172,90 @@ namespace slib
 		// override
 		void _cancel()
 		{
-			m_flagClosed = sl_true;
+			_UrlRequestCurlEngine* engine = _getUrlRequestCurlEngine();
+			if (engine) {
+				// the transfer is aborted by the progress callback
+				engine->wake();
+			}
+		}
+
+		// override
+		void _sendAsync()
+		{
+			_UrlRequestCurlEngine* engine = _getUrlRequestCurlEngine();
+			if (engine && engine->isRunning()) {
+				if (engine->isEngineThread()) {
+					// synchronous request from the transfer callbacks would block the engine
+					UrlRequest::_sendAsync();
+				} else {
+					engine->addRequest(this);
+				}
+				return;
+			}
+			onError();
 		}
 
 		// override
 		void _sendSync()
 		{
-			connection_h connection;
-			if (::connection_create(&connection) != CONNECTION_ERROR_NONE) {
-				onError();
+			_UrlRequestCurlEngine* engine = _getUrlRequestCurlEngine();
+			if (engine && engine->isRunning() && !(engine->isEngineThread())) {
+				UrlRequest::_sendSync();
 				return;
 			}
+			// blocking transfer, used by the synchronous requests on the engine thread and by the fallback of `_sendAsync()`
+			if (_prepare(sl_null)) {
+				CURLcode err = ::curl_easy_perform(m_curl);
+				processResponse();
+				_free();
+				_complete(err);
+			} else {
+				onError();
+			}
+		}
 
+		sl_bool _prepare(_UrlRequestCurlEngine* engine)
+		{
 			CURL* curl = ::curl_easy_init();
 			if (!curl) {
-				::connection_destroy(connection);
-				onError();
-				return;
+				return sl_false;
 			}
-
 			m_curl = curl;
 
-			char* proxy_address;
-			sl_bool flagSetProxy = sl_false;
-			int conn_err = ::connection_get_proxy(connection, CONNECTION_ADDRESS_FAMILY_IPV4, &proxy_address);
-			if (conn_err == CONNECTION_ERROR_NONE && proxy_address) {
-				if (proxy_address[0]) {
-					::curl_easy_setopt(curl, CURLOPT_PROXY, proxy_address);
-					flagSetProxy = sl_true;
-				}
-				::free(proxy_address);
-			}
-			if (!flagSetProxy) {
-				conn_err = ::connection_get_proxy(connection, CONNECTION_ADDRESS_FAMILY_IPV6, &proxy_address);
+#if defined(SLIB_PLATFORM_IS_TIZEN)
+			connection_h connection;
+			if (::connection_create(&connection) == CONNECTION_ERROR_NONE) {
+				m_connection = connection;
+				char* proxy_address;
+				sl_bool flagSetProxy = sl_false;
+				int conn_err = ::connection_get_proxy(connection, CONNECTION_ADDRESS_FAMILY_IPV4, &proxy_address);
 				if (conn_err == CONNECTION_ERROR_NONE && proxy_address) {
 					if (proxy_address[0]) {
 						::curl_easy_setopt(curl, CURLOPT_PROXY, proxy_address);
+						flagSetProxy = sl_true;
 					}
 					::free(proxy_address);
 				}
+				if (!flagSetProxy) {
+					conn_err = ::connection_get_proxy(connection, CONNECTION_ADDRESS_FAMILY_IPV6, &proxy_address);
+					if (conn_err == CONNECTION_ERROR_NONE && proxy_address) {
+						if (proxy_address[0]) {
+							::curl_easy_setopt(curl, CURLOPT_PROXY, proxy_address);
+						}
+						::free(proxy_address);
+					}
+				}
+				::connection_set_proxy_address_changed_cb(connection, UrlRequest_Impl::callbackProxyChanged, (void*)this);
 			}
-			::connection_set_proxy_address_changed_cb(connection, UrlRequest_Impl::callbackProxyChanged, (void*)this);
+#endif
+
+			if (engine) {
+				::curl_easy_setopt(curl, CURLOPT_PRIVATE, (void*)this);
+				if (engine->m_share) {
+					::curl_easy_setopt(curl, CURLOPT_SHARE, engine->m_share);
+				}
+			}
+			::curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
 
 			String url = m_url;
 			::curl_easy_setopt(curl, CURLOPT_URL, url.getData());
@@ -94,6 +263,17 @@ namespace slib
 			::curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
 			::curl_easy_setopt(curl, CURLOPT_MAXREDIRS, 10L);
 
+			if (m_flagHttp2) {
+#if LIBCURL_VERSION_NUM >= 0x072F00
+				::curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, (long)CURL_HTTP_VERSION_2TLS);
+#else
+				::curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, (long)CURL_HTTP_VERSION_2_0);
+#endif
+#if LIBCURL_VERSION_NUM >= 0x072B00
+				// waits for the existing connection to be multiplexed, instead of opening a new one
+				::curl_easy_setopt(curl, CURLOPT_PIPEWAIT, 1L);
+#endif
+			}
 			// Set http method
 			switch(m_method) {
 			case HttpMethod::GET:
@@ -106,7 +286,7 @@ namespace slib
 				::curl_easy_setopt(curl, CURLOPT_POST, 1L);
 				break;
 			case HttpMethod::PUT:
-				::curl_easy_setopt(curl, CURLOPT_PUT, 1L);
+				::curl_easy_setopt(curl, CURLOPT_UPLOAD, 1L);
 				break;
 			case HttpMethod::DELETE:
 				::curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "DELETE");
@@ -124,7 +304,7 @@ namespace slib
 				break;
 			}
 
-			curl_slist *headerChunk = sl_null;
+			curl_slist* headerChunk = sl_null;
 
 			// HTTP headers and additional headers
 			if(m_requestHeaders.isNotEmpty())
@@ -146,15 +326,19 @@ namespace slib
 				}
 			}
 			if (headerChunk) {
+				m_headerChunk = headerChunk;
 				::curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headerChunk);
 			}
 
-			// post data
+			// post data (`m_requestBody` is kept alive by the request)
 			Memory requestBody = m_requestBody;
 			if (m_method == HttpMethod::POST) {
 				::curl_easy_setopt(curl, CURLOPT_POSTFIELDS, requestBody.getData());
 				::curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, requestBody.getSize());
 			} else {
+				if (m_method == HttpMethod::PUT) {
+					::curl_easy_setopt(curl, CURLOPT_INFILESIZE_LARGE, (curl_off_t)(requestBody.getSize()));
+				}
 				if (requestBody.isNotEmpty()) {
 					::curl_easy_setopt(curl, CURLOPT_READFUNCTION, UrlRequest_Impl::callbackRead);
 					::curl_easy_setopt(curl, CURLOPT_READDATA, (void*)this);
@@ -169,27 +353,51 @@ namespace slib
 			::curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, UrlRequest_Impl::callbackWrite);
 			::curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void*)this);
 
-			/* getting data */
-			CURLcode err = ::curl_easy_perform(curl);
+			// aborts the canceled transfer
+			::curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
+			::curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, UrlRequest_Impl::callbackProgress);
+			::curl_easy_setopt(curl, CURLOPT_XFERINFODATA, (void*)this);
 
-			processResponse();
+			return sl_true;
+		}
 
+		void _complete(CURLcode err)
+		{
 			if (err == CURLE_OK) {
 				onComplete();
-			} else {
+			} else if (!m_flagClosed) {
 				String strError = ::curl_easy_strerror(err);
 				LogError("UrlRequest", "Error: %s", strError);
 				m_lastErrorMessage = strError;
 				onError();
 			}
+		}
 
-			if (headerChunk) {
-				::curl_slist_free_all(headerChunk);
+		void _free()
+		{
+			if (m_curl) {
+				::curl_easy_cleanup(m_curl);
+				m_curl = sl_null;
 			}
+			if (m_headerChunk) {
+				::curl_slist_free_all(m_headerChunk);
+				m_headerChunk = sl_null;
+			}
+#if defined(SLIB_PLATFORM_IS_TIZEN)
+			if (m_connection) {
+				::connection_destroy(m_connection);
+				m_connection = sl_null;
+			}
+#endif
+		}
 
-			::curl_easy_cleanup(curl);
-			::connection_destroy(connection);
-
+		static int callbackProgress(void* user_data, curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal, curl_off_t ulnow)
+		{
+			UrlRequest_Impl* req = (UrlRequest_Impl*)user_data;
+			if (req->m_flagClosed) {
+				return 1;
+			}
+			return 0;
 		}
 
 		void processResponse()
@@ -346,6 +554,87 @@ namespace slib
 	};
 
 
+	void _UrlRequestCurlEngine::run()
+	{
+		while (Thread::isNotStoppingCurrent()) {
+			_startRequests();
+			int nRunning = 0;
+			::curl_multi_perform(m_multi, &nRunning);
+			_finishRequests();
+			if (Thread::isStoppingCurrent()) {
+				break;
+			}
+#if defined(_URL_REQUEST_CURL_USE_MULTI_POLL)
+			::curl_multi_poll(m_multi, sl_null, 0, 1000, sl_null);
+#else
+			int nfds = 0;
+			::curl_multi_wait(m_multi, sl_null, 0, 50, &nfds);
+			if (!nfds && m_queueRequests.isEmpty()) {
+				Thread::sleep(10);
+			}
+#endif
+		}
+		// aborts the remaining transfers
+		Ref<UrlRequest_Impl> request;
+		while (m_queueRequests.pop(&request)) {
+			request->onError();
+		}
+		HashEntry< CURL*, Ref<UrlRequest_Impl> >* entry = m_mapActive.getFirstEntry();
+		while (entry) {
+			::curl_multi_remove_handle(m_multi, entry->key);
+			entry->value->_free();
+			entry->value->onError();
+			entry = entry->next;
+		}
+		m_mapActive.removeAll();
+	}
+
+	void _UrlRequestCurlEngine::_startRequests()
+	{
+		Ref<UrlRequest_Impl> request;
+		while (m_queueRequests.pop(&request)) {
+			if (request->isClosed()) {
+				continue;
+			}
+			// the limit is applied to the shared multi handle, so it is taken from the process-wide setting
+			sl_uint32 n = UrlRequest::getMaxConnectionsPerHost();
+			if (n != m_maxConnectionsPerHost) {
+				m_maxConnectionsPerHost = n;
+				::curl_multi_setopt(m_multi, CURLMOPT_MAX_HOST_CONNECTIONS, (long)n);
+			}
+			if (request->_prepare(this)) {
+				if (CURLM_OK == ::curl_multi_add_handle(m_multi, request->m_curl)) {
+					m_mapActive.put(request->m_curl, request);
+					continue;
+				}
+			}
+			request->_free();
+			request->onError();
+		}
+	}
+
+	void _UrlRequestCurlEngine::_finishRequests()
+	{
+		int nMessages = 0;
+		CURLMsg* msg;
+		while ((msg = ::curl_multi_info_read(m_multi, &nMessages))) {
+			if (msg->msg == CURLMSG_DONE) {
+				CURL* curl = msg->easy_handle;
+				CURLcode err = msg->data.result;
+				::curl_multi_remove_handle(m_multi, curl);
+				Ref<UrlRequest_Impl> request;
+				if (m_mapActive.remove(curl, &request)) {
+					// the easy handle is freed in the engine thread, and the connection is kept in the cache of the multi handle
+					request->processResponse();
+					request->_free();
+					dispatch(SLIB_BIND_REF(void(), UrlRequest_Impl, _complete, request.get(), err));
+				} else {
+					::curl_easy_cleanup(curl);
+				}
+			}
+		}
+	}
+
 	Ref<UrlRequest> UrlRequest::_create(const UrlRequestParam& param, const String& url)
 	{
 		return Ref<UrlRequest>::from(UrlRequest_Impl::create(param, url));